@@ -7,12 +7,17 @@
 // Press left/right arrow keys to increase/decrease the number of grid columns.
 // Press up/down arrow keys to increase/decrease the number of grid rows.
 // Press x, X, y, Y, z, Z to turn the pipe.
+//
+// The Release configuration is compiled with /arch:AVX2, so that meshBuilder.h
+// evaluates the pipe 8 vertices at a time. On a processor without AVX2, build the
+// ReleaseNoAVX2 configuration, which evaluates them one at a time.
 // 
 // Sumanta Guha.
 /////////////////////////////////////////////////////////////////////////////////
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -25,45 +30,55 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "meshBuilder.h"
+
 #define PI 3.14159265358979324
 
 using namespace std;
 
+// Vertex of the mesh.
+struct Vertex
+{
+   float coords[3];
+};
+
 // Globals. 
 static int p = 6; // Number of grid columns.
 static int q = 4; // Number of grid rows
-static float *vertices = NULL; // Vertex array of the mapped sample on the pipe.
+static vector<Vertex> vertices; // Vertex array of the mapped sample on the pipe.
 static float Xangle = 150.0, Yangle = 0.0, Zangle = 0.0; // Angles to rotate the pipe.
 
-// Fuctions to map the grid vertex (u_i,v_j) to the mesh vertex (f(u_i,v_j), g(u_i,v_j), h(u_i,v_j)) on the pipe.
-float f(int i, int j)
+// Surface mapping the grid vertex (u_i,v_j), u_i = (-1 + 2i/p)PI, v_j = (-1 + 2j/q)PI, 
+// to the mesh vertex (f(u_i,v_j), g(u_i,v_j), h(u_i,v_j)) on the pipe, where 
+// f(u,v) = cos u + sin v, g(u,v) = sin u + cos v and h(u,v) = u.
+struct PipeSurface
 {
-   return ( cos( (-1 + 2*(float)i/p) * PI ) + sin( (-1 + 2*(float)j/q) * PI ) );
-}
+   AngleTable longAngles, latAngles;
 
-float g(int i, int j)
-{
-   return ( sin( (-1 + 2*(float)i/p) * PI )  + cos( (-1 + 2*(float)j/q) * PI ) );
-}
+   PipeSurface(int p, int q) : longAngles(p, -PI, 2.0 * PI / p), latAngles(q, -PI, 2.0 * PI / q) {}
 
-float h(int i, int j)
-{
-   return ( (-1 + 2*(float)i/p) * PI );
-}
+   template <class T>
+   void operator()(SurfacePoint<T> &point, const SurfaceAngle<T> &u, const SurfaceAngle<float> &v) const
+   {
+      point.x = u.cosine + v.sine;
+      point.y = u.sine + v.cosine;
+      point.z = u.angle;
+   }
 
-// Routine to fill the vertex array with co-ordinates of the mapped sample points.
+   void store(Vertex &vertex, const SurfacePoint<float> &point) const
+   {
+      vertex.coords[0] = point.x;
+      vertex.coords[1] = point.y;
+      vertex.coords[2] = point.z;
+   }
+};
+
+// Routine to fill the vertex array with co-ordinates of the mapped sample points,
+// called whenever the grid changes.
 void fillVertexArray(void)
 {
-   int i, j, k;
-
-   k = 0;
-   for (j = 0; j <= q; j++)
-      for (i = 0; i <= p; i++)
-      {
-         vertices[k++] = f(i,j);
-         vertices[k++] = g(i,j);
-         vertices[k++] = h(i,j);
-      }
+   vertices.resize(gridNumVertices(p, q));
+   fillSurfaceVertices(&vertices[0], p, q, PipeSurface(p, q));
 }
 
 // Initialization routine.
@@ -72,15 +87,16 @@ void setup(void)
    glEnableClientState(GL_VERTEX_ARRAY);
 
    glClearColor(1.0, 1.0, 1.0, 0.0); 
+
+   fillVertexArray();
 }
 
 // Drawing routine.
 void drawScene(void)
 {
    int  i, j;
-   vertices = new float[3*(p+1)*(q+1)]; // Dynamic array allocation with new value of p and q. 
 
-   glVertexPointer(3, GL_FLOAT, 0, vertices);
+   glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
    glClear(GL_COLOR_BUFFER_BIT);
 
    glLoadIdentity();
@@ -95,9 +111,6 @@ void drawScene(void)
    glRotatef(Yangle, 0.0, 1.0, 0.0);
    glRotatef(Xangle, 1.0, 0.0, 0.0);
 
-   // Fill the vertex array.
-   fillVertexArray();
-
    // Make the approximating triangular mesh.
    for(j = 0; j < q; j++)
    {
@@ -175,6 +188,9 @@ void specialKeyInput(int key, int x, int y)
    if (key == GLUT_KEY_DOWN) if (q > 3) q -= 1;
    if (key == GLUT_KEY_UP) q += 1;
 
+   // Refill the vertex array for the new grid.
+   fillVertexArray();
+
    glutPostRedisplay();
 }
 
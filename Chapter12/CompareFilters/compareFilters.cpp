@@ -29,7 +29,7 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
-#include "getbmp.h"
+#include "textureCache.h"
 
 using namespace std;
 
@@ -43,16 +43,16 @@ static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
 // Load external texture.
 void loadExternalTextures()			
 {
-   // Local storage for bmp image data.
-   BitMapFile *image[1];
+   // Local storage for cached image data.
+   CachedTexture *image[1];
    
    // Load the image.
-   image[0] = getbmp("../../Textures/launch.bmp"); 
+   image[0] = getCachedTexture("../../Textures/launch.bmp"); 
+   if (image[0] == NULL) exit(1); // getCachedTexture() has printed why.
 
    // Bind image to texture object texture[0] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-    	        GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCached(image[0], false);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -60,8 +60,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[1] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[1]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-    	        GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCached(image[0], false);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -69,9 +68,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[2] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[2]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
@@ -79,9 +76,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[3] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[3]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
@@ -89,9 +84,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[4] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[4]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
@@ -99,9 +92,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[5] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[5]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -109,8 +100,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[6] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[6]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-    	        GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCached(image[0], false);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -118,8 +108,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[7] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[7]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-    	        GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCached(image[0], false);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -127,9 +116,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[8] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[8]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
@@ -137,9 +124,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[9] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[9]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
@@ -147,9 +132,7 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[10] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[10]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
@@ -157,13 +140,14 @@ void loadExternalTextures()
 
    // Bind image to texture object texture[11] with specified mag and min filters.
    glBindTexture(GL_TEXTURE_2D, texture[11]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+   // The texture objects hold copies of the images.
+   releaseCachedTexture(image[0]);
 }
 
 // Routine to draw a bitmap character string.
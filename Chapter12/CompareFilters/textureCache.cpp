@@ -0,0 +1,334 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#ifdef _WIN32
+#  include <windows.h>
+#  include <direct.h>
+#  include <sys/utime.h>
+#else
+#  include <dirent.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <utime.h>
+#endif
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "getbmp.h"
+#include "mipmap.h"
+#include "textureCache.h"
+
+using namespace std;
+
+// Header at the start of a cache file, followed by a table of numLevels
+// CacheLevel entries and then the RGBA data of all the levels (the payload).
+struct CacheHeader
+{
+   char magic[4]; // "CGTC"
+   unsigned int version;
+   unsigned int numLevels;
+   unsigned int reserved;
+   unsigned long long sourceHash; // Hash of the source image file.
+   unsigned long long payloadSize;
+   unsigned long long payloadChecksum; // Hash of the payload, to detect corruption.
+};
+
+struct CacheLevel
+{
+   unsigned int sizeX;
+   unsigned int sizeY;
+   unsigned long long offset; // Start of the level's data in the payload.
+};
+
+#define TEX_CACHE_VERSION 3
+
+// 64-bit FNV-1a hash, taken over 8-byte words with the remaining bytes one at a time.
+static unsigned long long hashBytes(const unsigned char *p, unsigned long long size)
+{
+   unsigned long long hash = 14695981039346656037ULL, word;
+   unsigned long long i = 0;
+   for (; i + 8 <= size; i += 8)
+   {
+      memcpy(&word, p + i, 8);
+      hash = (hash ^ word) * 1099511628211ULL;
+   }
+   for (; i < size; i++) hash = (hash ^ p[i]) * 1099511628211ULL;
+   return hash;
+}
+
+// Map a whole file read-only into memory. Returns NULL if it cannot be mapped.
+static const unsigned char *mapFile(string filename, long *size, void **handle)
+{
+   const unsigned char *file = NULL;
+   *size = 0;
+   *handle = NULL;
+#ifdef _WIN32
+   HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (fileHandle == INVALID_HANDLE_VALUE) return NULL;
+   *size = (long)GetFileSize(fileHandle, NULL);
+   HANDLE mapHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+   CloseHandle(fileHandle);
+   if (mapHandle == NULL) return NULL;
+   file = (const unsigned char *)MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+   if (file == NULL) CloseHandle(mapHandle);
+   else *handle = mapHandle;
+#else
+   int fd = open(filename.c_str(), O_RDONLY);
+   struct stat fileStat;
+   if (fd < 0) return NULL;
+   if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+   {
+      *size = (long)fileStat.st_size;
+      void *mapped = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) file = (const unsigned char *)mapped;
+   }
+   close(fd);
+#endif
+   return file;
+}
+
+// Unmap a file mapped by mapFile().
+static void unmapFile(const unsigned char *file, long size, void *handle)
+{
+   if (file == NULL) return;
+#ifdef _WIN32
+   (void)size;
+   UnmapViewOfFile(file);
+   CloseHandle((HANDLE)handle);
+#else
+   (void)handle;
+   munmap((void *)file, size);
+#endif
+}
+
+// Fill in the levels of a texture from a mapped cache file, checking the file
+// is complete and uncorrupted. Returns false if it isn't.
+static bool readCacheFile(const unsigned char *file, long size, unsigned long long sourceHash,
+                          CachedTexture *texture)
+{
+   CacheHeader header;
+   if (size < (long)sizeof(CacheHeader)) return false;
+   memcpy(&header, file, sizeof(CacheHeader));
+   if (memcmp(header.magic, "CGTC", 4) != 0 || header.version != TEX_CACHE_VERSION ||
+       header.sourceHash != sourceHash || header.numLevels < 1 || header.numLevels > TEX_CACHE_MAX_LEVELS)
+      return false;
+
+   unsigned long long payloadStart = sizeof(CacheHeader) + header.numLevels * sizeof(CacheLevel);
+   if (payloadStart + header.payloadSize != (unsigned long long)size) return false;
+   const unsigned char *payload = file + payloadStart;
+   if (hashBytes(payload, header.payloadSize) != header.payloadChecksum) return false;
+
+   texture->numLevels = header.numLevels;
+   for (int i = 0; i < texture->numLevels; i++)
+   {
+      CacheLevel level;
+      memcpy(&level, file + sizeof(CacheHeader) + i * sizeof(CacheLevel), sizeof(CacheLevel));
+      if (level.offset + 4ULL * level.sizeX * level.sizeY > header.payloadSize) return false;
+      texture->sizeX[i] = level.sizeX;
+      texture->sizeY[i] = level.sizeY;
+      texture->data[i] = payload + level.offset;
+   }
+   return true;
+}
+
+// Decode an image, build its mipmap levels and write them to a new cache file.
+static bool writeCacheFile(string filename, string cacheFilename, unsigned long long sourceHash)
+{
+   BitMapFile *image = getbmp(filename);
+   if (image == NULL) return false;
+
+   // Level sizes, halving down to 1x1.
+   CacheHeader header;
+   CacheLevel levels[TEX_CACHE_MAX_LEVELS];
+   int numLevels = 0, sizeX = image->sizeX, sizeY = image->sizeY;
+   unsigned long long payloadSize = 0;
+   for (;;)
+   {
+      levels[numLevels].sizeX = sizeX;
+      levels[numLevels].sizeY = sizeY;
+      levels[numLevels].offset = payloadSize;
+      payloadSize += 4ULL * sizeX * sizeY;
+      numLevels++;
+      if ((sizeX == 1 && sizeY == 1) || numLevels == TEX_CACHE_MAX_LEVELS) break;
+      nextMipmapSize(sizeX, sizeY, &sizeX, &sizeY);
+   }
+
+   // Fill the payload, each level filtered from the one before with a gamma-correct
+   // Kaiser filter, sharper than the box filter drivers generally use.
+   vector<unsigned char> payload(payloadSize);
+   memcpy(&payload[0], image->data, 4 * image->sizeX * image->sizeY);
+   for (int i = 1; i < numLevels; i++)
+      buildMipmapLevel(&payload[levels[i-1].offset], levels[i-1].sizeX, levels[i-1].sizeY,
+                       &payload[levels[i].offset], MIP_KAISER, true);
+   delete[] image->data;
+   delete image;
+
+   memcpy(header.magic, "CGTC", 4);
+   header.version = TEX_CACHE_VERSION;
+   header.numLevels = numLevels;
+   header.reserved = 0;
+   header.sourceHash = sourceHash;
+   header.payloadSize = payloadSize;
+   header.payloadChecksum = hashBytes(&payload[0], payloadSize);
+
+   // Write to a temporary file and rename it, so other programs never see a partial file.
+#ifdef _WIN32
+   _mkdir(TEX_CACHE_DIR);
+#else
+   mkdir(TEX_CACHE_DIR, 0755);
+#endif
+   string tempFilename = cacheFilename + ".tmp";
+   FILE *out = fopen(tempFilename.c_str(), "wb");
+   if (out == NULL) return false;
+   bool written = fwrite(&header, sizeof(CacheHeader), 1, out) == 1 &&
+                  fwrite(levels, sizeof(CacheLevel), numLevels, out) == (size_t)numLevels &&
+                  fwrite(&payload[0], 1, payloadSize, out) == payloadSize;
+   written = (fclose(out) == 0) && written;
+   remove(cacheFilename.c_str());
+   if (!written || rename(tempFilename.c_str(), cacheFilename.c_str()) != 0)
+   {
+      remove(tempFilename.c_str());
+      return false;
+   }
+   return true;
+}
+
+// Routine to get the decoded and mipmapped RGBA levels of an uncompressed bmp file.
+// The cache file keyed by the hash of the bmp file's contents is mapped if it exists
+// and is intact; otherwise the bmp file is decoded and the cache file (re)written.
+// Returns NULL if the bmp file cannot be read. Release with releaseCachedTexture().
+CachedTexture *getCachedTexture(string filename)
+{
+   // Hash the source file.
+   long sourceSize;
+   void *sourceHandle;
+   const unsigned char *source = mapFile(filename, &sourceSize, &sourceHandle);
+   if (source == NULL)
+   {
+      cout << "getCachedTexture: cannot open " << filename << endl;
+      return NULL;
+   }
+   unsigned long long sourceHash = hashBytes(source, sourceSize);
+   unmapFile(source, sourceSize, sourceHandle);
+
+   char hashName[17];
+   sprintf(hashName, "%016llx", sourceHash);
+   string cacheFilename = string(TEX_CACHE_DIR) + hashName + ".tex";
+
+   CachedTexture *texture = new CachedTexture;
+   texture->fromCache = true;
+   for (int attempt = 0; attempt < 2; attempt++)
+   {
+      texture->mapping = (void *)mapFile(cacheFilename, &texture->mappingSize, &texture->mappingHandle);
+      if (texture->mapping != NULL &&
+          readCacheFile((const unsigned char *)texture->mapping, texture->mappingSize, sourceHash, texture))
+      {
+         // Mark the file as recently used for eviction.
+         utime(cacheFilename.c_str(), NULL);
+         return texture;
+      }
+
+      // Missing or corrupt: (re)build the cache file and try once more.
+      unmapFile((const unsigned char *)texture->mapping, texture->mappingSize, texture->mappingHandle);
+      texture->fromCache = false;
+      if (attempt == 0 && !writeCacheFile(filename, cacheFilename, sourceHash)) break;
+   }
+
+   cout << "getCachedTexture: cannot cache " << filename << endl;
+   delete texture;
+   return NULL;
+}
+
+// Specify the image of the currently bound 2D texture object from a cached texture,
+// either its base level only or all its mipmap levels.
+void texImageCached(CachedTexture *texture, bool mipmaps)
+{
+   int numLevels = mipmaps ? texture->numLevels : 1;
+   for (int i = 0; i < numLevels; i++)
+      glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, texture->sizeX[i], texture->sizeY[i], 0,
+                   GL_RGBA, GL_UNSIGNED_BYTE, texture->data[i]);
+   if (mipmaps) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+}
+
+// Unmap and free a cached texture.
+void releaseCachedTexture(CachedTexture *texture)
+{
+   unmapFile((const unsigned char *)texture->mapping, texture->mappingSize, texture->mappingHandle);
+   delete texture;
+}
+
+// A cache file's name, size and last use time, for eviction.
+struct CacheEntry
+{
+   string filename;
+   long long size;
+   long long lastUsed;
+};
+
+static bool usedEarlier(const CacheEntry &a, const CacheEntry &b) { return a.lastUsed < b.lastUsed; }
+
+// Delete the least recently used cache files until the cache holds at most
+// maxSize bytes. Returns the resulting size of the cache.
+long long evictTextureCache(long long maxSize)
+{
+   vector<CacheEntry> entries;
+   long long totalSize = 0;
+
+#ifdef _WIN32
+   WIN32_FIND_DATAA found;
+   HANDLE find = FindFirstFileA((string(TEX_CACHE_DIR) + "*.tex").c_str(), &found);
+   if (find != INVALID_HANDLE_VALUE)
+   {
+      do
+      {
+         CacheEntry entry;
+         entry.filename = string(TEX_CACHE_DIR) + found.cFileName;
+         entry.size = ((long long)found.nFileSizeHigh << 32) | found.nFileSizeLow;
+         entry.lastUsed = ((long long)found.ftLastWriteTime.dwHighDateTime << 32) | found.ftLastWriteTime.dwLowDateTime;
+         entries.push_back(entry);
+      } while (FindNextFileA(find, &found));
+      FindClose(find);
+   }
+#else
+   DIR *dir = opendir(TEX_CACHE_DIR);
+   if (dir != NULL)
+   {
+      struct dirent *found;
+      while ((found = readdir(dir)) != NULL)
+      {
+         string name = found->d_name;
+         struct stat fileStat;
+         if (name.size() < 4 || name.compare(name.size() - 4, 4, ".tex") != 0) continue;
+         CacheEntry entry;
+         entry.filename = string(TEX_CACHE_DIR) + name;
+         if (stat(entry.filename.c_str(), &fileStat) != 0) continue;
+         entry.size = (long long)fileStat.st_size;
+         entry.lastUsed = (long long)fileStat.st_mtime;
+         entries.push_back(entry);
+      }
+      closedir(dir);
+   }
+#endif
+
+   for (int i = 0; i < (int)entries.size(); i++) totalSize += entries[i].size;
+   sort(entries.begin(), entries.end(), usedEarlier);
+   for (int i = 0; i < (int)entries.size() && totalSize > maxSize; i++)
+      if (remove(entries[i].filename.c_str()) == 0) totalSize -= entries[i].size;
+
+   return totalSize;
+}
@@ -42,6 +42,7 @@ void loadExternalTextures()
    // Load the images.
    image[0] = getbmp("../../Textures/grass.bmp");
    image[1] = getbmp("../../Textures/sky.bmp");
+   if (image[0] == NULL || image[1] == NULL) exit(1); // getbmp() has printed why.
    
    // Bind grass image to texture object texture[0]. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
@@ -60,6 +61,13 @@ void loadExternalTextures()
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+   // OpenGL has its own copy of the images now.
+   for (int i = 0; i < 2; i++)
+   {
+      delete[] image[i]->data;
+      delete image[i];
+   }
 		
 }
 
@@ -45,6 +45,7 @@ void loadExternalTextures()
    
    // Load the image.
    image[0] = getbmp("../../Textures/cray2.bmp"); 
+   if (image[0] == NULL) exit(1); // getbmp() has printed why.
 
    // Create texture object texture[0]. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
@@ -53,6 +54,10 @@ void loadExternalTextures()
    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
 	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
 
+   // OpenGL has its own copy of the image now.
+   delete[] image[0]->data;
+   delete image[0];
+
    // Set texture parameters for wrapping.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
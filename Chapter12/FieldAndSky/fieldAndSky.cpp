@@ -27,6 +27,7 @@
 #endif
 
 #include "getbmp.h"
+#include "compressedTexture.h"
 
 using namespace std;
 
@@ -37,17 +38,17 @@ static float d = 0.0; // Distance parameter in gluLookAt().
 // Load external textures.
 void loadExternalTextures()			
 {
-   // Local storage for bmp image data.
-   BitMapFile *image[2];
+   // Local storage for compressed image data.
+   CompressedTexture *image[2];
 
-   // Load the images.
-   image[0] = getbmp("../../Textures/grass.bmp");
-   image[1] = getbmp("../../Textures/sky.bmp");
+   // Load the images compressed to BC1, 1/8 the size of RGBA to upload and store.
+   image[0] = getCompressedTexture("../../Textures/grass.bmp", TEX_BC1);
+   image[1] = getCompressedTexture("../../Textures/sky.bmp", TEX_BC1);
+   if (image[0] == NULL || image[1] == NULL) exit(1); // getbmp() has printed why.
    
    // Bind grass image to texture object texture[0]. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCompressed(image[0]);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
@@ -55,12 +56,18 @@ void loadExternalTextures()
 
    // Bind sky image to texture object texture[1]
    glBindTexture(GL_TEXTURE_2D, texture[1]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[1]->sizeX, image[1]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[1]->data);		
+   texImageCompressed(image[1]);		
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);		
+
+   // OpenGL has its own copy of the images now.
+   for (int i = 0; i < 2; i++)
+   {
+      delete[] image[i]->data;
+      delete image[i];
+   }
 }
 
 // Initialization routine.
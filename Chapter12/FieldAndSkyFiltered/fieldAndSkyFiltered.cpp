@@ -28,7 +28,7 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
-#include "getbmp.h"
+#include "textureCache.h"
 
 using namespace std;
 
@@ -41,17 +41,17 @@ static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
 // Load external textures.
 void loadExternalTextures()			
 {
-   // Local storage for bmp image data.
-   BitMapFile *image[7]; 
+   // Local storage for cached image data.
+   CachedTexture *image[2];
    
    // Load the images.
-   image[0] = getbmp("../../Textures/grass.bmp");
-   image[1] = getbmp("../../Textures/sky.bmp");   
+   image[0] = getCachedTexture("../../Textures/grass.bmp");
+   image[1] = getCachedTexture("../../Textures/sky.bmp");   
+   if (image[0] == NULL || image[1] == NULL) exit(1); // getCachedTexture() has printed why.
 
    // Bind grass image to texture index[0] with specified mag and min filters. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCached(image[0], false);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -59,8 +59,7 @@ void loadExternalTextures()
 
    // Bind grass image to texture index[1] with specified mag and min filters. 
    glBindTexture(GL_TEXTURE_2D, texture[1]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCached(image[0], false);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -69,9 +68,7 @@ void loadExternalTextures()
    // Bind grass image to texture index[2] with specified mag and min filters. 
    // Use mipmapping.
    glBindTexture(GL_TEXTURE_2D, texture[2]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
@@ -80,9 +77,7 @@ void loadExternalTextures()
    // Bind grass image to texture index[3] with specified mag and min filters.
    // Use mipmapping.
    glBindTexture(GL_TEXTURE_2D, texture[3]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
@@ -91,9 +86,7 @@ void loadExternalTextures()
    // Bind grass image to texture index[4] with specified mag and min filters. 
    // Use mipmapping.
    glBindTexture(GL_TEXTURE_2D, texture[4]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
@@ -102,9 +95,7 @@ void loadExternalTextures()
    // Bind grass image to texture index[5] with specified mag and min filters. 
    // Use mipmapping.
    glBindTexture(GL_TEXTURE_2D, texture[5]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
-   glGenerateMipmap(GL_TEXTURE_2D);
+   texImageCached(image[0], true); // Mipmap levels come prebuilt from the cache.
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -112,12 +103,15 @@ void loadExternalTextures()
 
    // Bind sky image to texture index[6]
    glBindTexture(GL_TEXTURE_2D, texture[6]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[1]->sizeX, image[1]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[1]->data);		
+   texImageCached(image[1], false);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+   // The texture objects hold copies of the images.
+   releaseCachedTexture(image[0]);
+   releaseCachedTexture(image[1]);
 }
 
 // Routine to draw a bitmap character string.
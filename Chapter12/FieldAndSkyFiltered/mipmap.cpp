@@ -0,0 +1,395 @@
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+// SSE2 is available on every x86-64 processor.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define MIPMAP_SSE2
+#endif
+
+#include "mipmap.h"
+
+using namespace std;
+
+#define PI 3.14159265358979324
+#define MIP_RADIUS 2.0 // Radius of the Kaiser and Lanczos filters, in texels of the coarser level.
+#define MIP_MIN_THREADED_ROWS 64 // Levels with fewer rows are filtered by one thread.
+
+// Number of mipmap levels of an image, from the image itself down to 1x1.
+int numMipmapLevels(int sizeX, int sizeY)
+{
+   int numLevels = 1;
+   while (sizeX > 1 || sizeY > 1)
+   {
+      nextMipmapSize(sizeX, sizeY, &sizeX, &sizeY);
+      numLevels++;
+   }
+   return numLevels;
+}
+
+// Size of the next mipmap level: each dimension is halved, rounding down, as OpenGL
+// specifies for non-power-of-two textures.
+void nextMipmapSize(int sizeX, int sizeY, int *nextSizeX, int *nextSizeY)
+{
+   *nextSizeX = max(1, sizeX / 2);
+   *nextSizeY = max(1, sizeY / 2);
+}
+
+// Lookup tables between 8-bit sRGB values and linear intensity in [0, 1].
+static float sRGBToLinear[256];
+static unsigned char linearToSRGB[4096];
+
+static void initSRGBTables(void)
+{
+   static bool initialized = false;
+   if (initialized) return;
+   for (int i = 0; i < 256; i++)
+   {
+      float c = i / 255.0f;
+      sRGBToLinear[i] = (c <= 0.04045f) ? c / 12.92f : (float)pow((c + 0.055) / 1.055, 2.4);
+   }
+   for (int i = 0; i < 4096; i++)
+   {
+      float c = i / 4095.0f;
+      c = (c <= 0.0031308f) ? c * 12.92f : 1.055f * (float)pow(c, 1.0 / 2.4) - 0.055f;
+      linearToSRGB[i] = (unsigned char)(255.0f * c + 0.5f);
+   }
+   initialized = true;
+}
+
+// Convert a filtered value back to 8 bits, clamping the overshoot of the sinc filters.
+static unsigned char toByte(float value, bool linear)
+{
+   value = min(max(value, 0.0f), 1.0f);
+   return linear ? linearToSRGB[(int)(4095.0f * value + 0.5f)] : (unsigned char)(255.0f * value + 0.5f);
+}
+
+// Box filter rows [firstRow, lastRow) of the next level, of an image whose dimensions
+// are even or 1, in 8-bit integer arithmetic.
+static void boxRows(const unsigned char *in, int inX, int inY, unsigned char *out, int outX,
+                    int firstRow, int lastRow)
+{
+   for (int y = firstRow; y < lastRow; y++)
+   {
+      const unsigned char *row0 = in + 4 * inX * min(2 * y, inY - 1);
+      const unsigned char *row1 = in + 4 * inX * min(2 * y + 1, inY - 1);
+      unsigned char *outRow = out + 4 * outX * y;
+      int x = 0;
+#ifdef MIPMAP_SSE2
+      // Two output texels from each 4 texels of both input rows.
+      const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+      for (; 2 * x + 4 <= inX && x + 2 <= outX; x += 2)
+      {
+         __m128i a = _mm_loadu_si128((const __m128i *)(row0 + 8 * x));
+         __m128i b = _mm_loadu_si128((const __m128i *)(row1 + 8 * x));
+         __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+         __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+         __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+         sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+         _mm_storel_epi64((__m128i *)(outRow + 4 * x), _mm_packus_epi16(sum, sum));
+      }
+#endif
+      for (; x < outX; x++)
+      {
+         int x0 = 4 * min(2 * x, inX - 1), x1 = 4 * min(2 * x + 1, inX - 1);
+         for (int c = 0; c < 4; c++)
+            outRow[4 * x + c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4;
+      }
+   }
+}
+
+// Box filter rows [firstRow, lastRow) of the next level, of an image whose dimensions
+// are even or 1, averaging color in linear space.
+static void boxRowsSRGB(const unsigned char *in, int inX, int inY, unsigned char *out, int outX,
+                        int firstRow, int lastRow)
+{
+   for (int y = firstRow; y < lastRow; y++)
+   {
+      const unsigned char *row0 = in + 4 * inX * min(2 * y, inY - 1);
+      const unsigned char *row1 = in + 4 * inX * min(2 * y + 1, inY - 1);
+      unsigned char *outRow = out + 4 * outX * y;
+      for (int x = 0; x < outX; x++)
+      {
+         int x0 = 4 * min(2 * x, inX - 1), x1 = 4 * min(2 * x + 1, inX - 1);
+         for (int c = 0; c < 3; c++)
+            outRow[4 * x + c] = toByte(0.25f * (sRGBToLinear[row0[x0 + c]] + sRGBToLinear[row0[x1 + c]] +
+                                                sRGBToLinear[row1[x0 + c]] + sRGBToLinear[row1[x1 + c]]), true);
+         outRow[4 * x + 3] = (row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3] + 2) / 4;
+      }
+   }
+}
+
+// Taps of a filter along one dimension of a level: output texel x is the sum of
+// weights[numTaps * x + i] times input texel first[x] + i, 0 <= i < numTaps, input
+// texels beyond the edges clamped to the edges.
+struct FilterTaps
+{
+   int numTaps;
+   vector<int> first;
+   vector<float> weights;
+};
+
+// Taps of the box filter halving a dimension of in texels to out. An even dimension
+// averages input texels 2x and 2x+1; an odd one, 2out+1 texels, weighs input texels
+// 2x to 2x+2 by how much of each output texel x covers, so that no texel is dropped
+// and the image does not shift.
+static void boxTaps(int in, int out, FilterTaps &taps)
+{
+   taps.numTaps = 3;
+   taps.first.resize(out);
+   taps.weights.resize(3 * out);
+   for (int x = 0; x < out; x++)
+   {
+      float *weights = &taps.weights[3 * x];
+      taps.first[x] = (in == 1) ? 0 : 2 * x;
+      if (in == 1) { weights[0] = 1.0; weights[1] = weights[2] = 0.0; }
+      else if (in % 2 == 0) { weights[0] = weights[1] = 0.5; weights[2] = 0.0; }
+      else
+      {
+         weights[0] = (float)(out - x) / (2 * out + 1);
+         weights[1] = (float)out / (2 * out + 1);
+         weights[2] = (float)(x + 1) / (2 * out + 1);
+      }
+   }
+}
+
+// Box filter rows [firstRow, lastRow) of the next level of an image with an odd
+// dimension, by the taps of boxTaps(), color averaged as linear intensity if sRGB.
+static void boxRowsOdd(const unsigned char *in, int inX, int inY, unsigned char *out, int outX,
+                       const FilterTaps *tapsX, const FilterTaps *tapsY, bool sRGB, int firstRow, int lastRow)
+{
+   float colorToFloat[256];
+   for (int i = 0; i < 256; i++) colorToFloat[i] = sRGB ? sRGBToLinear[i] : i * (1.0f / 255.0f);
+   for (int y = firstRow; y < lastRow; y++)
+   {
+      unsigned char *outRow = out + 4 * outX * y;
+      for (int x = 0; x < outX; x++)
+      {
+         float sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+         for (int j = 0; j < 3; j++)
+         {
+            float weightY = tapsY->weights[3 * y + j];
+            const unsigned char *row = in + 4 * inX * min(tapsY->first[y] + j, inY - 1);
+            for (int i = 0; i < 3; i++)
+            {
+               float weight = weightY * tapsX->weights[3 * x + i];
+               const unsigned char *texel = row + 4 * min(tapsX->first[x] + i, inX - 1);
+               for (int c = 0; c < 3; c++) sum[c] += weight * colorToFloat[texel[c]];
+               sum[3] += weight * texel[3] * (1.0f / 255.0f);
+            }
+         }
+         for (int c = 0; c < 3; c++) outRow[4 * x + c] = toByte(sum[c], sRGB);
+         outRow[4 * x + 3] = toByte(sum[3], false);
+      }
+   }
+}
+
+// Value at distance t, in texels of the coarser level, of a windowed sinc filter.
+static double sincKernel(int filter, double t)
+{
+   if (t == 0.0) return 1.0;
+   double sinc = sin(PI * t) / (PI * t);
+   if (filter == MIP_LANCZOS) return sinc * sin(PI * t / MIP_RADIUS) / (PI * t / MIP_RADIUS);
+
+   // Kaiser window of radius 2 with alpha 4, the Bessel function I0 by its series.
+   double alpha = 4.0, u = alpha * sqrt(max(0.0, 1.0 - t * t / (MIP_RADIUS * MIP_RADIUS)));
+   double i0u = 1.0, i0a = 1.0, termU = 1.0, termA = 1.0;
+   for (int k = 1; k < 20; k++)
+   {
+      termU *= (u / (2.0 * k)) * (u / (2.0 * k));
+      termA *= (alpha / (2.0 * k)) * (alpha / (2.0 * k));
+      i0u += termU;
+      i0a += termA;
+   }
+   return sinc * i0u / i0a;
+}
+
+// Taps of a windowed sinc filter reducing a dimension of in texels to out. Output
+// texel x is centered at (x + 0.5) in/out in input texels, between input texels 2x and
+// 2x+1 when in is even, and its taps are the input texels whose centers lie within
+// MIP_RADIUS output texels, 8 of them when in is even.
+static void sincTaps(int filter, int in, int out, FilterTaps &taps)
+{
+   double scale = (double)in / out;
+   taps.numTaps = (int)ceil(2.0 * MIP_RADIUS * scale);
+   taps.first.resize(out);
+   taps.weights.resize(taps.numTaps * out);
+   for (int x = 0; x < out; x++)
+   {
+      double center = (x + 0.5) * scale;
+      int first = (int)floor(center - MIP_RADIUS * scale - 0.5) + 1;
+      float *weights = &taps.weights[taps.numTaps * x], sum = 0.0;
+      for (int i = 0; i < taps.numTaps; i++)
+      {
+         double t = (first + i + 0.5 - center) / scale; // Distance from the center in output texels.
+         weights[i] = (fabs(t) < MIP_RADIUS) ? (float)sincKernel(filter, t) : 0.0f;
+         sum += weights[i];
+      }
+      for (int i = 0; i < taps.numTaps; i++) weights[i] /= sum;
+      taps.first[x] = first;
+   }
+}
+
+// Weighted sum of numTaps RGBA texels given as floats, spaced stride floats apart.
+static inline void filterTaps(const float *in, int stride, const float *weights, int numTaps, float *out)
+{
+#ifdef MIPMAP_SSE2
+   __m128 sum = _mm_setzero_ps();
+   for (int i = 0; i < numTaps; i++)
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + i * stride), _mm_set1_ps(weights[i])));
+   _mm_storeu_ps(out, sum);
+#else
+   out[0] = out[1] = out[2] = out[3] = 0.0;
+   for (int i = 0; i < numTaps; i++)
+      for (int c = 0; c < 4; c++) out[c] += weights[i] * in[i * stride + c];
+#endif
+}
+
+// Horizontal pass of the separable filter over input rows [firstRow, lastRow):
+// convert each row to float RGBA, padded by clamping, and filter it to outX texels.
+static void sincRowsHorizontal(const unsigned char *in, int inX, float *temp, int outX,
+                               const FilterTaps *taps, bool sRGB, int firstRow, int lastRow)
+{
+   int pad = taps->numTaps;
+   vector<float> row(4 * (inX + 2 * pad));
+   float colorToFloat[256];
+   for (int i = 0; i < 256; i++) colorToFloat[i] = sRGB ? sRGBToLinear[i] : i * (1.0f / 255.0f);
+   for (int y = firstRow; y < lastRow; y++)
+   {
+      const unsigned char *inRow = in + 4 * inX * y;
+      for (int x = -pad; x < inX + pad; x++)
+      {
+         const unsigned char *texel = inRow + 4 * min(max(x, 0), inX - 1);
+         float *value = &row[4 * (x + pad)];
+         for (int c = 0; c < 3; c++) value[c] = colorToFloat[texel[c]];
+         value[3] = texel[3] * (1.0f / 255.0f);
+      }
+      for (int x = 0; x < outX; x++)
+         filterTaps(&row[4 * (taps->first[x] + pad)], 4, &taps->weights[taps->numTaps * x], taps->numTaps,
+                    temp + 4 * (outX * y + x));
+   }
+}
+
+// Vertical pass of the separable filter producing output rows [firstRow, lastRow):
+// accumulate the weighted input rows of each output row, then convert it to 8 bits.
+static void sincRowsVertical(const float *temp, int inY, unsigned char *out, int outX,
+                             const FilterTaps *taps, bool sRGB, int firstRow, int lastRow)
+{
+   vector<float> sum(4 * outX);
+   for (int y = firstRow; y < lastRow; y++)
+   {
+      fill(sum.begin(), sum.end(), 0.0f);
+      for (int i = 0; i < taps->numTaps; i++)
+      {
+         const float *row = temp + 4 * outX * min(max(taps->first[y] + i, 0), inY - 1);
+         float weight = taps->weights[taps->numTaps * y + i];
+         int x = 0;
+#ifdef MIPMAP_SSE2
+         __m128 weights = _mm_set1_ps(weight);
+         for (; x < 4 * outX; x += 4)
+            _mm_storeu_ps(&sum[x], _mm_add_ps(_mm_loadu_ps(&sum[x]), _mm_mul_ps(_mm_loadu_ps(row + x), weights)));
+#endif
+         for (; x < 4 * outX; x++) sum[x] += weight * row[x];
+      }
+
+      unsigned char *outRow = out + 4 * outX * y;
+      for (int x = 0; x < outX; x++)
+      {
+         for (int c = 0; c < 3; c++) outRow[4 * x + c] = toByte(sum[4 * x + c], sRGB);
+         outRow[4 * x + 3] = toByte(sum[4 * x + 3], false);
+      }
+   }
+}
+
+// Run rows [0, numRows) of a filter pass, split across MIP_THREADS threads if there are many.
+template <class RowFunction>
+static void forRows(int numRows, RowFunction rows)
+{
+   if (numRows < MIP_MIN_THREADED_ROWS) { rows(0, numRows); return; }
+   vector<thread> threads;
+   for (int i = 1; i < MIP_THREADS; i++)
+      threads.push_back(thread(rows, i * numRows / MIP_THREADS, (i + 1) * numRows / MIP_THREADS));
+   rows(0, numRows / MIP_THREADS);
+   for (int i = 0; i < (int)threads.size(); i++) threads[i].join();
+}
+
+// Routine to filter an RGBA image of size inX x inY down to the next mipmap level,
+// written to out, which must hold the size given by nextMipmapSize(). With sRGB set
+// the color channels are averaged as linear intensities rather than sRGB values.
+void buildMipmapLevel(const unsigned char *in, int inX, int inY, unsigned char *out,
+                      int filter, bool sRGB)
+{
+   int outX, outY;
+   nextMipmapSize(inX, inY, &outX, &outY);
+   if (sRGB) initSRGBTables();
+
+   if (filter == MIP_BOX && ((inX % 2 == 1 && inX > 1) || (inY % 2 == 1 && inY > 1)))
+   {
+      FilterTaps tapsX, tapsY;
+      boxTaps(inX, outX, tapsX);
+      boxTaps(inY, outY, tapsY);
+      const FilterTaps *tapsXData = &tapsX, *tapsYData = &tapsY;
+      forRows(outY, [=](int first, int last) { boxRowsOdd(in, inX, inY, out, outX, tapsXData, tapsYData, sRGB, first, last); });
+      return;
+   }
+   if (filter == MIP_BOX)
+   {
+      if (sRGB) forRows(outY, [=](int first, int last) { boxRowsSRGB(in, inX, inY, out, outX, first, last); });
+      else forRows(outY, [=](int first, int last) { boxRows(in, inX, inY, out, outX, first, last); });
+      return;
+   }
+
+   // Levels 1 texel wide or high are too small for the wide filters.
+   if (inX == 1 || inY == 1)
+   {
+      buildMipmapLevel(in, inX, inY, out, MIP_BOX, sRGB);
+      return;
+   }
+
+   FilterTaps tapsX, tapsY;
+   sincTaps(filter, inX, outX, tapsX);
+   sincTaps(filter, inY, outY, tapsY);
+   const FilterTaps *tapsXData = &tapsX, *tapsYData = &tapsY;
+
+   vector<float> temp(4 * outX * inY);
+   float *tempData = &temp[0];
+   forRows(inY, [=](int first, int last) { sincRowsHorizontal(in, inX, tempData, outX, tapsXData, sRGB, first, last); });
+   forRows(outY, [=](int first, int last) { sincRowsVertical(tempData, inY, out, outX, tapsYData, sRGB, first, last); });
+}
+
+// Specify all the mipmap levels of the currently bound 2D texture object, built on the
+// CPU from the RGBA image with the given filter, instead of by glGenerateMipmap().
+void texImageMipmaps(const unsigned char *image, int sizeX, int sizeY, int filter, bool sRGB)
+{
+   vector<unsigned char> levels[2];
+   const unsigned char *level = image;
+   int numLevels = numMipmapLevels(sizeX, sizeY);
+
+   for (int i = 0; i < numLevels; i++)
+   {
+      glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, sizeX, sizeY, 0, GL_RGBA, GL_UNSIGNED_BYTE, level);
+      if (i == numLevels - 1) break;
+
+      int nextSizeX, nextSizeY;
+      nextMipmapSize(sizeX, sizeY, &nextSizeX, &nextSizeY);
+      levels[i % 2].resize(4 * nextSizeX * nextSizeY);
+      buildMipmapLevel(level, sizeX, sizeY, &levels[i % 2][0], filter, sRGB);
+      level = &levels[i % 2][0];
+      sizeX = nextSizeX;
+      sizeY = nextSizeY;
+   }
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+}
@@ -51,6 +51,7 @@ void loadExternalTextures()
    // Load the textures.
    image[0] = getbmp("../../Textures/canLabel.bmp"); 
    image[1] = getbmp("../../Textures/canTop.bmp");   
+   if (image[0] == NULL || image[1] == NULL) exit(1); // getbmp() has printed why.
 
    // Bind can label image to texture index[0]. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
@@ -69,6 +70,13 @@ void loadExternalTextures()
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+   // OpenGL has its own copy of the images now.
+   for (int i = 0; i < 2; i++)
+   {
+      delete[] image[i]->data;
+      delete image[i];
+   }
 }
 
 // Fuctions to map the grid vertex (u_i,v_j) to the mesh vertex (f(u_i,v_j), g(u_i,v_j), h(u_i,v_j)) on the cylinder.
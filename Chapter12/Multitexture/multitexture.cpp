@@ -27,7 +27,7 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
-#include "getbmp.h"
+#include "textureLoader.h"
 
 using namespace std;
 
@@ -36,33 +36,25 @@ static unsigned int texture[2]; // Array of texture indices.
 static float alpha = 0.5; // Interpolation parameter.
 static float constColor[4]; // Constant texture environment color.
 
-// Load external textures.
+// Load external textures. The images are decoded in the background and
+// uploaded from drawScene() as they become ready.
 void loadExternalTextures()			
 {
-   // Local storage for bmp image data.
-   BitMapFile *image[2];
-   
-   // Load the texture.
-   image[0] = getbmp("../../Textures/sky.bmp"); 
-   image[1] = getbmp("../../Textures/nightSky.bmp"); 
-
-   // Bind sky image to texture index[0]. 
+   // Set sky texture index[0] parameters and start loading its image. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+   startTextureLoad(texture[0], "../../Textures/sky.bmp");
 
-   // Bind night sky image to texture index[1]
+   // Set night sky texture index[1] parameters and start loading its image.
    glBindTexture(GL_TEXTURE_2D, texture[1]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[1]->sizeX, image[1]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[1]->data);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   startTextureLoad(texture[1], "../../Textures/nightSky.bmp");
 }
 
 // Initialization routine.
@@ -105,6 +97,14 @@ void setup(void)
 // Drawing routine.
 void drawScene(void)
 {  
+   // Upload textures as their images finish loading, redrawing until all are in.
+   static bool texturesLoaded = false;
+   if (!texturesLoaded)
+   {
+      if (uploadLoadedTextures() > 0) glutPostRedisplay();
+      else { texturesLoaded = true; printTextureLoadTimes(); }
+   }
+
    glClear(GL_COLOR_BUFFER_BIT);
 
    glLoadIdentity();
@@ -50,6 +50,7 @@ void loadExternalTextures()
    
    // Load the image.
    image[0] = getbmp("../../Textures/trees.bmp");
+   if (image[0] == NULL) exit(1); // getbmp() has printed why.
 
    // Bind trees image to texture object texture[0]. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
@@ -59,6 +60,10 @@ void loadExternalTextures()
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR); 				
+
+   // OpenGL has its own copy of the image now.
+   delete[] image[0]->data;
+   delete image[0];
 }
 
 // Routine to draw a bitmap character string.
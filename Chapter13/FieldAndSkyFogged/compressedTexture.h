@@ -0,0 +1,29 @@
+#ifndef COMPRESSEDTEXTURE_H
+#define COMPRESSEDTEXTURE_H
+
+#include <string>
+
+using namespace std;
+
+#define TEX_BC1 1 // 4 bits per texel, opaque color (DXT1).
+#define TEX_BC3 3 // 8 bits per texel, color with interpolated alpha (DXT5).
+#define TEX_BC_THREADS 4 // Number of threads sharing the rows of blocks.
+
+// A block-compressed texture image of 4x4 texel blocks, in rows from the bottom up.
+struct CompressedTexture
+{
+   int sizeX;
+   int sizeY;
+   int format; // TEX_BC1 or TEX_BC3.
+   int dataSize; // Size of data in bytes.
+   unsigned char *data;
+};
+
+CompressedTexture *compressImage(const unsigned char *image, int sizeX, int sizeY, int format);
+void decompressImage(CompressedTexture *texture, unsigned char *image);
+bool writeCompressedTexture(string filename, CompressedTexture *texture);
+CompressedTexture *readCompressedTexture(string filename);
+CompressedTexture *getCompressedTexture(string filename, int format);
+void texImageCompressed(CompressedTexture *texture);
+
+#endif
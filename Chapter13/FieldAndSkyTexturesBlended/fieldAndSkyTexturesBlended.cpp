@@ -28,7 +28,7 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
-#include "getbmp.h"
+#include "textureLoader.h"
 
 using namespace std;
 
@@ -38,43 +38,33 @@ using namespace std;
 static unsigned int texture[3]; // Array of texture indices.
 static float theta = 0.0; // Angle of the sun with the ground.
 
-// Load external textures.
+// Load external textures. The images are decoded in the background and
+// uploaded from drawScene() as they become ready.
 void loadExternalTextures()			
 {
-   // Local storage for bmp image data.
-   BitMapFile  *image[3]; 
-   
-   // Load the textures.
-   image[0] = getbmp("../../Textures/grass.bmp");
-   image[1] = getbmp("../../Textures/sky.bmp");   
-   image[2] = getbmp("../../Textures/nightSky.bmp");  
-
-   // Bind grass image to texture object texture[0]. 
+   // Set grass texture object texture[0] parameters and start loading its image. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   startTextureLoad(texture[0], "../../Textures/grass.bmp");
 
-   // Bind sky image to texture object texture[1]
+   // Set sky texture object texture[1] parameters and start loading its image.
    glBindTexture(GL_TEXTURE_2D, texture[1]);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[1]->sizeX, image[1]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[1]->data);
+   startTextureLoad(texture[1], "../../Textures/sky.bmp");
    
-   // Bind night sky image to texture object texture[2]
+   // Set night sky texture object texture[2] parameters and start loading its image.
    glBindTexture(GL_TEXTURE_2D, texture[2]);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[2]->sizeX, image[2]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[2]->data);	
+   startTextureLoad(texture[2], "../../Textures/nightSky.bmp");
 }
 
 // Initialization routine.
@@ -139,6 +129,14 @@ void drawScene(void)
    // Set light position.
    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
 
+   // Upload textures as their images finish loading, redrawing until all are in.
+   static bool texturesLoaded = false;
+   if (!texturesLoaded)
+   {
+      if (uploadLoadedTextures() > 0) glutPostRedisplay();
+      else { texturesLoaded = true; printTextureLoadTimes(); }
+   }
+
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
    glLoadIdentity();
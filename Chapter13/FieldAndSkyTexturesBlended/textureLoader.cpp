@@ -0,0 +1,169 @@
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib") 
+#endif
+
+#include "textureLoader.h"
+
+using namespace std;
+
+// A texture whose image is decoded by a worker thread and uploaded by the render thread.
+struct TextureLoad
+{
+   unsigned int textureId;
+   string filename;
+   future<BitMapFile *> image; // Decoded image, ready once the worker is done.
+   chrono::steady_clock::time_point startTime; // When the load was requested.
+   double decodeTime; // Milliseconds spent decoding by the worker.
+   double readyTime; // Milliseconds from request until the image was uploaded.
+   double uploadTime; // Milliseconds spent uploading by the render thread.
+   bool uploaded;
+};
+
+// Globals.
+static vector<TextureLoad *> loads; // All requested loads, in request order.
+static deque<packaged_task<BitMapFile *()> > jobs; // Decodes waiting for a worker.
+static mutex jobsMutex;
+static int numWorkers = 0; // Worker threads currently running.
+static unsigned int unpackBuffer[TEX_UNPACK_BUFFERS]; // Ring of pixel unpack buffers.
+static int nextUnpackBuffer = 0;
+
+// Milliseconds elapsed since a given time.
+static double millisecondsSince(chrono::steady_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Worker thread routine: run queued decodes until there are none left.
+static void worker(void)
+{
+   for (;;)
+   {
+      packaged_task<BitMapFile *()> job;
+      {
+         lock_guard<mutex> lock(jobsMutex);
+         if (jobs.empty()) { numWorkers--; return; }
+         job = move(jobs.front());
+         jobs.pop_front();
+      }
+      job();
+   }
+}
+
+// Queue the bmp file to be decoded in the background for the given texture object.
+// The texture's parameters can be set straight away; its image is supplied
+// by a later call of uploadLoadedTextures().
+void startTextureLoad(unsigned int textureId, string filename)
+{
+   TextureLoad *load = new TextureLoad;
+   load->textureId = textureId;
+   load->filename = filename;
+   load->startTime = chrono::steady_clock::now();
+   load->decodeTime = load->readyTime = load->uploadTime = 0.0;
+   load->uploaded = false;
+
+   packaged_task<BitMapFile *()> job([load]()
+   {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      BitMapFile *image = getbmp(load->filename);
+      load->decodeTime = millisecondsSince(start);
+      return image;
+   });
+   load->image = job.get_future();
+   loads.push_back(load);
+
+   // Queue the decode, starting another worker if the pool isn't full.
+   lock_guard<mutex> lock(jobsMutex);
+   jobs.push_back(move(job));
+   if (numWorkers < TEX_LOAD_THREADS)
+   {
+      numWorkers++;
+      thread(worker).detach();
+   }
+}
+
+// Upload every decoded image that is ready, without waiting for the others, to its
+// texture object through the next pixel unpack buffer of the ring. Filling one buffer
+// while the driver transfers from the previous ones avoids stalling on the copy.
+// Call from the render thread; returns the number of textures still pending.
+int uploadLoadedTextures(void)
+{
+   int pending = 0, previousTexture;
+   bool bound = false;
+
+   for (int i = 0; i < (int)loads.size(); i++)
+   {
+      TextureLoad *load = loads[i];
+      if (load->uploaded) continue;
+      if (load->image.wait_for(chrono::seconds(0)) != future_status::ready) { pending++; continue; }
+
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      BitMapFile *image = load->image.get();
+      load->uploaded = true;
+      if (image == NULL) continue;
+
+      if (!bound)
+      {
+         if (unpackBuffer[0] == 0) glGenBuffers(TEX_UNPACK_BUFFERS, unpackBuffer);
+         glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+         bound = true;
+      }
+
+      // Orphan the next buffer of the ring and copy the image into it.
+      int size = 4 * image->sizeX * image->sizeY;
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer[nextUnpackBuffer]);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+      void *pixels = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+      if (pixels != NULL)
+      {
+         memcpy(pixels, image->data, size);
+         glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      }
+      nextUnpackBuffer = (nextUnpackBuffer + 1) % TEX_UNPACK_BUFFERS;
+
+      // Specify the texture image from the buffer, or from client memory if it couldn't be mapped.
+      glBindTexture(GL_TEXTURE_2D, load->textureId);
+      if (pixels == NULL) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->sizeX, image->sizeY, 0,
+                   GL_RGBA, GL_UNSIGNED_BYTE, pixels == NULL ? image->data : 0);
+
+      delete[] image->data;
+      delete image;
+      load->uploadTime = millisecondsSince(start);
+      load->readyTime = millisecondsSince(load->startTime);
+   }
+
+   // Restore the bindings of the caller.
+   if (bound)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glBindTexture(GL_TEXTURE_2D, previousTexture);
+   }
+
+   return pending;
+}
+
+// Output the decode and upload latency of each texture to the C++ window.
+void printTextureLoadTimes(void)
+{
+   cout << "Texture load times (ms):" << endl;
+   for (int i = 0; i < (int)loads.size(); i++)
+      cout << loads[i]->filename << ": decode " << loads[i]->decodeTime
+           << ", upload " << loads[i]->uploadTime
+           << ", request to upload " << loads[i]->readyTime << endl;
+}
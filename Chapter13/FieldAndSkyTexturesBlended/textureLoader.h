@@ -0,0 +1,17 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <string>
+
+#include "getbmp.h"
+
+using namespace std;
+
+#define TEX_LOAD_THREADS 4 // Number of worker threads decoding bmp files.
+#define TEX_UNPACK_BUFFERS 3 // Number of pixel unpack buffers in the upload ring.
+
+void startTextureLoad(unsigned int textureId, string filename);
+int uploadLoadedTextures(void);
+void printTextureLoadTimes(void);
+
+#endif
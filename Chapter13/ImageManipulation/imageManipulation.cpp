@@ -50,9 +50,14 @@ void setup(void)
    // Load the texture image into a BitMapFile.
    BitMapFile *image[1];
    image[0] = getbmp("../../Textures/number1.bmp");
+   if (image[0] == NULL) exit(1); // getbmp() has printed why.
 
    // Copy the texture image to global storage.
    memcpy(textureImage, image[0]->data, TextureWidth*TextureHeight*4);
+
+   // The image has been copied.
+   delete[] image[0]->data;
+   delete image[0];
 }
 
 // Drawing routine.
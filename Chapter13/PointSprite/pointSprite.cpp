@@ -49,6 +49,7 @@ void loadExternalTextures()
    
    // Load the image.
    image[0] = getbmp("../../Textures/star.bmp"); 
+   if (image[0] == NULL) exit(1); // getbmp() has printed why.
 
   // Bind star image to texture object texture[0]. 
    glBindTexture(GL_TEXTURE_2D, texture[0]); 
@@ -58,6 +59,10 @@ void loadExternalTextures()
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+   // OpenGL has its own copy of the image now.
+   delete[] image[0]->data;
+   delete image[0];
 }
 
 // Initialization routine.
@@ -10,10 +10,13 @@
 // Press the arrow keys to move the selected control point.
 // Press delete to reset.
 //
+// COMPILE NOTE: File curveTessellator.h must be in the same folder.
+//
 // Sumanta Guha
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -26,6 +29,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "curveTessellator.h"
+
+
 using namespace std;
 
 // Begin globals.
@@ -45,12 +51,18 @@ static float originalControlPoints[6][3] =
 	{ -40.0, 0.0, 0.0}, { -30.0, 0.0, 0.0}, { -10.0, 0.0, 0.0},
 	{0.0, 0.0, 0.0}, {30.0, 0.0, 0.0}, { 40.0, 0.0, 0.0}
 };
+
+static unsigned int curveBuffer; // Vertex buffer object of the line strip of the curve.
+static vector<float> curveVertices; // Its vertices, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Initialization routine.
 void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0);
+
+   // Create the vertex buffer object of the curve.
+   glGenBuffers(1, &curveBuffer);
 }
 
 // Routine to restore control points to original values.
@@ -118,14 +130,13 @@ void drawScene(void)
 	     glVertex3fv(controlPoints[i]);
 	  glEnd();
 
-      // Specify and enable the Bezier curve.
-	  glMap1f(GL_MAP1_VERTEX_3, 0.0, 1.0, 3, order, controlPoints[0]);
-	  glEnable(GL_MAP1_VERTEX_3);
-
-	  // Draw the Bezier curve by defining a sample grid and evaluating on it.
+	  // Draw the Bezier curve, tessellated adaptively into its vertex buffer object.
 	  glColor3f(0.0, 0.0, 0.0);
-	  glMapGrid1f(100, 0.0, 1.0);
-	  glEvalMesh1(GL_LINE, 0, 100);
+	  CurveView view;
+	  getCurveView(view);
+	  curveVertices.clear();
+	  tessellateBezierCurve(controlPoints[0], order, 3, 0.0, 1.0, view, CURVE_TOLERANCE, curveVertices);
+	  drawTessellationBuffer(curveBuffer, loadTessellationBuffer(curveBuffer, curveVertices));
 
 	  // Draw the control points as dots.
 	  glPointSize(5.0);
@@ -7,11 +7,14 @@
 // Interaction: 
 // Press the left/right arrows to decrease/increase the curve parameter u. 
 //
+// COMPILE NOTE: File curveTessellator.h must be in the same folder.
+//
 // Sumanta Guha
 //////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -24,6 +27,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "curveTessellator.h"
+
+
 using namespace std;
 
 // Begin globals.
@@ -36,6 +42,9 @@ static float ctrlpoints[3][3] =
 {
 	{ -40.0, -20.0, 0.0}, { 0.0, 40.0, 0.0}, {40.0, -20.0, 0.0}
 };
+
+static unsigned int curveBuffer; // Vertex buffer object of the line strip of the curve.
+static vector<float> curveVertices; // Its vertices, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Routine to draw a bitmap character string.
@@ -57,6 +66,9 @@ void floatToString(char * destStr, int precision, float val)
 void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0); 
+
+   // Create the vertex buffer object of the curve.
+   glGenBuffers(1, &curveBuffer);
 }
 
 // Drawing routine.
@@ -73,13 +85,14 @@ void drawScene(void)
    writeBitmapString((void*)font, "u = ");
    writeBitmapString((void*)font, theStringBuffer);
 
-   // The Bezier curve is drawn from 0 to parameter value.
+   // The Bezier curve is drawn from 0 to parameter value, tessellated adaptively.
    glColor3f(1.0, 0.0, 1.0);
    glLineWidth(2.0);
-   glMap1f(GL_MAP1_VERTEX_3, 0.0, 1.0, 3, 3, &ctrlpoints[0][0]);
-   glEnable(GL_MAP1_VERTEX_3);
-   glMapGrid1f(100, 0.0, 1.0);
-   glEvalMesh1(GL_LINE, 0, (int)(u*100));
+   CurveView view;
+   getCurveView(view);
+   curveVertices.clear();
+   tessellateBezierCurve(&ctrlpoints[0][0], 3, 3, 0.0, u, view, CURVE_TOLERANCE, curveVertices);
+   drawTessellationBuffer(curveBuffer, loadTessellationBuffer(curveBuffer, curveVertices));
    glLineWidth(1.0);
 
    // The control points as dots.
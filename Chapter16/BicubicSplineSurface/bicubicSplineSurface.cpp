@@ -12,6 +12,8 @@
 // Press the x, X, y, Y, z, Z keys to rotate the viewpoint.
 // Press delete to reset control points.
 //
+// COMPILE NOTE: Files bSplineBasis.h and nurbsSurface.h must be in the same folder.
+//
 // Sumanta Guha.
 //////////////////////////////////////////////////////////////////////////////// 
 
@@ -28,13 +30,15 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "nurbsSurface.h"
+
 using namespace std;
 
 // Begin globals.
 static float controlPoints[15][10][3]; // Control points.
 static float Xangle = 30.0, Yangle = 10.0, Zangle = 40.0; // Angles to rotate surface.
 static int rowCount = 0, columnCount = 0; // Indexes of selected control point.
-static GLUnurbsObj *nurbsObject; // Pointer to NURBS object.
+static NurbsSurface surface; // Tessellation of the spline surface.
 
 // Standard knot vector along the u-parameter.
 static float uknots[19] = 
@@ -75,11 +79,9 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0);
 
-   // Create NURBS object.
-   nurbsObject = gluNewNurbsRenderer();
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 100.0);
-   gluNurbsProperty(nurbsObject, GLU_DISPLAY_MODE, GLU_OUTLINE_POLYGON);
+   // Make the spline surface of the control points, sampled twice across each knot span,
+   // about as often as GLU sampled it to a tolerance of 100 pixels.
+   makeNurbsSurface(surface, 19, uknots, 14, vknots, 30, 3, controlPoints[0][0], 4, 4, 3, 2);
 
    resetControlPoints();
 }
@@ -100,10 +102,8 @@ void drawScene(void)
 
    // Draw the spline surface.
    glColor3f(0.0, 0.0, 0.0);
-   gluBeginSurface(nurbsObject);
-   gluNurbsSurface(nurbsObject, 19, uknots, 14, vknots, 
-	               30, 3, controlPoints[0][0], 4, 4, GL_MAP2_VERTEX_3);
-   gluEndSurface(nurbsObject);
+   updateNurbsSurface(surface);
+   drawNurbsSurface(surface, NURBS_OUTLINE_POLYGON);
 
    glPointSize(5.0);
 
@@ -234,6 +234,7 @@ void keyInput(unsigned char key, int x, int y)
          break;
       case 127:	
          resetControlPoints();
+         editNurbsSurface(surface);
          break;
       default:
          break;
@@ -250,6 +251,7 @@ void specialKeyInput(int key, int x, int y)
    if (key == GLUT_KEY_UP) controlPoints[rowCount][columnCount][1] += 0.1;
    if (key == GLUT_KEY_PAGE_DOWN) controlPoints[rowCount][columnCount][2] += 0.1;
    if (key == GLUT_KEY_PAGE_UP) controlPoints[rowCount][columnCount][2] -= 0.1;
+   editNurbsControlPoint(surface, rowCount, columnCount);
    glutPostRedisplay();
 }
 
@@ -16,6 +16,8 @@
 // Press the x, X, y, Y, z, Z keys to rotate the surface.
 // Press delete to reset control points.
 //
+// COMPILE NOTE: Files bSplineBasis.h and nurbsSurface.h must be in the same folder.
+//
 // Sumanta Guha.
 //
 // Texture Credits: See ExperimenterSource/Textures/TEXTURE_CREDITS.txt
@@ -37,6 +39,7 @@
 #endif
 
 #include "getbmp.h"
+#include "nurbsSurface.h"
 
 using namespace std;
 
@@ -48,18 +51,11 @@ static float theta = 45.0; // Angle of the sun with the ground.
 static float Xangle = 30.0, Yangle = 10.0, Zangle = 40.0; // Angles to rotate surface.
 static int rowCount = 0, columnCount = 0; // Indexes of selected control point.
 static float lightPos[] = { 0.0, 3.0, -13.0, 1.0 }; // Light position vector
-static GLUnurbsObj *nurbsObject; // Pointer to NURBS object.
+static NurbsSurface surface; // Tessellation of the spline surface.
 
 // Control points for a real bicubic spline surface.
 static float controlPoints[15][10][3]; 
 
-// Control points for a spline surface in texture space.
-static float texturePoints[2][2][2] = 
-{
-	{{0.0, 0.0}, {0.0, 5.0}}, 
-	{{5.0, 0.0}, {5.0, 5.0}}
-};
-
 // Standard knot vector along the u-parameter for the real spline surface.
 static float uknots[19] = 
 {0.0, 0.0, 0.0, 0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 
@@ -69,14 +65,6 @@ static float uknots[19] =
 static float vknots[14] = 
 {0.0, 0.0, 0.0, 0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 
 7.0, 7.0, 7.0, 7.0};
-
-// Standard knot vector along the u-parameter for the spline surface in texture space.
-static float uTextureknots[4] = 
-{0.0, 0.0, 12.0, 12.0};
-
-// Standard knot vector along the v-parameter for the spline surface in texture space.
-static float vTextureknots[4] = 
-{0.0, 0.0, 7.0, 7.0};
 // End globals.
 
 // Routine to draw a stroke character string.
@@ -181,15 +169,16 @@ void setup(void)
    // Specify how texture values combine with current surface color values.
    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE); 
 
-   // Create NURBS object.
-   nurbsObject = gluNewNurbsRenderer();
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 100.0);
-   gluNurbsProperty(nurbsObject, GLU_DISPLAY_MODE, GLU_FILL);
+   // Repeat the chessboard 5 times in either direction across the surface, whose
+   // texture co-ordinates run from 0 to 1.
+   glMatrixMode(GL_TEXTURE);
+   glScalef(5.0, 5.0, 1.0);
+   glMatrixMode(GL_MODELVIEW);
+
+   // Make the spline surface of the control points, with normals.
+   makeNurbsSurface(surface, 19, uknots, 14, vknots, 30, 3, controlPoints[0][0], 4, 4, 3);
 
    resetControlPoints(); // Fill control points array for real spline surface.
-
-   glEnable(GL_AUTO_NORMAL); // Enable automatic normal calculation.
 }
 
 // Drawing routine.
@@ -220,14 +209,10 @@ void drawScene(void)
    glRotatef (Yangle, 0.0, 1.0, 0.0);
    glRotatef (Xangle, 1.0, 0.0, 0.0);
 
-   // Create the spline surface and map the grass texture onto it.
+   // Draw the spline surface and map the chessboard texture onto it.
    glBindTexture(GL_TEXTURE_2D, texture[0]);
-   gluBeginSurface(nurbsObject);
-   gluNurbsSurface(nurbsObject, 19, uknots, 14, vknots, 
-	               30, 3, controlPoints[0][0], 4, 4, GL_MAP2_VERTEX_3);
-   gluNurbsSurface(nurbsObject, 4, uTextureknots, 4, vTextureknots, 
-	               4, 2, texturePoints[0][0], 2, 2, GL_MAP2_TEXTURE_COORD_2);
-   gluEndSurface(nurbsObject);
+   updateNurbsSurface(surface);
+   drawNurbsSurface(surface, NURBS_FILL);
 
    glDisable(GL_LIGHTING); // Disable lighting.
    glDisable(GL_TEXTURE_2D); // Disable texturing.
@@ -364,6 +349,7 @@ void keyInput(unsigned char key, int x, int y)
          break;
       case 127:	
          resetControlPoints();
+         editNurbsSurface(surface);
          break;
       default:
          break;
@@ -380,6 +366,7 @@ void specialKeyInput(int key, int x, int y)
    if (key == GLUT_KEY_UP) controlPoints[rowCount][columnCount][1] += 0.1;
    if (key == GLUT_KEY_PAGE_DOWN) controlPoints[rowCount][columnCount][2] += 0.1;
    if (key == GLUT_KEY_PAGE_UP) controlPoints[rowCount][columnCount][2] -= 0.1;
+   editNurbsControlPoint(surface, rowCount, columnCount);
    glutPostRedisplay();
 }
 
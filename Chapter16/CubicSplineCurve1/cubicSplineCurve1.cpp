@@ -21,10 +21,13 @@
 // The selected knot (in red) is increased/decreased using the right/left arrow keys.
 // Press delete to reset knot values.
 // 
+// COMPILE NOTE: Files bSplineBasis.h, bSplineCurve.h and curveTessellator.h must be in the same folder.
+// 
 //Sumanta Guha
 /////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -37,6 +40,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "bSplineCurve.h"
+#include "curveTessellator.h"
+
 using namespace std;
 
 // Begin globals.
@@ -65,7 +71,8 @@ static float originalControlPoints[9][3] =
 static float knots[13] = 
 {0.0, 6.0, 12.0, 18.0, 24.0, 30.0, 36.0, 42.0, 48.0, 54.0, 60.0, 66.0, 72.0};
 
-static GLUnurbsObj *nurbsObject; // Pointer to NURBS object.
+static unsigned int curveBuffer; // Vertex buffer object of the line strip of the curve.
+static vector<float> curveParameters; // Parameters of its vertices, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Routine to draw a bitmap character string.
@@ -81,10 +88,8 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0); 
 
-   // Create NURBS object.
-   nurbsObject = gluNewNurbsRenderer();
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 10.0);
+   // Create the vertex buffer object of the curve.
+   glGenBuffers(1, &curveBuffer);
 }
 
 // Function to increase value of a knot.
@@ -133,40 +138,10 @@ void resetControlPoints(void)
    selectedControlPoint = 0;
 }
 
-// Recursive computation of B-spline functions.
-float Bspline(int i, int m, float u)
-{
-   float coef1, coef2;
-   if ( m == 1 )
-   {
-	  if ( i == 0 ) if ( ( knots[i] <= u ) && ( u <= knots[i+1] ) ) return 1.0;
-      if ( ( knots[i] < u ) && ( u <= knots[i+1] ) ) return 1.0;
-	  else return 0.0;
-   }
-   else
-   {
-      if ( knots[i+m-1] == knots[i] ) 
-	  {
-	     if ( u == knots[i] ) coef1 = 1;
-		 else coef1 = 0;
-	  }
-	  else coef1 = (u - knots[i])/(knots[i+m-1] - knots[i]);
-
-      if ( knots[i+m] == knots[i+1] )
-	  {
-		 if ( u == knots[i+m] ) coef2 = 1;
-		 else coef2 = 0;
-	  }
-	  else coef2 = (knots[i+m] - u)/(knots[i+m] - knots[i+1]);
-		
-      return ( coef1 * Bspline(i, m-1, u) + coef2 * Bspline(i+1 ,m-1 ,u) );
-   }
-}
-
 // Drawing routine.
 void drawScene(void)
 {
-   int i, j;
+   int i;
 
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -192,11 +167,12 @@ void drawScene(void)
       glVertex3fv(controlPoints[i]);
    glEnd();
 
-   // Draw the spline curve.
+   // Draw the spline curve, tessellated adaptively and evaluated into its vertex buffer object.
    glColor3f(0.0, 0.0, 0.0);
-   gluBeginCurve(nurbsObject);
-   gluNurbsCurve(nurbsObject, 13, knots, 3, controlPoints[0], 4, GL_MAP1_VERTEX_3);
-   gluEndCurve(nurbsObject);
+   CurveView view;
+   getCurveView(view);
+   tessellateBsplineParameters(knots, 13, 4, controlPoints[0], 3, view, CURVE_TOLERANCE, curveParameters);
+   drawCurveBuffer(curveBuffer, loadCurveBuffer(curveBuffer, knots, 13, 4, controlPoints[0], curveParameters));
 
    // The following code displays the control points as dots.
    glPointSize(5.0);
@@ -273,32 +249,22 @@ void drawScene(void)
    // Draw images of knot points (i.e., joints) on the curve.
    glPointSize(5.0);
    glColor3f(0.0, 0.0, 1.0);
-   float knotImageX, knotImageY;
+   float knotImage[3];
    glBegin(GL_POINTS);
       for (i = 3; i < 10; i++) 
 	  {
-		 knotImageX = knotImageY = 0;
-		 for (j = 0; j < 9; j++)
-		 {
-	        knotImageX += Bspline(j, 4, knots[i]) * controlPoints[j][0];
-		    knotImageY += Bspline(j, 4, knots[i]) * controlPoints[j][1];
-		 }
-         glVertex3f(knotImageX, knotImageY, 0.0);
+		 evaluateCurvePoint(knots, 13, 4, controlPoints[0], 3, knots[i], knotImage);
+         glVertex3f(knotImage[0], knotImage[1], 0.0);
 	  }
    glEnd();
 
    // Highlight the image of the selected knot point (if its within the parameter space).
    glColor3f(1.0, 0.0, 0.0);
    glBegin(GL_POINTS);
-   knotImageX = knotImageY = 0;
    if ( (3 <= selectedKnot) && (selectedKnot <= 9) )
    {
-      for (j = 0; j < 9; j++)
-	  {
-         knotImageX += Bspline(j, 4, knots[selectedKnot]) * controlPoints[j][0];
-         knotImageY += Bspline(j, 4, knots[selectedKnot]) * controlPoints[j][1];
-	  }
-   glVertex3f(knotImageX, knotImageY, 0.0);
+      evaluateCurvePoint(knots, 13, 4, controlPoints[0], 3, knots[selectedKnot], knotImage);
+   glVertex3f(knotImage[0], knotImage[1], 0.0);
    }   
    glEnd();
 
@@ -0,0 +1,331 @@
+#ifndef CURVETESSELLATOR_H
+#define CURVETESSELLATOR_H
+
+#include <cmath>
+#include <vector>
+
+// Adaptive tessellation of Bezier, rational Bezier and B-spline curves into line strips,
+// in place of sampling them at fixed steps of the parameter, as glMapGrid1f() and
+// glEvalMesh1() do, or to a tolerance inside GLU. A curve is split in half by de
+// Casteljau's algorithm again and again, each half on its own, until the chord of a
+// piece lies within a tolerance in pixels of the piece on the screen, where the piece
+// becomes a segment of the line strip. The strip so has its vertices where the curve
+// bends, few where it is flat.
+//
+// The flatness test is a bound, not an estimate. The control points of a piece are
+// taken to the window by the modelview, projection and viewport transformations, of the
+// view the curve is drawn in. The piece lies in the convex hull of its projected
+// control points if their w's are positive; its distance from the chord is so at most
+// the largest distance of a control point from the chord. When the projection is
+// affine and the curve not rational, so that the w's are all equal, it is at most
+// 1 - 2^(1-n) of the largest distance from the line of the chord, n the degree, since
+// the distance from the line is then a Bezier function of degree n which is 0 at either
+// end; this halves the bound of a quadratic. A piece whose w's are none positive is
+// behind the eye, and is clipped whole as a single segment; one whose w's are of either
+// sign, crossing the plane of the eye, is split until it is CURVE_MAX_DEPTH halvings
+// deep.
+//
+// A B-spline curve is taken to Bezier curves one knot span at a time, the Bezier control
+// points of a span found by blossoming, i.e., de Boor's algorithm with its parameter
+// at each level one end or the other of the span. Its tessellation is the parameters of
+// the vertices of the strip, which bSplineCurve.h evaluates in SIMD lanes straight into
+// a vertex buffer object.
+//
+// Control points are homogeneous, (xw, yw, zw, w), of dimension 4, as those of
+// GL_MAP1_VERTEX_4, or (x, y, z), of dimension 3, w being 1. The vertices of the line
+// strip are (x, y, z).
+
+#define CURVE_TOLERANCE 0.25 // Largest distance in pixels of the line strip from the curve.
+#define CURVE_MAX_ORDER 16 // Highest order tessellated.
+#define CURVE_MAX_DEPTH 16 // Most halvings of a curve, 2^16 segments.
+
+// Transformation from object to window co-ordinates of the view a curve is drawn in:
+// the viewport's times the projection times the modelview, column-major as OpenGL's.
+struct CurveView
+{
+   float matrix[16];
+};
+
+// Make the view of the modelview and projection matrices and the viewport.
+inline void makeCurveView(const float *modelview, const float *projection, const int *viewport, CurveView &view)
+{
+   float window[16] = { 0.5f*viewport[2], 0.0, 0.0, 0.0,  0.0, 0.5f*viewport[3], 0.0, 0.0,
+                        0.0, 0.0, 1.0, 0.0,
+                        viewport[0] + 0.5f*viewport[2], viewport[1] + 0.5f*viewport[3], 0.0, 1.0 };
+   float windowProjection[16];
+   for (int c = 0; c < 4; c++)
+      for (int r = 0; r < 4; r++)
+      {
+         windowProjection[4*c + r] = 0.0;
+         for (int k = 0; k < 4; k++) windowProjection[4*c + r] += window[4*k + r] * projection[4*c + k];
+      }
+   for (int c = 0; c < 4; c++)
+      for (int r = 0; r < 4; r++)
+      {
+         view.matrix[4*c + r] = 0.0;
+         for (int k = 0; k < 4; k++) view.matrix[4*c + r] += windowProjection[4*k + r] * modelview[4*c + k];
+      }
+}
+
+// Make the view of the current OpenGL matrices and viewport.
+inline void getCurveView(CurveView &view)
+{
+   float modelview[16], projection[16];
+   int viewport[4];
+   glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+   glGetFloatv(GL_PROJECTION_MATRIX, projection);
+   glGetIntegerv(GL_VIEWPORT, viewport);
+   makeCurveView(modelview, projection, viewport, view);
+}
+
+// Distance in pixels between the points (x, y, z) a and b in the view.
+inline float windowDistance(const CurveView &view, const float *a, const float *b)
+{
+   const float *m = view.matrix;
+   float window[2][2];
+   for (int k = 0; k < 2; k++)
+   {
+      const float *p = k ? b : a;
+      float w = m[3]*p[0] + m[7]*p[1] + m[11]*p[2] + m[15];
+      window[k][0] = (m[0]*p[0] + m[4]*p[1] + m[8]*p[2] + m[12]) / w;
+      window[k][1] = (m[1]*p[0] + m[5]*p[1] + m[9]*p[2] + m[13]) / w;
+   }
+   float dx = window[1][0] - window[0][0], dy = window[1][1] - window[0][1];
+   return sqrt(dx*dx + dy*dy);
+}
+
+// Split the Bezier curve of the order with homogeneous control points points[4*i] at
+// t by de Casteljau's algorithm, into left[] on [0, t] and right[] on [t, 1].
+inline void splitBezierCurve(const float *points, int order, float t, float *left, float *right)
+{
+   float level[4 * CURVE_MAX_ORDER];
+   for (int k = 0; k < 4 * order; k++) level[k] = points[k];
+   for (int r = 0; r < order; r++)
+   {
+      for (int c = 0; c < 4; c++)
+      {
+         left[4*r + c] = level[c];
+         right[4*(order-1-r) + c] = level[4*(order-1-r) + c];
+      }
+      for (int i = 0; i < order - 1 - r; i++)
+         for (int c = 0; c < 4; c++) level[4*i + c] = (1 - t) * level[4*i + c] + t * level[4*(i+1) + c];
+   }
+}
+
+// Whether the Bezier curve of the order with homogeneous control points points[4*i]
+// lies within tolerance pixels of its chord in the view.
+inline bool isFlatBezierCurve(const float *points, int order, const CurveView &view, float tolerance)
+{
+   const float *m = view.matrix;
+   float x[CURVE_MAX_ORDER], y[CURVE_MAX_ORDER], w[CURVE_MAX_ORDER];
+   bool affine = true;
+   int numBehind = 0;
+   for (int i = 0; i < order; i++)
+   {
+      const float *p = points + 4*i;
+      w[i] = m[3]*p[0] + m[7]*p[1] + m[11]*p[2] + m[15]*p[3];
+      if (w[i] <= 0.0) numBehind++;
+   }
+   if (numBehind == order) return true; // Behind the eye, clipped.
+   if (numBehind > 0) return false;
+   for (int i = 0; i < order; i++)
+   {
+      const float *p = points + 4*i;
+      float reciprocal = 1.0f / w[i];
+      x[i] = (m[0]*p[0] + m[4]*p[1] + m[8]*p[2] + m[12]*p[3]) * reciprocal;
+      y[i] = (m[1]*p[0] + m[5]*p[1] + m[9]*p[2] + m[13]*p[3]) * reciprocal;
+      if (w[i] != w[0]) affine = false;
+   }
+
+   // Squared distances of the control points from the chord, those across from it as
+   // cross products with it, of its length times the distance.
+   float chordX = x[order-1] - x[0], chordY = y[order-1] - y[0];
+   float length2 = chordX*chordX + chordY*chordY;
+   float largestCross2 = 0.0, largestOutside2 = 0.0;
+   for (int i = 1; i < order - 1; i++)
+   {
+      float dx = x[i] - x[0], dy = y[i] - y[0];
+      float along = dx*chordX + dy*chordY, cross = dx*chordY - dy*chordX;
+      if ( (length2 > 0.0) && (along >= 0.0) && (along <= length2) )
+      {
+         if (cross*cross > largestCross2) largestCross2 = cross*cross;
+      }
+      else
+      {
+         float ex = x[i] - x[order-1], ey = y[i] - y[order-1];
+         float distance2 = (along <= 0.0) ? dx*dx + dy*dy : ex*ex + ey*ey;
+         if (distance2 > largestOutside2) largestOutside2 = distance2;
+      }
+   }
+   float bound2 = (length2 > 0.0) ? largestCross2 / length2 : 0.0f;
+   if (affine && (largestOutside2 == 0.0))
+   {
+      float factor = 1.0f - ldexp(1.0f, 2 - order);
+      bound2 *= factor * factor;
+   }
+   else if (largestOutside2 > bound2) bound2 = largestOutside2;
+   return bound2 <= tolerance * tolerance;
+}
+
+// Append to vertices the line strip of the Bezier curve of the order with homogeneous
+// control points points[4*i], past its first vertex, split to depth levels at most.
+inline void appendBezierCurve(const float *points, int order, const CurveView &view, float tolerance, int depth,
+                              std::vector<float> &vertices)
+{
+   if ( (depth > 0) && !isFlatBezierCurve(points, order, view, tolerance) )
+   {
+      float left[4 * CURVE_MAX_ORDER], right[4 * CURVE_MAX_ORDER];
+      splitBezierCurve(points, order, 0.5, left, right);
+      appendBezierCurve(left, order, view, tolerance, depth - 1, vertices);
+      appendBezierCurve(right, order, view, tolerance, depth - 1, vertices);
+      return;
+   }
+   const float *last = points + 4*(order-1);
+   for (int c = 0; c < 3; c++) vertices.push_back(last[c] / last[3]);
+}
+
+// Copy control points of the dimension, 3 or 4, into homogeneous ones.
+inline void makeHomogeneous(const float *controlPoints, int numControlPoints, int dimension, float *points)
+{
+   for (int i = 0; i < numControlPoints; i++)
+   {
+      for (int c = 0; c < dimension; c++) points[4*i + c] = controlPoints[dimension*i + c];
+      if (dimension == 3) points[4*i + 3] = 1.0;
+   }
+}
+
+// Tessellate the part from parameter u1 to u2, 0 <= u1 <= u2 <= 1, of the Bezier curve
+// of the order with the control points of the dimension, to the tolerance in pixels in
+// the view, appending the line strip to vertices and returning the number of vertices.
+inline int tessellateBezierCurve(const float *controlPoints, int order, int dimension, float u1, float u2,
+                                 const CurveView &view, float tolerance, std::vector<float> &vertices)
+{
+   float points[4 * CURVE_MAX_ORDER], left[4 * CURVE_MAX_ORDER], right[4 * CURVE_MAX_ORDER];
+   int numVertices = vertices.size() / 3;
+   makeHomogeneous(controlPoints, order, dimension, points);
+
+   // Cut the part out of the curve, keeping [0, u2] and then its part from u1.
+   if (u2 < 1.0)
+   {
+      splitBezierCurve(points, order, u2, left, right);
+      for (int k = 0; k < 4 * order; k++) points[k] = left[k];
+   }
+   if ( (u1 > 0.0) && (u2 > 0.0) )
+   {
+      splitBezierCurve(points, order, u1 / u2, left, right);
+      for (int k = 0; k < 4 * order; k++) points[k] = right[k];
+   }
+
+   for (int c = 0; c < 3; c++) vertices.push_back(points[c] / points[3]);
+   if (u2 > u1) appendBezierCurve(points, order, view, tolerance, CURVE_MAX_DEPTH, vertices);
+   return vertices.size() / 3 - numVertices;
+}
+
+// Fill points[4*j] with the homogeneous Bezier control points of the knot span s,
+// knots[s] < knots[s+1], of the B-spline curve of the order with homogeneous control
+// points controlPoints[4*i]: the blossom of the span's polynomial at order - 1 - j
+// copies of knots[s] and j of knots[s+1].
+inline void blossomBsplineSpan(const float *knots, int order, const float *controlPoints, int s, float *points)
+{
+   int p = order - 1;
+   float level[4 * CURVE_MAX_ORDER];
+   for (int j = 0; j < order; j++)
+   {
+      // De Boor's algorithm over control points s-p to s, at knots[s+1] for the first
+      // j levels and at knots[s] for the rest.
+      for (int k = 0; k < 4 * order; k++) level[k] = controlPoints[4*(s-p) + k];
+      for (int r = 1; r <= p; r++)
+      {
+         float u = (r <= j) ? knots[s+1] : knots[s];
+         for (int i = p; i >= r; i--)
+         {
+            int index = s - p + i;
+            float alpha = (u - knots[index]) / (knots[index + order - r] - knots[index]);
+            for (int c = 0; c < 4; c++) level[4*i + c] = (1 - alpha) * level[4*(i-1) + c] + alpha * level[4*i + c];
+         }
+      }
+      for (int c = 0; c < 4; c++) points[4*j + c] = level[4*p + c];
+   }
+}
+
+// Append to parameters the parameter at the end of each segment of the line strip of the
+// Bezier curve of the order with homogeneous control points points[4*i], the part from
+// u1 to u2 of a curve, split to depth levels at most.
+inline void appendBezierParameters(const float *points, int order, const CurveView &view, float tolerance, int depth,
+                                   float u1, float u2, std::vector<float> &parameters)
+{
+   if ( (depth > 0) && !isFlatBezierCurve(points, order, view, tolerance) )
+   {
+      float left[4 * CURVE_MAX_ORDER], right[4 * CURVE_MAX_ORDER], middle = 0.5f * (u1 + u2);
+      splitBezierCurve(points, order, 0.5, left, right);
+      appendBezierParameters(left, order, view, tolerance, depth - 1, u1, middle, parameters);
+      appendBezierParameters(right, order, view, tolerance, depth - 1, middle, u2, parameters);
+      return;
+   }
+   parameters.push_back(u2);
+}
+
+// Tessellate the B-spline curve of the order with the knots and numKnots - order control
+// points of the dimension, over its parameter range from knots[order-1] to
+// knots[numKnots-order], as gluNurbsCurve() draws it, to the tolerance in pixels in the
+// view, into the increasing parameters of the vertices of its line strip, returning
+// their number. The vertices are then evaluated, many at once, by evaluateCurvePoints()
+// or loadCurveBuffer() of bSplineCurve.h.
+//
+// A point at a knot is evaluated in the span before it. Where the curve is broken, at a
+// knot of multiplicity order, the span after it so starts at the next float past the
+// knot, its point there within rounding of the span's first.
+inline int tessellateBsplineParameters(const float *knots, int numKnots, int order, const float *controlPoints,
+                                       int dimension, const CurveView &view, float tolerance,
+                                       std::vector<float> &parameters)
+{
+   int numControlPoints = numKnots - order;
+   std::vector<float> homogeneous(4 * numControlPoints);
+   float points[4 * CURVE_MAX_ORDER], end[3];
+   makeHomogeneous(controlPoints, numControlPoints, dimension, &homogeneous[0]);
+   parameters.clear();
+   for (int s = order - 1; s < numControlPoints; s++)
+      if (knots[s] < knots[s+1])
+      {
+         blossomBsplineSpan(knots, order, &homogeneous[0], s, points);
+
+         // Start the strip at the span, or go on from the last unless the curve jumps
+         // there by more than the tolerance.
+         bool broken = (knots[s-order+1] == knots[s]) && (knots[0] < knots[s]);
+         float start[3];
+         for (int c = 0; c < 3; c++) start[c] = points[c] / points[3];
+         if ( parameters.empty() || (broken && (windowDistance(view, start, end) > tolerance)) )
+            parameters.push_back(broken ? nextafterf(knots[s], knots[s+1]) : knots[s]);
+         appendBezierParameters(points, order, view, tolerance, CURVE_MAX_DEPTH, knots[s], knots[s+1], parameters);
+         for (int c = 0; c < 3; c++) end[c] = points[4*(order-1) + c] / points[4*order - 1];
+      }
+   return (int)parameters.size();
+}
+
+// Load the vertices of a line strip into the vertex buffer object buffer, grown if it is
+// too small for them, and return their number.
+inline int loadTessellationBuffer(unsigned int buffer, const std::vector<float> &vertices)
+{
+   int numVertices = vertices.size() / 3;
+   glBindBuffer(GL_ARRAY_BUFFER, buffer);
+   GLint size;
+   glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+   if (size < (GLsizeiptr)(3 * numVertices * sizeof(float)))
+      glBufferData(GL_ARRAY_BUFFER, 3 * numVertices * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+   if (numVertices > 0) glBufferSubData(GL_ARRAY_BUFFER, 0, 3 * numVertices * sizeof(float), &vertices[0]);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   return numVertices;
+}
+
+// Draw the line strip of numVertices vertices in the vertex buffer object buffer.
+inline void drawTessellationBuffer(unsigned int buffer, int numVertices)
+{
+   glBindBuffer(GL_ARRAY_BUFFER, buffer);
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glVertexPointer(3, GL_FLOAT, 0, 0);
+   glDrawArrays(GL_LINE_STRIP, 0, numVertices);
+   glDisableClientState(GL_VERTEX_ARRAY);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+#endif
@@ -10,11 +10,14 @@
 // The selected control point (in red) is moved using the arrow keys.
 // Press delete to reset control points.
 //
+// COMPILE NOTE: Files bSplineBasis.h, bSplineCurve.h and curveTessellator.h must be in the same folder.
+//
 // Sumanta Guha
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -27,6 +30,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "bSplineCurve.h"
+#include "curveTessellator.h"
+
 #define PI 3.14159265
 
 using namespace std;
@@ -42,7 +48,8 @@ static float knots[34] =
 16.0, 17.0, 18.0, 19.0, 20.0, 21.0, 22.0, 23.0, 24.0, 
 25.0, 26.0, 27.0, 27.0, 27.0, 27.0};
 
-static GLUnurbsObj *nurbsObject; // Pointer to NURBS object.
+static unsigned int curveBuffer; // Vertex buffer object of the line strip of the curve.
+static vector<float> curveParameters; // Parameters of its vertices, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Reset control points.
@@ -65,10 +72,8 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0);
 
-   // Create NURBS object.
-   nurbsObject = gluNewNurbsRenderer();
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 10.0);
+   // Create the vertex buffer object of the curve.
+   glGenBuffers(1, &curveBuffer);
 
    resetControlPoints();
 }
@@ -82,11 +87,12 @@ void drawScene(void)
 
    glPushMatrix();
    
-   // Draw the spline curve.
+   // Draw the spline curve, tessellated adaptively and evaluated into its vertex buffer object.
    glColor3f(0.0, 0.0, 0.0);
-   gluBeginCurve(nurbsObject);
-   gluNurbsCurve(nurbsObject, 34, knots, 3, ctrlpoints[0], 4, GL_MAP1_VERTEX_3);
-   gluEndCurve(nurbsObject);
+   CurveView view;
+   getCurveView(view);
+   tessellateBsplineParameters(knots, 34, 4, ctrlpoints[0], 3, view, CURVE_TOLERANCE, curveParameters);
+   drawCurveBuffer(curveBuffer, loadCurveBuffer(curveBuffer, knots, 34, 4, ctrlpoints[0], curveParameters));
 
    // The following code displays the control points as dots.
    glPointSize(5.0);
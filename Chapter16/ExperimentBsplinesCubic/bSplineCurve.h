@@ -0,0 +1,318 @@
+#ifndef BSPLINECURVE_H
+#define BSPLINECURVE_H
+
+#include <vector>
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#endif
+
+#include "bSplineBasis.h"
+
+// Evaluation of a B-spline curve at many parameters at once, in place of
+// gluNurbsCurve(), whose sampling cannot be seen or tuned. The parameters are taken in
+// runs lying in one knot span, over which the curve is a single polynomial of degree
+// order - 1, and each run is evaluated CURVE_LANES parameters at a time, the
+// co-ordinates of the points computed one per lane, structure of arrays, and then
+// stored point by point.
+//
+// A run of at least CURVE_POLYNOMIAL_RUN parameters is evaluated from that polynomial
+// by Horner's rule, its coefficients in powers of u - c, c the middle of the span, found
+// once for the run from the derivatives of the B-splines at c by bSplineBasis.h. A
+// shorter run, or one at the single knots[0] of an empty first span, is evaluated by the
+// triangular table of bSplineBasis.h, filled for all the lanes together, the
+// coefficients of the recursion varying with the parameter from lane to lane but their
+// knots not; its arithmetic is that of evaluateCurvePoint(), operation for operation,
+// so that the points are the same to the last bit as it computes them one at a time.
+//
+// CurveLanes are the 8 float lanes of an AVX register if the compiler targets AVX or
+// AVX2 (e.g., with -mavx2 or -march=native, or /arch:AVX2 in Visual Studio), otherwise
+// they are a single float.
+//
+// A curve is drawn, by loadCurveBuffer() and drawCurveBuffer(), as a line strip evaluated
+// straight into a vertex buffer object, through CURVE_SAMPLES_PER_SPAN points of each
+// knot span of its parameter range, or at given parameters, such as those chosen to a
+// tolerance in pixels by tessellateBsplineParameters() of curveTessellator.h.
+
+#define CURVE_SAMPLES_PER_SPAN 32 // Segments of the line strip across each knot span.
+#define CURVE_POLYNOMIAL_RUN 16 // Fewest parameters of a run evaluated by the span's polynomial.
+#define CURVE_MAX_DIMENSION 4 // Most co-ordinates of a control point.
+
+#if defined(__AVX__)
+#define CURVE_LANES 8
+
+struct CurveLanes
+{
+   __m256 value;
+
+   CurveLanes() {}
+   CurveLanes(float x) : value(_mm256_set1_ps(x)) {}
+   CurveLanes(__m256 x) : value(x) {}
+
+   friend CurveLanes operator+(const CurveLanes &a, const CurveLanes &b) { return _mm256_add_ps(a.value, b.value); }
+   friend CurveLanes operator-(const CurveLanes &a, const CurveLanes &b) { return _mm256_sub_ps(a.value, b.value); }
+   friend CurveLanes operator*(const CurveLanes &a, const CurveLanes &b) { return _mm256_mul_ps(a.value, b.value); }
+   friend CurveLanes operator/(const CurveLanes &a, const CurveLanes &b) { return _mm256_div_ps(a.value, b.value); }
+};
+
+inline CurveLanes loadCurveLanes(const float *x) { return _mm256_loadu_ps(x); }
+inline void storeCurveLanes(float *x, const CurveLanes &a) { _mm256_storeu_ps(x, a.value); }
+
+// 1 in the lanes where a equals b, else 0.
+inline CurveLanes equalCurveLanes(const CurveLanes &a, const CurveLanes &b)
+{
+   return _mm256_and_ps(_mm256_cmp_ps(a.value, b.value, _CMP_EQ_OQ), _mm256_set1_ps(1.0f));
+}
+
+// Store the 8 points (x, y, z) of the lanes interleaved, transposing them by shuffles.
+inline void storeCurveLanes3(float *points, const CurveLanes &x, const CurveLanes &y, const CurveLanes &z)
+{
+   __m256 xy = _mm256_shuffle_ps(x.value, y.value, _MM_SHUFFLE(2, 0, 2, 0));
+   __m256 yz = _mm256_shuffle_ps(y.value, z.value, _MM_SHUFFLE(3, 1, 3, 1));
+   __m256 zx = _mm256_shuffle_ps(z.value, x.value, _MM_SHUFFLE(3, 1, 2, 0));
+   __m256 points04 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)); // Points 0 and 4, each with x of the next.
+   __m256 points15 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+   __m256 points26 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+   _mm256_storeu_ps(points, _mm256_permute2f128_ps(points04, points15, 0x20));
+   _mm256_storeu_ps(points + 8, _mm256_permute2f128_ps(points26, points04, 0x30));
+   _mm256_storeu_ps(points + 16, _mm256_permute2f128_ps(points15, points26, 0x31));
+}
+#else
+#define CURVE_LANES 1
+
+typedef float CurveLanes;
+
+inline CurveLanes loadCurveLanes(const float *x) { return *x; }
+inline void storeCurveLanes(float *x, const CurveLanes &a) { *x = a; }
+inline CurveLanes equalCurveLanes(const CurveLanes &a, const CurveLanes &b) { return (a == b) ? 1.0f : 0.0f; }
+
+inline void storeCurveLanes3(float *points, const CurveLanes &x, const CurveLanes &y, const CurveLanes &z)
+{
+   points[0] = x; points[1] = y; points[2] = z;
+}
+#endif
+
+// Store the first numLanes of the points held in the lanes of coordinates, a
+// co-ordinate to each, as points of dimension co-ordinates one after the other.
+inline void storeCurvePoints(float *points, const CurveLanes *coordinates, int dimension, int numLanes)
+{
+   if ( (dimension == 3) && (numLanes == CURVE_LANES) )
+   {
+      storeCurveLanes3(points, coordinates[0], coordinates[1], coordinates[2]);
+      return;
+   }
+   float lanes[CURVE_MAX_DIMENSION][CURVE_LANES];
+   for (int c = 0; c < dimension; c++) storeCurveLanes(lanes[c], coordinates[c]);
+   for (int k = 0; k < numLanes; k++)
+      for (int c = 0; c < dimension; c++) points[k*dimension + c] = lanes[c][k];
+}
+
+// Points of the curve of the order with the knots and numKnots - order control points,
+// each of dimension co-ordinates, at numParameters parameters in the knot span span,
+// knots[span] < u <= knots[span+1] (or u = knots[0] if span is 0), written to points
+// dimension co-ordinates apiece, by the triangular table.
+inline void evaluateCurveSpanByTable(const float *knots, int numKnots, int order, const float *controlPoints,
+                                     int dimension, int span, const float *parameters, int numParameters,
+                                     float *points)
+{
+   int first = span - order + 1;
+   CurveLanes row[BSPLINE_MAX_ORDER], coordinates[CURVE_MAX_DIMENSION];
+   float lanes[CURVE_LANES];
+
+   for (int p = 0; p < numParameters; p += CURVE_LANES)
+   {
+      // The lanes past the last parameter repeat it, and are not stored.
+      int numLanes = (numParameters - p < CURVE_LANES) ? numParameters - p : CURVE_LANES;
+      for (int k = 0; k < CURVE_LANES; k++) lanes[k] = parameters[p + ((k < numLanes) ? k : numLanes - 1)];
+      CurveLanes u = loadCurveLanes(lanes);
+
+      // The table of bSplineBasis.h in one row: row[j] holds N(first+j,k) after step k,
+      // computed in place from N(first+j,k-1) and N(first+j+1,k-1) before it.
+      for (int j = 0; j < order; j++) row[j] = 0.0f;
+      row[order-1] = 1.0f;
+      for (int k = 2; k <= order; k++)
+         for (int j = order - k; j < order; j++)
+         {
+            int i = first + j;
+            if ( (i < 0) || (i + k > numKnots - 1) ) { row[j] = 0.0f; continue; }
+            CurveLanes left = (knots[i+k-1] == knots[i]) ? equalCurveLanes(u, knots[i]) :
+                              (u - knots[i]) / CurveLanes(knots[i+k-1] - knots[i]);
+            if (j + 1 < order)
+            {
+               CurveLanes right = (knots[i+k] == knots[i+1]) ? equalCurveLanes(u, knots[i+k]) :
+                                  (CurveLanes(knots[i+k]) - u) / CurveLanes(knots[i+k] - knots[i+1]);
+               row[j] = left * row[j] + right * row[j+1];
+            }
+            else row[j] = left * row[j];
+         }
+
+      // Weight the control points by the last row, a co-ordinate at a time.
+      for (int c = 0; c < dimension; c++)
+      {
+         coordinates[c] = 0.0f;
+         for (int j = 0; j < order; j++)
+            if ( (first + j >= 0) && (first + j < numKnots - order) )
+               coordinates[c] = coordinates[c] + row[j] * CurveLanes(controlPoints[(first + j)*dimension + c]);
+      }
+      storeCurvePoints(points + p*dimension, coordinates, dimension, numLanes);
+   }
+}
+
+// Coefficients of the polynomial of the curve over the knot span span, knots[span] <
+// knots[span+1], in powers of u - c for c the middle of the span, which is returned:
+// coefficients[d*dimension + co-ordinate] is the d-th derivative of the curve at c
+// divided by d!, for d = 0 to order - 1.
+inline float fillSpanPolynomial(const float *knots, int numKnots, int order, const float *controlPoints,
+                                int dimension, int span, float *coefficients)
+{
+   float center = 0.5f * (knots[span] + knots[span+1]);
+   float derivatives[BSPLINE_MAX_ORDER * BSPLINE_MAX_ORDER];
+   int first = evaluateBasisDerivatives(knots, numKnots, order, center, order - 1, derivatives);
+   float factorial = 1.0f;
+   for (int d = 0; d < order; d++)
+   {
+      if (d > 1) factorial *= d;
+      for (int c = 0; c < dimension; c++)
+      {
+         float coefficient = 0.0f;
+         for (int j = 0; j < order; j++)
+            if ( (first + j >= 0) && (first + j < numKnots - order) )
+               coefficient += derivatives[d*order + j] * controlPoints[(first + j)*dimension + c];
+         coefficients[d*dimension + c] = coefficient / factorial;
+      }
+   }
+   return center;
+}
+
+// The same points as evaluateCurveSpanByTable(), for a span that is not empty, from its
+// polynomial by Horner's rule.
+inline void evaluateCurveSpanByPolynomial(const float *knots, int numKnots, int order, const float *controlPoints,
+                                          int dimension, int span, const float *parameters, int numParameters,
+                                          float *points)
+{
+   float coefficients[BSPLINE_MAX_ORDER * CURVE_MAX_DIMENSION];
+   CurveLanes center = fillSpanPolynomial(knots, numKnots, order, controlPoints, dimension, span, coefficients);
+   CurveLanes coordinates[CURVE_MAX_DIMENSION];
+   float lanes[CURVE_LANES];
+
+   for (int p = 0; p < numParameters; p += CURVE_LANES)
+   {
+      int numLanes = (numParameters - p < CURVE_LANES) ? numParameters - p : CURVE_LANES;
+      const float *u = parameters + p;
+      if (numLanes < CURVE_LANES)
+      {
+         for (int k = 0; k < CURVE_LANES; k++) lanes[k] = parameters[p + ((k < numLanes) ? k : numLanes - 1)];
+         u = lanes;
+      }
+      CurveLanes t = loadCurveLanes(u) - center;
+
+      for (int c = 0; c < dimension; c++)
+      {
+         coordinates[c] = coefficients[(order - 1)*dimension + c];
+         for (int d = order - 2; d >= 0; d--) coordinates[c] = coordinates[c] * t + CurveLanes(coefficients[d*dimension + c]);
+      }
+      storeCurvePoints(points + p*dimension, coordinates, dimension, numLanes);
+   }
+}
+
+// Points of the curve at numParameters parameters in the knot span span, written to
+// points dimension co-ordinates apiece, by the span's polynomial or the table.
+inline void evaluateCurveSpan(const float *knots, int numKnots, int order, const float *controlPoints,
+                              int dimension, int span, const float *parameters, int numParameters, float *points)
+{
+   if ( (numParameters >= CURVE_POLYNOMIAL_RUN) && (knots[span] < knots[span+1]) )
+      evaluateCurveSpanByPolynomial(knots, numKnots, order, controlPoints, dimension, span, parameters,
+                                    numParameters, points);
+   else evaluateCurveSpanByTable(knots, numKnots, order, controlPoints, dimension, span, parameters,
+                                 numParameters, points);
+}
+
+// Points of the curve at numParameters parameters, written to points dimension
+// co-ordinates apiece, taking together the runs of parameters in one knot span; the
+// parameters are best increasing, so that the runs are long. Points at parameters
+// outside the knots are 0, as those of evaluateCurvePoint().
+inline void evaluateCurvePoints(const float *knots, int numKnots, int order, const float *controlPoints,
+                                int dimension, const float *parameters, int numParameters, float *points)
+{
+   int p = 0;
+   while (p < numParameters)
+   {
+      int span = findKnotSpan(knots, numKnots, parameters[p]), end = p + 1;
+      if (span < 0)
+      {
+         for (int c = 0; c < dimension; c++) points[p*dimension + c] = 0.0f;
+         p++;
+         continue;
+      }
+      while ( (end < numParameters) && (knots[span] < parameters[end]) && (parameters[end] <= knots[span+1]) ) end++;
+      evaluateCurveSpan(knots, numKnots, order, controlPoints, dimension, span, parameters + p, end - p,
+                        points + p*dimension);
+      p = end;
+   }
+}
+
+// Parameters of the line strip of a curve: the start of its parameter range,
+// knots[order-1] to knots[numKnots-order], then samplesPerSpan parameters evenly across
+// each knot span of the range which is not empty, ending at its end knot. Returns their
+// number.
+inline int fillCurveParameters(const float *knots, int numKnots, int order, int samplesPerSpan,
+                               std::vector<float> &parameters)
+{
+   parameters.clear();
+   parameters.push_back(knots[order-1]);
+   for (int s = order - 1; s < numKnots - order; s++)
+      if (knots[s] < knots[s+1])
+      {
+         for (int k = 1; k < samplesPerSpan; k++)
+            parameters.push_back(knots[s] + (knots[s+1] - knots[s]) * k / samplesPerSpan);
+         parameters.push_back(knots[s+1]);
+      }
+   return (int)parameters.size();
+}
+
+// Evaluate the line strip of a curve in 3 dimensions at the parameters, increasing, into
+// the vertex buffer object buffer, mapped for writing and grown if it is too small for
+// the vertices, and return their number.
+inline int loadCurveBuffer(unsigned int buffer, const float *knots, int numKnots, int order,
+                           const float *controlPoints, const std::vector<float> &parameters)
+{
+   int numVertices = (int)parameters.size();
+   glBindBuffer(GL_ARRAY_BUFFER, buffer);
+   GLint size;
+   glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+   if (size < (GLsizeiptr)(3 * numVertices * sizeof(float)))
+      glBufferData(GL_ARRAY_BUFFER, 3 * numVertices * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+   float *vertices = (numVertices > 0) ?
+                     (float *)glMapBufferRange(GL_ARRAY_BUFFER, 0, 3 * numVertices * sizeof(float),
+                                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT) : NULL;
+   if (vertices)
+   {
+      evaluateCurvePoints(knots, numKnots, order, controlPoints, 3, &parameters[0], numVertices, vertices);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+   }
+   else numVertices = 0;
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   return numVertices;
+}
+
+// The same through samplesPerSpan points of each knot span. The parameters are a scratch
+// vector kept by the caller.
+inline int loadCurveBuffer(unsigned int buffer, const float *knots, int numKnots, int order,
+                           const float *controlPoints, int samplesPerSpan, std::vector<float> &parameters)
+{
+   fillCurveParameters(knots, numKnots, order, samplesPerSpan, parameters);
+   return loadCurveBuffer(buffer, knots, numKnots, order, controlPoints, parameters);
+}
+
+// Draw the line strip of numVertices vertices in the vertex buffer object buffer.
+inline void drawCurveBuffer(unsigned int buffer, int numVertices)
+{
+   glBindBuffer(GL_ARRAY_BUFFER, buffer);
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glVertexPointer(3, GL_FLOAT, 0, 0);
+   glDrawArrays(GL_LINE_STRIP, 0, numVertices);
+   glDisableClientState(GL_VERTEX_ARRAY);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+#endif
@@ -8,10 +8,13 @@
 // Press the left/right arrow keys to move the selected knot point.
 // Press delete to reset knot values.
 //
+// COMPILE NOTE: Files bSplineBasis.h, bSplineCurve.h and curveTessellator.h must be in the same folder.
+//
 // Sumanta Guha
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -24,6 +27,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "bSplineCurve.h"
+#include "curveTessellator.h"
+
 using namespace std;
 
 // Begin globals.
@@ -33,6 +39,9 @@ static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
 
 // Knot values scaled by a factor of 10 to avoid floating point error when comparing knot values.
 static float knots[9] = {0.0, 10.0, 20.0, 30.0, 40.0, 50.0, 60.0, 70.0, 80.0}; 	
+
+static unsigned int graphBuffer; // Vertex buffer object of the line strip of a graph.
+static vector<float> graphParameters; // Parameters of its vertices, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Routine to draw a bitmap character string.
@@ -47,6 +56,9 @@ void writeBitmapString(void *font, char *string)
 void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0);
+
+   // Create the vertex buffer object of the graphs.
+   glGenBuffers(1, &graphBuffer);
 }
 
 // Function to increase value of a knot.
@@ -87,50 +99,58 @@ void resetKnots(void)
    selectedKnot = 0;
 }
 
-// Recursive computation of B-spline functions.
+// B-spline function, by the table of bSplineBasis.h in place of the recursion.
 float Bspline(int index, int order, float u)
 {
-   float coef1, coef2;
-   if ( order == 1 )
+   return evaluateBspline(knots, 9, index, order, u);
+}
+
+// Tessellate the graph of the B-spline function of the index and order, as drawn, into
+// graphParameters, and evaluate it into graphBuffer, returning its number of vertices.
+// The graph is a B-spline curve of the order on the knots of the function, with
+// order - 1 more copies of the first and of the last, on which the B-splines sum to 1:
+// the curve of the control points (a - 40, 30b - 20) for the B-splines of these knots,
+// a the average of the order - 1 knots inside the support of each and b 1 for the
+// function and 0 for the others.
+int tessellateGraph(int index, int order)
+{
+   float graphKnots[3*4 - 1], graphControlPoints[2*4 - 1][3];
+   int i, j, numKnots = 3*order - 1;
+
+   for (i = 0; i < numKnots; i++)
    {
-	  if ( index == 0 ) if ( ( knots[index] <= u ) && ( u <= knots[index+1] ) ) return 1.0;
-      if ( ( knots[index] < u ) && ( u <= knots[index+1] ) ) return 1.0;
-	  else return 0.0;
+      if (i < order - 1) graphKnots[i] = knots[index];
+      else if (i < 2*order) graphKnots[i] = knots[index + i - order + 1];
+      else graphKnots[i] = knots[index + order];
    }
-   else
+   for (i = 0; i < numKnots - order; i++)
    {
-      if ( knots[index + order - 1] == knots[index] ) 
-	  {
-	     if ( u == knots[index] ) coef1 = 1;
-		 else coef1 = 0;
-	  }
-	  else coef1 = (u - knots[index])/(knots[index + order - 1] - knots[index]);
-
-      if ( knots[index + order] == knots[index+1] )
-	  {
-		 if ( u == knots[index + order] ) coef2 = 1;
-		 else coef2 = 0;
-	  }
-	  else coef2 = (knots[index + order] - u)/(knots[index + order] - knots[index+1]);
-		
-      return ( coef1 * Bspline(index, order-1, u) + coef2 * Bspline(index+1,order-1 ,u) );
+      graphControlPoints[i][0] = -40.0;
+      for (j = i + 1; j < i + order; j++) graphControlPoints[i][0] += graphKnots[j] / (order - 1);
+      graphControlPoints[i][1] = (i == order - 1) ? 10.0 : -20.0;
+      graphControlPoints[i][2] = 0.0;
    }
+
+   CurveView view;
+   getCurveView(view);
+   tessellateBsplineParameters(graphKnots, numKnots, order, graphControlPoints[0], 3, view, CURVE_TOLERANCE,
+                               graphParameters);
+   return loadCurveBuffer(graphBuffer, graphKnots, numKnots, order, graphControlPoints[0], graphParameters);
 }
 
 // Draw a B-spline function graph as line strip and joints as points.
 void drawSpline(int index, int order)
 {
-   float x;   
    int j;
 
    // Drawing are scaled by factor of 3 in the y-direction.
    // Special case to handle order 1 to avoid vertical edges.
    if (order == 1)
    {
-	  // Spline curve.
-      glBegin(GL_LINE_STRIP);
-	  for ( x = knots[index]; x < knots[index+1]; x+=0.05 )
-         glVertex3f( -40.0 + x, 10.0, 0.0 );	
+	  // Spline curve, a straight line.
+      glBegin(GL_LINES);
+         glVertex3f( -40.0 + knots[index], 10.0, 0.0 );
+         glVertex3f( -40.0 + knots[index+1], 10.0, 0.0 );
 	  glEnd();
 	  glPointSize(3.0);
 
@@ -142,11 +162,8 @@ void drawSpline(int index, int order)
    }
    else
    {
-	  // Spline curve.
-	  glBegin(GL_LINE_STRIP);
-	  for ( x = knots[index]; x <= knots[index + order]; x += 0.005 )
-	     glVertex3f( -40.0 + x, 30*Bspline(index, order, x) - 20.0, 0.0 );	
-      glEnd();
+	  // Spline curve, tessellated adaptively and evaluated into the vertex buffer object.
+	  drawCurveBuffer(graphBuffer, tessellateGraph(index, order));
 
 	  // Joints.
 	  glColor3f(0.0, 0.0, 0.0);
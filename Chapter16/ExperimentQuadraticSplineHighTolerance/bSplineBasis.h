@@ -0,0 +1,161 @@
+#ifndef BSPLINEBASIS_H
+#define BSPLINEBASIS_H
+
+// Evaluation of B-spline functions by the triangular table of the Cox-de Boor recursion,
+// in place of the recursive Bspline() of bSplines.cpp. That recursion expands into a
+// binary tree of calls, 2^(m-1) B-splines of order 1 for one of order m, the same lower
+// order B-splines computed again and again; the table computes each once, the m
+// B-splines of order m not zero at u from the one of order 1 not zero there, in O(m^2).
+//
+// The knot interval containing u, whose B-spline of order 1 is 1 at u, is found by
+// binary search. The conventions are those of Bspline(), so that the values are the
+// same to the last bit: the B-spline N(i,1) of order 1 is 1 on (knots[i], knots[i+1]],
+// and N(0,1) on [knots[0], knots[1]]; and a coefficient of the recursion with a zero
+// denominator, as at a multiple knot, is 1 if u is the knot, else 0.
+//
+// B-splines are indexed as in the book: N(i,m) of order m is not zero on (knots[i],
+// knots[i+m]) and needs knots[i] to knots[i+m].
+
+#define BSPLINE_MAX_ORDER 16 // Highest order evaluated.
+
+// Index s of the knot interval containing u, knots[s] < u <= knots[s+1], or 0 if u is
+// knots[0]; -1 if u lies outside [knots[0], knots[numKnots-1]].
+inline int findKnotSpan(const float *knots, int numKnots, float u)
+{
+   if ( (numKnots < 2) || (u < knots[0]) || (u > knots[numKnots-1]) ) return -1;
+   if (u == knots[0]) return 0;
+
+   // Keep knots[low] < u <= knots[high].
+   int low = 0, high = numKnots - 1;
+   while (high - low > 1)
+   {
+      int mid = (low + high) / 2;
+      if (knots[mid] < u) low = mid;
+      else high = mid;
+   }
+   return low;
+}
+
+// Coefficients of N(i,m-1) and N(i+1,m-1) in N(i,m) at u, as in Bspline().
+inline float leftBsplineCoefficient(const float *knots, int i, int m, float u)
+{
+   if ( knots[i+m-1] == knots[i] ) return (u == knots[i]) ? 1.0f : 0.0f;
+   return (u - knots[i])/(knots[i+m-1] - knots[i]);
+}
+
+inline float rightBsplineCoefficient(const float *knots, int i, int m, float u)
+{
+   if ( knots[i+m] == knots[i+1] ) return (u == knots[i+m]) ? 1.0f : 0.0f;
+   return (knots[i+m] - u)/(knots[i+m] - knots[i+1]);
+}
+
+// Fill table[k-1][j] with N(first+j,k) at u for k = 1 to order, j = order-k to order-1,
+// where first = s-order+1 for the knot span s of u, returning first. B-splines outside
+// the knots, of negative index or needing knots past the last, are 0; so are all if u
+// lies outside the knots.
+inline int evaluateBasisTable(const float *knots, int numKnots, int order, float u,
+                              float table[][BSPLINE_MAX_ORDER])
+{
+   int span = findKnotSpan(knots, numKnots, u);
+   int first = span - order + 1;
+   for (int k = 0; k < order; k++)
+      for (int j = 0; j < order; j++) table[k][j] = 0.0;
+   if (span < 0) return first;
+
+   table[0][order-1] = 1.0;
+   for (int k = 2; k <= order; k++)
+      for (int j = order - k; j < order; j++)
+      {
+         int i = first + j;
+         if ( (i < 0) || (i + k > numKnots - 1) ) continue;
+         if (j + 1 < order)
+            table[k-1][j] = leftBsplineCoefficient(knots, i, k, u) * table[k-2][j] +
+                            rightBsplineCoefficient(knots, i, k, u) * table[k-2][j+1];
+         else table[k-1][j] = leftBsplineCoefficient(knots, i, k, u) * table[k-2][j];
+      }
+   return first;
+}
+
+// Fill basis[j] with N(first+j,order) at u, j = 0 to order-1, returning first: all the
+// B-splines of the order which may not be 0 at u.
+inline int evaluateBasis(const float *knots, int numKnots, int order, float u, float *basis)
+{
+   float table[BSPLINE_MAX_ORDER][BSPLINE_MAX_ORDER];
+   int first = evaluateBasisTable(knots, numKnots, order, u, table);
+   for (int j = 0; j < order; j++) basis[j] = table[order-1][j];
+   return first;
+}
+
+// Fill derivatives[d*order + j] with the d-th derivative of N(first+j,order) at u, for
+// d = 0 to numDerivatives, returning first. The derivatives come from the same table,
+// differentiating the recursion: the d-th derivative of N(i,m) is (m-1) times the
+// difference of those of order d-1 of N(i,m-1) and N(i+1,m-1), divided by the lengths
+// of their supports.
+inline int evaluateBasisDerivatives(const float *knots, int numKnots, int order, float u, int numDerivatives,
+                                    float *derivatives)
+{
+   float table[BSPLINE_MAX_ORDER][BSPLINE_MAX_ORDER], lower[BSPLINE_MAX_ORDER][BSPLINE_MAX_ORDER];
+   int first = evaluateBasisTable(knots, numKnots, order, u, table);
+   for (int j = 0; j < order; j++) derivatives[j] = table[order-1][j];
+
+   for (int d = 1; d <= numDerivatives; d++)
+   {
+      // Take the table to the derivatives of order d from a copy of those of order d-1.
+      for (int k = 0; k < order; k++)
+         for (int j = 0; j < order; j++) lower[k][j] = table[k][j];
+      for (int j = 0; j < order; j++) table[0][j] = 0.0;
+      for (int k = 2; k <= order; k++)
+         for (int j = order - k; j < order; j++)
+         {
+            int i = first + j;
+            table[k-1][j] = 0.0;
+            if ( (i < 0) || (i + k > numKnots - 1) ) continue;
+            if (knots[i+k-1] != knots[i])
+               table[k-1][j] += (k - 1) * lower[k-2][j] / (knots[i+k-1] - knots[i]);
+            if ( (j + 1 < order) && (knots[i+k] != knots[i+1]) )
+               table[k-1][j] -= (k - 1) * lower[k-2][j+1] / (knots[i+k] - knots[i+1]);
+         }
+      for (int j = 0; j < order; j++) derivatives[d*order + j] = table[order-1][j];
+   }
+   return first;
+}
+
+// Value of the single B-spline N(index,order) at u, as Bspline(). Outside the support
+// it is 0 at once; within it the knot span is found by a walk along the order + 1 knots
+// of the support, and only the part of the table that N(index,order) comes from, the
+// B-splines N(index+j,k) of its support, is computed in place in one row.
+inline float evaluateBspline(const float *knots, int numKnots, int index, int order, float u)
+{
+   if ( (index < 0) || (index + order > numKnots - 1) || (u > knots[index + order]) ) return 0.0;
+   int span = 0; // Span of u = knots[0], where N(0,1) is 1.
+   if (u <= knots[index])
+   {
+      if ( (index > 0) || (u < knots[0]) ) return 0.0;
+   }
+   else for (span = index; knots[span+1] < u; span++);
+   if (order == 1) return 1.0;
+
+   float row[BSPLINE_MAX_ORDER];
+   for (int j = 0; j < order; j++) row[j] = (index + j == span) ? 1.0f : 0.0f;
+   for (int k = 2; k <= order; k++)
+      for (int j = 0; j <= order - k; j++)
+         row[j] = leftBsplineCoefficient(knots, index + j, k, u) * row[j] +
+                  rightBsplineCoefficient(knots, index + j, k, u) * row[j+1];
+   return row[0];
+}
+
+// Point at u of the B-spline curve of the order with the knots and numKnots - order
+// control points, each of dimension co-ordinates: the sum of the control points weighted
+// by the B-splines not 0 at u.
+inline void evaluateCurvePoint(const float *knots, int numKnots, int order, const float *controlPoints,
+                               int dimension, float u, float *point)
+{
+   float basis[BSPLINE_MAX_ORDER];
+   int first = evaluateBasis(knots, numKnots, order, u, basis);
+   for (int c = 0; c < dimension; c++) point[c] = 0.0;
+   for (int j = 0; j < order; j++)
+      if ( (first + j >= 0) && (first + j < numKnots - order) )
+         for (int c = 0; c < dimension; c++) point[c] += basis[j] * controlPoints[(first + j)*dimension + c];
+}
+
+#endif
@@ -13,6 +13,8 @@
 // The selected knot (in red) is increased/decreased using the right/left arrow keys.
 // Press delete to reset knot values.
 //
+// COMPILE NOTE: File bSplineBasis.h must be in the same folder.
+//
 // Sumanta Guha
 /////////////////////////////////////////////////////////////////////////////////////
 
@@ -29,6 +31,8 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "bSplineBasis.h"
+
 using namespace std;
 
 // Begin globals.
@@ -125,40 +129,10 @@ void resetControlPoints(void)
    selectedControlPoint = 0;
 }
 
-// Recursive computation of B-spline functions.
-float Bspline(int i, int m, float u)
-{
-   float coef1, coef2;
-   if ( m == 1 )
-   {
-	  if ( i == 0 ) if ( ( knots[i] <= u ) && ( u <= knots[i+1] ) ) return 1.0;
-      if ( ( knots[i] < u ) && ( u <= knots[i+1] ) ) return 1.0;
-	  else return 0.0;
-   }
-   else
-   {
-      if ( knots[i+m-1] == knots[i] ) 
-	  {
-	     if ( u == knots[i] ) coef1 = 1;
-		 else coef1 = 0;
-	  }
-	  else coef1 = (u - knots[i])/(knots[i+m-1] - knots[i]);
-
-      if ( knots[i+m] == knots[i+1] )
-	  {
-		 if ( u == knots[i+m] ) coef2 = 1;
-		 else coef2 = 0;
-	  }
-	  else coef2 = (knots[i+m] - u)/(knots[i+m] - knots[i+1]);
-		
-      return ( coef1 * Bspline(i, m-1, u) + coef2 * Bspline(i+1 ,m-1 ,u) );
-   }
-}
-
 // Drawing routine.
 void drawScene(void)
 {
-   int i,j;
+   int i;
 
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -263,32 +237,22 @@ void drawScene(void)
    // Draw images of knot points (i.e., joints) on the curve.
    glPointSize(5.0);
    glColor3f(0.0, 0.0, 1.0);
-   float knotImageX, knotImageY;
+   float knotImage[3];
    glBegin(GL_POINTS);
       for (i = 2; i < 10; i++) 
 	  {
-		 knotImageX = knotImageY = 0;
-		 for (j = 0; j < 9; j++)
-		 {
-	        knotImageX += Bspline(j, 3, knots[i]) * controlPoints[j][0];
-		    knotImageY += Bspline(j, 3, knots[i]) * controlPoints[j][1];
-		 }
-         glVertex3f(knotImageX, knotImageY, 0.0);
+		 evaluateCurvePoint(knots, 12, 3, controlPoints[0], 3, knots[i], knotImage);
+         glVertex3f(knotImage[0], knotImage[1], 0.0);
 	  }
    glEnd();
 
    // Highlight the image of the selected knot point (if it is within the parameter space).
    glColor3f(1.0, 0.0, 0.0);
    glBegin(GL_POINTS);
-   knotImageX = knotImageY = 0;
    if ( (2 <= selectedKnot) && (selectedKnot <= 9) )
    {
-      for (j = 0; j < 9; j++)
-	  {
-         knotImageX += Bspline(j, 3, knots[selectedKnot]) * controlPoints[j][0];
-         knotImageY += Bspline(j, 3, knots[selectedKnot]) * controlPoints[j][1];
-	  }
-   glVertex3f(knotImageX, knotImageY, 0.0);
+      evaluateCurvePoint(knots, 12, 3, controlPoints[0], 3, knots[selectedKnot], knotImage);
+   glVertex3f(knotImage[0], knotImage[1], 0.0);
    }   
    glEnd();
 
@@ -14,6 +14,8 @@
 // Press the x, X, y, Y, z, Z keys to rotate the viewpoint.
 // Press delete to reset control points.
 //
+// COMPILE NOTE: Files bSplineBasis.h and nurbsSurface.h must be in the same folder.
+//
 //Sumanta Guha.
 ////////////////////////////////////////////////////////////////////////////////////
 
@@ -31,6 +33,8 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "nurbsSurface.h"
+
 #define PI 3.14159265
 
 using namespace std;
@@ -66,7 +70,7 @@ static float curveKnots[10] =
 {0.0, 0.0, 0.0, 0.0, 1.0, 2.0, 3.0, 3.0, 3.0, 3.0}; 
 
 static int rowCount = 0, columnCount = 0; // Indexes of selected control point.
-static GLUnurbsObj *nurbsObject; // Pointer to NURBS object.
+static NurbsSurface surface; // Tessellation of the trimmed spline surface.
 // End globals.
 
 // Routine to draw a stroke character string.
@@ -111,14 +115,27 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0); 
 
-   // Create NURBS object.
-   nurbsObject = gluNewNurbsRenderer();
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
-   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 100.0);
-   gluNurbsProperty(nurbsObject, GLU_DISPLAY_MODE, GLU_OUTLINE_POLYGON);
-
    resetControlPoints();
    setCirclePoints();
+
+   // Make the spline surface of the control points, sampled twice across each knot span,
+   // about as often as GLU sampled it to a tolerance of 100 pixels.
+   makeNurbsSurface(surface, 19, uknots, 14, vknots, 30, 3, controlPoints[0][0], 4, 4, 3, 2);
+
+   // Counter-clockwise oriented trimming rectangle.
+   beginNurbsTrim(surface);
+   nurbsTrimPolyline(surface, 5, boundaryPoints[0], 2);
+
+   // Clockwise oriented trimming circle.
+   beginNurbsTrim(surface);
+   nurbsTrimPolyline(surface, 11, circlePoints[0], 2);
+
+   // Clockwise oriented trimming B-spline loop.
+   beginNurbsTrim(surface);
+   nurbsTrimCurve(surface, 10, curveKnots, 2, curvePoints[0], 4);
+
+   // Triangulate the trimmed domain once; edits only move its vertices.
+   trimNurbsSurface(surface);
 }
 
 // Drawing routine.
@@ -137,27 +154,8 @@ void drawScene(void)
 
    // Draw the spline surface.
    glColor3f(0.0, 0.0, 0.0);
-   gluBeginSurface(nurbsObject);
-   gluNurbsSurface(nurbsObject, 19, uknots, 14, vknots, 
-	               30, 3, controlPoints[0][0], 4, 4, GL_MAP2_VERTEX_3);
-
-   // Counter-clockwise oriented trimming rectangle.
-   gluBeginTrim(nurbsObject);
-      gluPwlCurve(nurbsObject, 5, boundaryPoints[0], 2, GLU_MAP1_TRIM_2);
-   gluEndTrim(nurbsObject);
-
-   // Cloclwise oriented trimming circle.
-   gluBeginTrim(nurbsObject);
-      gluPwlCurve(nurbsObject, 11, circlePoints[0], 2, GLU_MAP1_TRIM_2);
-   gluEndTrim(nurbsObject);
-
-   // Clockwise oriented trimming B-spline loop.
-   gluBeginTrim(nurbsObject);
-      gluNurbsCurve(nurbsObject, 10, curveKnots, 2, curvePoints[0], 4, 
-		             GLU_MAP1_TRIM_2);
-   gluEndTrim(nurbsObject);
-
-   gluEndSurface(nurbsObject);
+   updateNurbsSurface(surface);
+   drawNurbsSurface(surface, NURBS_OUTLINE_POLYGON);
 
    glPointSize(5.0);
 
@@ -302,6 +300,7 @@ void keyInput(unsigned char key, int x, int y)
          break;
       case 127:	
          resetControlPoints();
+         editNurbsSurface(surface);
 		 glutPostRedisplay();
          break;
       default:
@@ -318,6 +317,7 @@ void specialKeyInput(int key, int x, int y)
    if (key == GLUT_KEY_UP) controlPoints[rowCount][columnCount][1] += 0.1;
    if (key == GLUT_KEY_PAGE_DOWN) controlPoints[rowCount][columnCount][2] += 0.1;
    if (key == GLUT_KEY_PAGE_UP) controlPoints[rowCount][columnCount][2] -= 0.1;
+   editNurbsControlPoint(surface, rowCount, columnCount);
    glutPostRedisplay();
 }
 
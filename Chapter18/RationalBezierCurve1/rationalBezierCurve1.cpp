@@ -22,11 +22,14 @@
 // Press the up/down arrow keys to increase/decrease the weight of the selected control point.
 // Press delete to reset the weights.
 //
+// COMPILE NOTE: File curveTessellator.h must be in the same folder.
+//
 // Sumanta Guha
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -39,6 +42,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "curveTessellator.h"
+
+
 using namespace std;
 
 // Begin globals.
@@ -60,6 +66,10 @@ static float controlPointsLifted[4][3];
 
 // Control points in homogeneous co-ordinates.
 static float controlPointsHomogeneous[4][4];
+
+// Vertex buffer objects of the line strips of the polynomial and the rational curves.
+static unsigned int curveBuffers[2];
+static vector<float> curveVertices; // Vertices of a curve, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Routine to draw a bitmap character string.
@@ -145,6 +155,9 @@ void setup(void)
    glClearColor(1.0, 1.0, 1.0, 0.0); 
    computeControlPointsHomogeneous();
    computeControlPointsLifted();
+
+   // Create the vertex buffer objects of the curves.
+   glGenBuffers(2, curveBuffers);
 }
 
 // Drawing routine.
@@ -173,21 +186,20 @@ void drawScene(void)
       glEnd();
    }
 
-   // Draw the polynomial Bezier curve in 3-space in green.
+   // Draw the polynomial Bezier curve in 3-space in green, tessellated adaptively in
+   // the perspective view.
+   CurveView view;
+   getCurveView(view);
    glColor3f(0.0, 1.0, 0.0);
-   glMap1f(GL_MAP1_VERTEX_3, 0.0, 1.0, 3, 4, controlPointsLifted[0]);
-   glEnable(GL_MAP1_VERTEX_3);
-   glMapGrid1f(100, 0.0, 1.0);
-   glEvalMesh1(GL_LINE, 0, 100);
-   glDisable(GL_MAP1_VERTEX_3);
+   curveVertices.clear();
+   tessellateBezierCurve(controlPointsLifted[0], 4, 3, 0.0, 1.0, view, CURVE_TOLERANCE, curveVertices);
+   drawTessellationBuffer(curveBuffers[0], loadTessellationBuffer(curveBuffers[0], curveVertices));
 
    // Draw the rational Bezier curve on the plane in red.
    glColor3f(1.0, 0.0, 0.0);
-   glMap1f(GL_MAP1_VERTEX_4, 0.0, 1.0, 4, 4, controlPointsHomogeneous[0]);
-   glEnable(GL_MAP1_VERTEX_4);
-   glMapGrid1f(100, 0.0, 1.0);
-   glEvalMesh1(GL_LINE, 0, 100);
-   glDisable(GL_MAP1_VERTEX_4);
+   curveVertices.clear();
+   tessellateBezierCurve(controlPointsHomogeneous[0], 4, 4, 0.0, 1.0, view, CURVE_TOLERANCE, curveVertices);
+   drawTessellationBuffer(curveBuffers[1], loadTessellationBuffer(curveBuffers[1], curveVertices));
 
    // Draw the cone through the polynomial Bezier curve in 3-space in a light gray
    // to intesect the rational Bezier curve on z=1..
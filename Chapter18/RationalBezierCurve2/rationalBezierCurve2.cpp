@@ -8,12 +8,15 @@
 // Interaction:
 // Press the up/down arrow keys to increase/decrease the weight of the control point at (1,1).
 //
+// COMPILE NOTE: File curveTessellator.h must be in the same folder.
+//
 // Sumanta Guha
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -26,6 +29,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "curveTessellator.h"
+
+
 #define PI 3.14159265358979324
 
 using namespace std;
@@ -45,6 +51,9 @@ static float weights[3] = {1.0, 1.5, 1.0};
 
 // Control points in homogeneous co-ordinates.
 static float controlPointsHomogeneous[3][4];
+
+static unsigned int curveBuffer; // Vertex buffer object of the line strip of the curve.
+static vector<float> curveVertices; // Its vertices, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Routine to draw a bitmap character string.
@@ -111,6 +120,9 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0); 
    computeControlPointsHomogeneous();
+
+   // Create the vertex buffer object of the curve.
+   glGenBuffers(1, &curveBuffer);
 }
 
 // Drawing routine.
@@ -142,12 +154,13 @@ void drawScene(void)
    }
    glEnd();
 
-   // Draw the red rational Bezier curve.
+   // Draw the red rational Bezier curve, tessellated adaptively.
    glColor3f(1.0, 0.0, 0.0);
-   glMap1f(GL_MAP1_VERTEX_4, 0.0, 1.0, 4, 3, controlPointsHomogeneous[0]);
-   glEnable(GL_MAP1_VERTEX_4);
-   glMapGrid1f(100, 0.0, 1.0);
-   glEvalMesh1(GL_LINE, 0, 100);
+   CurveView view;
+   getCurveView(view);
+   curveVertices.clear();
+   tessellateBezierCurve(controlPointsHomogeneous[0], 3, 4, 0.0, 1.0, view, CURVE_TOLERANCE, curveVertices);
+   drawTessellationBuffer(curveBuffer, loadTessellationBuffer(curveBuffer, curveVertices));
 
    // Draw the control points as red dots.
    glColor3f(1.0, 0.0, 0.0);	  
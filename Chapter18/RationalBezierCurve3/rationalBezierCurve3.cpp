@@ -10,11 +10,14 @@
 // Press the page up/down keys to increase/decrease the weight of the selected control point.
 // Press delete to reset the control points.
 //
+// COMPILE NOTE: File curveTessellator.h must be in the same folder.
+//
 //Sumanta Guha
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -27,6 +30,9 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "curveTessellator.h"
+
+
 using namespace std;
 
 // Begin globals.
@@ -53,6 +59,9 @@ static float weights[6] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
 
 // Control points in homogeneous co-ordinates.
 static float controlPointsHomogeneous[6][4];
+
+static unsigned int curveBuffer; // Vertex buffer object of the line strip of the curve.
+static vector<float> curveVertices; // Its vertices, tessellated to CURVE_TOLERANCE.
 // End globals.
 
 // Routine to draw a bitmap character string.
@@ -137,6 +146,9 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0); 
    computeControlPointsHomogeneous();
+
+   // Create the vertex buffer object of the curve.
+   glGenBuffers(1, &curveBuffer);
 }
 
 // Drawing routine.
@@ -148,12 +160,13 @@ void drawScene(void)
 
    glPointSize(5.0);
 
-   // Draw the black rational Bezier curve.
+   // Draw the black rational Bezier curve, tessellated adaptively.
    glColor3f(0.0, 0.0, 0.0);
-   glMap1f(GL_MAP1_VERTEX_4, 0.0, 1.0, 4, 6, controlPointsHomogeneous[0]);
-   glEnable(GL_MAP1_VERTEX_4);
-   glMapGrid1f(100, 0.0, 1.0);
-   glEvalMesh1(GL_LINE, 0, 100);
+   CurveView view;
+   getCurveView(view);
+   curveVertices.clear();
+   tessellateBezierCurve(controlPointsHomogeneous[0], 6, 4, 0.0, 1.0, view, CURVE_TOLERANCE, curveVertices);
+   drawTessellationBuffer(curveBuffer, loadTessellationBuffer(curveBuffer, curveVertices));
 
    // Draw the control points as green dots.
    glColor3f(0.0, 1.0, 0.0);	  
@@ -0,0 +1,999 @@
+#ifndef NURBSSURFACE_H
+#define NURBSSURFACE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bSplineBasis.h"
+
+// Tessellation of a tensor-product B-spline surface, polynomial or rational, into an
+// indexed vertex buffer object with normals and texture co-ordinates, in place of
+// gluNurbsSurface(), which retessellates the whole surface in immediate mode every
+// time it is drawn.
+//
+// The surface is sampled on a fixed grid of parameters, samplesPerSpan steps across
+// each knot span in either direction, so that the triangles and their indices are made
+// once, with the surface, and only the vertices change with the control points. For
+// each parameter the B-splines not 0 there and their first derivatives are tabled once
+// too, from the span's polynomial by bSplineBasis.h, so that a vertex costs only the
+// sums of the control points weighted by them.
+//
+// An edit of a control point, reported by editNurbsControlPoint(), marks as changed the
+// rectangle of the grid over the support of its B-splines, which is all it moves, and
+// updateNurbsSurface() evaluates just that rectangle and copies it into the vertex
+// buffer, a large rectangle split into bands of rows evaluated by concurrent threads.
+// Nothing is evaluated when nothing has changed.
+//
+// Control points are laid out as for gluNurbsSurface(): the (i, j)th, of index i along
+// u and j along v, starts at controlPoints[i*uStride + j*vStride] and has dimension
+// co-ordinates, 3, or 4 for homogeneous co-ordinates (x*w, y*w, z*w, w) of a rational
+// surface. A texture co-ordinate runs from 0 to 1 across the parameter range in its
+// direction.
+//
+// A surface may be trimmed, in place of gluBeginTrim(), by loops of polylines and
+// B-spline curves in its (u, v) plane, the part kept lying to the left of each loop:
+// an outer loop runs counter-clockwise, a hole in it clockwise. trimNurbsSurface()
+// triangulates the trimmed domain once, on the grid: a cell no loop crosses keeps its
+// two triangles, or none if it lies outside; a cell a loop crosses is cut along the
+// loops into polygons of its corners, the points of the loops in it and where they
+// cross its sides, which are ear clipped. The points of the loops become vertices past
+// the grid's, with their B-splines tabled as the grid's, so that an edit still only
+// evaluates the vertices it moves, the triangles staying as they are.
+
+#define NURBS_SAMPLES_PER_SPAN 4 // Steps of the grid across each knot span.
+#define NURBS_THREAD_VERTICES 16384 // Fewest vertices worth a thread of their own.
+#define NURBS_FILL 0 // Draw the triangles filled, with normals and texture co-ordinates.
+#define NURBS_OUTLINE_POLYGON 1 // Draw the outlines of the triangles.
+#define NURBS_MESH 2 // Draw the lines of the grid, as glEvalMesh2(GL_LINE, ...).
+#define NURBS_TRIM_SAMPLES_PER_SPAN 16 // Steps along each knot span of a B-spline trim curve.
+#define NURBS_TRIM_NUDGE 0.001f // Fraction of a grid step trim points are moved off grid lines.
+
+struct NurbsVertex
+{
+   float coords[3];
+   float normal[3];
+   float texCoords[2];
+};
+
+struct NurbsSurface
+{
+   int uOrder, vOrder;
+   std::vector<float> uKnots, vKnots;
+   const float *controlPoints;
+   int uStride, vStride, dimension;
+
+   // The grid's parameters in either direction, each with the index of the first
+   // control point whose B-spline is not 0 there, and the values of the order
+   // B-splines from it followed by their derivatives.
+   std::vector<float> uParameters, vParameters;
+   std::vector<int> uFirst, vFirst;
+   std::vector<float> uBasis, vBasis;
+
+   // The trim loops, each of points u, v; and the vertices of a trimmed surface past the
+   // grid's, each with its parameters u, v, the first control points along u and v whose
+   // B-splines are not 0 there, and the B-splines in u and their derivatives followed by
+   // those in v.
+   std::vector< std::vector<float> > trimLoops;
+   std::vector<float> trimParameters;
+   std::vector<int> trimFirst;
+   std::vector<float> trimBasis;
+
+   // Row after row of v, each of all the u parameters, then the vertices of the trim.
+   std::vector<NurbsVertex> vertices;
+   std::vector<unsigned int> indices; // The triangles, then the lines of the grid.
+   int numTriangleIndices, numMeshIndices;
+
+   // Rectangle of the grid changed since the last update, columns firstColumn to
+   // lastColumn - 1 of rows firstRow to lastRow - 1; none if either range is empty.
+   int firstColumn, lastColumn, firstRow, lastRow;
+
+   // Vertices of the trim firstTrimVertex to lastTrimVertex - 1 evaluated by the last
+   // evaluation.
+   int firstTrimVertex, lastTrimVertex;
+
+   unsigned int buffers[2]; // Vertex and index buffer objects, 0 until first made.
+   bool loaded; // Whether the buffers hold the vertices and indices as made.
+
+   NurbsSurface() : controlPoints(0), numTriangleIndices(0), numMeshIndices(0),
+                    firstColumn(0), lastColumn(0), firstRow(0), lastRow(0),
+                    firstTrimVertex(0), lastTrimVertex(0), loaded(false) { buffers[0] = buffers[1] = 0; }
+};
+
+// A point of a trim loop within the grid, and its vertex.
+struct NurbsTrimPoint
+{
+   float u, v;
+   unsigned int index;
+};
+
+// The pieces of the trim loops within a cell of the grid: runs from a side of the cell
+// to a side, and whole loops.
+struct NurbsTrimCell
+{
+   std::vector< std::vector<NurbsTrimPoint> > runs, loops;
+};
+
+// Append to basis the order B-splines at u - center = t, and their derivatives, from
+// their derivatives at center.
+inline void tableNurbsBasis(const float *derivatives, int order, float t, std::vector<float> &basis)
+{
+   for (int j = 0; j < order; j++)
+   {
+      float value = 0.0f, power = 1.0f;
+      for (int d = 0; d < order; d++, power *= t / d) value += derivatives[d*order + j] * power;
+      basis.push_back(value);
+   }
+   for (int j = 0; j < order; j++)
+   {
+      float slope = 0.0f, power = 1.0f;
+      for (int d = 1; d < order; d++, power *= t / (d - 1)) slope += derivatives[d*order + j] * power;
+      basis.push_back(slope);
+   }
+}
+
+// Fill the parameters of one direction of the grid, samplesPerSpan steps across each
+// knot span of the parameter range knots[order-1] to knots[numKnots-order] which is not
+// empty, with their first control points and B-splines. Each parameter belongs to the
+// span it ends or lies in, whose polynomial, in powers of u - c for c the middle of the
+// span, gives the B-splines and their derivatives at it, even at the ends of the range.
+inline void fillNurbsParameters(const std::vector<float> &knots, int order, int samplesPerSpan,
+                                std::vector<float> &parameters, std::vector<int> &firsts, std::vector<float> &basis)
+{
+   int numKnots = (int)knots.size();
+   float derivatives[BSPLINE_MAX_ORDER * BSPLINE_MAX_ORDER];
+   parameters.clear();
+   firsts.clear();
+   basis.clear();
+
+   for (int s = order - 1; s < numKnots - order; s++)
+   {
+      if (knots[s] == knots[s+1]) continue;
+      float center = 0.5f * (knots[s] + knots[s+1]);
+      int first = evaluateBasisDerivatives(&knots[0], numKnots, order, center, order - 1, derivatives);
+      for (int k = parameters.empty() ? 0 : 1; k <= samplesPerSpan; k++)
+      {
+         float u = (k == samplesPerSpan) ? knots[s+1] : knots[s] + (knots[s+1] - knots[s]) * k / samplesPerSpan;
+         parameters.push_back(u);
+         firsts.push_back(first);
+         tableNurbsBasis(derivatives, order, u - center, basis);
+      }
+   }
+}
+
+// Append the first control point and B-splines at a parameter u of the range, not on
+// the grid, from the polynomial of the span it lies in, as fillNurbsParameters().
+inline void appendNurbsParameter(const std::vector<float> &knots, int order, float u, std::vector<int> &firsts,
+                                 std::vector<float> &basis)
+{
+   int numKnots = (int)knots.size();
+   float derivatives[BSPLINE_MAX_ORDER * BSPLINE_MAX_ORDER];
+   int s = (int)(std::upper_bound(knots.begin() + order - 1, knots.begin() + numKnots - order + 1, u) - knots.begin()) - 1;
+   s = std::min(std::max(s, order - 1), numKnots - order - 1);
+   while ( (s > order - 1) && (knots[s] == knots[s+1]) ) s--;
+   float center = 0.5f * (knots[s] + knots[s+1]);
+   firsts.push_back(evaluateBasisDerivatives(&knots[0], numKnots, order, center, order - 1, derivatives));
+   tableNurbsBasis(derivatives, order, u - center, basis);
+}
+
+// Mark the whole grid changed.
+inline void editNurbsSurface(NurbsSurface &surface)
+{
+   surface.firstColumn = surface.firstRow = 0;
+   surface.lastColumn = (int)surface.uParameters.size();
+   surface.lastRow = (int)surface.vParameters.size();
+}
+
+// Make the surface of the knots, orders and control points, its grid of samplesPerSpan
+// steps across each knot span, and its triangles, all of whose vertices are then to be
+// evaluated by the first update.
+inline void makeNurbsSurface(NurbsSurface &surface, int uKnotCount, const float *uKnots, int vKnotCount,
+                             const float *vKnots, int uStride, int vStride, const float *controlPoints,
+                             int uOrder, int vOrder, int dimension, int samplesPerSpan = NURBS_SAMPLES_PER_SPAN)
+{
+   surface.uOrder = uOrder;
+   surface.vOrder = vOrder;
+   surface.uKnots.assign(uKnots, uKnots + uKnotCount);
+   surface.vKnots.assign(vKnots, vKnots + vKnotCount);
+   surface.controlPoints = controlPoints;
+   surface.uStride = uStride;
+   surface.vStride = vStride;
+   surface.dimension = dimension;
+   fillNurbsParameters(surface.uKnots, uOrder, samplesPerSpan, surface.uParameters, surface.uFirst, surface.uBasis);
+   fillNurbsParameters(surface.vKnots, vOrder, samplesPerSpan, surface.vParameters, surface.vFirst, surface.vBasis);
+   surface.trimLoops.clear();
+   surface.trimParameters.clear();
+   surface.trimFirst.clear();
+   surface.trimBasis.clear();
+   surface.loaded = false;
+
+   int numColumns = (int)surface.uParameters.size(), numRows = (int)surface.vParameters.size();
+   surface.vertices.assign(numColumns * numRows, NurbsVertex());
+
+   // Two triangles a cell, counter-clockwise in the (u, v) plane, so that the normal,
+   // the cross product of the u and v derivatives, is on their front.
+   std::vector<unsigned int> &indices = surface.indices;
+   indices.clear();
+   for (int q = 0; q < numRows - 1; q++)
+      for (int p = 0; p < numColumns - 1; p++)
+      {
+         unsigned int lower = q * numColumns + p, upper = lower + numColumns;
+         indices.push_back(lower); indices.push_back(lower + 1); indices.push_back(upper + 1);
+         indices.push_back(lower); indices.push_back(upper + 1); indices.push_back(upper);
+      }
+   surface.numTriangleIndices = (int)indices.size();
+   for (int q = 0; q < numRows; q++)
+      for (int p = 0; p < numColumns - 1; p++)
+      {
+         indices.push_back(q * numColumns + p);
+         indices.push_back(q * numColumns + p + 1);
+      }
+   for (int p = 0; p < numColumns; p++)
+      for (int q = 0; q < numRows - 1; q++)
+      {
+         indices.push_back(q * numColumns + p);
+         indices.push_back((q + 1) * numColumns + p);
+      }
+   surface.numMeshIndices = (int)indices.size() - surface.numTriangleIndices;
+
+   editNurbsSurface(surface);
+}
+
+// Mark changed the part of the grid moved by the control point of index i along u and
+// j along v: the parameters within the supports, knots[i] to knots[i+order], of its
+// B-splines in either direction.
+inline void editNurbsControlPoint(NurbsSurface &surface, int i, int j)
+{
+   const std::vector<float> &us = surface.uParameters, &vs = surface.vParameters;
+   int firstColumn = (int)(std::lower_bound(us.begin(), us.end(), surface.uKnots[i]) - us.begin());
+   int lastColumn = (int)(std::upper_bound(us.begin(), us.end(), surface.uKnots[i + surface.uOrder]) - us.begin());
+   int firstRow = (int)(std::lower_bound(vs.begin(), vs.end(), surface.vKnots[j]) - vs.begin());
+   int lastRow = (int)(std::upper_bound(vs.begin(), vs.end(), surface.vKnots[j + surface.vOrder]) - vs.begin());
+   if ( (firstColumn >= lastColumn) || (firstRow >= lastRow) ) return;
+
+   if (surface.firstColumn < surface.lastColumn)
+   {
+      firstColumn = std::min(firstColumn, surface.firstColumn);
+      lastColumn = std::max(lastColumn, surface.lastColumn);
+      firstRow = std::min(firstRow, surface.firstRow);
+      lastRow = std::max(lastRow, surface.lastRow);
+   }
+   surface.firstColumn = firstColumn;
+   surface.lastColumn = lastColumn;
+   surface.firstRow = firstRow;
+   surface.lastRow = lastRow;
+}
+
+// Begin a trim loop, as gluBeginTrim(); the polylines and curves added after it join
+// end to end into the loop.
+inline void beginNurbsTrim(NurbsSurface &surface)
+{
+   surface.trimLoops.push_back(std::vector<float>());
+}
+
+// Add the point (u, v) to the end of the trim loop begun last, unless it ends there.
+inline void addNurbsTrimPoint(NurbsSurface &surface, float u, float v)
+{
+   std::vector<float> &loop = surface.trimLoops.back();
+   if ( !loop.empty() && (loop[loop.size() - 2] == u) && (loop.back() == v) ) return;
+   loop.push_back(u);
+   loop.push_back(v);
+}
+
+// Add to the trim loop the polyline of count points (u, v), each stride floats after
+// the last, as gluPwlCurve(..., GLU_MAP1_TRIM_2).
+inline void nurbsTrimPolyline(NurbsSurface &surface, int count, const float *points, int stride)
+{
+   for (int k = 0; k < count; k++) addNurbsTrimPoint(surface, points[k * stride], points[k * stride + 1]);
+}
+
+// Add to the trim loop the B-spline curve of the knots, order and control points, each
+// stride floats after the last, as gluNurbsCurve(): of dimension 2, points (u, v), or 3,
+// homogeneous points (u*w, v*w, w) of a rational curve, as GLU_MAP1_TRIM_2 and
+// GLU_MAP1_TRIM_3. The curve is sampled samplesPerSpan steps along each knot span.
+inline void nurbsTrimCurve(NurbsSurface &surface, int knotCount, const float *knots, int stride,
+                           const float *controlPoints, int order, int dimension = 2,
+                           int samplesPerSpan = NURBS_TRIM_SAMPLES_PER_SPAN)
+{
+   std::vector<float> knotVector(knots, knots + knotCount), basis;
+   std::vector<int> firsts;
+   bool started = false;
+   for (int s = order - 1; s < knotCount - order; s++)
+   {
+      if (knots[s] == knots[s+1]) continue;
+      for (int k = started ? 1 : 0; k <= samplesPerSpan; k++)
+      {
+         float u = (k == samplesPerSpan) ? knots[s+1] : knots[s] + (knots[s+1] - knots[s]) * k / samplesPerSpan;
+         firsts.clear();
+         basis.clear();
+         appendNurbsParameter(knotVector, order, u, firsts, basis);
+         float point[3] = { 0.0f, 0.0f, 0.0f };
+         for (int j = 0; j < order; j++)
+         {
+            const float *controlPoint = controlPoints + (firsts[0] + j) * stride;
+            for (int c = 0; c < dimension; c++) point[c] += basis[j] * controlPoint[c];
+         }
+         if (dimension == 3) addNurbsTrimPoint(surface, point[0] / point[2], point[1] / point[2]);
+         else addNurbsTrimPoint(surface, point[0], point[1]);
+      }
+      started = true;
+   }
+}
+
+// Add a vertex of the trim at (u, v), returning its index.
+inline unsigned int addNurbsTrimVertex(NurbsSurface &surface, float u, float v)
+{
+   surface.trimParameters.push_back(u);
+   surface.trimParameters.push_back(v);
+   appendNurbsParameter(surface.uKnots, surface.uOrder, u, surface.trimFirst, surface.trimBasis);
+   appendNurbsParameter(surface.vKnots, surface.vOrder, v, surface.trimFirst, surface.trimBasis);
+   surface.vertices.push_back(NurbsVertex());
+   return (unsigned int)surface.vertices.size() - 1;
+}
+
+// Move a co-ordinate of a trim point off the grid's parameters: outwards to a nudge past
+// either end of the range if within one of it, otherwise along by a part of one.
+inline float nudgeNurbsTrim(float u, const std::vector<float> &parameters, float nudge)
+{
+   if (std::fabs(u - parameters[0]) < nudge) return parameters[0] - nudge;
+   if (std::fabs(u - parameters.back()) < nudge) return parameters.back() + nudge;
+   return u + 0.37f * nudge;
+}
+
+// Index of the grid cell of columns p, p + 1 and rows q, q + 1, or -1 if there is none.
+inline int nurbsTrimCell(int p, int q, int numColumns, int numRows)
+{
+   if ( (p < 0) || (p >= numColumns - 1) || (q < 0) || (q >= numRows - 1) ) return -1;
+   return q * (numColumns - 1) + p;
+}
+
+// Twice the area of the triangle abc, positive if it is counter-clockwise.
+inline double orientNurbsTrim(const NurbsTrimPoint &a, const NurbsTrimPoint &b, const NurbsTrimPoint &c)
+{
+   return (double)(b.u - a.u) * (c.v - a.v) - (double)(b.v - a.v) * (c.u - a.u);
+}
+
+inline bool sameNurbsTrimPoint(const NurbsTrimPoint &a, const NurbsTrimPoint &b)
+{
+   return (a.u == b.u) && (a.v == b.v);
+}
+
+// Whether the segments ab and cd cross, each strictly between the other's ends.
+inline bool crossNurbsTrimSegments(const NurbsTrimPoint &a, const NurbsTrimPoint &b, const NurbsTrimPoint &c,
+                                   const NurbsTrimPoint &d)
+{
+   double abc = orientNurbsTrim(a, b, c), abd = orientNurbsTrim(a, b, d);
+   double cda = orientNurbsTrim(c, d, a), cdb = orientNurbsTrim(c, d, b);
+   return ( ((abc > 0.0) && (abd < 0.0)) || ((abc < 0.0) && (abd > 0.0)) ) &&
+          ( ((cda > 0.0) && (cdb < 0.0)) || ((cda < 0.0) && (cdb > 0.0)) );
+}
+
+// Whether the point lies inside the polygon, by the parity of the polygon's crossings
+// of the ray to its right.
+inline bool insideNurbsTrimPolygon(const NurbsTrimPoint &point, const std::vector<NurbsTrimPoint> &polygon)
+{
+   bool inside = false;
+   for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+      if ( ((polygon[i].v > point.v) != (polygon[j].v > point.v)) &&
+           (point.u < polygon[j].u + (point.v - polygon[j].v) * (polygon[i].u - polygon[j].u) /
+                                     (polygon[i].v - polygon[j].v)) )
+         inside = !inside;
+   return inside;
+}
+
+// Position of a point on the boundary of the cell of the given corners, counter-clockwise
+// from the lower left corner, each side of length 1.
+inline float nurbsTrimPerimeter(const NurbsTrimPoint &point, const NurbsTrimPoint *corners)
+{
+   float u0 = corners[0].u, v0 = corners[0].v, u1 = corners[2].u, v1 = corners[2].v;
+   if (point.v == v0) return (point.u - u0) / (u1 - u0);
+   if (point.u == u1) return 1.0f + (point.v - v0) / (v1 - v0);
+   if (point.v == v1) return 2.0f + (u1 - point.u) / (u1 - u0);
+   return 3.0f + (v1 - point.v) / (v1 - v0);
+}
+
+// Join the hole, clockwise, into the polygon about it by a cut there and back from the
+// hole's vertex of greatest u to the nearest vertex of the polygon to which the cut
+// crosses no edge of the polygon or of the holes.
+inline void bridgeNurbsTrimHole(std::vector<NurbsTrimPoint> &polygon, const std::vector<NurbsTrimPoint> &hole,
+                                const std::vector< std::vector<NurbsTrimPoint> > &holes)
+{
+   int m = 0, numPoints = (int)polygon.size(), best = -1;
+   for (int k = 1; k < (int)hole.size(); k++)
+      if (hole[k].u > hole[m].u) m = k;
+   double bestDistance = 0.0;
+   for (int i = 0; i < numPoints; i++)
+   {
+      double du = polygon[i].u - hole[m].u, dv = polygon[i].v - hole[m].v, distance = du * du + dv * dv;
+      if ( (best >= 0) && (distance >= bestDistance) ) continue;
+      bool clear = true;
+      for (int j = 0; (j < numPoints) && clear; j++)
+         clear = !crossNurbsTrimSegments(hole[m], polygon[i], polygon[j], polygon[(j + 1) % numPoints]);
+      for (int k = 0; (k < (int)hole.size()) && clear; k++)
+         clear = !crossNurbsTrimSegments(hole[m], polygon[i], hole[k], hole[(k + 1) % hole.size()]);
+      for (int h = 0; (h < (int)holes.size()) && clear; h++)
+         for (int j = 0; (j < (int)holes[h].size()) && clear; j++)
+            clear = !crossNurbsTrimSegments(hole[m], polygon[i], holes[h][j], holes[h][(j + 1) % holes[h].size()]);
+      if (clear)
+      {
+         best = i;
+         bestDistance = distance;
+      }
+   }
+   if (best < 0) best = 0;
+
+   std::vector<NurbsTrimPoint> joined(polygon.begin(), polygon.begin() + best + 1);
+   for (int k = 0; k <= (int)hole.size(); k++) joined.push_back(hole[(m + k) % hole.size()]);
+   joined.insert(joined.end(), polygon.begin() + best, polygon.end());
+   polygon.swap(joined);
+}
+
+// Ear clip the polygon, counter-clockwise, appending its triangles to indices. An ear is
+// a convex corner whose triangle holds no other point of the polygon; failing one, as
+// left by a polygon down to a sliver, the most convex corner is cut off, and dropped if
+// its triangle has no area.
+inline void clipNurbsTrimPolygon(std::vector<NurbsTrimPoint> &polygon, std::vector<unsigned int> &indices)
+{
+   for (int i = (int)polygon.size() - 1; (i > 0) && (polygon.size() > 1); i--)
+      if (sameNurbsTrimPoint(polygon[i], polygon[(i + 1) % polygon.size()])) polygon.erase(polygon.begin() + i);
+
+   while (polygon.size() >= 3)
+   {
+      int n = (int)polygon.size(), ear = -1, best = 0;
+      double bestOrientation = 0.0;
+      for (int i = 0; (i < n) && (ear < 0); i++)
+      {
+         const NurbsTrimPoint &a = polygon[(i + n - 1) % n], &b = polygon[i], &c = polygon[(i + 1) % n];
+         double orientation = orientNurbsTrim(a, b, c);
+         if ( (i == 0) || (orientation > bestOrientation) )
+         {
+            best = i;
+            bestOrientation = orientation;
+         }
+         if (orientation <= 0.0) continue;
+         bool empty = true;
+         for (int k = 0; (k < n) && empty; k++)
+         {
+            const NurbsTrimPoint &point = polygon[k];
+            if (sameNurbsTrimPoint(point, a) || sameNurbsTrimPoint(point, b) || sameNurbsTrimPoint(point, c)) continue;
+            empty = (orientNurbsTrim(a, b, point) < 0.0) || (orientNurbsTrim(b, c, point) < 0.0) ||
+                    (orientNurbsTrim(c, a, point) < 0.0);
+         }
+         if (empty) ear = i;
+      }
+      if (ear < 0) ear = best;
+
+      const NurbsTrimPoint &a = polygon[(ear + n - 1) % n], &b = polygon[ear], &c = polygon[(ear + 1) % n];
+      if (orientNurbsTrim(a, b, c) > 0.0)
+      {
+         indices.push_back(a.index);
+         indices.push_back(b.index);
+         indices.push_back(c.index);
+      }
+      polygon.erase(polygon.begin() + ear);
+   }
+}
+
+// Triangulate the part within the trim of the grid cell of columns p, p + 1 and rows q,
+// q + 1, crossed by the loops of the given pieces, whose lower left corner lies within
+// the trim if cornerInside; appending the triangles to indices. Each run and the
+// boundary of the cell from its end counter-clockwise to the start of the next make up
+// the cell's polygons, as Weiler and Atherton clip, the cell whole if there are no runs
+// and its corner is inside. A loop within the cell adds an island if counter-clockwise,
+// or cuts a hole, joined into the polygon about it, if clockwise.
+inline void triangulateNurbsTrimCell(const NurbsSurface &surface, int p, int q, const NurbsTrimCell &cell,
+                                     bool cornerInside, std::vector<unsigned int> &indices)
+{
+   const std::vector<float> &us = surface.uParameters, &vs = surface.vParameters;
+   unsigned int lower = q * (unsigned int)us.size() + p, upper = lower + (unsigned int)us.size();
+   NurbsTrimPoint corners[4] = { { us[p], vs[q], lower }, { us[p+1], vs[q], lower + 1 },
+                                 { us[p+1], vs[q+1], upper + 1 }, { us[p], vs[q+1], upper } };
+   int numRuns = (int)cell.runs.size();
+   std::vector<float> entries(numRuns), exits(numRuns);
+   for (int r = 0; r < numRuns; r++)
+   {
+      entries[r] = nurbsTrimPerimeter(cell.runs[r].front(), corners);
+      exits[r] = nurbsTrimPerimeter(cell.runs[r].back(), corners);
+   }
+
+   std::vector< std::vector<NurbsTrimPoint> > polygons;
+   std::vector<bool> used(numRuns, false);
+   for (int first = 0; first < numRuns; first++)
+   {
+      if (used[first]) continue;
+      std::vector<NurbsTrimPoint> polygon;
+      for (int r = first; ; )
+      {
+         used[r] = true;
+         polygon.insert(polygon.end(), cell.runs[r].begin(), cell.runs[r].end());
+         int next = r;
+         float nearest = 5.0f;
+         for (int s = 0; s < numRuns; s++)
+         {
+            float distance = entries[s] - exits[r];
+            if (distance <= 0.0f) distance += 4.0f;
+            if (distance < nearest)
+            {
+               next = s;
+               nearest = distance;
+            }
+         }
+         for (int c = (int)exits[r] + 1; c < exits[r] + nearest; c++) polygon.push_back(corners[c % 4]);
+         if ( (next == first) || used[next] ) break;
+         r = next;
+      }
+      polygons.push_back(polygon);
+   }
+   if ( (numRuns == 0) && cornerInside ) polygons.push_back(std::vector<NurbsTrimPoint>(corners, corners + 4));
+
+   // Each whole loop counts by the winding about it of the polygons and the other loops:
+   // an island where it is 0, a hole where it is 1, in the least polygon about it.
+   int numPolygons = (int)polygons.size(), numLoops = (int)cell.loops.size();
+   std::vector<double> areas(numLoops, 0.0);
+   for (int l = 0; l < numLoops; l++)
+   {
+      const std::vector<NurbsTrimPoint> &loop = cell.loops[l];
+      for (int k = 1; k + 1 < (int)loop.size(); k++) areas[l] += orientNurbsTrim(loop[0], loop[k], loop[k+1]);
+   }
+   std::vector<int> holes;
+   for (int l = 0; l < numLoops; l++)
+   {
+      const NurbsTrimPoint &point = cell.loops[l][0];
+      int winding = 0;
+      for (int i = 0; i < numPolygons; i++) winding += insideNurbsTrimPolygon(point, polygons[i]) ? 1 : 0;
+      for (int m = 0; m < numLoops; m++)
+         if ( (m != l) && insideNurbsTrimPolygon(point, cell.loops[m]) ) winding += (areas[m] > 0.0) ? 1 : -1;
+      if ( (areas[l] > 0.0) && (winding <= 0) ) polygons.push_back(cell.loops[l]);
+      if ( (areas[l] < 0.0) && (winding == 1) ) holes.push_back(l);
+   }
+
+   std::vector< std::vector< std::vector<NurbsTrimPoint> > > polygonHoles(polygons.size());
+   std::vector<double> polygonAreas(polygons.size(), 0.0);
+   for (int i = 0; i < (int)polygons.size(); i++)
+      for (int k = 1; k + 1 < (int)polygons[i].size(); k++)
+         polygonAreas[i] += orientNurbsTrim(polygons[i][0], polygons[i][k], polygons[i][k+1]);
+   for (int h = 0; h < (int)holes.size(); h++)
+   {
+      const std::vector<NurbsTrimPoint> &hole = cell.loops[holes[h]];
+      int least = -1;
+      for (int i = 0; i < (int)polygons.size(); i++)
+         if ( insideNurbsTrimPolygon(hole[0], polygons[i]) && ((least < 0) || (polygonAreas[i] < polygonAreas[least])) )
+            least = i;
+      if (least >= 0) polygonHoles[least].push_back(hole);
+   }
+
+   for (int i = 0; i < (int)polygons.size(); i++)
+   {
+      // The holes, joined in from that of greatest u down.
+      std::vector< std::vector<NurbsTrimPoint> > &inside = polygonHoles[i];
+      std::vector<float> greatest(inside.size());
+      for (int h = 0; h < (int)inside.size(); h++)
+      {
+         greatest[h] = inside[h][0].u;
+         for (int k = 1; k < (int)inside[h].size(); k++) greatest[h] = std::max(greatest[h], inside[h][k].u);
+      }
+      while (!inside.empty())
+      {
+         int h = (int)(std::max_element(greatest.begin(), greatest.end()) - greatest.begin());
+         std::vector<NurbsTrimPoint> hole;
+         hole.swap(inside[h]);
+         inside.erase(inside.begin() + h);
+         greatest.erase(greatest.begin() + h);
+         bridgeNurbsTrimHole(polygons[i], hole, inside);
+      }
+      clipNurbsTrimPolygon(polygons[i], indices);
+   }
+}
+
+// Triangulate the domain of the surface as trimmed by its loops, in place of the grid's
+// triangles, adding the vertices of the trim, to be evaluated, with the whole grid, by
+// the next update, which loads the buffers anew. The mesh becomes the lines of the grid
+// about the cells kept whole, and the loops.
+//
+// The loops are first moved off the grid, by NURBS_TRIM_NUDGE of the least step of the
+// grid: points at the ends of the range outwards, all others along u and v, so that no
+// point lies on a grid line nor, save by chance, any edge through a grid corner. Each
+// loop is then walked from cell to cell, its edges split where they cross grid lines,
+// into runs across the cells and loops whole within one. A cell no loop crosses is kept
+// whole if its lower left corner is within the trim, about which the loops crossing the
+// grid line of its row to the right wind a positive number of times, counting a loop
+// crossing upwards 1 and downwards -1.
+inline void trimNurbsSurface(NurbsSurface &surface)
+{
+   const std::vector<float> &us = surface.uParameters, &vs = surface.vParameters;
+   int numColumns = (int)us.size(), numRows = (int)vs.size();
+   surface.trimParameters.clear();
+   surface.trimFirst.clear();
+   surface.trimBasis.clear();
+   surface.vertices.resize(numColumns * numRows);
+   surface.loaded = false;
+   if ( (numColumns < 2) || (numRows < 2) ) return;
+
+   float uNudge = us.back() - us[0], vNudge = vs.back() - vs[0];
+   for (int p = 1; p < numColumns; p++) uNudge = std::min(uNudge, us[p] - us[p-1]);
+   for (int q = 1; q < numRows; q++) vNudge = std::min(vNudge, vs[q] - vs[q-1]);
+   uNudge *= NURBS_TRIM_NUDGE;
+   vNudge *= NURBS_TRIM_NUDGE;
+   std::vector< std::vector<NurbsTrimPoint> > loops;
+   for (int l = 0; l < (int)surface.trimLoops.size(); l++)
+   {
+      const std::vector<float> &trimLoop = surface.trimLoops[l];
+      std::vector<NurbsTrimPoint> loop;
+      for (int k = 0; k + 1 < (int)trimLoop.size(); k += 2)
+      {
+         NurbsTrimPoint point = { nudgeNurbsTrim(trimLoop[k], us, uNudge), nudgeNurbsTrim(trimLoop[k+1], vs, vNudge), 0 };
+         loop.push_back(point);
+      }
+      if ( (loop.size() > 1) && sameNurbsTrimPoint(loop.front(), loop.back()) ) loop.pop_back();
+      if (loop.size() >= 3) loops.push_back(loop);
+   }
+
+   // Walk the loops through the cells. A crossing is given by its parameter along the
+   // edge and the grid line, k for the kth of u and -1 - k for the kth of v.
+   std::map<int, NurbsTrimCell> cells;
+   std::vector< std::pair<float, int> > crossings;
+   for (int l = 0; l < (int)loops.size(); l++)
+   {
+      std::vector<NurbsTrimPoint> &loop = loops[l];
+      int numPoints = (int)loop.size();
+      int p = (int)(std::upper_bound(us.begin(), us.end(), loop[0].u) - us.begin()) - 1;
+      int q = (int)(std::upper_bound(vs.begin(), vs.end(), loop[0].v) - vs.begin()) - 1;
+      int cell = nurbsTrimCell(p, q, numColumns, numRows);
+      if (cell >= 0) loop[0].index = addNurbsTrimVertex(surface, loop[0].u, loop[0].v);
+      std::vector<NurbsTrimPoint> run(1, loop[0]), firstRun;
+      bool crossed = false;
+
+      for (int e = 0; e < numPoints; e++)
+      {
+         const NurbsTrimPoint a = loop[e], b = loop[(e + 1) % numPoints];
+         crossings.clear();
+         int uFrom = (int)(std::upper_bound(us.begin(), us.end(), std::min(a.u, b.u)) - us.begin());
+         int uTo = (int)(std::upper_bound(us.begin(), us.end(), std::max(a.u, b.u)) - us.begin());
+         for (int k = uFrom; k < uTo; k++) crossings.push_back(std::make_pair((us[k] - a.u) / (b.u - a.u), k));
+         int vFrom = (int)(std::upper_bound(vs.begin(), vs.end(), std::min(a.v, b.v)) - vs.begin());
+         int vTo = (int)(std::upper_bound(vs.begin(), vs.end(), std::max(a.v, b.v)) - vs.begin());
+         for (int k = vFrom; k < vTo; k++) crossings.push_back(std::make_pair((vs[k] - a.v) / (b.v - a.v), -1 - k));
+         std::sort(crossings.begin(), crossings.end());
+
+         for (int c = 0; c < (int)crossings.size(); c++)
+         {
+            float t = crossings[c].first;
+            int k = crossings[c].second;
+            NurbsTrimPoint point;
+            if (k >= 0)
+            {
+               point.u = us[k];
+               point.v = a.v + t * (b.v - a.v);
+               if (q >= 0 && q < numRows - 1) point.v = std::min(std::max(point.v, vs[q]), vs[q+1]);
+               p = (b.u > a.u) ? k : k - 1;
+            }
+            else
+            {
+               k = -1 - k;
+               point.u = a.u + t * (b.u - a.u);
+               point.v = vs[k];
+               if (p >= 0 && p < numColumns - 1) point.u = std::min(std::max(point.u, us[p]), us[p+1]);
+               q = (b.v > a.v) ? k : k - 1;
+            }
+            int next = nurbsTrimCell(p, q, numColumns, numRows);
+            point.index = ( (cell >= 0) || (next >= 0) ) ? addNurbsTrimVertex(surface, point.u, point.v) : 0;
+            run.push_back(point);
+            if (!crossed) firstRun.swap(run);
+            else if (cell >= 0) cells[cell].runs.push_back(run);
+            crossed = true;
+            run.assign(1, point);
+            cell = next;
+         }
+         if (e + 1 < numPoints)
+         {
+            if (cell >= 0) loop[e+1].index = addNurbsTrimVertex(surface, b.u, b.v);
+            run.push_back(loop[e+1]);
+         }
+      }
+      if (cell < 0) continue;
+      if (crossed)
+      {
+         run.insert(run.end(), firstRun.begin(), firstRun.end());
+         cells[cell].runs.push_back(run);
+      }
+      else cells[cell].loops.push_back(run);
+   }
+
+   // Triangulate the cells row by row, with the windings about the corners of the row.
+   std::vector<unsigned int> &indices = surface.indices;
+   std::vector<char> whole((numColumns - 1) * (numRows - 1), 0);
+   indices.clear();
+   for (int q = 0; q < numRows - 1; q++)
+   {
+      crossings.clear();
+      int winding = 0;
+      for (int l = 0; l < (int)loops.size(); l++)
+         for (int e = 0; e < (int)loops[l].size(); e++)
+         {
+            const NurbsTrimPoint &a = loops[l][e], &b = loops[l][(e + 1) % loops[l].size()];
+            if ( (a.v < vs[q]) == (b.v < vs[q]) ) continue;
+            crossings.push_back(std::make_pair(a.u + (vs[q] - a.v) / (b.v - a.v) * (b.u - a.u), (b.v > a.v) ? 1 : -1));
+            winding += crossings.back().second;
+         }
+      std::sort(crossings.begin(), crossings.end());
+
+      for (int p = 0, c = 0; p < numColumns - 1; p++)
+      {
+         for ( ; (c < (int)crossings.size()) && (crossings[c].first < us[p]); c++) winding -= crossings[c].second;
+         int cell = q * (numColumns - 1) + p;
+         std::map<int, NurbsTrimCell>::const_iterator trimmed = cells.find(cell);
+         if (trimmed != cells.end()) triangulateNurbsTrimCell(surface, p, q, trimmed->second, winding > 0, indices);
+         else if (winding > 0)
+         {
+            unsigned int lower = q * numColumns + p, upper = lower + numColumns;
+            indices.push_back(lower); indices.push_back(lower + 1); indices.push_back(upper + 1);
+            indices.push_back(lower); indices.push_back(upper + 1); indices.push_back(upper);
+            whole[cell] = 1;
+         }
+      }
+   }
+   surface.numTriangleIndices = (int)indices.size();
+
+   // The lines of the grid about the cells kept whole, each once, and the loops.
+   for (int q = 0; q < numRows - 1; q++)
+      for (int p = 0; p < numColumns - 1; p++)
+      {
+         int cell = q * (numColumns - 1) + p;
+         if (!whole[cell]) continue;
+         unsigned int lower = q * numColumns + p, upper = lower + numColumns;
+         indices.push_back(lower); indices.push_back(lower + 1);
+         indices.push_back(lower); indices.push_back(upper);
+         if ( (q == numRows - 2) || !whole[cell + numColumns - 1] )
+         {
+            indices.push_back(upper); indices.push_back(upper + 1);
+         }
+         if ( (p == numColumns - 2) || !whole[cell + 1] )
+         {
+            indices.push_back(lower + 1); indices.push_back(upper + 1);
+         }
+      }
+   for (std::map<int, NurbsTrimCell>::const_iterator trimmed = cells.begin(); trimmed != cells.end(); trimmed++)
+   {
+      const NurbsTrimCell &cell = trimmed->second;
+      for (int r = 0; r < (int)cell.runs.size(); r++)
+         for (int k = 0; k + 1 < (int)cell.runs[r].size(); k++)
+         {
+            indices.push_back(cell.runs[r][k].index);
+            indices.push_back(cell.runs[r][k+1].index);
+         }
+      for (int l = 0; l < (int)cell.loops.size(); l++)
+         for (int k = 0; k < (int)cell.loops[l].size(); k++)
+         {
+            indices.push_back(cell.loops[l][k].index);
+            indices.push_back(cell.loops[l][(k + 1) % cell.loops[l].size()].index);
+         }
+   }
+   surface.numMeshIndices = (int)indices.size() - surface.numTriangleIndices;
+
+   editNurbsSurface(surface);
+}
+
+// Store in the vertex the point of the surface and its unit normal, from the sums of
+// the control points weighted by the B-splines and by their derivatives in u and v.
+inline void storeNurbsVertex(int dimension, float *position, float *du, float *dv, NurbsVertex &vertex)
+{
+   if (dimension == 4)
+      for (int c = 0; c < 3; c++)
+      {
+         position[c] /= position[3];
+         du[c] -= du[3] * position[c];
+         dv[c] -= dv[3] * position[c];
+      }
+
+   float normal[3] = { du[1]*dv[2] - du[2]*dv[1], du[2]*dv[0] - du[0]*dv[2], du[0]*dv[1] - du[1]*dv[0] };
+   float length = std::sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+   if (length > 0.0f) length = 1.0f / length;
+   for (int c = 0; c < 3; c++)
+   {
+      vertex.coords[c] = position[c];
+      vertex.normal[c] = normal[c] * length;
+   }
+}
+
+// Evaluate the vertices of columns firstColumn to lastColumn - 1 of rows firstRow to
+// lastRow - 1. Each row first sums the control points of each column of control points
+// the columns need, weighted by the B-splines in v, into a point of the curve in u of
+// the row, and its derivative in v; the vertices then weight these by the B-splines in
+// u. A rational surface is evaluated in homogeneous co-ordinates and then divided
+// through, its derivatives (P_u - w_u * P/w) / w, whose cross product is along the normal.
+inline void evaluateNurbsRows(NurbsSurface *surface, int firstColumn, int lastColumn, int firstRow, int lastRow)
+{
+   const NurbsSurface &s = *surface;
+   int uOrder = s.uOrder, vOrder = s.vOrder, dimension = s.dimension;
+   int numColumns = (int)s.uParameters.size();
+   int firstPoint = s.uFirst[firstColumn], numPoints = s.uFirst[lastColumn - 1] + uOrder - firstPoint;
+   float uStart = s.uParameters[0], uLength = s.uParameters[numColumns - 1] - uStart;
+   float vStart = s.vParameters[0], vLength = s.vParameters.back() - vStart;
+   std::vector<float> curve(2 * dimension * numPoints); // Points of the row's curve, then their v derivatives.
+
+   for (int q = firstRow; q < lastRow; q++)
+   {
+      const float *vBasis = &s.vBasis[2 * vOrder * q];
+      float *point = &curve[0], *vDerivative = &curve[dimension * numPoints];
+      for (int i = firstPoint; i < firstPoint + numPoints; i++, point += dimension, vDerivative += dimension)
+      {
+         for (int c = 0; c < dimension; c++) point[c] = vDerivative[c] = 0.0f;
+         const float *controlPoint = s.controlPoints + i * s.uStride + s.vFirst[q] * s.vStride;
+         for (int j = 0; j < vOrder; j++, controlPoint += s.vStride)
+            for (int c = 0; c < dimension; c++)
+            {
+               point[c] += vBasis[j] * controlPoint[c];
+               vDerivative[c] += vBasis[vOrder + j] * controlPoint[c];
+            }
+      }
+
+      NurbsVertex *vertex = &surface->vertices[q * numColumns + firstColumn];
+      for (int p = firstColumn; p < lastColumn; p++, vertex++)
+      {
+         const float *uBasis = &s.uBasis[2 * uOrder * p];
+         const float *points = &curve[dimension * (s.uFirst[p] - firstPoint)];
+         const float *vDerivatives = points + dimension * numPoints;
+         float position[4] = { 0.0f }, du[4] = { 0.0f }, dv[4] = { 0.0f };
+         for (int i = 0; i < uOrder; i++)
+            for (int c = 0; c < dimension; c++)
+            {
+               position[c] += uBasis[i] * points[i * dimension + c];
+               du[c] += uBasis[uOrder + i] * points[i * dimension + c];
+               dv[c] += uBasis[i] * vDerivatives[i * dimension + c];
+            }
+         storeNurbsVertex(dimension, position, du, dv, *vertex);
+         vertex->texCoords[0] = (s.uParameters[p] - uStart) / uLength;
+         vertex->texCoords[1] = (s.vParameters[q] - vStart) / vLength;
+      }
+   }
+}
+
+// Evaluate vertex k of the trim, the sums of the control points weighted by the
+// products of its B-splines in u and v.
+inline void evaluateNurbsTrimVertex(NurbsSurface &surface, int k)
+{
+   const NurbsSurface &s = surface;
+   int uOrder = s.uOrder, vOrder = s.vOrder, dimension = s.dimension;
+   const float *uBasis = &s.trimBasis[2 * (uOrder + vOrder) * k], *vBasis = uBasis + 2 * uOrder;
+   float position[4] = { 0.0f }, du[4] = { 0.0f }, dv[4] = { 0.0f };
+   for (int i = 0; i < uOrder; i++)
+   {
+      const float *controlPoint = s.controlPoints + (s.trimFirst[2*k] + i) * s.uStride + s.trimFirst[2*k + 1] * s.vStride;
+      for (int j = 0; j < vOrder; j++, controlPoint += s.vStride)
+      {
+         float weight = uBasis[i] * vBasis[j], uWeight = uBasis[uOrder + i] * vBasis[j];
+         float vWeight = uBasis[i] * vBasis[vOrder + j];
+         for (int c = 0; c < dimension; c++)
+         {
+            position[c] += weight * controlPoint[c];
+            du[c] += uWeight * controlPoint[c];
+            dv[c] += vWeight * controlPoint[c];
+         }
+      }
+   }
+
+   NurbsVertex &vertex = surface.vertices[s.uParameters.size() * s.vParameters.size() + k];
+   storeNurbsVertex(dimension, position, du, dv, vertex);
+   vertex.texCoords[0] = (s.trimParameters[2*k] - s.uParameters[0]) / (s.uParameters.back() - s.uParameters[0]);
+   vertex.texCoords[1] = (s.trimParameters[2*k + 1] - s.vParameters[0]) / (s.vParameters.back() - s.vParameters[0]);
+}
+
+// Number of threads to evaluate the given number of vertices.
+inline int nurbsThreads(int numVertices)
+{
+   static int hardwareThreads = std::max(1, (int)std::thread::hardware_concurrency());
+   return std::max(1, std::min(hardwareThreads, numVertices / NURBS_THREAD_VERTICES));
+}
+
+// Evaluate the changed rectangle of the grid, a large one split into bands of rows
+// evaluated by concurrent threads, and the vertices of the trim within its parameters.
+inline void evaluateNurbsSurface(NurbsSurface &surface)
+{
+   int firstColumn = surface.firstColumn, lastColumn = surface.lastColumn;
+   int firstRow = surface.firstRow, numRows = surface.lastRow - firstRow;
+   surface.firstTrimVertex = surface.lastTrimVertex = 0;
+   if ( (firstColumn >= lastColumn) || (numRows <= 0) ) return;
+   int numThreads = std::min(nurbsThreads((lastColumn - firstColumn) * numRows), numRows);
+
+   std::vector<std::thread> threads;
+   for (int t = 1; t < numThreads; t++)
+      threads.push_back(std::thread(evaluateNurbsRows, &surface, firstColumn, lastColumn,
+                                    firstRow + t * numRows / numThreads, firstRow + (t + 1) * numRows / numThreads));
+   evaluateNurbsRows(&surface, firstColumn, lastColumn, firstRow, firstRow + numRows / numThreads);
+
+   float uLow = surface.uParameters[firstColumn], uHigh = surface.uParameters[lastColumn - 1];
+   float vLow = surface.vParameters[firstRow], vHigh = surface.vParameters[surface.lastRow - 1];
+   int numTrimVertices = (int)surface.trimParameters.size() / 2;
+   for (int k = 0; k < numTrimVertices; k++)
+   {
+      float u = surface.trimParameters[2*k], v = surface.trimParameters[2*k + 1];
+      if ( (u < uLow) || (u > uHigh) || (v < vLow) || (v > vHigh) ) continue;
+      evaluateNurbsTrimVertex(surface, k);
+      if (surface.firstTrimVertex == surface.lastTrimVertex) surface.firstTrimVertex = k;
+      surface.lastTrimVertex = k + 1;
+   }
+   for (int t = 0; t < (int)threads.size(); t++) threads[t].join();
+}
+
+// Evaluate the changed rectangle of the grid and copy it into the vertex buffer, row by
+// row unless it spans whole rows, and the trim's vertices evaluated with it in one
+// piece; first creating the buffers and loading all the vertices and the indices, as
+// again after the surface is trimmed. Nothing is done if nothing has changed.
+inline void updateNurbsSurface(NurbsSurface &surface)
+{
+   if ( (surface.firstColumn >= surface.lastColumn) || (surface.firstRow >= surface.lastRow) ) return;
+   evaluateNurbsSurface(surface);
+
+   int numColumns = (int)surface.uParameters.size(), numGridVertices = numColumns * (int)surface.vParameters.size();
+   if (!surface.loaded)
+   {
+      if (!surface.buffers[0]) glGenBuffers(2, surface.buffers);
+      glBindBuffer(GL_ARRAY_BUFFER, surface.buffers[0]);
+      glBufferData(GL_ARRAY_BUFFER, surface.vertices.size() * sizeof(NurbsVertex), &surface.vertices[0],
+                   GL_DYNAMIC_DRAW);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface.buffers[1]);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, surface.indices.size() * sizeof(unsigned int), &surface.indices[0],
+                   GL_STATIC_DRAW);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+      surface.loaded = true;
+   }
+   else
+   {
+      glBindBuffer(GL_ARRAY_BUFFER, surface.buffers[0]);
+      if ( (surface.firstColumn == 0) && (surface.lastColumn == numColumns) )
+         glBufferSubData(GL_ARRAY_BUFFER, surface.firstRow * numColumns * sizeof(NurbsVertex),
+                         (surface.lastRow - surface.firstRow) * numColumns * sizeof(NurbsVertex),
+                         &surface.vertices[surface.firstRow * numColumns]);
+      else
+         for (int q = surface.firstRow; q < surface.lastRow; q++)
+            glBufferSubData(GL_ARRAY_BUFFER, (q * numColumns + surface.firstColumn) * sizeof(NurbsVertex),
+                            (surface.lastColumn - surface.firstColumn) * sizeof(NurbsVertex),
+                            &surface.vertices[q * numColumns + surface.firstColumn]);
+      if (surface.firstTrimVertex < surface.lastTrimVertex)
+         glBufferSubData(GL_ARRAY_BUFFER, (numGridVertices + surface.firstTrimVertex) * sizeof(NurbsVertex),
+                         (surface.lastTrimVertex - surface.firstTrimVertex) * sizeof(NurbsVertex),
+                         &surface.vertices[numGridVertices + surface.firstTrimVertex]);
+   }
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+   surface.firstColumn = surface.lastColumn = 0;
+}
+
+// Draw the surface from its buffers in the display mode, NURBS_FILL, NURBS_OUTLINE_POLYGON
+// or NURBS_MESH; only filled triangles send their normals and texture co-ordinates.
+inline void drawNurbsSurface(const NurbsSurface &surface, int mode)
+{
+   glBindBuffer(GL_ARRAY_BUFFER, surface.buffers[0]);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface.buffers[1]);
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glVertexPointer(3, GL_FLOAT, sizeof(NurbsVertex), (void *)offsetof(NurbsVertex, coords));
+   if (mode == NURBS_FILL)
+   {
+      glEnableClientState(GL_NORMAL_ARRAY);
+      glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+      glNormalPointer(GL_FLOAT, sizeof(NurbsVertex), (void *)offsetof(NurbsVertex, normal));
+      glTexCoordPointer(2, GL_FLOAT, sizeof(NurbsVertex), (void *)offsetof(NurbsVertex, texCoords));
+   }
+
+   if (mode == NURBS_MESH)
+      glDrawElements(GL_LINES, surface.numMeshIndices, GL_UNSIGNED_INT,
+                     (void *)(surface.numTriangleIndices * sizeof(unsigned int)));
+   else
+   {
+      if (mode == NURBS_OUTLINE_POLYGON) glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+      glDrawElements(GL_TRIANGLES, surface.numTriangleIndices, GL_UNSIGNED_INT, 0);
+      if (mode == NURBS_OUTLINE_POLYGON) glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+   }
+
+   glDisableClientState(GL_VERTEX_ARRAY);
+   glDisableClientState(GL_NORMAL_ARRAY);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+#endif
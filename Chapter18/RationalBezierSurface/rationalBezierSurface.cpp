@@ -12,6 +12,8 @@
 // Press < and > to decrease/increase the weight of the control point.
 // Press the x, X, y, Y, z, Z keys to rotate the viewpoint.
 // Press delete to reset control points.
+//
+// COMPILE NOTE: Files bSplineBasis.h and nurbsSurface.h must be in the same folder.
 // 
 // Sumanta Guha.
 //////////////////////////////////////////////////////////////////////////////////////////////// 
@@ -30,6 +32,8 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "nurbsSurface.h"
+
 using namespace std;
 
 // Begin globals.
@@ -53,6 +57,12 @@ float weights[6][4];
 // Control points in homogeneous co-ordinates.
 float controlPointsHomogeneous[6][4][4];
 
+// Knot vectors of the Bezier surface as a B-spline surface, of order 4 along the
+// u-parameter and 6 along the v-parameter, and its tessellation.
+static float uknots[8] = {0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0};
+static float vknots[12] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+static NurbsSurface surface;
+
 static float Xangle = 30.0, Yangle = 0.0, Zangle = 0.0; // Angles to rotate canoe.
 static int rowCount = 0, columnCount = 0; // Indexes of selected control point.
 static char theStringBuffer[10]; // String buffer.
@@ -128,6 +138,9 @@ void setup(void)
 	        originalControlPoints[i][j][k] = controlPoints[i][j][k];
 
    computeControlPointsHomeogeneous();
+
+   // Make the surface of the homogeneous control points on a 20 x 20 grid.
+   makeNurbsSurface(surface, 8, uknots, 12, vknots, 4, 16, controlPointsHomogeneous[0][0], 4, 6, 4, 20);
 }
 
 // Drawing routine.
@@ -167,14 +180,10 @@ void drawScene(void)
       glVertex3fv(controlPoints[rowCount][columnCount]);
    glEnd();
 
-   // Specify and enable the Bezier surface.
-   glMap2f(GL_MAP2_VERTEX_4, 0, 1, 4, 4, 0, 1, 16, 6, controlPointsHomogeneous[0][0]); 
-   glEnable(GL_MAP2_VERTEX_4);
-
    // Make a mesh approximation of the Bezier surface.
    glColor3f(0.0, 0.0, 0.0);
-   glMapGrid2f(20, 0.0, 1.0, 20, 0.0, 1.0);
-   glEvalMesh2(GL_LINE, 0, 20, 0, 20);
+   updateNurbsSurface(surface);
+   drawNurbsSurface(surface, NURBS_MESH);
 
    // Draw the co-ordinate axes.
    glLineWidth(2.0);
@@ -289,16 +298,19 @@ void keyInput(unsigned char key, int x, int y)
          break;
       case 127:	
 	     restoreControlPoints();
+	     editNurbsSurface(surface);
 	     glutPostRedisplay();
          break;
 	  case '<':
 		 if ( weights[rowCount][columnCount] > 0.02 ) weights[rowCount][columnCount] -= 0.01f;
 		 computeControlPointsHomeogeneous();
+		 editNurbsControlPoint(surface, columnCount, rowCount);
 	     glutPostRedisplay();
          break;
 	  case '>':
 		 weights[rowCount][columnCount] += 0.01f;
 		 computeControlPointsHomeogeneous();
+		 editNurbsControlPoint(surface, columnCount, rowCount);
 	     glutPostRedisplay();
          break;
       default:
@@ -316,6 +328,7 @@ void specialKeyInput(int key, int x, int y)
    if (key == GLUT_KEY_PAGE_DOWN) controlPoints[rowCount][columnCount][2] -= 0.1;
    if (key == GLUT_KEY_PAGE_UP) controlPoints[rowCount][columnCount][2] += 0.1;
    computeControlPointsHomeogeneous();
+   editNurbsControlPoint(surface, columnCount, rowCount);
    
    glutPostRedisplay();
 }
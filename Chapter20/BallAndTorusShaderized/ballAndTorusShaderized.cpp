@@ -7,6 +7,8 @@
 // Press space to toggle between animation on and off.
 // Press the up/down arrow keys to speed up/slow down animation.
 // Press the x, X, y, Y, z, Z keys to rotate the scene.
+// Press the page up/down keys to increase/decrease the torus tessellation.
+// Press l to cycle the torus index layout between strips, restart and triangles.
 //
 // Sumanta Guha
 //////////////////////////////////////////////////////////////// 
@@ -54,11 +56,11 @@ static int hemCounts[HEM_LATS];
 static void* hemOffsets[HEM_LATS]; 
 static vec4 hemColors = vec4(HEM_COLORS); 
 
-// Torus data.
-static Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)]; 
-static unsigned int torIndices[TOR_LATS][2*(TOR_LONGS+1)]; 
-static int torCounts[TOR_LATS];
-static void* torOffsets[TOR_LATS]; 
+// Torus data, with tessellation chosen at run time.
+static GridMesh<Vertex> torus;
+static int torSlices = TOR_LONGS; // Number of longitudinal and of latitudinal slices.
+static int torLayout = MESH_STRIPS; // Index layout.
+static const char *torLayoutNames[] = {"strips", "restart", "triangles"};
 static vec4 torColors = vec4(TOR_COLORS);
 
 static mat4 modelViewMat = mat4(1.0);
@@ -66,8 +68,6 @@ static mat4 projMat = mat4(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    objectLoc,
@@ -82,18 +82,17 @@ void setup(void)
    glClearColor(1.0, 1.0, 1.0, 0.0); 
    glEnable(GL_DEPTH_TEST);
 
+   // The restart index never occurs in the strips and triangles layouts, so it is
+   // safe to leave primitive restart on for every draw.
+   glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId);    
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId); 
 
    // Initialize hemishpere and torus.
    fillHemisphere(hemVertices, hemIndices, hemCounts, hemOffsets);
-   fillTorus(torVertices, torIndices, torCounts, torOffsets);
+   buildTorus(torus, torSlices, torSlices, torLayout);
 
    // Create VAOs and VBOs... 
    glGenVertexArrays(2, vao);
@@ -111,10 +110,10 @@ void setup(void)
    // ...and associate data with vertex shader.
    glBindVertexArray(vao[TORUS]);
    glBindBuffer(GL_ARRAY_BUFFER, buffer[TOR_VERTICES]);
-   glBufferData(GL_ARRAY_BUFFER, sizeof(torVertices), torVertices, GL_STATIC_DRAW);
+   glBufferData(GL_ARRAY_BUFFER, torus.vertices.size() * sizeof(Vertex), &torus.vertices[0], GL_STATIC_DRAW);
    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer[TOR_INDICES]);
-   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(torIndices), torIndices, GL_STATIC_DRAW);
-   glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(torVertices[0]), 0);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, torus.indices.size() * sizeof(unsigned int), &torus.indices[0], GL_STATIC_DRAW);
+   glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
    glEnableVertexAttribArray(1);
 
    // Obtain projection matrix uniform location and set value.
@@ -151,7 +150,12 @@ void drawScene(void)
    // Draw torus.
    glUniform1ui(objectLoc, TORUS); // Update object name.
    glBindVertexArray(vao[TORUS]);
-   glMultiDrawElements(GL_TRIANGLE_STRIP, torCounts, GL_UNSIGNED_INT, (const void **)torOffsets, TOR_LATS);
+   if (torLayout == MESH_STRIPS)
+      glMultiDrawElements(GL_TRIANGLE_STRIP, &torus.counts[0], GL_UNSIGNED_INT, (const void **)&torus.offsets[0], torus.lats);
+   else if (torLayout == MESH_RESTART)
+      glDrawElements(GL_TRIANGLE_STRIP, torus.indices.size(), GL_UNSIGNED_INT, 0);
+   else
+      glDrawElements(GL_TRIANGLES, torus.indices.size(), GL_UNSIGNED_INT, 0);
 
    // Calculate and update modelview matrix.
    modelViewMat = rotate(modelViewMat, longAngle, vec3(0.0, 0.0, 1.0));
@@ -193,6 +197,18 @@ void animate(int value)
    }
 }
 
+// Rebuild the torus with the current tessellation and layout and reload its buffers.
+void retessellateTorus(void)
+{
+   buildTorus(torus, torSlices, torSlices, torLayout);
+   cout << "Torus: " << torSlices << " x " << torSlices << " slices, " 
+        << torLayoutNames[torLayout] << " layout, " << torus.indices.size() << " indices." << endl;
+   glBindVertexArray(vao[TORUS]);
+   glBindBuffer(GL_ARRAY_BUFFER, buffer[TOR_VERTICES]);
+   glBufferData(GL_ARRAY_BUFFER, torus.vertices.size() * sizeof(Vertex), &torus.vertices[0], GL_STATIC_DRAW);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, torus.indices.size() * sizeof(unsigned int), &torus.indices[0], GL_STATIC_DRAW);
+}
+
 // Keyboard input processing routine.
 void keyInput(unsigned char key, int x, int y)
 {
@@ -239,6 +255,11 @@ void keyInput(unsigned char key, int x, int y)
 		 if (Zangle < 0.0) Zangle += 360.0;
          glutPostRedisplay();
          break;
+      case 'l':
+         torLayout = (torLayout + 1) % 3;
+         retessellateTorus();
+         glutPostRedisplay();
+         break;
       default:
          break;
    }
@@ -249,6 +270,16 @@ void specialKeyInput(int key, int x, int y)
 {
    if (key == GLUT_KEY_DOWN) animationPeriod += 5;
    if( key == GLUT_KEY_UP) if (animationPeriod > 5) animationPeriod -= 5;
+   if (key == GLUT_KEY_PAGE_UP && torSlices * 2 <= 2048) 
+   {
+      torSlices *= 2;
+      retessellateTorus();
+   }
+   if (key == GLUT_KEY_PAGE_DOWN && torSlices > 5) 
+   {
+      torSlices /= 2;
+      retessellateTorus();
+   }
    glutPostRedisplay();
 }
 
@@ -258,7 +289,9 @@ void printInteraction(void)
    cout << "Interaction:" << endl;
    cout << "Press space to toggle between animation on and off." << endl
 	    << "Press the up/down arrow keys to speed up/slow down animation." << endl
-        << "Press the x, X, y, Y, z, Z keys to rotate the scene." << endl;
+        << "Press the x, X, y, Y, z, Z keys to rotate the scene." << endl
+        << "Press the page up/down keys to increase/decrease the torus tessellation." << endl
+        << "Press l to cycle the torus index layout between strips, restart and triangles." << endl;
 }
 
 // Main routine.
@@ -16,49 +16,49 @@
 
 using namespace std;
 
+// Sample point (i, j) of the torus is at longitudinal angle (-1 + 2i/longs)PI about
+// the z-axis and latitudinal angle (-1 + 2j/lats)PI around the tube.
+struct TorusSampler
+{
+   AngleTable longAngles, latAngles;
+
+   TorusSampler(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats),
+                                       longs(longs), lats(lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      float r = TOR_OUTRAD + TOR_INRAD * latAngles.cosines[j];
+      vertex.coords.x = r * longAngles.cosines[i];
+      vertex.coords.y = r * longAngles.sines[i];
+      vertex.coords.z = TOR_INRAD * latAngles.sines[j];
+      vertex.coords.w = 1.0;
+   }
+
+   int longs, lats;
+};
+
 // Fill the vertex array with co-ordinates of the sample points.
 void fillTorVertexArray(Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)])
 {
-   int i, j, k;
-
-   k = 0;
-   for (j = 0; j <= TOR_LATS; j++)
-      for (i = 0; i <= TOR_LONGS; i++)
-      {
-         torVertices[k].coords.x = ( TOR_OUTRAD + TOR_INRAD * cos( (-1 + 2*(float)j/TOR_LATS) * PI ) ) * cos( (-1 + 2*(float)i/TOR_LONGS) * PI );
-         torVertices[k].coords.y = ( TOR_OUTRAD + TOR_INRAD * cos( (-1 + 2*(float)j/TOR_LATS) * PI ) ) * sin( (-1 + 2*(float)i/TOR_LONGS) * PI );
-         torVertices[k].coords.z = TOR_INRAD * sin( (-1 + 2*(float)j/TOR_LATS) * PI );
-		 torVertices[k].coords.w = 1.0;
-		 k++;
-	  }
+   fillGridVertices(torVertices, TOR_LONGS, TOR_LATS, TorusSampler(TOR_LONGS, TOR_LATS));
 }
 
 // Fill the array of index arrays.
 void fillTorIndices(unsigned int torIndices[TOR_LATS][2*(TOR_LONGS+1)])
 {
-   int i, j;
-   for(j = 0; j < TOR_LATS; j++)
-   {
-      for (i = 0; i <= TOR_LONGS; i++)
-      {
-	     torIndices[j][2*i] = (j+1)*(TOR_LONGS + 1) + i;
-	     torIndices[j][2*i+1] = j*(TOR_LONGS + 1) + i;
-      }
-   }
+   fillGridIndices(&torIndices[0][0], TOR_LONGS, TOR_LATS);
 }
 
 // Fill the array of counts.
 void fillTorCounts(int torCounts[TOR_LATS])
 {
-   int j;
-   for(j = 0; j < TOR_LATS; j++) torCounts[j] = 2*(TOR_LONGS + 1);
+   fillGridCounts(torCounts, TOR_LONGS, TOR_LATS);
 }
 
 // Fill the array of buffer offsets.
 void fillTorOffsets(void* torOffsets[TOR_LATS])
 {
-   int j;
-   for(j = 0; j < TOR_LATS; j++) torOffsets[j] = (GLvoid*)(2*(TOR_LONGS+1)*j*sizeof(unsigned int));
+   fillGridOffsets(torOffsets, TOR_LONGS, TOR_LATS);
 }
 
 // Initialize the torus.
@@ -71,4 +71,11 @@ void fillTorus(Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)],
    fillTorIndices(torIndices);
    fillTorCounts(torCounts);
    fillTorOffsets(torOffsets);
-}
\ No newline at end of file
+}
+
+// Build the torus with the given numbers of longitudinal and latitudinal slices and
+// index layout (see meshBuilder.h).
+void buildTorus(GridMesh<Vertex> &mesh, int longs, int lats, int layout)
+{
+   buildGridMesh(mesh, longs, lats, TorusSampler(longs, lats), layout);
+}
@@ -80,8 +80,6 @@ static mat3 normalMat = mat3(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    normalMatLoc,
@@ -98,12 +96,7 @@ void setup(void)
    glEnable(GL_DEPTH_TEST);
 
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId); 
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId);  
 
    // Initialize plane.
@@ -13,6 +13,7 @@
 ///////////////////////////////////////////////////////////////////////////////// 
 
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 
@@ -34,6 +35,7 @@
 
 #include "shader.h"
 #include "getbmp.h"
+#include "mipmap.h"
 #include "vertex.h"
 
 using namespace std;
@@ -64,8 +66,6 @@ static mat4 projMat = mat4(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    grassTexLoc,
@@ -86,12 +86,7 @@ void setup(void)
    glEnable(GL_DEPTH_TEST);
 
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId); 
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId); 
 
    // Create VAOs and VBOs... 
@@ -128,6 +123,7 @@ void setup(void)
    // Load the images.
    image[0] = getbmp("../../Textures/grass.bmp"); 
    image[1] = getbmp("../../Textures/sky.bmp"); 
+   if (image[0] == NULL || image[1] == NULL) exit(1); // getbmp() has printed why.
 
    // Create texture ids.
    glGenTextures(2, texture);
@@ -135,13 +131,12 @@ void setup(void)
    // Bind grass image.
    glActiveTexture(GL_TEXTURE0);
    glBindTexture(GL_TEXTURE_2D, texture[0]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   // Mipmap levels are built on the CPU with a gamma-correct Kaiser filter.
+   texImageMipmaps(image[0]->data, image[0]->sizeX, image[0]->sizeY, MIP_KAISER, true);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-   glGenerateMipmap(GL_TEXTURE_2D);
    grassTexLoc = glGetUniformLocation(programId, "grassTex");
    glUniform1i(grassTexLoc, 0);
 
@@ -156,6 +151,13 @@ void setup(void)
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
    skyTexLoc = glGetUniformLocation(programId, "skyTex");
    glUniform1i(skyTexLoc, 1);
+
+   // OpenGL has its own copy of the images now.
+   for (int i = 0; i < 2; i++)
+   {
+      delete[] image[i]->data;
+      delete image[i];
+   }
 }
 
 // Drawing routine.
@@ -0,0 +1,15 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#define MIP_BOX 0 // 2x2 box filter.
+#define MIP_KAISER 1 // 8-tap Kaiser-windowed sinc filter.
+#define MIP_LANCZOS 2 // 8-tap Lanczos (a = 2) filter.
+#define MIP_THREADS 4 // Number of threads sharing the rows of a large level.
+
+int numMipmapLevels(int sizeX, int sizeY);
+void nextMipmapSize(int sizeX, int sizeY, int *nextSizeX, int *nextSizeY);
+void buildMipmapLevel(const unsigned char *in, int inX, int inY, unsigned char *out,
+                      int filter, bool sRGB);
+void texImageMipmaps(const unsigned char *image, int sizeX, int sizeY, int filter, bool sRGB);
+
+#endif
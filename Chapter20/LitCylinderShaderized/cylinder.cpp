@@ -16,53 +16,53 @@
 
 using namespace std;
 
+// Sample point (i, j) of the cylinder is at angle (-1 + 2i/longs)PI about the z-axis
+// and height -1 + 2j/lats.
+struct CylinderSampler
+{
+   AngleTable longAngles;
+
+   CylinderSampler(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), longs(longs), lats(lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      vertex.coords.x = longAngles.cosines[i];
+      vertex.coords.y = longAngles.sines[i];
+      vertex.coords.z = -1 + 2*(float)j/lats;
+      vertex.coords.w = 1.0;
+      vertex.normal.x = longAngles.cosines[i];
+      vertex.normal.y = longAngles.sines[i];
+      vertex.normal.z = 0.0;
+   }
+
+   int longs, lats;
+};
+
 // Fill the vertex array with co-ordinates of the sample points.
 void fillCylVertexArray(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)])
 {
-   int i, j, k;
-
-   k = 0;
-   for (j = 0; j <= CYL_LATS; j++)
-      for (i = 0; i <= CYL_LONGS; i++)
-      {
-         cylVertices[k].coords.x = cos( (-1 + 2*(float)i/CYL_LONGS) * PI );
-         cylVertices[k].coords.y = sin( (-1 + 2*(float)i/CYL_LONGS) * PI );
-         cylVertices[k].coords.z = -1 + 2*(float)j/CYL_LATS;
-		 cylVertices[k].coords.w = 1.0;
-		 cylVertices[k].normal.x = cos( (-1 + 2*(float)i/CYL_LONGS) * PI );
-         cylVertices[k].normal.y = sin( (-1 + 2*(float)i/CYL_LONGS) * PI );
-		 cylVertices[k].normal.z = 0.0;
-		 k++;
-	  }
+   fillGridVertices(cylVertices, CYL_LONGS, CYL_LATS, CylinderSampler(CYL_LONGS, CYL_LATS));
 }
 
+// Fill the array of index arrays.
 void fillCylIndices(unsigned int cylIndices[CYL_LATS][2*(CYL_LONGS+1)])
 {
-   int i, j;
-   for(j = 0; j < CYL_LATS; j++)
-   {
-      for (i = 0; i <= CYL_LONGS; i++)
-      {
-	     cylIndices[j][2*i] = (j+1)*(CYL_LONGS + 1) + i;
-	     cylIndices[j][2*i+1] = j*(CYL_LONGS + 1) + i;
-      }
-   }
+   fillGridIndices(&cylIndices[0][0], CYL_LONGS, CYL_LATS);
 }
 
-// Fill the array cylCounts.
+// Fill the array of counts.
 void fillCylCounts(int cylCounts[CYL_LATS])
 {
-   int j;
-   for(j = 0; j < CYL_LATS; j++) cylCounts[j] = 2*(CYL_LONGS + 1);
+   fillGridCounts(cylCounts, CYL_LONGS, CYL_LATS);
 }
 
-// Fill the array cylOffsets.
+// Fill the array of buffer offsets.
 void fillCylOffsets(void* cylOffsets[CYL_LATS])
 {
-   int j;
-   for(j = 0; j < CYL_LATS; j++) cylOffsets[j] = (GLvoid*)(2*(CYL_LONGS+1)*j*sizeof(unsigned int));
+   fillGridOffsets(cylOffsets, CYL_LONGS, CYL_LATS);
 }
 
+// Initialize the cylinder.
 void fillCylinder(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)], 
 	         unsigned int cylIndices[CYL_LATS][2*(CYL_LONGS+1)],
 			 int cylCounts[CYL_LATS],
@@ -72,4 +72,11 @@ void fillCylinder(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)],
    fillCylIndices(cylIndices);
    fillCylCounts(cylCounts);
    fillCylOffsets(cylOffsets);
-}
\ No newline at end of file
+}
+
+// Build the cylinder with the given numbers of longitudinal and latitudinal slices
+// and index layout (see meshBuilder.h).
+void buildCylinder(GridMesh<Vertex> &mesh, int longs, int lats, int layout)
+{
+   buildGridMesh(mesh, longs, lats, CylinderSampler(longs, lats), layout);
+}
@@ -2,6 +2,7 @@
 #define CYLINDER_H
 
 #include "vertex.h"
+#include "meshBuilder.h"
 
 #define PI 3.14159265
 #define CYL_LONGS 30 // Number of longitudinal slices.
@@ -17,4 +18,6 @@ void fillCylinder(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)],
 			 int cylCounts[CYL_LATS],
 			 void* cylOffsets[CYL_LATS]);
 
+void buildCylinder(GridMesh<Vertex> &mesh, int longs, int lats, int layout = MESH_STRIPS);
+
 #endif
@@ -16,54 +16,66 @@
 
 using namespace std;
 
+// Sample point (i, j) of the cylinder is at angle (-1 + 2i/longs)PI about the z-axis
+// and height -1 + 2j/lats.
+struct CylinderSampler
+{
+   AngleTable longAngles;
+
+   CylinderSampler(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), longs(longs), lats(lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      vertex.coords.x = longAngles.cosines[i];
+      vertex.coords.y = longAngles.sines[i];
+      vertex.coords.z = -1 + 2*(float)j/lats;
+      vertex.coords.w = 1.0;
+      vertex.normal.x = longAngles.cosines[i];
+      vertex.normal.y = longAngles.sines[i];
+      vertex.normal.z = 0.0;
+      vertex.texCoords.s = (float)i / longs;
+      vertex.texCoords.t = (float)j / lats;
+   }
+
+   void operator()(PackedVertex &vertex, int i, int j) const
+   {
+      packPosition(vertex.coords, longAngles.cosines[i], longAngles.sines[i], -1 + 2*(float)j/lats, cylBounds);
+      vertex.normal = packNormal(longAngles.cosines[i], longAngles.sines[i], 0.0f);
+      vertex.texCoords[0] = packHalf((float)i / longs);
+      vertex.texCoords[1] = packHalf((float)j / lats);
+   }
+
+   int longs, lats;
+};
+
 // Fill the vertex array with co-ordinates of the sample points.
 void fillCylVertexArray(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)])
 {
-   int i, j, k;
-
-   k = 0;
-   for (j = 0; j <= CYL_LATS; j++)
-      for (i = 0; i <= CYL_LONGS; i++)
-      {
-         cylVertices[k].coords.x = cos( (-1 + 2*(float)i/CYL_LONGS) * PI );
-         cylVertices[k].coords.y = sin( (-1 + 2*(float)i/CYL_LONGS) * PI );
-         cylVertices[k].coords.z = -1 + 2*(float)j/CYL_LATS;
-		 cylVertices[k].coords.w = 1.0;
-		 cylVertices[k].normal.x = cos( (-1 + 2*(float)i/CYL_LONGS) * PI );
-         cylVertices[k].normal.y = sin( (-1 + 2*(float)i/CYL_LONGS) * PI );
-		 cylVertices[k].normal.z = 0.0;
-		 cylVertices[k].texCoords.s = (float)i/CYL_LONGS;
-		 cylVertices[k].texCoords.t = (float)j/CYL_LATS;
-		 k++;
-	  }
+   fillGridVertices(cylVertices, CYL_LONGS, CYL_LATS, CylinderSampler(CYL_LONGS, CYL_LATS));
+}
+
+// Fill the packed vertex array with co-ordinates of the sample points.
+void fillCylPackedVertexArray(PackedVertex cylPackedVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)])
+{
+   fillGridVertices(cylPackedVertices, CYL_LONGS, CYL_LATS, CylinderSampler(CYL_LONGS, CYL_LATS));
 }
 
 // Fill the array of index arrays.
 void fillCylIndices(unsigned int cylIndices[CYL_LATS][2*(CYL_LONGS+1)])
 {
-   int i, j;
-   for(j = 0; j < CYL_LATS; j++)
-   {
-      for (i = 0; i <= CYL_LONGS; i++)
-      {
-	     cylIndices[j][2*i] = (j+1)*(CYL_LONGS + 1) + i;
-	     cylIndices[j][2*i+1] = j*(CYL_LONGS + 1) + i;
-      }
-   }
+   fillGridIndices(&cylIndices[0][0], CYL_LONGS, CYL_LATS);
 }
 
 // Fill the array of counts.
 void fillCylCounts(int cylCounts[CYL_LATS])
 {
-   int j;
-   for(j = 0; j < CYL_LATS; j++) cylCounts[j] = 2*(CYL_LONGS + 1);
+   fillGridCounts(cylCounts, CYL_LONGS, CYL_LATS);
 }
 
 // Fill the array of buffer offsets.
 void fillCylOffsets(void* cylOffsets[CYL_LATS])
 {
-   int j;
-   for(j = 0; j < CYL_LATS; j++) cylOffsets[j] = (GLvoid*)(2*(CYL_LONGS+1)*j*sizeof(unsigned int));
+   fillGridOffsets(cylOffsets, CYL_LONGS, CYL_LATS);
 }
 
 // Initialize the cylinder.
@@ -76,4 +88,17 @@ void fillCylinder(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)],
    fillCylIndices(cylIndices);
    fillCylCounts(cylCounts);
    fillCylOffsets(cylOffsets);
-}
\ No newline at end of file
+}
+
+// Build the cylinder with the given numbers of longitudinal and latitudinal slices
+// and index layout (see meshBuilder.h).
+void buildCylinder(GridMesh<Vertex> &mesh, int longs, int lats, int layout)
+{
+   buildGridMesh(mesh, longs, lats, CylinderSampler(longs, lats), layout);
+}
+
+// Build the cylinder of packed vertices.
+void buildCylinder(GridMesh<PackedVertex> &mesh, int longs, int lats, int layout)
+{
+   buildGridMesh(mesh, longs, lats, CylinderSampler(longs, lats), layout);
+}
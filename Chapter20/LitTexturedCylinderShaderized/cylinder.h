@@ -2,12 +2,18 @@
 #define CYLINDER_H
 
 #include "vertex.h"
+#include "meshBuilder.h"
+#include "vertexPacking.h"
 
 #define PI 3.14159265
 #define CYL_LONGS 30 // Number of longitudinal slices.
 #define CYL_LATS 10 // Number of latitudinal slices.
 
+// Bounds to which packed positions are normalized.
+const MeshBounds cylBounds = { {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0} };
+
 void fillCylVertexArray(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)]);
+void fillCylPackedVertexArray(PackedVertex cylPackedVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)]);
 void fillCylIndices(unsigned int cylIndices[CYL_LATS][2*(CYL_LONGS+1)]);
 void fillCylCounts(int cylCounts[CYL_LATS]);
 void fillCylOffsets(void* cylOffsets[CYL_LATS]);
@@ -17,4 +23,7 @@ void fillCylinder(Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)],
 			 int cylCounts[CYL_LATS],
 			 void* cylOffsets[CYL_LATS]);
 
+void buildCylinder(GridMesh<Vertex> &mesh, int longs, int lats, int layout = MESH_STRIPS);
+void buildCylinder(GridMesh<PackedVertex> &mesh, int longs, int lats, int layout = MESH_STRIPS);
+
 #endif
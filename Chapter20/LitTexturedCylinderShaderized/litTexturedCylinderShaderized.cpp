@@ -5,6 +5,7 @@
 //
 // Interaction:
 // Press x, X, y, Y, z, Z to turn the hemisphere.
+// Press p to toggle between float and packed cylinder vertices.
 //
 // Sumanta Guha
 //
@@ -12,6 +13,7 @@
 /////////////////////////////////////////////////////////////////////// 
 
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 
@@ -41,11 +43,12 @@
 using namespace std;
 using namespace glm;
 
-static enum object {CYLINDER, DISC}; // VAO ids.
-static enum buffer {CYL_VERTICES, CYL_INDICES, DISC_VERTICES}; // VBO ids.
+static enum object {CYLINDER, DISC, PACKED_CYLINDER}; // VAO ids.
+static enum buffer {CYL_VERTICES, CYL_INDICES, DISC_VERTICES, PACKED_CYL_VERTICES}; // VBO ids.
 
 // Globals.
 static float Xangle = 150.0, Yangle = 60.0, Zangle = 0.0; // Angles to rotate the cylinder.
+static int isPacked = 0; // Are the packed cylinder vertices drawn?
 
 // Light properties.
 static const Light light0 = 
@@ -71,6 +74,7 @@ static const Material canFandB =
 
 // Cylinder data.
 static Vertex cylVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)]; 
+static PackedVertex cylPackedVertices[(CYL_LONGS + 1) * (CYL_LATS + 1)]; 
 static unsigned int cylIndices[CYL_LATS][2*(CYL_LONGS+1)]; 
 static int cylCounts[CYL_LATS]; 
 static void* cylOffsets[CYL_LATS]; 
@@ -84,16 +88,16 @@ static mat3 normalMat = mat3(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    normalMatLoc,
    projMatLoc,
    canLabelTexLoc,
    canTopTexLoc,
    objectLoc,
-   buffer[3], 
-   vao[2],
+   meshCenterLoc,
+   meshExtentLoc,
+   buffer[4], 
+   vao[3],
    texture[2],
    width,
    height; 
@@ -107,21 +111,17 @@ void setup(void)
    glEnable(GL_DEPTH_TEST);
 
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId); 
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId); 
 
    // Initialize cylinder and disc.
    fillCylinder(cylVertices, cylIndices, cylCounts, cylOffsets);
+   fillCylPackedVertexArray(cylPackedVertices);
    fillDiscVertexArray(discVertices);
 
    // Create VAOs and VBOs... 
-   glGenVertexArrays(2, vao);
-   glGenBuffers(3, buffer); 
+   glGenVertexArrays(3, vao);
+   glGenBuffers(4, buffer); 
 
    // ...and associate data with vertex shader.
    glBindVertexArray(vao[CYLINDER]);
@@ -149,11 +149,29 @@ void setup(void)
 	                                               (void*)(sizeof(discVertices[0].coords)+sizeof(discVertices[0].normal)));
    glEnableVertexAttribArray(5);
 
+   // ...and associate packed data, sharing the indices, with vertex shader: positions 
+   // as normalized shorts, normals as normalized 10-bit integers and texture 
+   // co-ordinates as half floats.
+   glBindVertexArray(vao[PACKED_CYLINDER]);
+   glBindBuffer(GL_ARRAY_BUFFER, buffer[PACKED_CYL_VERTICES]);
+   glBufferData(GL_ARRAY_BUFFER, sizeof(cylPackedVertices), cylPackedVertices, GL_STATIC_DRAW);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer[CYL_INDICES]);
+   glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, sizeof(cylPackedVertices[0]), 0);
+   glEnableVertexAttribArray(0);
+   glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(cylPackedVertices[0]), 
+	                     (void*)sizeof(cylPackedVertices[0].coords));
+   glEnableVertexAttribArray(1);
+   glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(cylPackedVertices[0]), 
+	                     (void*)(sizeof(cylPackedVertices[0].coords)+sizeof(cylPackedVertices[0].normal)));
+   glEnableVertexAttribArray(2);
+
    // Obtain modelview matrix, projection matrix, normal matrix and object uniform locations.
    modelViewMatLoc = glGetUniformLocation(programId,"modelViewMat"); 
    projMatLoc = glGetUniformLocation(programId,"projMat"); 
    normalMatLoc = glGetUniformLocation(programId,"normalMat"); 
    objectLoc = glGetUniformLocation(programId, "object");
+   meshCenterLoc = glGetUniformLocation(programId, "meshCenter");
+   meshExtentLoc = glGetUniformLocation(programId, "meshExtent");
 
    // Obtain light property uniform locations and set values.
    glUniform4fv(glGetUniformLocation(programId, "light0.ambCols"), 1, &light0.ambCols[0]);
@@ -174,6 +192,7 @@ void setup(void)
    // Load the images.
    image[0] = getbmp("../../Textures/canLabel.bmp"); 
    image[1] = getbmp("../../Textures/canTop.bmp"); 
+   if (image[0] == NULL || image[1] == NULL) exit(1); // getbmp() has printed why.
 
    // Create texture ids.
    glGenTextures(2, texture);
@@ -201,6 +220,13 @@ void setup(void)
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
    canTopTexLoc = glGetUniformLocation(programId, "canTopTex");
    glUniform1i(canTopTexLoc, 1);
+
+   // OpenGL has its own copy of the images now.
+   for (int i = 0; i < 2; i++)
+   {
+      delete[] image[i]->data;
+      delete image[i];
+   }
 }
 
 // Drawing routine.
@@ -224,9 +250,20 @@ void drawScene(void)
    normalMat = transpose(inverse(mat3(modelViewMat)));
    glUniformMatrix3fv(normalMatLoc, 1, GL_FALSE, value_ptr(normalMat));
 
-   // Draw cylinder.
+   // Draw cylinder, packed positions restored from the cylinder bounds.
    glUniform1ui(objectLoc, CYLINDER);
-   glBindVertexArray(vao[CYLINDER]);
+   if (isPacked)
+   {
+      glUniform3fv(meshCenterLoc, 1, cylBounds.center);
+      glUniform3fv(meshExtentLoc, 1, cylBounds.extent);
+      glBindVertexArray(vao[PACKED_CYLINDER]);
+   }
+   else
+   {
+      glUniform3f(meshCenterLoc, 0.0, 0.0, 0.0);
+      glUniform3f(meshExtentLoc, 1.0, 1.0, 1.0);
+      glBindVertexArray(vao[CYLINDER]);
+   }
    glMultiDrawElements(GL_TRIANGLE_STRIP, cylCounts, GL_UNSIGNED_INT, (const void **)cylOffsets, CYL_LATS);
 
    // Draw disc.
@@ -282,6 +319,12 @@ void keyInput(unsigned char key, int x, int y)
 		 if (Zangle < 0.0) Zangle += 360.0;
          glutPostRedisplay();
          break;
+      case 'p':
+         isPacked = !isPacked;
+         if (isPacked) cout << "Packed cylinder vertices: " << sizeof(cylPackedVertices) << " bytes." << endl;
+         else cout << "Float cylinder vertices: " << sizeof(cylVertices) << " bytes." << endl;
+         glutPostRedisplay();
+         break;
       default:
          break;
    }
@@ -291,7 +334,8 @@ void keyInput(unsigned char key, int x, int y)
 void printInteraction(void)
 {
    cout << "Interaction:" << endl;
-   cout << "Press x, X, y, Y, z, Z to turn the cylinder." << endl;
+   cout << "Press x, X, y, Y, z, Z to turn the cylinder." << endl
+        << "Press p to toggle between float and packed cylinder vertices." << endl;
 }
 
 // Main routine.
@@ -10,4 +10,12 @@ struct Vertex
    glm::vec2 texCoords;
 };
 
+// Vertex packed to 16 bytes (see vertexPacking.h).
+struct PackedVertex
+{
+   short coords[4];
+   unsigned int normal;
+   unsigned short texCoords[2];
+};
+
 #endif
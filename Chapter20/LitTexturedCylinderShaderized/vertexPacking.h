@@ -0,0 +1,88 @@
+#ifndef VERTEXPACKING_H
+#define VERTEXPACKING_H
+
+#include <cmath>
+#include <cstring>
+
+// Conversions of vertex attributes to compact formats which the vertex fetcher
+// expands back to floats: positions to 16-bit normalized integers within the bounds
+// of their mesh (GL_SHORT, normalized), normals to 10-bit normalized integers
+// (GL_INT_2_10_10_10_REV, normalized) and texture co-ordinates to half floats
+// (GL_HALF_FLOAT). Only positions need decoding in the vertex shader, as
+// center + extent * coords.xyz, with the center and extent of the mesh bounds.
+
+#define PACKED_SNORM16_MAX 32767 // Largest value of a 16-bit normalized integer.
+#define PACKED_SNORM10_MAX 511 // Largest value of a 10-bit normalized integer.
+
+// Axis-aligned box enclosing a mesh, given by its center and half its size along
+// each axis.
+struct MeshBounds
+{
+   float center[3];
+   float extent[3];
+};
+
+// Convert a value in [-1, 1] to a 16-bit normalized integer.
+inline short packSnorm16(float x)
+{
+   x = (x < -1.0f) ? -1.0f : ((x > 1.0f) ? 1.0f : x);
+   return (short)std::floor(x * PACKED_SNORM16_MAX + 0.5f);
+}
+
+// Convert a position to 16-bit normalized integers within the bounds, the fourth set
+// so that the fetched w is 1.
+inline void packPosition(short packed[4], float x, float y, float z, const MeshBounds &bounds)
+{
+   packed[0] = packSnorm16((x - bounds.center[0]) / bounds.extent[0]);
+   packed[1] = packSnorm16((y - bounds.center[1]) / bounds.extent[1]);
+   packed[2] = packSnorm16((z - bounds.center[2]) / bounds.extent[2]);
+   packed[3] = PACKED_SNORM16_MAX;
+}
+
+// Convert a unit normal to three 10-bit normalized integers, x in the low bits,
+// as GL_INT_2_10_10_10_REV.
+inline unsigned int packNormal(float x, float y, float z)
+{
+   float components[3] = { x, y, z };
+   unsigned int packed = 0;
+   for (int c = 0; c < 3; c++)
+   {
+      float value = (components[c] < -1.0f) ? -1.0f : ((components[c] > 1.0f) ? 1.0f : components[c]);
+      int quantized = (int)std::floor(value * PACKED_SNORM10_MAX + 0.5f);
+      packed |= ((unsigned int)quantized & 0x3FF) << (10 * c);
+   }
+   return packed;
+}
+
+// Convert a float to a half float, rounding to nearest even.
+inline unsigned short packHalf(float x)
+{
+   unsigned int bits;
+   std::memcpy(&bits, &x, sizeof(bits));
+   unsigned int sign = (bits >> 16) & 0x8000, magnitude = bits & 0x7FFFFFFF;
+
+   // Infinity and NaN, and values too large for a half.
+   if (magnitude >= 0x7F800000) return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+   if (magnitude >= 0x477FF000) return sign | 0x7C00;
+
+   // Values too small even for a denormal half.
+   if (magnitude < 0x33000001) return sign;
+
+   // Denormal halves, shifting the mantissa with its implicit bit into place.
+   int exponent = magnitude >> 23;
+   if (exponent < 113)
+   {
+      unsigned int mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+      int shift = 126 - exponent;
+      unsigned int half = mantissa >> shift, rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+      if (rest > halfway || (rest == halfway && (half & 1))) half++;
+      return sign | half;
+   }
+
+   // Normal halves, rebiasing the exponent and rounding off 13 bits of mantissa.
+   unsigned int half = ((magnitude - 0x38000000) >> 13), rest = magnitude & 0x1FFF;
+   if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;
+   return sign | half;
+}
+
+#endif
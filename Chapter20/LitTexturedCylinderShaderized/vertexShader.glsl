@@ -14,6 +14,7 @@ uniform mat4 modelViewMat;
 uniform mat4 projMat;
 uniform mat3 normalMat;
 uniform uint object;
+uniform vec3 meshCenter, meshExtent; // Bounds of packed cylinder positions.
 
 out vec4 frontAmbDiffExport, frontSpecExport, backAmbDiffExport, backSpecExport;
 out vec2 texCoordsExport;
@@ -48,7 +49,7 @@ void main(void)
 {
    if (object == CYLINDER)
    {
-      coords = cylCoords;
+      coords = vec4(meshCenter + meshExtent * cylCoords.xyz, 1.0);
       normal = cylNormal;
       texCoordsExport = cylTexCoords;
    }
@@ -0,0 +1,382 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "getbmp.h"
+#include "compressedTexture.h"
+
+using namespace std;
+
+// Header at the start of a compressed texture file, followed by the blocks.
+struct CompressedHeader
+{
+   char magic[4]; // "CGBC"
+   int format;
+   int sizeX;
+   int sizeY;
+   int dataSize;
+};
+
+// Round a color channel to 5 or 6 bits and expand it back to 8, as a decoder would.
+static int quantize(float value, int bits)
+{
+   int top = (1 << bits) - 1;
+   return min(top, (int)(min(max(value, 0.0f), 255.0f) * top / 255.0f + 0.5f));
+}
+
+static int expand(int value, int bits)
+{
+   return (bits == 5) ? (value << 3) | (value >> 2) : (value << 2) | (value >> 4);
+}
+
+// Pack a color to 5:6:5 bits and unpack it again.
+static int packColor(const float color[3])
+{
+   return (quantize(color[0], 5) << 11) | (quantize(color[1], 6) << 5) | quantize(color[2], 5);
+}
+
+static void unpackColor(int packed, int color[3])
+{
+   color[0] = expand((packed >> 11) & 31, 5);
+   color[1] = expand((packed >> 5) & 63, 6);
+   color[2] = expand(packed & 31, 5);
+}
+
+// Choose the 4 color indices of a block for the given 5:6:5 endpoints, returning the
+// 32 index bits and the total squared error.
+static unsigned int colorIndices(const unsigned char block[16][4], int color0, int color1, int *error)
+{
+   int palette[4][3], c0[3], c1[3];
+   unpackColor(color0, c0);
+   unpackColor(color1, c1);
+   for (int c = 0; c < 3; c++)
+   {
+      palette[0][c] = c0[c];
+      palette[1][c] = c1[c];
+      palette[2][c] = (2 * c0[c] + c1[c]) / 3;
+      palette[3][c] = (c0[c] + 2 * c1[c]) / 3;
+   }
+
+   unsigned int indices = 0;
+   *error = 0;
+   for (int i = 0; i < 16; i++)
+   {
+      int best = 0, bestError = 1 << 30;
+      for (int j = 0; j < 4; j++)
+      {
+         int dr = block[i][0] - palette[j][0], dg = block[i][1] - palette[j][1], db = block[i][2] - palette[j][2];
+         int e = dr * dr + dg * dg + db * db;
+         if (e < bestError) { bestError = e; best = j; }
+      }
+      indices |= (unsigned int)best << (2 * i);
+      *error += bestError;
+   }
+   return indices;
+}
+
+// Order the endpoints so that color0 > color1, which selects the 4-color mode, and
+// write the 8-byte color block.
+static void writeColorBlock(int color0, int color1, const unsigned char block[16][4], unsigned char *out)
+{
+   int error;
+   if (color0 < color1) swap(color0, color1);
+   unsigned int indices = (color0 == color1) ? 0 : colorIndices(block, color0, color1, &error);
+   out[0] = color0 & 0xFF; out[1] = color0 >> 8;
+   out[2] = color1 & 0xFF; out[3] = color1 >> 8;
+   for (int i = 0; i < 4; i++) out[4 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+// Encode the color of a 4x4 block of RGBA texels as a BC1 block. The endpoints are first
+// the extremes of the texels along their principal axis, inset a little, then refined
+// once by least squares for the chosen indices.
+static void encodeColorBlock(const unsigned char block[16][4], unsigned char *out)
+{
+   float mean[3] = { 0.0, 0.0, 0.0 }, cov[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+   for (int i = 0; i < 16; i++)
+      for (int c = 0; c < 3; c++) mean[c] += block[i][c] / 16.0f;
+   for (int i = 0; i < 16; i++)
+   {
+      float r = block[i][0] - mean[0], g = block[i][1] - mean[1], b = block[i][2] - mean[2];
+      cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+      cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+   }
+
+   // Principal axis by power iteration.
+   float axis[3] = { 1.0, 1.0, 1.0 };
+   for (int k = 0; k < 8; k++)
+   {
+      float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+      float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+      float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+      float length = max(fabs(x), max(fabs(y), fabs(z)));
+      if (length == 0.0) break;
+      axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+   }
+
+   float minT = 1e30f, maxT = -1e30f, axisLength2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+   for (int i = 0; i < 16; i++)
+   {
+      float t = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+      minT = min(minT, t);
+      maxT = max(maxT, t);
+   }
+   float inset = (maxT - minT) / 16.0f;
+   float end0[3], end1[3];
+   for (int c = 0; c < 3; c++)
+   {
+      end0[c] = mean[c] + axis[c] * (maxT - inset) / axisLength2;
+      end1[c] = mean[c] + axis[c] * (minT + inset) / axisLength2;
+   }
+   int color0 = packColor(end0), color1 = packColor(end1), error;
+   if (color0 == color1) { writeColorBlock(color0, color1, block, out); return; }
+   if (color0 < color1) swap(color0, color1);
+   unsigned int indices = colorIndices(block, color0, color1, &error);
+
+   // Least squares endpoints for the indices: texel i is a[i] * end0 + b[i] * end1.
+   static const float weight0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+   float aa = 0.0, ab = 0.0, bb = 0.0, ax[3] = { 0.0, 0.0, 0.0 }, bx[3] = { 0.0, 0.0, 0.0 };
+   for (int i = 0; i < 16; i++)
+   {
+      float a = weight0[(indices >> (2 * i)) & 3], b = 1.0f - a;
+      aa += a * a; ab += a * b; bb += b * b;
+      for (int c = 0; c < 3; c++) { ax[c] += a * block[i][c]; bx[c] += b * block[i][c]; }
+   }
+   float det = aa * bb - ab * ab;
+   if (fabs(det) > 1e-6)
+   {
+      for (int c = 0; c < 3; c++)
+      {
+         end0[c] = (bb * ax[c] - ab * bx[c]) / det;
+         end1[c] = (aa * bx[c] - ab * ax[c]) / det;
+      }
+      int refined0 = packColor(end0), refined1 = packColor(end1), refinedError;
+      if (refined0 < refined1) swap(refined0, refined1);
+      if (refined0 != refined1)
+      {
+         colorIndices(block, refined0, refined1, &refinedError);
+         if (refinedError < error) { color0 = refined0; color1 = refined1; }
+      }
+   }
+   writeColorBlock(color0, color1, block, out);
+}
+
+// Encode the alpha of a 4x4 block of RGBA texels as a BC3 alpha block, in the mode
+// interpolating 8 values between the block's minimum and maximum alpha.
+static void encodeAlphaBlock(const unsigned char block[16][4], unsigned char *out)
+{
+   int alpha0 = 0, alpha1 = 255;
+   for (int i = 0; i < 16; i++)
+   {
+      alpha0 = max(alpha0, (int)block[i][3]);
+      alpha1 = min(alpha1, (int)block[i][3]);
+   }
+   out[0] = alpha0;
+   out[1] = alpha1;
+
+   int palette[8] = { alpha0, alpha1 };
+   for (int j = 1; j < 7; j++) palette[j + 1] = ((7 - j) * alpha0 + j * alpha1) / 7;
+
+   unsigned long long indices = 0;
+   if (alpha0 != alpha1)
+      for (int i = 0; i < 16; i++)
+      {
+         int best = 0, bestError = 256;
+         for (int j = 0; j < 8; j++)
+            if (abs(block[i][3] - palette[j]) < bestError) { bestError = abs(block[i][3] - palette[j]); best = j; }
+         indices |= (unsigned long long)best << (3 * i);
+      }
+   for (int i = 0; i < 6; i++) out[2 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+// Encode rows of blocks [firstRow, lastRow) of an image.
+static void compressBlockRows(const unsigned char *image, int sizeX, int sizeY, int format,
+                              unsigned char *out, int firstRow, int lastRow)
+{
+   int blocksX = (sizeX + 3) / 4, blockSize = (format == TEX_BC1) ? 8 : 16;
+   unsigned char block[16][4];
+   for (int by = firstRow; by < lastRow; by++)
+      for (int bx = 0; bx < blocksX; bx++)
+      {
+         // Gather the block, repeating the last row and column of a partial block.
+         for (int i = 0; i < 16; i++)
+         {
+            int x = min(4 * bx + i % 4, sizeX - 1), y = min(4 * by + i / 4, sizeY - 1);
+            memcpy(block[i], image + 4 * (sizeX * y + x), 4);
+         }
+         unsigned char *outBlock = out + blockSize * (blocksX * by + bx);
+         if (format == TEX_BC3)
+         {
+            encodeAlphaBlock(block, outBlock);
+            outBlock += 8;
+         }
+         encodeColorBlock(block, outBlock);
+      }
+}
+
+// Routine to compress an RGBA image to BC1 or BC3, the rows of blocks shared
+// among TEX_BC_THREADS threads.
+CompressedTexture *compressImage(const unsigned char *image, int sizeX, int sizeY, int format)
+{
+   CompressedTexture *texture = new CompressedTexture;
+   int blocksY = (sizeY + 3) / 4;
+   texture->sizeX = sizeX;
+   texture->sizeY = sizeY;
+   texture->format = format;
+   texture->dataSize = ((sizeX + 3) / 4) * blocksY * ((format == TEX_BC1) ? 8 : 16);
+   texture->data = new unsigned char[texture->dataSize];
+
+   vector<thread> threads;
+   for (int i = 1; i < TEX_BC_THREADS; i++)
+      threads.push_back(thread(compressBlockRows, image, sizeX, sizeY, format, texture->data,
+                               i * blocksY / TEX_BC_THREADS, (i + 1) * blocksY / TEX_BC_THREADS));
+   compressBlockRows(image, sizeX, sizeY, format, texture->data, 0, blocksY / TEX_BC_THREADS);
+   for (int i = 0; i < (int)threads.size(); i++) threads[i].join();
+
+   return texture;
+}
+
+// Routine to decode a compressed texture back to an RGBA image of 4 * sizeX * sizeY bytes.
+void decompressImage(CompressedTexture *texture, unsigned char *image)
+{
+   int blocksX = (texture->sizeX + 3) / 4, blocksY = (texture->sizeY + 3) / 4;
+   int blockSize = (texture->format == TEX_BC1) ? 8 : 16;
+   for (int by = 0; by < blocksY; by++)
+      for (int bx = 0; bx < blocksX; bx++)
+      {
+         const unsigned char *block = texture->data + blockSize * (blocksX * by + bx);
+         int alpha[16];
+         for (int i = 0; i < 16; i++) alpha[i] = 255;
+         if (texture->format == TEX_BC3)
+         {
+            int palette[8] = { block[0], block[1] };
+            for (int j = 1; j < 7; j++)
+               palette[j + 1] = (block[0] > block[1]) ? ((7 - j) * block[0] + j * block[1]) / 7
+                                                      : (j < 5 ? ((5 - j) * block[0] + j * block[1]) / 5 : (j == 5 ? 0 : 255));
+            unsigned long long indices = 0;
+            for (int i = 0; i < 6; i++) indices |= (unsigned long long)block[2 + i] << (8 * i);
+            for (int i = 0; i < 16; i++) alpha[i] = palette[(indices >> (3 * i)) & 7];
+            block += 8;
+         }
+
+         int color0 = block[0] | block[1] << 8, color1 = block[2] | block[3] << 8;
+         int palette[4][3];
+         unpackColor(color0, palette[0]);
+         unpackColor(color1, palette[1]);
+         for (int c = 0; c < 3; c++)
+         {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+         }
+         unsigned int indices = block[4] | block[5] << 8 | block[6] << 16 | (unsigned int)block[7] << 24;
+         for (int i = 0; i < 16; i++)
+         {
+            int x = 4 * bx + i % 4, y = 4 * by + i / 4;
+            if (x >= texture->sizeX || y >= texture->sizeY) continue;
+            unsigned char *texel = image + 4 * (texture->sizeX * y + x);
+            for (int c = 0; c < 3; c++) texel[c] = palette[(indices >> (2 * i)) & 3][c];
+            texel[3] = alpha[i];
+         }
+      }
+}
+
+// Write a compressed texture to a file.
+bool writeCompressedTexture(string filename, CompressedTexture *texture)
+{
+   CompressedHeader header;
+   memcpy(header.magic, "CGBC", 4);
+   header.format = texture->format;
+   header.sizeX = texture->sizeX;
+   header.sizeY = texture->sizeY;
+   header.dataSize = texture->dataSize;
+
+   FILE *out = fopen(filename.c_str(), "wb");
+   if (out == NULL) return false;
+   bool written = fwrite(&header, sizeof(CompressedHeader), 1, out) == 1 &&
+                  fwrite(texture->data, 1, texture->dataSize, out) == (size_t)texture->dataSize;
+   return (fclose(out) == 0) && written;
+}
+
+// Read a compressed texture from a file. Returns NULL if the file is missing or invalid.
+CompressedTexture *readCompressedTexture(string filename)
+{
+   FILE *in = fopen(filename.c_str(), "rb");
+   if (in == NULL) return NULL;
+
+   CompressedHeader header;
+   CompressedTexture *texture = NULL;
+   if (fread(&header, sizeof(CompressedHeader), 1, in) == 1 && memcmp(header.magic, "CGBC", 4) == 0 &&
+       (header.format == TEX_BC1 || header.format == TEX_BC3) && header.sizeX > 0 && header.sizeY > 0 &&
+       // In 64 bits, so that no corrupt header's size can wrap around to match dataSize.
+       header.dataSize == (header.sizeX + 3LL) / 4 * ((header.sizeY + 3LL) / 4) * ((header.format == TEX_BC1) ? 8 : 16))
+   {
+      texture = new CompressedTexture;
+      texture->sizeX = header.sizeX;
+      texture->sizeY = header.sizeY;
+      texture->format = header.format;
+      texture->dataSize = header.dataSize;
+      texture->data = new unsigned char[header.dataSize];
+      if (fread(texture->data, 1, header.dataSize, in) != (size_t)header.dataSize)
+      {
+         delete[] texture->data;
+         delete texture;
+         texture = NULL;
+      }
+   }
+   fclose(in);
+   return texture;
+}
+
+// Routine to get a bmp file's image compressed in the given format: read from the
+// compressed texture file beside it (grass.bc1 for grass.bmp and TEX_BC1) if there
+// is one, otherwise compressed at run time.
+CompressedTexture *getCompressedTexture(string filename, int format)
+{
+   string compressedFilename = filename.substr(0, filename.rfind('.')) + (format == TEX_BC1 ? ".bc1" : ".bc3");
+   CompressedTexture *texture = readCompressedTexture(compressedFilename);
+   if (texture != NULL && texture->format != format)
+   {
+      delete[] texture->data;
+      delete texture;
+      texture = NULL;
+   }
+   if (texture != NULL) return texture;
+
+   BitMapFile *image = getbmp(filename);
+   if (image == NULL) return NULL;
+   texture = compressImage(image->data, image->sizeX, image->sizeY, format);
+   delete[] image->data;
+   delete image;
+   return texture;
+}
+
+// Specify the image of the currently bound 2D texture object from a compressed texture.
+// Without EXT_texture_compression_s3tc the texture is decoded and specified uncompressed.
+void texImageCompressed(CompressedTexture *texture)
+{
+   if (GLEW_EXT_texture_compression_s3tc)
+      glCompressedTexImage2D(GL_TEXTURE_2D, 0,
+                             texture->format == TEX_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                             texture->sizeX, texture->sizeY, 0, texture->dataSize, texture->data);
+   else
+   {
+      vector<unsigned char> image(4 * texture->sizeX * texture->sizeY);
+      decompressImage(texture, &image[0]);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture->sizeX, texture->sizeY, 0,
+                   GL_RGBA, GL_UNSIGNED_BYTE, &image[0]);
+   }
+}
@@ -5,6 +5,7 @@
 //
 // Interaction:
 // Press x, X, y, Y, z, Z to turn the torus.
+// Press p to toggle between float and packed torus vertices.
 //
 // Sumanta Guha
 //
@@ -12,6 +13,7 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 
@@ -33,18 +35,21 @@
 #include "shader.h"
 #include "torus.h"
 #include "getbmp.h"
+#include "compressedTexture.h"
 
 using namespace std;
 using namespace glm;
 
-static enum object {TORUS}; // VAO ids.
-static enum buffer {TOR_VERTICES, TOR_INDICES}; // VBO ids.
+static enum object {TORUS, PACKED_TORUS}; // VAO ids.
+static enum buffer {TOR_VERTICES, TOR_INDICES, PACKED_TOR_VERTICES}; // VBO ids.
 
 // Globals.
 static float Xangle = 0.0, Yangle = 0.0, Zangle = 0.0; // Angles to rotate torus.
+static int isPacked = 0; // Are the packed torus vertices drawn?
 
 // Torus data.
 static Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)]; 
+static PackedVertex torPackedVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)]; 
 static unsigned int torIndices[TOR_LATS][2*(TOR_LONGS+1)]; 
 static int torCounts[TOR_LATS]; 
 static void* torOffsets[TOR_LATS]; 
@@ -54,16 +59,16 @@ static mat4 projMat = mat4(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    launchTexLoc,
-   buffer[2], 
-   vao[1],
+   meshCenterLoc,
+   meshExtentLoc,
+   buffer[3], 
+   vao[2],
    texture[1]; 
 
-static BitMapFile *image[1]; // Local storage for bmp image data.
+static CompressedTexture *image[1]; // Local storage for compressed image data.
 
 // Initialization routine.
 void setup(void) 
@@ -72,20 +77,16 @@ void setup(void)
    glEnable(GL_DEPTH_TEST);
 
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId);    
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId); 
 
    // Initialize torus.
    fillTorus(torVertices, torIndices, torCounts, torOffsets);
+   fillTorPackedVertexArray(torPackedVertices);
 
    // Create VAOs and VBOs... 
-   glGenVertexArrays(1, vao);
-   glGenBuffers(2, buffer); 
+   glGenVertexArrays(2, vao);
+   glGenBuffers(3, buffer); 
 
    // ...and associate data with vertex shader.
    glBindVertexArray(vao[TORUS]);
@@ -98,6 +99,22 @@ void setup(void)
    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(torVertices[0]), (void*)sizeof(torVertices[0].coords));
    glEnableVertexAttribArray(1);
 
+   // ...and associate packed data, sharing the indices, with vertex shader: positions 
+   // as normalized shorts and texture co-ordinates as half floats.
+   glBindVertexArray(vao[PACKED_TORUS]);
+   glBindBuffer(GL_ARRAY_BUFFER, buffer[PACKED_TOR_VERTICES]);
+   glBufferData(GL_ARRAY_BUFFER, sizeof(torPackedVertices), torPackedVertices, GL_STATIC_DRAW);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer[TOR_INDICES]);
+   glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, sizeof(torPackedVertices[0]), 0);
+   glEnableVertexAttribArray(0);
+   glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(torPackedVertices[0]), 
+                         (void*)sizeof(torPackedVertices[0].coords));
+   glEnableVertexAttribArray(1);
+
+   // Obtain mesh bounds uniform locations.
+   meshCenterLoc = glGetUniformLocation(programId,"meshCenter"); 
+   meshExtentLoc = glGetUniformLocation(programId,"meshExtent"); 
+
    // Obtain projection matrix uniform location and set value.
    projMatLoc = glGetUniformLocation(programId,"projMat"); 
    projMat = frustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0); 
@@ -106,8 +123,9 @@ void setup(void)
    // Obtain modelview matrix uniform location.
    modelViewMatLoc = glGetUniformLocation(programId,"modelViewMat");
 
-   // Load the image.
-   image[0] = getbmp("../../Textures/launch.bmp"); 
+   // Load the image compressed to BC1.
+   image[0] = getCompressedTexture("../../Textures/launch.bmp", TEX_BC1); 
+   if (image[0] == NULL) exit(1); // getbmp() has printed why.
    
    // Create texture id.
    glGenTextures(1, texture);
@@ -115,14 +133,17 @@ void setup(void)
    // Bind launch image.
    glActiveTexture(GL_TEXTURE0);
    glBindTexture(GL_TEXTURE_2D, texture[0]);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image[0]->sizeX, image[0]->sizeY, 0, 
-	            GL_RGBA, GL_UNSIGNED_BYTE, image[0]->data);
+   texImageCompressed(image[0]);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
    launchTexLoc = glGetUniformLocation(programId, "launchTex");
    glUniform1i(launchTexLoc, 0);
+
+   // OpenGL has its own copy of the image now.
+   delete[] image[0]->data;
+   delete image[0];
 }
 
 // Drawing routine.
@@ -138,8 +159,19 @@ void drawScene(void)
    modelViewMat = rotate(modelViewMat, Xangle, vec3(1.0, 0.0, 0.0));
    glUniformMatrix4fv(modelViewMatLoc, 1, GL_FALSE, value_ptr(modelViewMat));
 
-   // Draw torus.
-   glBindVertexArray(vao[TORUS]);
+   // Draw torus, packed positions restored from the torus bounds.
+   if (isPacked)
+   {
+      glUniform3fv(meshCenterLoc, 1, torBounds.center);
+      glUniform3fv(meshExtentLoc, 1, torBounds.extent);
+      glBindVertexArray(vao[PACKED_TORUS]);
+   }
+   else
+   {
+      glUniform3f(meshCenterLoc, 0.0, 0.0, 0.0);
+      glUniform3f(meshExtentLoc, 1.0, 1.0, 1.0);
+      glBindVertexArray(vao[TORUS]);
+   }
    glMultiDrawElements(GL_TRIANGLE_STRIP, torCounts, GL_UNSIGNED_INT, (const void **)torOffsets, TOR_LATS);
 
    glutSwapBuffers();
@@ -189,6 +221,12 @@ void keyInput(unsigned char key, int x, int y)
 		 if (Zangle < 0.0) Zangle += 360.0;
          glutPostRedisplay();
          break;
+      case 'p':
+         isPacked = !isPacked;
+         if (isPacked) cout << "Packed torus vertices: " << sizeof(torPackedVertices) << " bytes." << endl;
+         else cout << "Float torus vertices: " << sizeof(torVertices) << " bytes." << endl;
+         glutPostRedisplay();
+         break;
       default:
          break;
    }
@@ -199,7 +237,8 @@ void keyInput(unsigned char key, int x, int y)
 void printInteraction(void)
 {
    cout << "Interaction:" << endl;
-   cout << "Press x, X, y, Y, z, Z to turn the torus." << endl;
+   cout << "Press x, X, y, Y, z, Z to turn the torus." << endl
+        << "Press p to toggle between float and packed torus vertices." << endl;
 }
 
 // Main routine.
@@ -2,6 +2,8 @@
 #define TORUS_H
 
 #include "vertex.h"
+#include "meshBuilder.h"
+#include "vertexPacking.h"
 
 #define PI 3.14159265
 #define TOR_OUTRAD 12.0 // Torus outer radius.
@@ -9,7 +11,11 @@
 #define TOR_LONGS 20 // Number of longitudinal slices.
 #define TOR_LATS 20 // Number of latitudinal slices.
 
+// Bounds to which packed positions are normalized.
+const MeshBounds torBounds = { {0.0, 0.0, 0.0}, {TOR_OUTRAD + TOR_INRAD, TOR_OUTRAD + TOR_INRAD, TOR_INRAD} };
+
 void fillTorVertexArray(Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)]);
+void fillTorPackedVertexArray(PackedVertex torPackedVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)]);
 void fillTorIndices(unsigned int torIndices[TOR_LATS][2*(TOR_LONGS+1)]);
 void fillTorCounts(int torCounts[TOR_LATS]);
 void fillTorOffsets(void* torOffsets[TOR_LATS]);
@@ -18,4 +24,8 @@ void fillTorus(Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)],
 	         unsigned int torIndices[TOR_LATS][2*(TOR_LONGS+1)],
 			 int torCounts[TOR_LATS],
 			 void* torOffsets[TOR_LATS]);
+
+void buildTorus(GridMesh<Vertex> &mesh, int longs, int lats, int layout = MESH_STRIPS);
+void buildTorus(GridMesh<PackedVertex> &mesh, int longs, int lats, int layout = MESH_STRIPS);
+
 #endif
\ No newline at end of file
@@ -9,4 +9,11 @@ struct Vertex
    glm::vec2 texCoords;
 };
 
+// Vertex packed to 12 bytes (see vertexPacking.h).
+struct PackedVertex
+{
+   short coords[4];
+   unsigned short texCoords[2];
+};
+
 #endif
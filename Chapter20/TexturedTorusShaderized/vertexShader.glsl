@@ -5,11 +5,12 @@ layout(location=1) in vec2 torTexCoords;
 
 uniform mat4 modelViewMat;
 uniform mat4 projMat;
+uniform vec3 meshCenter, meshExtent; // Bounds of packed positions.
 
 out vec2 texCoordsExport;
 
 void main(void)
 {  
-   gl_Position = projMat * modelViewMat * torCoords;
+   gl_Position = projMat * modelViewMat * vec4(meshCenter + meshExtent * torCoords.xyz, 1.0);
    texCoordsExport = torTexCoords;
 }
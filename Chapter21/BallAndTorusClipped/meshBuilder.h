@@ -0,0 +1,474 @@
+#ifndef MESHBUILDER_H
+#define MESHBUILDER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#endif
+
+#define MESH_STRIPS 0 // One triangle strip per latitude, drawn with glMultiDrawElements().
+#define MESH_RESTART 1 // The strips in one index stream, separated by MESH_RESTART_INDEX.
+#define MESH_TRIANGLES 2 // A triangle list reordered for the post-transform vertex cache.
+#define MESH_RESTART_INDEX 0xFFFFFFFF // Index of GL_PRIMITIVE_RESTART_FIXED_INDEX for GL_UNSIGNED_INT.
+#define MESH_CACHE_SIZE 32 // Size of the LRU cache modelled by the reordering.
+#define MESH_REORDER_VERTICES 262144 // Most vertices of a triangle list worth reordering.
+#define SURFACE_THREAD_VERTICES 65536 // Fewest vertices worth a thread of their own.
+
+// Builders of meshes sampled on a grid of (longs + 1) x (lats + 1) points of a
+// parametric surface, drawn as lats triangle strips of 2 * (longs + 1) indices each,
+// and of curves sampled at segs + 1 points. The number of samples may be chosen at
+// run time, with the mesh held in vectors, or fixed at compile time, with the mesh
+// held in arrays whose sizes are the constant expressions below.
+//
+// A surface is given by a sampler, a function object setting the vertex at grid point
+// (i, j), 0 <= i <= longs, 0 <= j <= lats, which a sampler typically computes from
+// tables of sines and cosines of the longitudinal and latitudinal angles built once
+// for the grid rather than once per point. Alternatively, a surface whose point
+// depends on the two angles through their sines and cosines may be given as a
+// parametric surface (see the end of the file), which is evaluated several rows at a
+// time in threads and, where the compiler targets AVX, several columns at a time in
+// SIMD lanes. The lanes are chosen at compile time, and the programs' projects do not
+// target AVX, so a surface cheap to sample, such as a torus, is better given by a
+// sampler: its table look-ups are as fast as the evaluator's scalar arithmetic and
+// avoid the evaluator's copy of each point into the vertex.
+
+// Number of vertices of a grid mesh.
+constexpr int gridNumVertices(int longs, int lats) { return (longs + 1) * (lats + 1); }
+
+// Number of indices of each strip of a grid mesh.
+constexpr int gridStripLength(int longs) { return 2 * (longs + 1); }
+
+// Number of indices of a grid mesh.
+constexpr int gridNumIndices(int longs, int lats) { return lats * gridStripLength(longs); }
+
+// Number of indices of a grid mesh as one stream of strips with restarts.
+constexpr int gridNumRestartIndices(int longs, int lats) { return gridNumIndices(longs, lats) + lats - 1; }
+
+// Number of indices of a grid mesh as a triangle list.
+constexpr int gridNumTriangleIndices(int longs, int lats) { return 6 * longs * lats; }
+
+// A grid mesh with its tessellation chosen at run time.
+template <class Vertex>
+struct GridMesh
+{
+   int longs;
+   int lats;
+   int layout; // MESH_STRIPS, MESH_RESTART or MESH_TRIANGLES.
+   std::vector<Vertex> vertices;
+   std::vector<unsigned int> indices; // The strips one after another, or the triangles.
+   std::vector<int> counts; // Number of indices of each strip (MESH_STRIPS only).
+   std::vector<void*> offsets; // Offset of each strip in the index buffer (MESH_STRIPS only).
+};
+
+// A grid mesh with its tessellation fixed at compile time.
+template <class Vertex, int LONGS, int LATS>
+struct FixedGridMesh
+{
+   Vertex vertices[gridNumVertices(LONGS, LATS)];
+   unsigned int indices[LATS][gridStripLength(LONGS)];
+   int counts[LATS];
+   void* offsets[LATS];
+};
+
+// Fill the vertex array of a grid mesh, row by row.
+template <class Vertex, class Sampler>
+void fillGridVertices(Vertex *vertices, int longs, int lats, const Sampler &sampler)
+{
+   for (int j = 0; j <= lats; j++)
+      for (int i = 0; i <= longs; i++) sampler(*vertices++, i, j);
+}
+
+// Fill the index arrays of the strips of a grid mesh.
+inline void fillGridIndices(unsigned int *indices, int longs, int lats)
+{
+   for (int j = 0; j < lats; j++)
+      for (int i = 0; i <= longs; i++)
+      {
+         *indices++ = (j + 1) * (longs + 1) + i;
+         *indices++ = j * (longs + 1) + i;
+      }
+}
+
+// Fill the array of counts of the strips of a grid mesh.
+inline void fillGridCounts(int *counts, int longs, int lats)
+{
+   for (int j = 0; j < lats; j++) counts[j] = gridStripLength(longs);
+}
+
+// Fill the array of buffer offsets of the strips of a grid mesh.
+inline void fillGridOffsets(void **offsets, int longs, int lats)
+{
+   for (int j = 0; j < lats; j++) offsets[j] = (void*)(gridStripLength(longs) * j * sizeof(unsigned int));
+}
+
+// Fill the single index stream of a grid mesh, its strips separated by restart indices.
+inline void fillGridRestartIndices(unsigned int *indices, int longs, int lats)
+{
+   for (int j = 0; j < lats; j++)
+   {
+      if (j > 0) *indices++ = MESH_RESTART_INDEX;
+      for (int i = 0; i <= longs; i++)
+      {
+         *indices++ = (j + 1) * (longs + 1) + i;
+         *indices++ = j * (longs + 1) + i;
+      }
+   }
+}
+
+// Fill the triangle list of a grid mesh, two triangles per cell with the winding of the
+// strips, in the strips' order.
+inline void fillGridTriangleIndices(unsigned int *indices, int longs, int lats)
+{
+   for (int j = 0; j < lats; j++)
+      for (int i = 0; i < longs; i++)
+      {
+         unsigned int lower = j * (longs + 1) + i, upper = lower + longs + 1;
+         *indices++ = upper; *indices++ = lower; *indices++ = upper + 1;
+         *indices++ = upper + 1; *indices++ = lower; *indices++ = lower + 1;
+      }
+}
+
+// Score of a vertex for optimizeVertexCache(), from its position in the modelled cache
+// (-1 if not in it) and its number of triangles not yet emitted.
+inline float vertexCacheScore(int position, int remaining)
+{
+   if (remaining == 0) return -1.0f;
+   float score = 0.0f;
+   if (position >= 0)
+      score = (position < 3) ? 0.75f : std::pow(1.0f - (position - 3) / (float)(MESH_CACHE_SIZE - 3), 1.5f);
+   return score + 2.0f / std::sqrt((float)remaining);
+}
+
+// Reorder a triangle list for a post-transform vertex cache, after Forsyth's linear-speed
+// vertex cache optimisation: each next triangle is the one of highest score among those
+// using vertices in a modelled LRU cache, a vertex scoring more the more recently it
+// was used and the fewer triangles it has left, so that vertices are finished off
+// before they leave the cache.
+inline void optimizeVertexCache(unsigned int *indices, int numIndices, int numVertices)
+{
+   int numTriangles = numIndices / 3;
+   std::vector<int> valence(numVertices, 0), firstTriangle(numVertices + 1, 0), vertexTriangles(numIndices);
+   for (int k = 0; k < numIndices; k++) valence[indices[k]]++;
+   for (int v = 0; v < numVertices; v++) firstTriangle[v + 1] = firstTriangle[v] + valence[v];
+   std::vector<int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+   for (int k = 0; k < numIndices; k++) vertexTriangles[fill[indices[k]]++] = k / 3;
+
+   std::vector<int> cache, newCache;
+   std::vector<float> vertexScore(numVertices), triangleScore(numTriangles, 0.0f);
+   std::vector<bool> added(numTriangles, false);
+   std::vector<unsigned int> output;
+   output.reserve(numIndices);
+
+   for (int v = 0; v < numVertices; v++) vertexScore[v] = vertexCacheScore(-1, valence[v]);
+   for (int t = 0; t < numTriangles; t++)
+      for (int c = 0; c < 3; c++) triangleScore[t] += vertexScore[indices[3 * t + c]];
+
+   int best = -1, nextUnadded = 0;
+   for (int k = 0; k < numTriangles; k++)
+   {
+      // Without a candidate from the cache, take the best of all remaining triangles.
+      if (best < 0)
+      {
+         float bestScore = -1.0f;
+         for (int t = nextUnadded; t < numTriangles; t++)
+            if (!added[t] && triangleScore[t] > bestScore) { bestScore = triangleScore[t]; best = t; }
+      }
+      added[best] = true;
+      while (nextUnadded < numTriangles && added[nextUnadded]) nextUnadded++;
+
+      // Emit the triangle, removing it from its vertices' lists, and move its vertices
+      // to the front of the cache.
+      newCache.clear();
+      for (int c = 0; c < 3; c++)
+      {
+         int v = indices[3 * best + c];
+         output.push_back(v);
+         int *list = &vertexTriangles[firstTriangle[v]];
+         for (int i = 0; i < valence[v]; i++)
+            if (list[i] == best) { list[i] = list[--valence[v]]; break; }
+         newCache.push_back(v);
+      }
+      for (int i = 0; i < (int)cache.size(); i++)
+         if (cache[i] != (int)output[output.size() - 3] && cache[i] != (int)output[output.size() - 2] &&
+             cache[i] != (int)output[output.size() - 1]) newCache.push_back(cache[i]);
+      cache.swap(newCache);
+
+      // Rescore the cached vertices and their triangles, and choose the best of these.
+      for (int i = 0; i < (int)cache.size(); i++)
+      {
+         int v = cache[i];
+         int position = (i < MESH_CACHE_SIZE) ? i : -1;
+         float score = vertexCacheScore(position, valence[v]);
+         float delta = score - vertexScore[v];
+         vertexScore[v] = score;
+         for (int j = 0; j < valence[v]; j++) triangleScore[vertexTriangles[firstTriangle[v] + j]] += delta;
+      }
+      best = -1;
+      float bestScore = -1.0f;
+      for (int i = 0; i < (int)cache.size() && i < MESH_CACHE_SIZE; i++)
+      {
+         int v = cache[i];
+         for (int j = 0; j < valence[v]; j++)
+         {
+            int t = vertexTriangles[firstTriangle[v] + j];
+            if (triangleScore[t] > bestScore) { bestScore = triangleScore[t]; best = t; }
+         }
+      }
+      if (cache.size() > MESH_CACHE_SIZE) cache.resize(MESH_CACHE_SIZE);
+   }
+   std::copy(output.begin(), output.end(), indices);
+}
+
+// Fill the indices of a grid mesh whose tessellation is set in the given layout.
+template <class Vertex>
+void fillGridMeshIndices(GridMesh<Vertex> &mesh, int layout)
+{
+   int longs = mesh.longs, lats = mesh.lats;
+   mesh.layout = layout;
+   mesh.counts.clear();
+   mesh.offsets.clear();
+   if (layout == MESH_RESTART)
+   {
+      mesh.indices.resize(gridNumRestartIndices(longs, lats));
+      fillGridRestartIndices(&mesh.indices[0], longs, lats);
+   }
+   else if (layout == MESH_TRIANGLES)
+   {
+      mesh.indices.resize(gridNumTriangleIndices(longs, lats));
+      fillGridTriangleIndices(&mesh.indices[0], longs, lats);
+      // Larger meshes keep grid order: their reordering would take seconds.
+      if (mesh.vertices.size() <= MESH_REORDER_VERTICES)
+         optimizeVertexCache(&mesh.indices[0], (int)mesh.indices.size(), (int)mesh.vertices.size());
+   }
+   else
+   {
+      mesh.indices.resize(gridNumIndices(longs, lats));
+      mesh.counts.resize(lats);
+      mesh.offsets.resize(lats);
+      fillGridIndices(&mesh.indices[0], longs, lats);
+      fillGridCounts(&mesh.counts[0], longs, lats);
+      fillGridOffsets(&mesh.offsets[0], longs, lats);
+   }
+}
+
+// Build a grid mesh of the given tessellation and layout.
+template <class Vertex, class Sampler>
+void buildGridMesh(GridMesh<Vertex> &mesh, int longs, int lats, const Sampler &sampler, int layout = MESH_STRIPS)
+{
+   mesh.longs = longs;
+   mesh.lats = lats;
+   mesh.vertices.resize(gridNumVertices(longs, lats));
+   fillGridVertices(&mesh.vertices[0], longs, lats, sampler);
+   fillGridMeshIndices(mesh, layout);
+}
+
+// Build a grid mesh of fixed tessellation.
+template <class Vertex, int LONGS, int LATS, class Sampler>
+void buildGridMesh(FixedGridMesh<Vertex, LONGS, LATS> &mesh, const Sampler &sampler)
+{
+   fillGridVertices(mesh.vertices, LONGS, LATS, sampler);
+   fillGridIndices(&mesh.indices[0][0], LONGS, LATS);
+   fillGridCounts(mesh.counts, LONGS, LATS);
+   fillGridOffsets(mesh.offsets, LONGS, LATS);
+}
+
+// Fill the vertex array of a curve of segs segments, the sampler setting the vertex
+// at sample point k, 0 <= k <= segs.
+template <class Vertex, class Sampler>
+void fillCurveVertices(Vertex *vertices, int segs, const Sampler &sampler)
+{
+   for (int k = 0; k <= segs; k++) sampler(vertices[k], k);
+}
+
+// Build the vertices of a curve of the given number of segments.
+template <class Vertex, class Sampler>
+void buildCurve(std::vector<Vertex> &vertices, int segs, const Sampler &sampler)
+{
+   vertices.resize(segs + 1);
+   fillCurveVertices(&vertices[0], segs, sampler);
+}
+
+// Table of the angles start + k * step, 0 <= k <= n, with their cosines and sines.
+struct AngleTable
+{
+   std::vector<float> angles;
+   std::vector<float> cosines;
+   std::vector<float> sines;
+
+   AngleTable(int n, double start, double step) : angles(n + 1), cosines(n + 1), sines(n + 1)
+   {
+      for (int k = 0; k <= n; k++)
+      {
+         angles[k] = (float)(start + k * step);
+         cosines[k] = (float)cos(start + k * step);
+         sines[k] = (float)sin(start + k * step);
+      }
+   }
+};
+
+// Parametric surfaces.
+//
+// A parametric surface is a function object with members longAngles and latAngles,
+// AngleTables of the grid's longitudinal angles u_i, 0 <= i <= longs, and latitudinal
+// angles v_j, 0 <= j <= lats, and two member functions:
+//
+//    template <class T>
+//    void operator()(SurfacePoint<T> &point, const SurfaceAngle<T> &u, const SurfaceAngle<float> &v) const;
+//
+// sets the position, and normal if the surface has one, at angles u and v, where T is
+// float for one point or SurfaceLanes for SURFACE_LANES consecutive points of a row,
+// so the function must be written with arithmetic common to the two; and
+//
+//    void store(Vertex &vertex, const SurfacePoint<float> &point) const;
+//
+// copies what the vertex needs of the point, which comes with texture co-ordinates
+// (i/longs, j/lats), into the vertex.
+//
+// SurfaceLanes are the 8 float lanes of an AVX register if the compiler targets AVX or
+// AVX2 (e.g., with -mavx2 or -march=native, or /arch:AVX2 in Visual Studio), otherwise
+// they are a single float. The choice cannot be made at run time, as getbmp.cpp does
+// for its kernels, because operator() is the caller's template, which would have to
+// be compiled for AVX too.
+
+#if defined(__AVX__)
+#define SURFACE_LANES 8
+
+struct SurfaceLanes
+{
+   __m256 value;
+
+   SurfaceLanes() {}
+   SurfaceLanes(float x) : value(_mm256_set1_ps(x)) {}
+   SurfaceLanes(__m256 x) : value(x) {}
+
+   friend SurfaceLanes operator+(const SurfaceLanes &a, const SurfaceLanes &b) { return _mm256_add_ps(a.value, b.value); }
+   friend SurfaceLanes operator-(const SurfaceLanes &a, const SurfaceLanes &b) { return _mm256_sub_ps(a.value, b.value); }
+   friend SurfaceLanes operator*(const SurfaceLanes &a, const SurfaceLanes &b) { return _mm256_mul_ps(a.value, b.value); }
+   friend SurfaceLanes operator/(const SurfaceLanes &a, const SurfaceLanes &b) { return _mm256_div_ps(a.value, b.value); }
+   friend SurfaceLanes operator-(const SurfaceLanes &a) { return _mm256_sub_ps(_mm256_setzero_ps(), a.value); }
+   friend SurfaceLanes sqrt(const SurfaceLanes &a) { return _mm256_sqrt_ps(a.value); }
+};
+
+inline SurfaceLanes loadSurfaceLanes(const float *x) { return _mm256_loadu_ps(x); }
+inline void storeSurfaceLanes(float *x, const SurfaceLanes &a) { _mm256_storeu_ps(x, a.value); }
+#else
+#define SURFACE_LANES 1
+
+typedef float SurfaceLanes;
+
+inline SurfaceLanes loadSurfaceLanes(const float *x) { return *x; }
+inline void storeSurfaceLanes(float *x, const SurfaceLanes &a) { *x = a; }
+#endif
+
+// An angle with its cosine and sine.
+template <class T>
+struct SurfaceAngle
+{
+   T angle, cosine, sine;
+};
+
+// A point of a parametric surface with its normal, zero if the surface sets none, and
+// texture co-ordinates.
+template <class T>
+struct SurfacePoint
+{
+   T x, y, z;
+   T nx, ny, nz;
+   T s, t;
+
+   SurfacePoint() : nx(0.0f), ny(0.0f), nz(0.0f) {}
+};
+
+// Number of threads to fill a grid of the given number of vertices.
+inline int surfaceThreads(int numVertices)
+{
+   static int hardwareThreads = std::max(1, (int)std::thread::hardware_concurrency());
+   return std::max(1, std::min(hardwareThreads, numVertices / SURFACE_THREAD_VERTICES));
+}
+
+// Fill the vertices of rows firstRow to lastRow - 1 of a parametric surface.
+template <class Vertex, class Surface>
+void fillSurfaceRows(Vertex *vertices, int longs, int firstRow, int lastRow, const Surface &surface)
+{
+   const AngleTable &us = surface.longAngles, &vs = surface.latAngles;
+   int lats = (int)vs.angles.size() - 1;
+   float lanes[7][SURFACE_LANES], firstLanes[SURFACE_LANES];
+   for (int k = 0; k < SURFACE_LANES; k++) firstLanes[k] = (float)k;
+   SurfaceLanes laneNumbers = loadSurfaceLanes(firstLanes);
+
+   for (int j = firstRow; j < lastRow; j++)
+   {
+      SurfaceAngle<float> v = { vs.angles[j], vs.cosines[j], vs.sines[j] };
+      float t = (float)j / lats;
+      Vertex *row = vertices + j * (longs + 1);
+      int i = 0;
+
+      // Whole groups of lanes, evaluated together and stored one by one...
+      for (; i + SURFACE_LANES <= longs + 1; i += SURFACE_LANES)
+      {
+         SurfaceAngle<SurfaceLanes> u = { loadSurfaceLanes(&us.angles[i]), loadSurfaceLanes(&us.cosines[i]),
+                                          loadSurfaceLanes(&us.sines[i]) };
+         SurfacePoint<SurfaceLanes> point;
+         surface(point, u, v);
+         storeSurfaceLanes(lanes[0], point.x);
+         storeSurfaceLanes(lanes[1], point.y);
+         storeSurfaceLanes(lanes[2], point.z);
+         storeSurfaceLanes(lanes[3], point.nx);
+         storeSurfaceLanes(lanes[4], point.ny);
+         storeSurfaceLanes(lanes[5], point.nz);
+         storeSurfaceLanes(lanes[6], (SurfaceLanes((float)i) + laneNumbers) / SurfaceLanes((float)longs));
+         for (int k = 0; k < SURFACE_LANES; k++)
+         {
+            SurfacePoint<float> lane;
+            lane.x = lanes[0][k]; lane.y = lanes[1][k]; lane.z = lanes[2][k];
+            lane.nx = lanes[3][k]; lane.ny = lanes[4][k]; lane.nz = lanes[5][k];
+            lane.s = lanes[6][k]; lane.t = t;
+            surface.store(row[i + k], lane);
+         }
+      }
+
+      // ...then the rest of the row one at a time.
+      for (; i <= longs; i++)
+      {
+         SurfaceAngle<float> u = { us.angles[i], us.cosines[i], us.sines[i] };
+         SurfacePoint<float> point;
+         surface(point, u, v);
+         point.s = (float)i / longs;
+         point.t = t;
+         surface.store(row[i], point);
+      }
+   }
+}
+
+// Fill the vertex array of a parametric surface, row by row, large grids split into
+// bands of rows filled by concurrent threads.
+template <class Vertex, class Surface>
+void fillSurfaceVertices(Vertex *vertices, int longs, int lats, const Surface &surface)
+{
+   int numThreads = std::min(surfaceThreads(gridNumVertices(longs, lats)), lats + 1);
+
+   std::vector<std::thread> threads;
+   for (int t = 1; t < numThreads; t++)
+      threads.push_back(std::thread(fillSurfaceRows<Vertex, Surface>, vertices, longs, 
+                                    t * (lats + 1) / numThreads, (t + 1) * (lats + 1) / numThreads, std::cref(surface)));
+   fillSurfaceRows(vertices, longs, 0, (lats + 1) / numThreads, surface);
+   for (int t = 0; t < (int)threads.size(); t++) threads[t].join();
+}
+
+// Build a grid mesh of a parametric surface of the given tessellation and layout.
+template <class Vertex, class Surface>
+void buildSurfaceMesh(GridMesh<Vertex> &mesh, int longs, int lats, const Surface &surface, int layout = MESH_STRIPS)
+{
+   mesh.longs = longs;
+   mesh.lats = lats;
+   mesh.vertices.resize(gridNumVertices(longs, lats));
+   fillSurfaceVertices(&mesh.vertices[0], longs, lats, surface);
+   fillGridMeshIndices(mesh, layout);
+}
+
+#endif
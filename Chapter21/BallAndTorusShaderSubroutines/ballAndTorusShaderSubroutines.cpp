@@ -67,8 +67,6 @@ static mat4 projMat = mat4(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    hemColorLoc,
@@ -78,20 +76,38 @@ static unsigned int
    buffer[4], 
    vao[2]; 
 
+// Routine to obtain uniform locations and set values, once the program is linked.
+void setupUniforms(void)
+{
+   glUseProgram(programId); 
+
+   // Obtain projection matrix uniform location and set value.
+   projMatLoc = glGetUniformLocation(programId,"projMat"); 
+   projMat = frustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0); 
+   glUniformMatrix4fv(projMatLoc, 1, GL_FALSE, value_ptr(projMat));
+
+   // Obtain color uniform locations and set values.
+   hemColorLoc = glGetUniformLocation(programId, "hemColor");
+   glUniform4fv(hemColorLoc, 1, &hemColors[0]);
+   torColorLoc = glGetUniformLocation(programId, "torColor");
+   glUniform4fv(torColorLoc, 1, &torColors[0]);
+
+   // Obtain modelview matrix uniform locations.
+   modelViewMatLoc = glGetUniformLocation(programId,"modelViewMat"); 
+
+   // Obtain shader subroutine indices.
+   hemSubroutineIndex = glGetSubroutineIndex(programId, GL_VERTEX_SHADER, "hemisphere");
+   torSubroutineIndex = glGetSubroutineIndex(programId, GL_VERTEX_SHADER, "torus");
+}
+
 // Initialization routine.
 void setup(void) 
 {
    glClearColor(1.0, 1.0, 1.0, 0.0); 
    glEnable(GL_DEPTH_TEST);
 
-   // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId);    
-   glLinkProgram(programId); 
-   glUseProgram(programId); 
+   // Submit shader program executable, to compile while the rest is set up.
+   programId = startProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
 
    // Initialize hemishpere and torus.
    fillHemisphere(hemVertices, hemIndices, hemCounts, hemOffsets);
@@ -119,32 +135,30 @@ void setup(void)
    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(torVertices[0]), 0);
    glEnableVertexAttribArray(1);
 
-   // Obtain projection matrix uniform location and set value.
-   projMatLoc = glGetUniformLocation(programId,"projMat"); 
-   projMat = frustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0); 
-   glUniformMatrix4fv(projMatLoc, 1, GL_FALSE, value_ptr(projMat));
-
-   // Obtain color uniform locations and set values.
-   hemColorLoc = glGetUniformLocation(programId, "hemColor");
-   glUniform4fv(hemColorLoc, 1, &hemColors[0]);
-   torColorLoc = glGetUniformLocation(programId, "torColor");
-   glUniform4fv(torColorLoc, 1, &torColors[0]);
-
-   // Obtain modelview matrix uniform locations.
-   modelViewMatLoc = glGetUniformLocation(programId,"modelViewMat"); 
-
-   // Obtain shader subroutine indices.
-   hemSubroutineIndex = glGetSubroutineIndex(programId, GL_VERTEX_SHADER, "hemisphere");
-   torSubroutineIndex = glGetSubroutineIndex(programId, GL_VERTEX_SHADER, "torus");
-
    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 }
 
 // Drawing routine.
 void drawScene(void)
 {
+   static bool programReady = false;
+
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+   // Until the program is compiled and linked, keep redrawing the empty window.
+   if (!programReady)
+   {
+      programReady = isProgramReady(programId);
+      if (!programReady)
+      {
+         glutSwapBuffers();
+         glutPostRedisplay();
+         return;
+      }
+      printProgramTimes();
+      setupUniforms();
+   }
+
    // Calculate and update modelview matrix.
    modelViewMat = mat4(1.0);
    modelViewMat = translate(modelViewMat, vec3(0.0, 0.0, -25.0));
@@ -2,6 +2,7 @@
 #define TORUS_H
 
 #include "vertex.h"
+#include "meshBuilder.h"
 
 #define PI 3.14159265
 #define TOR_OUTRAD 12.0 // Torus outer radius.
@@ -19,4 +20,7 @@ void fillTorus(Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)],
 	         unsigned int torIndices[TOR_LATS][2*(TOR_LONGS+1)],
 			 int torCounts[TOR_LATS],
 			 void* torOffsets[TOR_LATS]);
+
+void buildTorus(GridMesh<Vertex> &mesh, int longs, int lats, int layout = MESH_STRIPS);
+
 #endif
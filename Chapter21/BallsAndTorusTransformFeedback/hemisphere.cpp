@@ -16,49 +16,45 @@
 
 using namespace std;
 
+// Sample point (i, j) of the hemisphere is at longitudinal angle 2PI i/longs about the
+// y-axis and latitudinal angle (PI/2)j/lats above the xz-plane.
+struct HemisphereSampler
+{
+   AngleTable longAngles, latAngles;
+
+   HemisphereSampler(int longs, int lats) : longAngles(longs, 0.0, 2.0 * PI / longs), latAngles(lats, 0.0, PI / 2.0 / lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      vertex.coords.x = HEM_RADIUS * latAngles.cosines[j] * longAngles.cosines[i];
+      vertex.coords.y = HEM_RADIUS * latAngles.sines[j];
+      vertex.coords.z = HEM_RADIUS * latAngles.cosines[j] * longAngles.sines[i];
+      vertex.coords.w = 1.0;
+   }
+};
+
 // Fill the vertex array with co-ordinates of the sample points.
 void fillHemVertexArray(Vertex hemVertices[(HEM_LONGS + 1) * (HEM_LATS + 1)])
 {
-   int i, j, k;
-
-   k = 0;
-   for (j = 0; j <= HEM_LATS; j++)
-      for (i = 0; i <= HEM_LONGS; i++)
-      {
-         hemVertices[k].coords.x = HEM_RADIUS * cos( (float)j/HEM_LATS * PI/2.0 ) * cos( 2.0 * (float)i/HEM_LONGS * PI );
-         hemVertices[k].coords.y = HEM_RADIUS * sin( (float)j/HEM_LATS * PI/2.0 );
-         hemVertices[k].coords.z = HEM_RADIUS * cos( (float)j/HEM_LATS * PI/2.0 ) * sin( 2.0 * (float)i/HEM_LONGS * PI );
-		 hemVertices[k].coords.w = 1.0;
-		 k++;
-	  }
+   fillGridVertices(hemVertices, HEM_LONGS, HEM_LATS, HemisphereSampler(HEM_LONGS, HEM_LATS));
 }
 
 // Fill the array of index arrays.
 void fillHemIndices(unsigned int hemIndices[HEM_LATS][2*(HEM_LONGS+1)])
 {
-   int i, j;
-   for(j = 0; j < HEM_LATS; j++)
-   {
-      for (i = 0; i <= HEM_LONGS; i++)
-      {
-	     hemIndices[j][2*i] = (j+1)*(HEM_LONGS + 1) + i;
-	     hemIndices[j][2*i+1] = j*(HEM_LONGS + 1) + i;
-      }
-   }
+   fillGridIndices(&hemIndices[0][0], HEM_LONGS, HEM_LATS);
 }
 
 // Fill the array of counts.
 void fillHemCounts(int hemCounts[HEM_LATS])
 {
-   int j;
-   for(j = 0; j < HEM_LATS; j++) hemCounts[j] = 2*(HEM_LONGS + 1);
+   fillGridCounts(hemCounts, HEM_LONGS, HEM_LATS);
 }
 
 // Fill the array of buffer offsets.
 void fillHemOffsets(void* hemOffsets[HEM_LATS])
 {
-   int j;
-   for(j = 0; j < HEM_LATS; j++) hemOffsets[j] = (GLvoid*)(2*(HEM_LONGS+1)*j*sizeof(unsigned int));
+   fillGridOffsets(hemOffsets, HEM_LONGS, HEM_LATS);
 }
 
 // Initialize the hemisphere.
@@ -72,3 +68,10 @@ void fillHemisphere(Vertex hemVertices[(HEM_LONGS + 1) * (HEM_LATS + 1)],
    fillHemCounts(hemCounts);
    fillHemOffsets(hemOffsets);
 }
+
+// Build the hemisphere with the given numbers of longitudinal and latitudinal slices
+// and index layout (see meshBuilder.h).
+void buildHemisphere(GridMesh<Vertex> &mesh, int longs, int lats, int layout)
+{
+   buildGridMesh(mesh, longs, lats, HemisphereSampler(longs, lats), layout);
+}
@@ -2,6 +2,7 @@
 #define HEMISPHERE_H
 
 #include "vertex.h"
+#include "meshBuilder.h"
 
 #define PI 3.14159265
 #define HEM_RADIUS 2.0 // Hemisphere radius.
@@ -19,4 +20,6 @@ void fillHemisphere(Vertex hemVertices[(HEM_LONGS + 1) * (HEM_LATS + 1)],
 			 int hemCounts[HEM_LATS],
 			 void* hemOffsets[HEM_LATS]);
 
+void buildHemisphere(GridMesh<Vertex> &mesh, int longs, int lats, int layout = MESH_STRIPS);
+
 #endif
\ No newline at end of file
@@ -12,6 +12,7 @@
 //////////////////////////////////////////////////////////////////////////// 
 
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 
@@ -96,8 +97,6 @@ static mat3 normalMat = mat3(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    normalMatLoc,
@@ -123,12 +122,7 @@ void setup(void)
    glEnable(GL_DEPTH_TEST);
 
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId); 
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId); 
 
    // Create VAOs and VBOs... 
@@ -193,6 +187,7 @@ void setup(void)
    image[0] = getbmp("../../Textures/grass.bmp"); 
    image[1] = getbmp("../../Textures/sky.bmp"); 
    image[2] = getbmp("../../Textures/nightSky.bmp"); 
+   if (image[0] == NULL || image[1] == NULL || image[2] == NULL) exit(1); // getbmp() has printed why.
 
    // Create texture ids.
    glGenTextures(3, texture);
@@ -232,6 +227,13 @@ void setup(void)
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
    nightSkyTexLoc = glGetUniformLocation(programId, "nightSkyTex");
    glUniform1i(nightSkyTexLoc, 2);
+
+   // OpenGL has its own copy of the images now.
+   for (int i = 0; i < 3; i++)
+   {
+      delete[] image[i]->data;
+      delete image[i];
+   }
 }
 
 // Drawing routine.
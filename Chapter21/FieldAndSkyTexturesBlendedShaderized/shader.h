@@ -1,6 +1,12 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#define SHADER_CACHE_DIR "shaderCache/" // Directory of cached program binaries.
+
 int setShader(char* shaderType, char* shaderFile);
+int setProgram(char* shaderType, char* shaderFile, ...);
+int startProgram(char* shaderType, char* shaderFile, ...);
+bool isProgramReady(int programId);
+void printProgramTimes(void);
 
-#endif
\ No newline at end of file
+#endif
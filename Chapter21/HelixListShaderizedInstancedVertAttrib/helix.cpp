@@ -16,20 +16,28 @@
 
 using namespace std;
 
+// Sample point k of a helix of segs segments is at parameter
+// t = (-1 + 2k/segs) * HEL_HALF_TURNS * PI.
+struct HelixSampler
+{
+   AngleTable angles;
+   int segs;
+
+   HelixSampler(int segs) : angles(segs, -HEL_HALF_TURNS * PI, 2.0 * HEL_HALF_TURNS * PI / segs), segs(segs) {}
+
+   void operator()(Vertex &vertex, int k) const
+   {
+      vertex.coords.x = 2 * HEL_HALF_TURNS * angles.cosines[k];
+      vertex.coords.y = 2 * HEL_HALF_TURNS * angles.sines[k];
+      vertex.coords.z = (-1 + 2*(float)k/segs) * HEL_HALF_TURNS * PI;
+      vertex.coords.w = 1.0;
+   }
+};
+
 // Fill the vertex array with co-ordinates of the sample points.
 void fillHelVertexArray(Vertex helVertices[HEL_SEGS+1])
 {
-   float t;
-   int k = 0;
-
-   for(t = -1.0 * HEL_HALF_TURNS * PI; t <= HEL_HALF_TURNS * PI; t += (2 * HEL_HALF_TURNS * PI)/HEL_SEGS)
-      {
-         helVertices[k].coords.x = 2 * HEL_HALF_TURNS * cos(t);
-         helVertices[k].coords.y = 2 * HEL_HALF_TURNS * sin(t);
-         helVertices[k].coords.z = t;
-		 helVertices[k].coords.w = 1.0;
-		 k++;
-	  }
+   fillCurveVertices(helVertices, HEL_SEGS, HelixSampler(HEL_SEGS));
 }
 
 // Initialize the helix.
@@ -37,3 +45,9 @@ void fillHelix(Vertex helVertices[HEL_SEGS+1])
 {
    fillHelVertexArray(helVertices);
 }
+
+// Build the helix with the given number of line segments.
+void buildHelix(vector<Vertex> &helVertices, int segs)
+{
+   buildCurve(helVertices, segs, HelixSampler(segs));
+}
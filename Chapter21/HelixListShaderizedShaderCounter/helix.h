@@ -2,6 +2,7 @@
 #define HELIX_H
 
 #include "vertex.h"
+#include "meshBuilder.h"
 
 #define PI 3.14159265
 #define HEL_HALF_TURNS 10 // Half the number of turns in the helix.
@@ -11,4 +12,6 @@ void fillHelVertexArray(Vertex helVertices[HEL_SEGS+1]);
 
 void fillHelix(Vertex helVertices[HEL_SEGS+1]);
 
+void buildHelix(std::vector<Vertex> &helVertices, int segs);
+
 #endif
\ No newline at end of file
@@ -13,6 +13,7 @@
 // Texture Credits: See ExperimenterSource/Textures/TEXTURE_CREDITS.txt
 ///////////////////////////////////////////////////////////////////////
 
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 
@@ -55,8 +56,6 @@ static mat4 projMat = mat4(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    pointSetColorLoc,
@@ -78,12 +77,7 @@ void setup(void)
    glClearColor(1.0, 1.0, 1.0, 0.0);
 
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId);    
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId); 
 
    // Create VAOs and VBOs... 
@@ -113,6 +107,7 @@ void setup(void)
 
    // Load the images.
    image[0] = getbmp("../../Textures/star.bmp"); 
+   if (image[0] == NULL) exit(1); // getbmp() has printed why.
 
    // Create texture ids.
    glGenTextures(1, texture);
@@ -129,6 +124,10 @@ void setup(void)
    starTexLoc = glGetUniformLocation(programId, "starTex");
    glUniform1i(starTexLoc, 0);
 
+   // OpenGL has its own copy of the image now.
+   delete[] image[0]->data;
+   delete image[0];
+
    // Enable shader control of point size.
    glEnable(GL_PROGRAM_POINT_SIZE);
 
@@ -48,11 +48,8 @@ static Vertex inputPointSetVertices[3] =
 };
 
 static unsigned int
-   programId,
-   vertexShaderId,
-   tessControlShaderId,
-   tessEvaluationShaderId,
-   fragmentShaderId,
+   curveProgramId,
+   pointsProgramId,
    tessLevelOuter1Loc,
    buffer[1], 
    vao[1],
@@ -65,16 +62,11 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0); 
 
-   // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   tessControlShaderId = setShader("tessControl", "tessControlShader.glsl");
-   tessEvaluationShaderId = setShader("tessEvaluation", "tessEvaluationShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, fragmentShaderId);
-   glLinkProgram(programId); 
-   glUseProgram(programId); 
+   // Submit the shader program executables, with and without the TCS and TES, 
+   // to compile together while the rest is set up.
+   curveProgramId = startProgram("vertex", "vertexShader.glsl", "tessControl", "tessControlShader.glsl",
+                                 "tessEvaluation", "tessEvaluationShader.glsl", "fragment", "fragmentShader.glsl", NULL);
+   pointsProgramId = startProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
 
    // Create VAOs and VBOs... 
    glGenVertexArrays(1, vao);
@@ -87,9 +79,6 @@ void setup(void)
    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(inputPointSetVertices[0]), 0);
    glEnableVertexAttribArray(0);
 
-   // Set value of gl_TessLevelOuter[1] in TCS.
-   tessLevelOuter1Loc = glGetUniformLocation(programId, "tessLevelOuter1");
-
    // Point size.
    glPointSize(5.0); 
 
@@ -100,24 +89,33 @@ void setup(void)
 // Drawing routine.
 void drawScene(void)
 {
+   static bool programsReady = false;
+
    glClear(GL_COLOR_BUFFER_BIT);
 
-   // Attach TCS and TES...
-   glAttachShader(programId, tessControlShaderId); 
-   glAttachShader(programId, tessEvaluationShaderId);  
-   glLinkProgram(programId); 
+   // Until both programs are compiled and linked, keep redrawing the empty window.
+   if (!programsReady)
+   {
+      programsReady = isProgramReady(curveProgramId) & isProgramReady(pointsProgramId);
+      if (!programsReady)
+      {
+         glFlush();
+         glutPostRedisplay();
+         return;
+      }
+      printProgramTimes();
+
+      // Location of the value of gl_TessLevelOuter[1] in TCS.
+      tessLevelOuter1Loc = glGetUniformLocation(curveProgramId, "tessLevelOuter1");
+   }
 
-   // ...and draw Bezier curve.
-   tessLevelOuter1Loc = glGetUniformLocation(programId, "tessLevelOuter1");   
+   // Draw Bezier curve with the TCS and TES...
+   glUseProgram(curveProgramId);
    glUniform1f(tessLevelOuter1Loc, tessLevelOuter1);
    glDrawArrays(GL_PATCHES, 0, 3);
 
-   // Detach TCS and TES...
-   glDetachShader(programId, tessControlShaderId); 
-   glDetachShader(programId, tessEvaluationShaderId);
-   glLinkProgram(programId); 
-
-   // ...and draw points.
+   // ...and points without.
+   glUseProgram(pointsProgramId);
    glDrawArrays(GL_POINTS, 0, 3);
    
    glFlush();
@@ -55,9 +55,6 @@ static mat4 projMat = mat4(1.0);
 
 static unsigned int
    programId,
-   vertexShaderId,
-   tessEvaluationShaderId,
-   fragmentShaderId,
    modelViewMatLoc,
    projMatLoc,
    hemRadiusLoc,
@@ -71,14 +68,7 @@ void setup(void)
    glEnable(GL_DEPTH_TEST);
 
    // Create shader program executable.
-   vertexShaderId = setShader("vertex", "vertexShader.glsl");
-   tessEvaluationShaderId = setShader("tessEvaluation", "tessEvaluationShader.glsl");
-   fragmentShaderId = setShader("fragment", "fragmentShader.glsl");
-   programId = glCreateProgram(); 
-   glAttachShader(programId, vertexShaderId); 
-   glAttachShader(programId, tessEvaluationShaderId);
-   glAttachShader(programId, fragmentShaderId);
-   glLinkProgram(programId); 
+   programId = setProgram("vertex", "vertexShader.glsl", "tessEvaluation", "tessEvaluationShader.glsl", "fragment", "fragmentShader.glsl", NULL);
    glUseProgram(programId); 
 
    // Create VAOs and VBOs... 
@@ -1,6 +1,18 @@
 #include <cstdlib>
+#include <cstdarg>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#  include <direct.h>
+#else
+#  include <sys/stat.h>
+#endif
 
 #ifdef __APPLE__
 #  include <GL/glew.h>
@@ -13,40 +25,352 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "shader.h"
+
 using namespace std;
 
-// Function to read text file.
+// Function to read text file. Returns NULL if the file cannot be read.
 char* readTextFile(char* aTextFile)
 {
    FILE* filePointer = fopen(aTextFile, "rb");	
    char* content = NULL;
    long numVal = 0;
 
+   if (filePointer == NULL)
+   {
+      cout << "Cannot read shader file " << aTextFile << endl;
+      return NULL;
+   }
    fseek(filePointer, 0L, SEEK_END);
    numVal = ftell(filePointer);
    fseek(filePointer, 0L, SEEK_SET);
    content = (char*) malloc((numVal+1) * sizeof(char)); 
-   fread(content, 1, numVal, filePointer);
+   numVal = (long)fread(content, 1, numVal, filePointer);
    content[numVal] = '\0';
    fclose(filePointer);
    return content;
 }
 
+// Shader stage of a shader type name, or 0 if the name is unknown.
+static GLenum shaderStage(char* shaderType)
+{
+   if (strcmp(shaderType, "vertex") == 0) return GL_VERTEX_SHADER; 
+   if (strcmp(shaderType, "tessControl") == 0) return GL_TESS_CONTROL_SHADER;    
+   if (strcmp(shaderType, "tessEvaluation") == 0) return GL_TESS_EVALUATION_SHADER; 
+   if (strcmp(shaderType, "geometry") == 0) return GL_GEOMETRY_SHADER; 
+   if (strcmp(shaderType, "fragment") == 0) return GL_FRAGMENT_SHADER; 
+   if (strcmp(shaderType, "compute") == 0) return GL_COMPUTE_SHADER; 
+   return 0;
+}
+
+// Compile a shader of the given type from source, printing the info log if it fails.
+static int compileShader(char* shaderType, char* shaderFile, const char* shader)
+{
+   int status;
+   GLenum stage = shaderStage(shaderType);
+   int shaderId = (stage != 0) ? glCreateShader(stage) : 0;
+   if (shaderId == 0)
+   {
+      cout << "Unknown shader type " << shaderType << " for " << shaderFile << endl;
+      return 0;
+   }
+
+   glShaderSource(shaderId, 1, &shader, NULL); 
+   glCompileShader(shaderId); 
+
+   glGetShaderiv(shaderId, GL_COMPILE_STATUS, &status);
+   if (!status)
+   {
+      char log[4096];
+      glGetShaderInfoLog(shaderId, sizeof(log), NULL, log);
+      cout << "Cannot compile " << shaderFile << ":" << endl << log << endl;
+   }
+   return shaderId;
+}
+
 // Function to initialize shaders.
 int setShader(char* shaderType, char* shaderFile)
 {
-   int shaderId;
    char* shader = readTextFile(shaderFile);
-   
-   if (shaderType == "vertex") shaderId = glCreateShader(GL_VERTEX_SHADER); 
-   if (shaderType == "tessControl") shaderId = glCreateShader(GL_TESS_CONTROL_SHADER);    
-   if (shaderType == "tessEvaluation") shaderId = glCreateShader(GL_TESS_EVALUATION_SHADER); 
-   if (shaderType == "geometry") shaderId = glCreateShader(GL_GEOMETRY_SHADER); 
-   if (shaderType == "fragment") shaderId = glCreateShader(GL_FRAGMENT_SHADER); 
-
-   glShaderSource(shaderId, 1, (const char**) &shader, NULL); 
-   glCompileShader(shaderId); 
-
+   if (shader == NULL) return 0;
+   int shaderId = compileShader(shaderType, shaderFile, shader);
+   free(shader);
    return shaderId;
 }
 
+// Header of a cached program binary file, followed by the binary.
+struct ProgramCacheHeader
+{
+   char magic[4]; // "CGPB"
+   int binaryFormat;
+   int binarySize;
+   int reserved;
+   unsigned long long key; // Hash of the sources and driver the binary was built from.
+};
+
+// 64-bit FNV-1a hash of a string, continuing from the given hash.
+static unsigned long long hashString(unsigned long long hash, const char* s)
+{
+   for (; *s != '\0'; s++) hash = (hash ^ (unsigned char)*s) * 1099511628211ULL;
+   return (hash ^ 0xFF) * 1099511628211ULL; // Separate consecutive strings.
+}
+
+// Load a program from a cached binary. Returns 0 if there is none or the driver rejects it.
+static int loadProgramBinary(string cacheFilename, unsigned long long key)
+{
+   FILE* in = fopen(cacheFilename.c_str(), "rb");
+   if (in == NULL) return 0;
+
+   ProgramCacheHeader header;
+   vector<char> binary;
+   if (fread(&header, sizeof(ProgramCacheHeader), 1, in) == 1 && memcmp(header.magic, "CGPB", 4) == 0 &&
+       header.key == key && header.binarySize > 0)
+   {
+      binary.resize(header.binarySize);
+      if (fread(&binary[0], 1, header.binarySize, in) != (size_t)header.binarySize) binary.clear();
+   }
+   fclose(in);
+   if (binary.empty()) return 0;
+
+   int programId = glCreateProgram(), status;
+   glProgramBinary(programId, header.binaryFormat, &binary[0], header.binarySize);
+   glGetProgramiv(programId, GL_LINK_STATUS, &status);
+   if (!status)
+   {
+      glDeleteProgram(programId);
+      return 0;
+   }
+   return programId;
+}
+
+// Store the binary of a linked program in the cache, through a temporary file renamed
+// into place so that a partial file is never read.
+static void saveProgramBinary(int programId, string cacheFilename, unsigned long long key)
+{
+   int binarySize = 0;
+   glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+   if (binarySize <= 0) return;
+
+   ProgramCacheHeader header;
+   vector<char> binary(binarySize);
+   GLenum binaryFormat;
+   glGetProgramBinary(programId, binarySize, &binarySize, &binaryFormat, &binary[0]);
+   memcpy(header.magic, "CGPB", 4);
+   header.binaryFormat = binaryFormat;
+   header.binarySize = binarySize;
+   header.reserved = 0;
+   header.key = key;
+
+#ifdef _WIN32
+   _mkdir(SHADER_CACHE_DIR);
+#else
+   mkdir(SHADER_CACHE_DIR, 0755);
+#endif
+   string tempFilename = cacheFilename + ".tmp";
+   FILE* out = fopen(tempFilename.c_str(), "wb");
+   if (out == NULL) return;
+   bool written = fwrite(&header, sizeof(ProgramCacheHeader), 1, out) == 1 &&
+                  fwrite(&binary[0], 1, binarySize, out) == (size_t)binarySize;
+   written = (fclose(out) == 0) && written;
+   remove(cacheFilename.c_str());
+   if (!written || rename(tempFilename.c_str(), cacheFilename.c_str()) != 0) remove(tempFilename.c_str());
+}
+
+// A program submitted by startProgram() and not yet known to be ready, or ready and
+// kept for printProgramTimes().
+struct ProgramRecord
+{
+   int programId;
+   string name; // Shader files of the program.
+   vector<int> shaderIds; // Shaders still attached, when compiled from source.
+   unsigned long long key;
+   string cacheFilename;
+   bool useCache;
+   bool fromCache; // Whether loaded from a cached binary.
+   bool ready;
+   chrono::steady_clock::time_point submitted;
+   double submitTime; // Milliseconds spent issuing the compile and link.
+   double readyTime; // Milliseconds from submission until the program was ready.
+};
+
+static vector<ProgramRecord> programs;
+
+// Whether the driver compiles and links on its own threads, reporting progress
+// through GL_COMPLETION_STATUS_KHR (GL_KHR_parallel_shader_compile).
+static bool parallelCompile()
+{
+   static int parallel = -1;
+   if (parallel < 0)
+   {
+      parallel = 0;
+#ifdef GL_KHR_parallel_shader_compile
+      int numExtensions = 0;
+      glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+      for (int i = 0; i < numExtensions; i++)
+         if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_KHR_parallel_shader_compile") == 0)
+            parallel = 1;
+      if (parallel) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); // As many threads as the driver likes.
+#endif
+   }
+   return parallel == 1;
+}
+
+// Submit a program given by a list of shader type and file pairs, without waiting for
+// the driver to compile and link it.
+static int startProgramList(char* shaderType, char* shaderFile, va_list args)
+{
+   ProgramRecord program;
+   program.submitted = chrono::steady_clock::now();
+   vector<char*> shaderTypes, shaderFiles, shaders;
+   while (shaderType != NULL)
+   {
+      shaderTypes.push_back(shaderType);
+      shaderFiles.push_back(shaderFile);
+      program.name += (program.name.empty() ? "" : "+") + string(shaderFile);
+      shaderType = va_arg(args, char*);
+      if (shaderType != NULL) shaderFile = va_arg(args, char*);
+   }
+
+   // Key the cache by the shaders and the driver.
+   unsigned long long key = 14695981039346656037ULL;
+   bool sourcesRead = true;
+   for (int i = 0; i < (int)shaderTypes.size(); i++)
+   {
+      shaders.push_back(readTextFile(shaderFiles[i]));
+      if (shaders[i] == NULL) sourcesRead = false;
+      else key = hashString(hashString(key, shaderTypes[i]), shaders[i]);
+   }
+   key = hashString(key, (const char*)glGetString(GL_VENDOR));
+   key = hashString(key, (const char*)glGetString(GL_RENDERER));
+   key = hashString(key, (const char*)glGetString(GL_VERSION));
+
+   int numBinaryFormats = 0;
+   glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+   char keyName[17];
+   sprintf(keyName, "%016llx", key);
+   program.key = key;
+   program.cacheFilename = string(SHADER_CACHE_DIR) + keyName + ".bin";
+   program.useCache = sourcesRead && numBinaryFormats > 0;
+   program.ready = false;
+
+   parallelCompile();
+   program.programId = program.useCache ? loadProgramBinary(program.cacheFilename, key) : 0;
+   program.fromCache = program.programId != 0;
+   if (!program.fromCache)
+   {
+      // Submit every stage, then the link, before asking for any result.
+      program.programId = glCreateProgram();
+      for (int i = 0; i < (int)shaderTypes.size(); i++)
+         if (shaders[i] != NULL)
+         {
+            GLenum stage = shaderStage(shaderTypes[i]);
+            if (stage == 0)
+            {
+               cout << "Unknown shader type " << shaderTypes[i] << " for " << shaderFiles[i] << endl;
+               continue;
+            }
+            int shaderId = glCreateShader(stage);
+            glShaderSource(shaderId, 1, (const char**) &shaders[i], NULL);
+            glCompileShader(shaderId);
+            glAttachShader(program.programId, shaderId);
+            program.shaderIds.push_back(shaderId);
+         }
+      if (program.useCache) glProgramParameteri(program.programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      glLinkProgram(program.programId);
+   }
+
+   for (int i = 0; i < (int)shaders.size(); i++) free(shaders[i]);
+   program.submitTime = chrono::duration<double, milli>(chrono::steady_clock::now() - program.submitted).count();
+   programs.push_back(program);
+   return program.programId;
+}
+
+// Finish a program once it has compiled and linked: report errors, store its binary
+// in the cache and release its shaders.
+static void finishProgram(ProgramRecord &program)
+{
+   int status;
+   glGetProgramiv(program.programId, GL_LINK_STATUS, &status);
+   if (!status)
+   {
+      char log[4096];
+      for (int i = 0; i < (int)program.shaderIds.size(); i++)
+      {
+         glGetShaderiv(program.shaderIds[i], GL_COMPILE_STATUS, &status);
+         if (status) continue;
+         glGetShaderInfoLog(program.shaderIds[i], sizeof(log), NULL, log);
+         cout << "Cannot compile a shader of " << program.name << ":" << endl << log << endl;
+      }
+      glGetProgramInfoLog(program.programId, sizeof(log), NULL, log);
+      cout << "Cannot link " << program.name << ":" << endl << log << endl;
+   }
+   else if (program.useCache && !program.fromCache) saveProgramBinary(program.programId, program.cacheFilename, program.key);
+
+   for (int i = 0; i < (int)program.shaderIds.size(); i++)
+   {
+      glDetachShader(program.programId, program.shaderIds[i]);
+      glDeleteShader(program.shaderIds[i]);
+   }
+   program.shaderIds.clear();
+   program.ready = true;
+   program.readyTime = chrono::duration<double, milli>(chrono::steady_clock::now() - program.submitted).count();
+}
+
+// Function to submit a program for compiling and linking, with shaders given as for
+// setProgram(), and return its id at once. The program's binary is loaded from the
+// cache if there is one. Poll isProgramReady() before first using the program.
+int startProgram(char* shaderType, char* shaderFile, ...)
+{
+   va_list args;
+   va_start(args, shaderFile);
+   int programId = startProgramList(shaderType, shaderFile, args);
+   va_end(args);
+   return programId;
+}
+
+// Function to check whether a program submitted by startProgram() has finished
+// compiling and linking, without blocking if the driver supports parallel compiling.
+// Otherwise the program is compiled and linked at this first check.
+bool isProgramReady(int programId)
+{
+   for (int i = 0; i < (int)programs.size(); i++)
+      if (programs[i].programId == programId && !programs[i].ready)
+      {
+#ifdef GL_KHR_parallel_shader_compile
+         if (parallelCompile())
+         {
+            int complete;
+            glGetProgramiv(programId, GL_COMPLETION_STATUS_KHR, &complete);
+            if (!complete) return false;
+         }
+#endif
+         finishProgram(programs[i]);
+      }
+   return true;
+}
+
+// Function to print the compile and link wall time of each program.
+void printProgramTimes(void)
+{
+   cout << "Shader programs (" << (parallelCompile() ? "parallel" : "serial") << " compile):" << endl;
+   for (int i = 0; i < (int)programs.size(); i++)
+      cout << programs[i].name << ": " << (programs[i].fromCache ? "binary" : "source")
+           << ", submitted in " << programs[i].submitTime << " ms, ready after "
+           << (programs[i].ready ? programs[i].readyTime : -1.0) << " ms" << endl;
+}
+
+// Function to create and link a program from shaders given as a NULL-terminated list
+// of shader type and file pairs, e.g., setProgram("vertex", "vertexShader.glsl",
+// "fragment", "fragmentShader.glsl", NULL). The linked binary is cached on disk under
+// the hash of the shader sources and the driver's identity, so that later runs load
+// it with glProgramBinary() instead of compiling. If there is no usable binary, e.g.,
+// after a driver update, the program is compiled from source and the cache refreshed.
+int setProgram(char* shaderType, char* shaderFile, ...)
+{
+   va_list args;
+   va_start(args, shaderFile);
+   int programId = startProgramList(shaderType, shaderFile, args);
+   va_end(args);
+   finishProgram(programs.back());
+   return programId;
+}
@@ -16,44 +16,62 @@
 
 using namespace std;
 
+// Sample point (i, j) of the torus is at longitudinal angle (-1 + 2i/longs)PI about
+// the z-axis and latitudinal angle (-1 + 2j/lats)PI around the tube.
+struct TorusSampler
+{
+   AngleTable longAngles, latAngles;
+
+   TorusSampler(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats),
+                                       longs(longs), lats(lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      float r = TOR_OUTRAD + TOR_INRAD * latAngles.cosines[j];
+      vertex.coords.x = r * longAngles.cosines[i];
+      vertex.coords.y = r * longAngles.sines[i];
+      vertex.coords.z = TOR_INRAD * latAngles.sines[j];
+      vertex.coords.w = 1.0;
+   }
+
+   int longs, lats;
+};
+
 // Fill the vertex array with co-ordinates of the sample points.
 void fillTorVertexArray(Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)])
 {
-   int i, j, k;
-
-   k = 0;
-   for (j = 0; j <= TOR_LATS; j++)
-      for (i = 0; i <= TOR_LONGS; i++)
-      {
-         torVertices[k].coords.x = ( TOR_OUTRAD + TOR_INRAD * cos( (-1 + 2*(float)j/TOR_LATS) * PI ) ) * cos( (-1 + 2*(float)i/TOR_LONGS) * PI );
-         torVertices[k].coords.y = ( TOR_OUTRAD + TOR_INRAD * cos( (-1 + 2*(float)j/TOR_LATS) * PI ) ) * sin( (-1 + 2*(float)i/TOR_LONGS) * PI );
-         torVertices[k].coords.z = TOR_INRAD * sin( (-1 + 2*(float)j/TOR_LATS) * PI );
-		 torVertices[k].coords.w = 1.0;
-		 k++;
-	  }
+   fillGridVertices(torVertices, TOR_LONGS, TOR_LATS, TorusSampler(TOR_LONGS, TOR_LATS));
 }
 
-// Fill the array of index arrays.
-void fillTorIndices(unsigned int torIndices[TOR_LATS][4*(TOR_LONGS+1)])
+// Fill the index arrays of a torus of the given numbers of slices, each strip with
+// adjacency for the geometry shader: the indices of the strip's vertices alternate
+// with those of the vertices across the neighbouring strips.
+static void fillTorAdjacencyIndices(unsigned int *torIndices, int longs, int lats)
 {
    int i, j;   
-   for(j = 0; j < TOR_LATS; j++)
+   for(j = 0; j < lats; j++, torIndices += 4*(longs+1))
    {
-      for (i = 0; i <= TOR_LONGS; i++)
+      for (i = 0; i <= longs; i++)
       {
-	     torIndices[j][4*i] = j * (TOR_LONGS+1) + i;
-	     torIndices[j][4*i+2] = (j+1) * (TOR_LONGS+1) + i;
+	     torIndices[4*i] = j * (longs+1) + i;
+	     torIndices[4*i+2] = (j+1) * (longs+1) + i;
       }
-      for (i = 0; i < TOR_LONGS; i++)
+      for (i = 0; i < longs; i++)
 	  {
-		 torIndices[j][4*i+3] = (j > 0 ? j-1 : TOR_LATS) * (TOR_LONGS+1) + i + 1;
-		 torIndices[j][4*i+5] = ((j+2) % (TOR_LATS+1)) * (TOR_LONGS+1) + i;
+		 torIndices[4*i+3] = (j > 0 ? j-1 : lats) * (longs+1) + i + 1;
+		 torIndices[4*i+5] = ((j+2) % (lats+1)) * (longs+1) + i;
 	  }
-	  torIndices[j][1] = (j+1) * (TOR_LONGS + 1) + TOR_LONGS - 1;
-	  torIndices[j][4*TOR_LONGS+3] = j * (TOR_LONGS + 1) + 1;
+	  torIndices[1] = (j+1) * (longs + 1) + longs - 1;
+	  torIndices[4*longs+3] = j * (longs + 1) + 1;
    }
 }
 
+// Fill the array of index arrays.
+void fillTorIndices(unsigned int torIndices[TOR_LATS][4*(TOR_LONGS+1)])
+{
+   fillTorAdjacencyIndices(&torIndices[0][0], TOR_LONGS, TOR_LATS);
+}
+
 // Fill the array of counts.
 void fillTorCounts(int torCounts[TOR_LATS])
 {
@@ -78,4 +96,22 @@ void fillTorus(Vertex torVertices[(TOR_LONGS + 1) * (TOR_LATS + 1)],
    fillTorIndices(torIndices);
    fillTorCounts(torCounts);
    fillTorOffsets(torOffsets);
-}
\ No newline at end of file
+}
+
+// Build the torus, with adjacency, with the given numbers of longitudinal and latitudinal slices.
+void buildTorus(GridMesh<Vertex> &mesh, int longs, int lats)
+{
+   mesh.longs = longs;
+   mesh.lats = lats;
+   mesh.vertices.resize(gridNumVertices(longs, lats));
+   mesh.indices.resize(2 * gridNumIndices(longs, lats));
+   mesh.counts.resize(lats);
+   mesh.offsets.resize(lats);
+   fillGridVertices(&mesh.vertices[0], longs, lats, TorusSampler(longs, lats));
+   fillTorAdjacencyIndices(&mesh.indices[0], longs, lats);
+   for (int j = 0; j < lats; j++)
+   {
+      mesh.counts[j] = 4*(longs + 1);
+      mesh.offsets[j] = (GLvoid*)(4*(longs+1)*j*sizeof(unsigned int));
+   }
+}
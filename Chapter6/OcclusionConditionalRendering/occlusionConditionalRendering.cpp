@@ -8,14 +8,33 @@
 // sphere is visible and draw the sphere on condition its bounding box
 // is visible.
 //
+// A second scene, a city of buildings seen from a street, scales this up:
+// the buildings are kept in a hierarchy of bounding boxes traversed front
+// to back, whose boxes are queried in batches, the results of the previous
+// frame reused and the buildings drawn by conditional rendering on the
+// queries of their leaves (see occlusionCulling.h).
+//
+// COMPILE NOTE: Files occlusionCulling.h and frustumCulling.h must be in
+//               the same folder.
+//
 // Interaction:
 // Press the arrow keys to move the sphere and its bounding box.
 // Press r to reset their location.
 // Press the space bar to toggle between showing/hiding the bounding box.
+// Press c to toggle between the sphere and the city.
+// In the city:
+// Press the up/down arrow keys to walk forward/back.
+// Press the left/right arrow keys to turn.
+// Press m to cycle the culling through frustum culling only, a query
+// for each box waited for, and coherent hierarchical culling.
 //
 // Sumanta Guha.
 /////////////////////////////////////////////////////////////////////////
 
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
 #include <iostream>
 
 #ifdef __APPLE__
@@ -29,16 +48,142 @@
 #pragma comment(lib, "glew32.lib") 
 #endif
 
+#include "occlusionCulling.h"
+
 using namespace std;
 
+#define PI 3.14159265
+#define CITY_SIDE 30 // Blocks along each side of the city.
+#define BLOCK_SIZE 20.0 // Distance between the centers of neighboring blocks.
+#define FLOOR_HEIGHT 3.0
+#define EYE_HEIGHT 2.0
+#define NEAR_DISTANCE 1.0
+#define LEAF_SIZE 4 // Buildings to a leaf of the hierarchy.
+
 // Globals.
 static float Xvalue = 0.0, Yvalue = 0.0; // Co-ordinates of the sphere.
 static unsigned int query; // Query id. 
 static unsigned int boxVisible = 1; // Is the bounding box visible?
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+static int isCity = 0; // Is the city shown rather than the sphere?
+static int cullingMode = OCCLUSION_COHERENT; // Occlusion culling mode of the city.
+static float eyeX = 0.0, eyeZ = BLOCK_SIZE * CITY_SIDE / 2, heading = 0.0; // Position and heading (degrees) in the city.
+static unsigned int buildingLists; // Display lists base index, one for each building.
+static OcclusionCulling culling; // Occlusion culling of the buildings.
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{  
+   char *c;
+
+   for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+} 
+
+float randomFloat(float low, float high) { return low + (high - low) * rand() / RAND_MAX; }
+
+// Routine to draw building k.
+void drawBuilding(int k)
+{
+   glCallList(buildingLists + k);
+}
+
+// Compile the display list of a building on the box, floor by floor, each face of each
+// floor a quad with its own shade of the building's color.
+void makeBuilding(unsigned int list, const OcclusionBox &b)
+{
+   float r = randomFloat(0.3, 1.0), g = randomFloat(0.3, 1.0), bl = randomFloat(0.3, 1.0);
+   int numFloors = (int)((b.maxY - b.minY) / FLOOR_HEIGHT + 0.5);
+   glNewList(list, GL_COMPILE);
+   glBegin(GL_QUADS);
+   for (int f = 0; f < numFloors; f++)
+   {
+      float y0 = b.minY + f * FLOOR_HEIGHT, y1 = (f == numFloors - 1) ? b.maxY : y0 + FLOOR_HEIGHT;
+      float shade = (f % 2) ? 0.8 : 1.0;
+      glColor3f(shade * r, shade * g, shade * bl);
+      glVertex3f(b.minX, y0, b.maxZ); glVertex3f(b.maxX, y0, b.maxZ); glVertex3f(b.maxX, y1, b.maxZ); glVertex3f(b.minX, y1, b.maxZ);
+      glColor3f(0.7 * shade * r, 0.7 * shade * g, 0.7 * shade * bl);
+      glVertex3f(b.maxX, y0, b.maxZ); glVertex3f(b.maxX, y0, b.minZ); glVertex3f(b.maxX, y1, b.minZ); glVertex3f(b.maxX, y1, b.maxZ);
+      glColor3f(0.5 * shade * r, 0.5 * shade * g, 0.5 * shade * bl);
+      glVertex3f(b.maxX, y0, b.minZ); glVertex3f(b.minX, y0, b.minZ); glVertex3f(b.minX, y1, b.minZ); glVertex3f(b.maxX, y1, b.minZ);
+      glColor3f(0.6 * shade * r, 0.6 * shade * g, 0.6 * shade * bl);
+      glVertex3f(b.minX, y0, b.minZ); glVertex3f(b.minX, y0, b.maxZ); glVertex3f(b.minX, y1, b.maxZ); glVertex3f(b.minX, y1, b.minZ);
+   }
+   glColor3f(0.3 * r, 0.3 * g, 0.3 * bl);
+   glVertex3f(b.minX, b.maxY, b.maxZ); glVertex3f(b.maxX, b.maxY, b.maxZ); glVertex3f(b.maxX, b.maxY, b.minZ); glVertex3f(b.minX, b.maxY, b.minZ);
+   glEnd();
+   glEndList();
+}
+
+// Build the city, CITY_SIDE x CITY_SIDE blocks about the origin, a building of random
+// footprint and height in each, mostly low with some towers; streets run between the
+// blocks, one down the middle along the z-axis.
+void makeCity(void)
+{
+   vector<OcclusionBox> buildings;
+   for (int i = 0; i < CITY_SIDE; i++)
+      for (int j = 0; j < CITY_SIDE; j++)
+      {
+         float x = BLOCK_SIZE * (i - CITY_SIDE / 2 + 0.5), z = BLOCK_SIZE * (j - CITY_SIDE / 2 + 0.5);
+         float halfWidth = randomFloat(5.0, 8.0), halfDepth = randomFloat(5.0, 8.0);
+         float height = FLOOR_HEIGHT * (int)(randomFloat(2.0, 10.0) + ((rand() % 10 == 0) ? randomFloat(10.0, 30.0) : 0.0));
+         OcclusionBox b = { x - halfWidth, 0.0, z - halfDepth, x + halfWidth, height, z + halfDepth };
+         buildings.push_back(b);
+      }
+   buildingLists = glGenLists((int)buildings.size());
+   for (int k = 0; k < (int)buildings.size(); k++) makeBuilding(buildingLists + k, buildings[k]);
+   culling.initialize(buildings, LEAF_SIZE);
+}
+
+// Routine to draw the city from the street, occlusion culled.
+void drawCity(void)
+{
+   static const char *modeNames[3] = { "Frustum culling only", "Stop-and-wait queries", "Coherent hierarchical culling" };
+   float eye[3] = { eyeX, EYE_HEIGHT, eyeZ };
+   char text[128];
+
+   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+   glEnable(GL_DEPTH_TEST);
+
+   // A far plane to see across the city.
+   glMatrixMode(GL_PROJECTION);
+   glPushMatrix();
+   glLoadIdentity();
+   glFrustum(-1.0, 1.0, -1.0, 1.0, NEAR_DISTANCE, 2000.0);
+   glMatrixMode(GL_MODELVIEW);
+
+   glLoadIdentity();
+   gluLookAt(eyeX, EYE_HEIGHT, eyeZ, eyeX - sin((PI/180.0) * heading), EYE_HEIGHT, eyeZ - cos((PI/180.0) * heading),
+             0.0, 1.0, 0.0);
+   culling.render(eye, NEAR_DISTANCE, cullingMode, drawBuilding);
+
+   // Write the culling mode and counts of the frame.
+   const OcclusionStats &stats = culling.getStats();
+   glDisable(GL_DEPTH_TEST);
+   glLoadIdentity();
+   glColor3f(0.0, 0.0, 0.0);
+   glRasterPos3f(-1.9, 1.85, -2.0);
+   writeBitmapString((void*)font, (char *)modeNames[cullingMode]);
+   sprintf(text, "%d buildings: %d drawn, %d on condition (%d hidden), %d culled", culling.getNumObjects(),
+           stats.numDrawn, stats.numConditional, stats.numConditionalHidden,
+           culling.getNumObjects() - stats.numDrawn - stats.numConditional);
+   glRasterPos3f(-1.9, 1.75, -2.0);
+   writeBitmapString((void*)font, text);
+   sprintf(text, "%d queries in %d batches", stats.numQueries, stats.numBatches);
+   glRasterPos3f(-1.9, 1.65, -2.0);
+   writeBitmapString((void*)font, text);
+
+   glMatrixMode(GL_PROJECTION);
+   glPopMatrix();
+   glMatrixMode(GL_MODELVIEW);
+
+   glutSwapBuffers();
+}
 
 // Drawing routine.
 void drawScene(void)
 {
+   if (isCity) { drawCity(); return; }
+
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
    glEnable(GL_DEPTH_TEST); 
    glLoadIdentity();
@@ -90,6 +235,7 @@ void setup(void)
 {
    glClearColor(1.0, 1.0, 1.0, 0.0);  
    glGenQueries(1, &query); // Generate a query object, putting its id in query.
+   makeCity();
 }
 
 // OpenGL window reshape routine.
@@ -115,6 +261,14 @@ void keyInput(unsigned char key, int x, int y)
          if (boxVisible) boxVisible = 0; else boxVisible = 1;
          glutPostRedisplay();
          break;
+      case 'c':
+         if (isCity) isCity = 0; else isCity = 1;
+         glutPostRedisplay();
+         break;
+      case 'm':
+         cullingMode = (cullingMode + 1) % 3;
+         glutPostRedisplay();
+         break;
       case 27:
          exit(0);
          break;
@@ -126,6 +280,15 @@ void keyInput(unsigned char key, int x, int y)
 // Callback routine for non-ASCII key entry.
 void specialKeyInput(int key, int x, int y)
 {
+   if (isCity)
+   {
+      if (key == GLUT_KEY_UP) { eyeX -= 2.0 * sin((PI/180.0) * heading); eyeZ -= 2.0 * cos((PI/180.0) * heading); }
+      if (key == GLUT_KEY_DOWN) { eyeX += 2.0 * sin((PI/180.0) * heading); eyeZ += 2.0 * cos((PI/180.0) * heading); }
+      if (key == GLUT_KEY_LEFT) heading += 5.0;
+      if (key == GLUT_KEY_RIGHT) heading -= 5.0;
+      glutPostRedisplay();
+      return;
+   }
    if(key == GLUT_KEY_UP) Yvalue += 0.1;
    if(key == GLUT_KEY_DOWN) Yvalue -= 0.1;
    if(key == GLUT_KEY_LEFT) Xvalue -= 0.1;
@@ -139,7 +302,12 @@ void printInteraction(void)
    cout << "Interaction:" << endl;
    cout << "Press the arrow keys to move the sphere and its bounding box." << endl
         << "Press r to reset their location." << endl
-        << "Press the space bar to toggle between showing/hiding the bounding box." << endl;
+        << "Press the space bar to toggle between showing/hiding the bounding box." << endl
+        << "Press c to toggle between the sphere and the city." << endl
+        << "In the city:" << endl
+        << "Press the up/down arrow keys to walk forward/back." << endl
+        << "Press the left/right arrow keys to turn." << endl
+        << "Press m to cycle the culling mode." << endl;
 }
 
 // Main routine.
@@ -0,0 +1,424 @@
+#ifndef OCCLUSIONCULLING_H
+#define OCCLUSIONCULLING_H
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "frustumCulling.h"
+
+// Occlusion culling of a scene of objects with axis-aligned bounding boxes, by occlusion
+// queries as in occlusion.cpp but over a hierarchy of boxes and, in the coherent mode,
+// after coherent hierarchical culling (CHC) with batched queries.
+//
+// The objects are kept in a bounding volume hierarchy, a binary tree of boxes built by
+// splitting the objects at the median of their centers along the longest axis, down to
+// leaves of a few objects. The tree is traversed front to back, nearest box first, so
+// that the boxes queried are tested against the depths of the nearer objects already
+// drawn. Nodes outside the view frustum are culled as by frustumCulling.h.
+//
+// Modes of render():
+// OCCLUSION_FRUSTUM_ONLY draws every leaf meeting the frustum.
+// OCCLUSION_STOP_AND_WAIT queries each node meeting the frustum and waits for the result
+//    before going on, drawing a leaf or opening an inner node only if its box is visible.
+// OCCLUSION_COHERENT reuses the visibility of the previous frame: the nodes then visible
+//    are taken to be visible again, without waiting, an inner node opened at once and a
+//    leaf drawn, its query issued with its draw to learn if it still is; the nodes then
+//    invisible are queried, the queries gathered into batches issued together with
+//    color and depth writes off. A leaf of a batch is drawn at once, by conditional
+//    rendering on its query, so that the GPU skips it if hidden while the CPU goes on; an
+//    inner node is opened when its result comes back. While results are outstanding the
+//    traversal goes on with the nodes it need not wait for, so the CPU only waits when
+//    nothing else is left. Visibility found at the leaves is pulled up to their
+//    ancestors, whose boxes are then not queried the next frame.
+//
+// Nodes whose box holds the eye, or comes nearer it than the near plane, are taken to be
+// visible, as the box drawn for their query would be clipped.
+
+#define OCCLUSION_FRUSTUM_ONLY 0
+#define OCCLUSION_STOP_AND_WAIT 1
+#define OCCLUSION_COHERENT 2
+
+#define OCCLUSION_BATCH_SIZE 16 // Queries of invisible nodes issued together.
+
+// Box of an object.
+struct OcclusionBox
+{
+   float minX, minY, minZ, maxX, maxY, maxZ;
+};
+
+// Counts and times of the last frame rendered.
+struct OcclusionStats
+{
+   int numVisited; // Nodes meeting the frustum.
+   int numDrawn; // Objects drawn unconditionally.
+   int numConditional; // Objects drawn on condition of their leaf's query.
+   int numConditionalHidden; // Of those, the ones whose query found them hidden.
+   int numQueries, numBatches;
+   int numReady; // Query results available when first needed.
+   double waitTime; // Milliseconds the CPU waited for query results.
+   double latency; // Milliseconds from issuing the queries to reading their results, summed.
+};
+
+// Node of the hierarchy: an inner node with children firstChild and firstChild + 1, or
+// a leaf (firstChild -1) with the objects first to first + count - 1 of the object order.
+struct OcclusionNode
+{
+   OcclusionBox box;
+   int parent, firstChild, first, count;
+   unsigned int query;
+   int lastVisited; // Frame last met in the frustum.
+   bool isVisible; // Visible when last visited.
+   bool isDrawn; // Leaf drawn this frame...
+   bool isConditional; // ...on condition of its query.
+};
+
+// Occlusion culling class.
+class OcclusionCulling
+{
+public:
+   OcclusionCulling();
+
+   // Build the hierarchy of the objects with the given boxes, at most leafSize to a leaf.
+   void initialize(const std::vector<OcclusionBox> &boxes, int leafSize);
+
+   // Draw the scene with the current matrices, seen from eye with the given near distance,
+   // culled in the given mode, drawObject(k) drawing object k.
+   void render(const float eye[3], float nearDistance, int mode, void (*drawObject)(int));
+
+   const OcclusionStats &getStats() const { return stats; }
+   int getNumNodes() const { return (int)nodes.size(); }
+   int getNumObjects() const { return (int)objects.size(); }
+
+private:
+   typedef std::pair<float, int> QueueEntry; // Distance and node.
+
+   std::vector<OcclusionNode> nodes;
+   std::vector<int> objects; // Objects in the order of the leaves.
+   int frame, mode;
+   OcclusionStats stats;
+   FrustumPlanes frustum;
+   float eye[3], nearDistance;
+   void (*drawObject)(int);
+   std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > distanceQueue;
+   std::deque<int> queryQueue; // Nodes queried, in order of issue.
+   std::vector<int> batch; // Invisible nodes to query.
+   std::vector<std::chrono::steady_clock::time_point> issueTimes; // Of each node's query.
+
+   void build(std::vector<OcclusionBox> &boxes, int n, int first, int count, int parent, int leafSize);
+   void pushNode(int n);
+   void pushChildren(int n);
+   bool isNearEye(int n) const;
+   void drawLeaf(int n);
+   void drawBox(int n);
+   void issueBatch();
+   void pullUpVisibility(int n);
+   bool fetchResult(int n, bool mustWait, bool &isVisible);
+   void handleResult(int n, bool isVisible);
+};
+
+inline OcclusionCulling::OcclusionCulling()
+{
+   frame = 0;
+   mode = OCCLUSION_COHERENT;
+   nearDistance = 0.0;
+   drawObject = NULL;
+}
+
+inline void OcclusionCulling::initialize(const std::vector<OcclusionBox> &boxes, int leafSize)
+{
+   std::vector<OcclusionBox> sorted(boxes);
+   objects.resize(boxes.size());
+   for (int k = 0; k < (int)objects.size(); k++) objects[k] = k;
+   nodes.clear();
+   if (boxes.empty()) return;
+   nodes.resize(1);
+   build(sorted, 0, 0, (int)boxes.size(), -1, leafSize > 0 ? leafSize : 1);
+
+   issueTimes.resize(nodes.size());
+   for (int n = 0; n < (int)nodes.size(); n++) glGenQueries(1, &nodes[n].query);
+}
+
+// Make node n the root of the subtree of the objects first to first + count - 1, their
+// boxes reordered with them.
+inline void OcclusionCulling::build(std::vector<OcclusionBox> &boxes, int n, int first, int count, int parent,
+                                    int leafSize)
+{
+   OcclusionNode &node = nodes[n];
+   node.box = boxes[first];
+   for (int k = first + 1; k < first + count; k++)
+   {
+      node.box.minX = std::min(node.box.minX, boxes[k].minX); node.box.maxX = std::max(node.box.maxX, boxes[k].maxX);
+      node.box.minY = std::min(node.box.minY, boxes[k].minY); node.box.maxY = std::max(node.box.maxY, boxes[k].maxY);
+      node.box.minZ = std::min(node.box.minZ, boxes[k].minZ); node.box.maxZ = std::max(node.box.maxZ, boxes[k].maxZ);
+   }
+   node.parent = parent;
+   node.firstChild = -1;
+   node.first = first;
+   node.count = count;
+   node.query = 0;
+   node.lastVisited = -1;
+   node.isVisible = false;
+   node.isDrawn = node.isConditional = false;
+   if (count <= leafSize) return;
+
+   // Split at the median center along the longest axis of the box.
+   float sizeX = node.box.maxX - node.box.minX, sizeY = node.box.maxY - node.box.minY,
+         sizeZ = node.box.maxZ - node.box.minZ;
+   int axis = (sizeX >= sizeY && sizeX >= sizeZ) ? 0 : ((sizeY >= sizeZ) ? 1 : 2);
+   std::vector<std::pair<float, int> > centers(count);
+   for (int k = 0; k < count; k++)
+   {
+      const OcclusionBox &b = boxes[first + k];
+      float center = (axis == 0) ? b.minX + b.maxX : ((axis == 1) ? b.minY + b.maxY : b.minZ + b.maxZ);
+      centers[k] = std::make_pair(center, k);
+   }
+   int half = count / 2;
+   std::nth_element(centers.begin(), centers.begin() + half, centers.end());
+   std::vector<OcclusionBox> splitBoxes(count);
+   std::vector<int> splitObjects(count);
+   for (int k = 0; k < count; k++)
+   {
+      splitBoxes[k] = boxes[first + centers[k].second];
+      splitObjects[k] = objects[first + centers[k].second];
+   }
+   std::copy(splitBoxes.begin(), splitBoxes.end(), boxes.begin() + first);
+   std::copy(splitObjects.begin(), splitObjects.end(), objects.begin() + first);
+
+   int firstChild = (int)nodes.size();
+   nodes[n].firstChild = firstChild;
+   nodes.resize(nodes.size() + 2);
+   build(boxes, firstChild, first, half, n, leafSize);
+   build(boxes, firstChild + 1, first + half, count - half, n, leafSize);
+}
+
+inline void OcclusionCulling::render(const float eye[3], float nearDistance, int mode, void (*drawObject)(int))
+{
+   frame++;
+   for (int c = 0; c < 3; c++) this->eye[c] = eye[c];
+   this->nearDistance = nearDistance;
+   this->mode = mode;
+   this->drawObject = drawObject;
+   OcclusionStats zero = { 0, 0, 0, 0, 0, 0, 0, 0.0, 0.0 };
+   stats = zero;
+   if (nodes.empty()) return;
+
+   // Planes of the frustum of the current projection and modelview matrices.
+   float modelViewMat[16], projMat[16], clipMat[16];
+   glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMat);
+   glGetFloatv(GL_PROJECTION_MATRIX, projMat);
+   for (int c = 0; c < 4; c++)
+      for (int r = 0; r < 4; r++)
+      {
+         clipMat[4*c + r] = 0.0;
+         for (int k = 0; k < 4; k++) clipMat[4*c + r] += projMat[4*k + r] * modelViewMat[4*c + k];
+      }
+   setMatrixFrustum(frustum, clipMat);
+
+   pushNode(0);
+   while (!distanceQueue.empty() || !queryQueue.empty() || !batch.empty())
+   {
+      // Handle the results come back, waiting for the first only if there is nothing
+      // else to do.
+      while (!queryQueue.empty())
+      {
+         int n = queryQueue.front();
+         bool mustWait = (distanceQueue.empty() && batch.empty()) || mode == OCCLUSION_STOP_AND_WAIT;
+         bool isVisible;
+         if (!fetchResult(n, mustWait, isVisible)) break;
+         queryQueue.pop_front();
+         handleResult(n, isVisible);
+      }
+
+      if (!distanceQueue.empty())
+      {
+         int n = distanceQueue.top().second;
+         distanceQueue.pop();
+         OcclusionNode &node = nodes[n];
+         stats.numVisited++;
+         bool wasVisible = node.isVisible && node.lastVisited == frame - 1;
+         node.lastVisited = frame;
+         node.isVisible = false;
+         node.isDrawn = node.isConditional = false;
+
+         if (mode == OCCLUSION_FRUSTUM_ONLY || isNearEye(n))
+         // Visible for sure: draw a leaf, open an inner node.
+         {
+            if (node.firstChild < 0)
+            {
+               drawLeaf(n);
+               pullUpVisibility(n);
+            }
+            else pushChildren(n);
+         }
+         else if (mode == OCCLUSION_STOP_AND_WAIT)
+         {
+            batch.push_back(n);
+            issueBatch();
+         }
+         else if (wasVisible)
+         // Visible last frame: draw a leaf, querying it as it is drawn, and open an inner
+         // node, whose visibility will come up from its leaves.
+         {
+            if (node.firstChild < 0)
+            {
+               glBeginQuery(GL_ANY_SAMPLES_PASSED, node.query);
+               drawLeaf(n);
+               glEndQuery(GL_ANY_SAMPLES_PASSED);
+               issueTimes[n] = std::chrono::steady_clock::now();
+               queryQueue.push_back(n);
+               stats.numQueries++;
+            }
+            else pushChildren(n);
+         }
+         else
+         // Invisible last frame: query the node, with others.
+         {
+            batch.push_back(n);
+            if ((int)batch.size() >= OCCLUSION_BATCH_SIZE) issueBatch();
+         }
+      }
+      else if (!batch.empty()) issueBatch();
+   }
+}
+
+// Push node n on the distance queue, by the distance of its box from the eye, if it meets
+// the frustum.
+inline void OcclusionCulling::pushNode(int n)
+{
+   const OcclusionBox &b = nodes[n].box;
+   if (cullBox(frustum, b.minX, b.minY, b.minZ, b.maxX, b.maxY, b.maxZ) == CULL_OUTSIDE) return;
+   float dx = std::max(std::max(b.minX - eye[0], eye[0] - b.maxX), 0.0f);
+   float dy = std::max(std::max(b.minY - eye[1], eye[1] - b.maxY), 0.0f);
+   float dz = std::max(std::max(b.minZ - eye[2], eye[2] - b.maxZ), 0.0f);
+   distanceQueue.push(QueueEntry(dx*dx + dy*dy + dz*dz, n));
+}
+
+inline void OcclusionCulling::pushChildren(int n)
+{
+   pushNode(nodes[n].firstChild);
+   pushNode(nodes[n].firstChild + 1);
+}
+
+// Whether the box of node n, grown by twice the near distance to cover the near plane's
+// corners, holds the eye.
+inline bool OcclusionCulling::isNearEye(int n) const
+{
+   const OcclusionBox &b = nodes[n].box;
+   float margin = 2.0f * nearDistance;
+   return b.minX - margin <= eye[0] && eye[0] <= b.maxX + margin && b.minY - margin <= eye[1] &&
+          eye[1] <= b.maxY + margin && b.minZ - margin <= eye[2] && eye[2] <= b.maxZ + margin;
+}
+
+inline void OcclusionCulling::drawLeaf(int n)
+{
+   const OcclusionNode &node = nodes[n];
+   for (int k = node.first; k < node.first + node.count; k++) drawObject(objects[k]);
+   nodes[n].isDrawn = true;
+   if (node.isConditional) stats.numConditional += node.count;
+   else stats.numDrawn += node.count;
+}
+
+// Draw the box of node n, with the vertex array enabled.
+inline void OcclusionCulling::drawBox(int n)
+{
+   static const unsigned char indices[36] = { 0, 2, 1, 1, 2, 3,  4, 5, 6, 5, 7, 6,  0, 1, 4, 1, 5, 4,
+                                              2, 6, 3, 3, 6, 7,  0, 4, 2, 2, 4, 6,  1, 3, 5, 3, 7, 5 };
+   const OcclusionBox &b = nodes[n].box;
+   float vertices[24];
+   for (int v = 0; v < 8; v++)
+   {
+      vertices[3*v] = (v & 1) ? b.maxX : b.minX;
+      vertices[3*v + 1] = (v & 2) ? b.maxY : b.minY;
+      vertices[3*v + 2] = (v & 4) ? b.maxZ : b.minZ;
+   }
+   glVertexPointer(3, GL_FLOAT, 0, vertices);
+   glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, indices);
+}
+
+// Issue the queries of the nodes of the batch, drawing their boxes with color and depth
+// writes off, then draw its leaves on condition of their queries.
+inline void OcclusionCulling::issueBatch()
+{
+   glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); // Make color buffer not writable.
+   glDepthMask(GL_FALSE); // Make depth buffer not writable.
+   glEnableClientState(GL_VERTEX_ARRAY);
+   for (int k = 0; k < (int)batch.size(); k++)
+   {
+      int n = batch[k];
+      glBeginQuery(GL_ANY_SAMPLES_PASSED, nodes[n].query);
+      drawBox(n);
+      glEndQuery(GL_ANY_SAMPLES_PASSED);
+      issueTimes[n] = std::chrono::steady_clock::now();
+      queryQueue.push_back(n);
+   }
+   glDisableClientState(GL_VERTEX_ARRAY);
+   glDepthMask(GL_TRUE); // Make depth buffer writable.
+   glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); // Make color buffer writable.
+   stats.numQueries += (int)batch.size();
+   stats.numBatches++;
+
+   glFlush(); // So that the results come back while the CPU goes on.
+
+   // The GPU skips a leaf's draw if its box was hidden, and the CPU need not wait to know.
+   // In the stop-and-wait mode, though, it does.
+   for (int k = 0; k < (int)batch.size(); k++)
+   {
+      int n = batch[k];
+      if (nodes[n].firstChild >= 0 || mode == OCCLUSION_STOP_AND_WAIT) continue;
+      nodes[n].isConditional = true;
+      glBeginConditionalRender(nodes[n].query, GL_QUERY_WAIT);
+      drawLeaf(n);
+      glEndConditionalRender();
+   }
+   batch.clear();
+}
+
+// Mark node n and its ancestors visible, up to one already marked.
+inline void OcclusionCulling::pullUpVisibility(int n)
+{
+   while (n >= 0 && !nodes[n].isVisible)
+   {
+      nodes[n].isVisible = true;
+      n = nodes[n].parent;
+   }
+}
+
+// Read the result of the query of node n into isVisible, if it is available or mustWait,
+// returning whether it was read.
+inline bool OcclusionCulling::fetchResult(int n, bool mustWait, bool &isVisible)
+{
+   unsigned int isAvailable = 0, result = 0;
+   glGetQueryObjectuiv(nodes[n].query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+   if (!isAvailable && !mustWait) return false;
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   glGetQueryObjectuiv(nodes[n].query, GL_QUERY_RESULT, &result);
+   std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+   if (isAvailable) stats.numReady++;
+   else stats.waitTime += std::chrono::duration<double, std::milli>(end - start).count();
+   stats.latency += std::chrono::duration<double, std::milli>(end - issueTimes[n]).count();
+   isVisible = (result != 0);
+   return true;
+}
+
+// Act on the result of the query of node n: if visible, pull its visibility up and open
+// it, or draw it if a leaf not yet drawn.
+inline void OcclusionCulling::handleResult(int n, bool isVisible)
+{
+   OcclusionNode &node = nodes[n];
+   if (!isVisible)
+   {
+      if (node.isConditional) stats.numConditionalHidden += node.count;
+      return;
+   }
+   pullUpVisibility(n);
+   if (node.firstChild >= 0) pushChildren(n);
+   else if (!node.isDrawn) drawLeaf(n);
+}
+
+#endif
@@ -0,0 +1,44 @@
+#version 430 core
+
+// Frustum culling of the asteroids, one to an invocation: each asteroid whose bounding
+// sphere is not beyond a plane of the frustum is appended to the instances, its slot
+// taken by incrementing the instance count of the indirect draw command.
+
+layout(local_size_x=256) in;
+
+layout(std430, binding=0) readonly buffer asteroidStorage
+{
+   uint asteroidWords[]; // Five words to an asteroid, laid out as AsteroidInstance.
+};
+
+layout(std430, binding=1) writeonly buffer instanceStorage
+{
+   uint instanceWords[]; // Likewise for the instances.
+};
+
+layout(std430, binding=2) buffer commandStorage
+{
+   uint count;
+   uint instanceCount;
+   uint firstIndex;
+   int baseVertex;
+   uint baseInstance;
+};
+
+uniform uint numAsteroids;
+uniform int numPlanes;
+uniform vec4 planes[8]; // Inward unit normals and offsets.
+
+void main(void)
+{
+   uint k = gl_GlobalInvocationID.x;
+   if (k >= numAsteroids) return;
+
+   vec4 centerRadius = uintBitsToFloat(uvec4(asteroidWords[5*k], asteroidWords[5*k + 1], 
+                                             asteroidWords[5*k + 2], asteroidWords[5*k + 3]));
+   for (int p = 0; p < numPlanes; p++)
+      if (dot(planes[p].xyz, centerRadius.xyz) + planes[p].w + centerRadius.w < 0.0) return;
+
+   uint slot = atomicAdd(instanceCount, 1);
+   for (int i = 0; i < 5; i++) instanceWords[5*slot + i] = asteroidWords[5*k + i];
+}
\ No newline at end of file
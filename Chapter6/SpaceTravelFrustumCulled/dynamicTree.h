@@ -0,0 +1,386 @@
+#ifndef DYNAMICTREE_H
+#define DYNAMICTREE_H
+
+#include <algorithm>
+#include <vector>
+
+#include "frustumCulling.h"
+
+// Dynamic bounding volume hierarchy of axis-aligned boxes, for objects which move, appear
+// and disappear. Each object is a leaf holding its box enlarged by a margin, so that as
+// long as the object stays within this fat box a move changes nothing; one that leaves it
+// is removed and inserted again. A leaf is inserted next to the sibling which least adds
+// to the surface area of the tree, and the ancestors of an inserted or removed leaf are
+// refitted and rotated where one child has grown taller than the other by more than one,
+// keeping the tree balanced so that insert, remove and move take O(log n) time, amortized
+// over moves within the fat boxes. The nodes are stored in one array, referring to one
+// another by index, with a list of the free ones for reuse.
+
+#define DYNAMIC_TREE_NULL -1 // Index of no node.
+
+// Axis-aligned box.
+struct DynamicTreeBox
+{
+   float minX, minY, minZ, maxX, maxY, maxZ;
+};
+
+// Node of the tree: a leaf if it has no children, in which case it holds an object.
+struct DynamicTreeNode
+{
+   DynamicTreeBox box;
+   int parent; // Parent, or the next free node if the node is free.
+   int child1, child2;
+   int height; // 0 for a leaf, -1 for a free node.
+   int object;
+
+   bool isLeaf() const { return child1 == DYNAMIC_TREE_NULL; }
+};
+
+// Dynamic tree class.
+class DynamicTree
+{
+public:
+   // The margin by which the boxes of the leaves exceed those of their objects.
+   DynamicTree(float margin = 0.0);
+
+   // Insert an object with the given box, returning its leaf, which stays the same until
+   // the object is removed.
+   int insert(const DynamicTreeBox &box, int object);
+
+   // Remove an object by its leaf.
+   void remove(int leaf);
+
+   // Move an object to the given box. Return whether the object left its fat box, and so
+   // was inserted again.
+   bool move(int leaf, const DynamicTreeBox &box);
+
+   int getObject(int leaf) const { return nodes[leaf].object; }
+   const DynamicTreeBox &getFatBox(int leaf) const { return nodes[leaf].box; }
+
+   // Collect the objects whose fat boxes meet the given box. Return their number.
+   int query(const DynamicTreeBox &box, std::vector<int> &objects) const;
+
+   // Collect the objects whose fat boxes meet the frustum, those of a node inside it
+   // taken without further tests. Return their number.
+   int cull(const FrustumPlanes &frustum, std::vector<int> &objects) const;
+
+   int getNumObjects() const { return numObjects; }
+   int getHeight() const { return (root == DYNAMIC_TREE_NULL) ? 0 : nodes[root].height; }
+
+   // Check the links, heights and boxes of the nodes. Return the number of errors.
+   int validate() const;
+
+private:
+   int allocateNode();
+   void freeNode(int node);
+   void insertLeaf(int leaf);
+   void removeLeaf(int leaf);
+   int balance(int node);
+   void refit(int node);
+   int validate(int node, int &numLeaves) const;
+
+   float margin;
+   int root, freeList, numObjects;
+   std::vector<DynamicTreeNode> nodes;
+};
+
+// Smallest box containing two boxes.
+inline DynamicTreeBox combineBoxes(const DynamicTreeBox &a, const DynamicTreeBox &b)
+{
+   DynamicTreeBox box = { std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::min(a.minZ, b.minZ),
+                          std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY), std::max(a.maxZ, b.maxZ) };
+   return box;
+}
+
+// Half the surface area of a box, the cost of visiting it.
+inline float boxArea(const DynamicTreeBox &box)
+{
+   float dx = box.maxX - box.minX, dy = box.maxY - box.minY, dz = box.maxZ - box.minZ;
+   return dx * dy + dy * dz + dz * dx;
+}
+
+inline bool boxContains(const DynamicTreeBox &a, const DynamicTreeBox &b)
+{
+   return a.minX <= b.minX && a.minY <= b.minY && a.minZ <= b.minZ &&
+          a.maxX >= b.maxX && a.maxY >= b.maxY && a.maxZ >= b.maxZ;
+}
+
+inline bool boxesOverlap(const DynamicTreeBox &a, const DynamicTreeBox &b)
+{
+   return a.minX <= b.maxX && a.maxX >= b.minX && a.minY <= b.maxY && a.maxY >= b.minY &&
+          a.minZ <= b.maxZ && a.maxZ >= b.minZ;
+}
+
+inline DynamicTree::DynamicTree(float margin)
+{
+   this->margin = margin;
+   root = freeList = DYNAMIC_TREE_NULL;
+   numObjects = 0;
+}
+
+inline int DynamicTree::allocateNode()
+{
+   int node;
+   if (freeList != DYNAMIC_TREE_NULL)
+   {
+      node = freeList;
+      freeList = nodes[node].parent;
+   }
+   else
+   {
+      node = (int)nodes.size();
+      nodes.push_back(DynamicTreeNode());
+   }
+   nodes[node].parent = nodes[node].child1 = nodes[node].child2 = DYNAMIC_TREE_NULL;
+   nodes[node].height = 0;
+   nodes[node].object = -1;
+   return node;
+}
+
+inline void DynamicTree::freeNode(int node)
+{
+   nodes[node].parent = freeList;
+   nodes[node].height = -1;
+   freeList = node;
+}
+
+inline int DynamicTree::insert(const DynamicTreeBox &box, int object)
+{
+   int leaf = allocateNode();
+   DynamicTreeBox fatBox = { box.minX - margin, box.minY - margin, box.minZ - margin,
+                             box.maxX + margin, box.maxY + margin, box.maxZ + margin };
+   nodes[leaf].box = fatBox;
+   nodes[leaf].object = object;
+   insertLeaf(leaf);
+   numObjects++;
+   return leaf;
+}
+
+inline void DynamicTree::remove(int leaf)
+{
+   removeLeaf(leaf);
+   freeNode(leaf);
+   numObjects--;
+}
+
+inline bool DynamicTree::move(int leaf, const DynamicTreeBox &box)
+{
+   if (boxContains(nodes[leaf].box, box)) return false;
+
+   removeLeaf(leaf);
+   DynamicTreeBox fatBox = { box.minX - margin, box.minY - margin, box.minZ - margin,
+                             box.maxX + margin, box.maxY + margin, box.maxZ + margin };
+   nodes[leaf].box = fatBox;
+   insertLeaf(leaf);
+   return true;
+}
+
+// Recompute the height and box of a node from its children.
+inline void DynamicTree::refit(int node)
+{
+   DynamicTreeNode &n = nodes[node];
+   n.height = 1 + std::max(nodes[n.child1].height, nodes[n.child2].height);
+   n.box = combineBoxes(nodes[n.child1].box, nodes[n.child2].box);
+}
+
+inline void DynamicTree::insertLeaf(int leaf)
+{
+   if (root == DYNAMIC_TREE_NULL)
+   {
+      root = leaf;
+      nodes[root].parent = DYNAMIC_TREE_NULL;
+      return;
+   }
+
+   // Descend to the best sibling: at each node, stop if pairing the leaf with the node
+   // itself is cheaper than descending to either child, counting the growth of the boxes
+   // of the ancestors the leaf would pass on the way.
+   DynamicTreeBox box = nodes[leaf].box;
+   int index = root;
+   while (!nodes[index].isLeaf())
+   {
+      int child1 = nodes[index].child1, child2 = nodes[index].child2;
+      float area = boxArea(nodes[index].box);
+      float combinedArea = boxArea(combineBoxes(nodes[index].box, box));
+      float cost = 2.0f * combinedArea; // Of a new parent of the node and the leaf.
+      float inheritanceCost = 2.0f * (combinedArea - area); // Of pushing the leaf down.
+
+      float cost1 = boxArea(combineBoxes(box, nodes[child1].box)) + inheritanceCost;
+      if (!nodes[child1].isLeaf()) cost1 -= boxArea(nodes[child1].box);
+      float cost2 = boxArea(combineBoxes(box, nodes[child2].box)) + inheritanceCost;
+      if (!nodes[child2].isLeaf()) cost2 -= boxArea(nodes[child2].box);
+
+      if (cost < cost1 && cost < cost2) break;
+      index = (cost1 < cost2) ? child1 : child2;
+   }
+   int sibling = index;
+
+   // Make a new parent of the sibling and the leaf.
+   int oldParent = nodes[sibling].parent;
+   int newParent = allocateNode();
+   nodes[newParent].parent = oldParent;
+   nodes[newParent].child1 = sibling;
+   nodes[newParent].child2 = leaf;
+   nodes[sibling].parent = nodes[leaf].parent = newParent;
+   if (oldParent == DYNAMIC_TREE_NULL) root = newParent;
+   else if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+   else nodes[oldParent].child2 = newParent;
+
+   // Rebalance and refit the ancestors.
+   for (index = newParent; index != DYNAMIC_TREE_NULL; index = nodes[index].parent)
+   {
+      index = balance(index);
+      refit(index);
+   }
+}
+
+inline void DynamicTree::removeLeaf(int leaf)
+{
+   if (leaf == root)
+   {
+      root = DYNAMIC_TREE_NULL;
+      return;
+   }
+
+   // Replace the parent by the sibling.
+   int parent = nodes[leaf].parent, grandParent = nodes[parent].parent;
+   int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+   nodes[sibling].parent = grandParent;
+   freeNode(parent);
+   if (grandParent == DYNAMIC_TREE_NULL)
+   {
+      root = sibling;
+      return;
+   }
+   if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+   else nodes[grandParent].child2 = sibling;
+
+   // Rebalance and refit the ancestors.
+   for (int index = grandParent; index != DYNAMIC_TREE_NULL; index = nodes[index].parent)
+   {
+      index = balance(index);
+      refit(index);
+   }
+}
+
+// If a child of node A is taller than the other by more than one, rotate it up into A's
+// place, A taking the place of its shorter child. Return the node in A's place.
+inline int DynamicTree::balance(int iA)
+{
+   if (nodes[iA].isLeaf() || nodes[iA].height < 2) return iA;
+
+   int iB = nodes[iA].child1, iC = nodes[iA].child2;
+   int difference = nodes[iC].height - nodes[iB].height;
+   if (difference >= -1 && difference <= 1) return iA;
+
+   // The taller child, iUp, goes up; its shorter child is handed to A in place of iUp.
+   int iUp = (difference > 1) ? iC : iB;
+   int iF = nodes[iUp].child1, iG = nodes[iUp].child2;
+   int iKeep = (nodes[iF].height > nodes[iG].height) ? iF : iG;
+   int iGive = (iKeep == iF) ? iG : iF;
+
+   nodes[iUp].child1 = iA;
+   nodes[iUp].child2 = iKeep;
+   nodes[iUp].parent = nodes[iA].parent;
+   nodes[iA].parent = iUp;
+   int upParent = nodes[iUp].parent;
+   if (upParent == DYNAMIC_TREE_NULL) root = iUp;
+   else if (nodes[upParent].child1 == iA) nodes[upParent].child1 = iUp;
+   else nodes[upParent].child2 = iUp;
+
+   if (iUp == iC) nodes[iA].child2 = iGive;
+   else nodes[iA].child1 = iGive;
+   nodes[iGive].parent = iA;
+
+   refit(iA);
+   refit(iUp);
+   return iUp;
+}
+
+inline int DynamicTree::query(const DynamicTreeBox &box, std::vector<int> &objects) const
+{
+   objects.clear();
+   if (root == DYNAMIC_TREE_NULL) return 0;
+
+   std::vector<int> stack;
+   stack.reserve(nodes[root].height + 2);
+   stack.push_back(root);
+   while (!stack.empty())
+   {
+      const DynamicTreeNode &node = nodes[stack.back()];
+      stack.pop_back();
+      if (!boxesOverlap(node.box, box)) continue;
+      if (node.isLeaf()) objects.push_back(node.object);
+      else
+      {
+         stack.push_back(node.child2);
+         stack.push_back(node.child1);
+      }
+   }
+   return (int)objects.size();
+}
+
+inline int DynamicTree::cull(const FrustumPlanes &frustum, std::vector<int> &objects) const
+{
+   objects.clear();
+   if (root == DYNAMIC_TREE_NULL) return 0;
+
+   // The stack holds nodes which meet the frustum, with whether they lie inside it.
+   std::vector<int> stack;
+   std::vector<unsigned char> inside;
+   stack.reserve(nodes[root].height + 2);
+   inside.reserve(nodes[root].height + 2);
+   stack.push_back(root);
+   inside.push_back(0);
+   while (!stack.empty())
+   {
+      const DynamicTreeNode &node = nodes[stack.back()];
+      unsigned char isInside = inside.back();
+      stack.pop_back();
+      inside.pop_back();
+      if (!isInside)
+      {
+         const DynamicTreeBox &b = node.box;
+         int result = cullBox(frustum, b.minX, b.minY, b.minZ, b.maxX, b.maxY, b.maxZ);
+         if (result == CULL_OUTSIDE) continue;
+         isInside = (result == CULL_INSIDE);
+      }
+      if (node.isLeaf()) objects.push_back(node.object);
+      else
+      {
+         stack.push_back(node.child2);
+         stack.push_back(node.child1);
+         inside.push_back(isInside);
+         inside.push_back(isInside);
+      }
+   }
+   return (int)objects.size();
+}
+
+inline int DynamicTree::validate() const
+{
+   int numLeaves = 0, errors = 0;
+   if (root != DYNAMIC_TREE_NULL)
+   {
+      errors += (nodes[root].parent != DYNAMIC_TREE_NULL);
+      errors += validate(root, numLeaves);
+   }
+   return errors + (numLeaves != numObjects);
+}
+
+inline int DynamicTree::validate(int node, int &numLeaves) const
+{
+   const DynamicTreeNode &n = nodes[node];
+   if (n.isLeaf())
+   {
+      numLeaves++;
+      return (n.height != 0) + (n.child2 != DYNAMIC_TREE_NULL);
+   }
+   const DynamicTreeNode &c1 = nodes[n.child1], &c2 = nodes[n.child2];
+   int errors = (c1.parent != node) + (c2.parent != node);
+   errors += (n.height != 1 + std::max(c1.height, c2.height));
+   errors += !boxContains(n.box, c1.box) + !boxContains(n.box, c2.box);
+   return errors + validate(n.child1, numLeaves) + validate(n.child2, numLeaves);
+}
+
+#endif
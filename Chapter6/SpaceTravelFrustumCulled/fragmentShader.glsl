@@ -0,0 +1,10 @@
+#version 430 core
+
+in vec4 colorsExport;
+
+out vec4 colorsOut;
+
+void main(void)
+{
+   colorsOut = colorsExport;
+}
\ No newline at end of file
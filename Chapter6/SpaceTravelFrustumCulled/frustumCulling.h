@@ -0,0 +1,254 @@
+#ifndef FRUSTUMCULLING_H
+#define FRUSTUMCULLING_H
+
+#include <cmath>
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#endif
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#  include <xmmintrin.h>
+#  define FRUSTUM_SSE
+#endif
+
+// Culling of axis-aligned boxes and spheres to a frustum given by the planes bounding
+// it, ax + by + cz + d >= 0 inside. The boxes and spheres are passed as a structure of
+// arrays and tested several at a time, one per lane of a SIMD register: 8 with AVX, 4
+// with SSE, 1 otherwise. A frustum is either 3D, the six planes of a projection times
+// modelview matrix, or 2D, a convex quadrilateral in the xz-plane, whose edges and
+// bounding rectangle give vertical planes (b = 0). The boxes of the 2D mode are the
+// rectangles of a quadtree, their y extent ignored, and its test is exact.
+
+#define FRUSTUM_MAX_PLANES 8
+
+#define CULL_OUTSIDE 0 // Result for a box or sphere outside the frustum.
+#define CULL_INTERSECTING 1 // Result for a box or sphere crossing the frustum's boundary.
+#define CULL_INSIDE 2 // Result for a box or sphere inside the frustum.
+
+// Planes of a frustum, inward unit normals (a, b, c) with offsets d, as arrays.
+struct FrustumPlanes
+{
+   int numPlanes;
+   float a[FRUSTUM_MAX_PLANES], b[FRUSTUM_MAX_PLANES], c[FRUSTUM_MAX_PLANES], d[FRUSTUM_MAX_PLANES];
+};
+
+// CullLanes are the float lanes of an SSE or AVX register, with the arithmetic of the
+// tests, or a single float; negativeLanes() gives a bit for each lane less than 0.
+// CULL_LANES is the widest available.
+inline int negativeLanes(float x) { return x < 0.0f; }
+
+#if defined(FRUSTUM_SSE)
+struct CullLanes4
+{
+   __m128 value;
+
+   CullLanes4() {}
+   CullLanes4(float x) : value(_mm_set1_ps(x)) {}
+   CullLanes4(__m128 x) : value(x) {}
+
+   friend CullLanes4 operator+(const CullLanes4 &x, const CullLanes4 &y) { return _mm_add_ps(x.value, y.value); }
+   friend CullLanes4 operator-(const CullLanes4 &x, const CullLanes4 &y) { return _mm_sub_ps(x.value, y.value); }
+   friend CullLanes4 operator*(const CullLanes4 &x, const CullLanes4 &y) { return _mm_mul_ps(x.value, y.value); }
+   friend CullLanes4 minLanes(const CullLanes4 &x, const CullLanes4 &y) { return _mm_min_ps(x.value, y.value); }
+   friend CullLanes4 maxLanes(const CullLanes4 &x, const CullLanes4 &y) { return _mm_max_ps(x.value, y.value); }
+};
+
+inline CullLanes4 loadCullLanes4(const float *x) { return _mm_loadu_ps(x); }
+inline int negativeLanes(const CullLanes4 &x) { return _mm_movemask_ps(_mm_cmplt_ps(x.value, _mm_setzero_ps())); }
+#else
+typedef float CullLanes4; // Four lanes are then four passes of one.
+#endif
+
+#if defined(__AVX__)
+#define CULL_LANES 8
+
+struct CullLanes
+{
+   __m256 value;
+
+   CullLanes() {}
+   CullLanes(float x) : value(_mm256_set1_ps(x)) {}
+   CullLanes(__m256 x) : value(x) {}
+
+   friend CullLanes operator+(const CullLanes &x, const CullLanes &y) { return _mm256_add_ps(x.value, y.value); }
+   friend CullLanes operator-(const CullLanes &x, const CullLanes &y) { return _mm256_sub_ps(x.value, y.value); }
+   friend CullLanes operator*(const CullLanes &x, const CullLanes &y) { return _mm256_mul_ps(x.value, y.value); }
+   friend CullLanes minLanes(const CullLanes &x, const CullLanes &y) { return _mm256_min_ps(x.value, y.value); }
+   friend CullLanes maxLanes(const CullLanes &x, const CullLanes &y) { return _mm256_max_ps(x.value, y.value); }
+};
+
+inline CullLanes loadCullLanes(const float *x) { return _mm256_loadu_ps(x); }
+inline int negativeLanes(const CullLanes &x) { return _mm256_movemask_ps(_mm256_cmp_ps(x.value, _mm256_setzero_ps(), _CMP_LT_OQ)); }
+#elif defined(FRUSTUM_SSE)
+#define CULL_LANES 4
+
+typedef CullLanes4 CullLanes;
+inline CullLanes loadCullLanes(const float *x) { return loadCullLanes4(x); }
+#else
+#define CULL_LANES 1
+
+typedef float CullLanes;
+inline CullLanes loadCullLanes(const float *x) { return *x; }
+#endif
+
+inline float minLanes(float x, float y) { return x < y ? x : y; }
+inline float maxLanes(float x, float y) { return x > y ? x : y; }
+
+// Planes of the frustum of the clip matrix m = projection x modelview, column-major as
+// given by glGetFloatv(): each is the sum or difference of the fourth row and another.
+inline void setMatrixFrustum(FrustumPlanes &frustum, const float m[16])
+{
+   static const int rows[6] = { 0, 0, 1, 1, 2, 2 };
+   frustum.numPlanes = 6;
+   for (int p = 0; p < 6; p++)
+   {
+      float sign = (p % 2) ? -1.0f : 1.0f;
+      int r = rows[p];
+      float a = m[3] + sign * m[r], b = m[7] + sign * m[4 + r], c = m[11] + sign * m[8 + r], d = m[15] + sign * m[12 + r];
+      float length = std::sqrt(a*a + b*b + c*c);
+      frustum.a[p] = a / length; frustum.b[p] = b / length; frustum.c[p] = c / length; frustum.d[p] = d / length;
+   }
+}
+
+// Planes of the 2D frustum, the convex quadrilateral with vertices (x1, z1), ..., (x4, z4)
+// in either order: the lines of its four edges and the sides of its bounding rectangle,
+// which together separate it from any rectangle it does not meet.
+inline void setQuadrilateralFrustum(FrustumPlanes &frustum, float x1, float z1, float x2, float z2,
+                                    float x3, float z3, float x4, float z4)
+{
+   float x[4] = { x1, x2, x3, x4 }, z[4] = { z1, z2, z3, z4 };
+   float area = 0.0;
+   for (int k = 0; k < 4; k++) area += x[k] * z[(k + 1) % 4] - x[(k + 1) % 4] * z[k];
+   float orientation = (area > 0.0) ? 1.0f : -1.0f;
+
+   frustum.numPlanes = 8;
+   for (int k = 0; k < 4; k++)
+   {
+      float nx = -orientation * (z[(k + 1) % 4] - z[k]), nz = orientation * (x[(k + 1) % 4] - x[k]);
+      float length = std::sqrt(nx*nx + nz*nz);
+      if (length > 0.0) { nx /= length; nz /= length; }
+      frustum.a[k] = nx; frustum.b[k] = 0.0; frustum.c[k] = nz; frustum.d[k] = -(nx * x[k] + nz * z[k]);
+   }
+   float minX = minLanes(minLanes(x1, x2), minLanes(x3, x4)), maxX = maxLanes(maxLanes(x1, x2), maxLanes(x3, x4));
+   float minZ = minLanes(minLanes(z1, z2), minLanes(z3, z4)), maxZ = maxLanes(maxLanes(z1, z2), maxLanes(z3, z4));
+   float a[4] = { 1.0, -1.0, 0.0, 0.0 }, c[4] = { 0.0, 0.0, 1.0, -1.0 }, d[4] = { -minX, maxX, -minZ, maxZ };
+   for (int k = 0; k < 4; k++)
+   {
+      frustum.a[4 + k] = a[k]; frustum.b[4 + k] = 0.0; frustum.c[4 + k] = c[k]; frustum.d[4 + k] = d[k];
+   }
+}
+
+// Test lanes of boxes against the planes, setting a bit in outside for each box beyond
+// some plane and in crossing for each box not inside them all. A box is beyond a plane
+// if its corner farthest along the normal is, and inside if its nearest corner is; the
+// y terms are skipped for vertical planes.
+template <class Lanes>
+inline void testBoxLanes(const FrustumPlanes &frustum, const Lanes &minX, const Lanes &minY, const Lanes &minZ,
+                         const Lanes &maxX, const Lanes &maxY, const Lanes &maxZ, int &outside, int &crossing)
+{
+   outside = crossing = 0;
+   for (int p = 0; p < frustum.numPlanes; p++)
+   {
+      Lanes a(frustum.a[p]), c(frustum.c[p]), d(frustum.d[p]);
+      Lanes ax0 = a * minX, ax1 = a * maxX, cz0 = c * minZ, cz1 = c * maxZ;
+      Lanes farthest = maxLanes(ax0, ax1) + maxLanes(cz0, cz1) + d, nearest = minLanes(ax0, ax1) + minLanes(cz0, cz1) + d;
+      if (frustum.b[p] != 0.0)
+      {
+         Lanes b(frustum.b[p]), by0 = b * minY, by1 = b * maxY;
+         farthest = farthest + maxLanes(by0, by1);
+         nearest = nearest + minLanes(by0, by1);
+      }
+      outside |= negativeLanes(farthest);
+      crossing |= negativeLanes(nearest);
+   }
+}
+
+// Test lanes of spheres against the planes, likewise.
+template <class Lanes>
+inline void testSphereLanes(const FrustumPlanes &frustum, const Lanes &x, const Lanes &y, const Lanes &z,
+                            const Lanes &r, int &outside, int &crossing)
+{
+   outside = crossing = 0;
+   for (int p = 0; p < frustum.numPlanes; p++)
+   {
+      Lanes distance = Lanes(frustum.a[p]) * x + Lanes(frustum.c[p]) * z + Lanes(frustum.d[p]);
+      if (frustum.b[p] != 0.0) distance = distance + Lanes(frustum.b[p]) * y;
+      outside |= negativeLanes(distance + r);
+      crossing |= negativeLanes(distance - r);
+   }
+}
+
+// Write the results of n lanes from their bits.
+inline void writeCullResults(int outside, int crossing, int n, unsigned char *results)
+{
+   for (int k = 0; k < n; k++)
+      results[k] = ((outside >> k) & 1) ? CULL_OUTSIDE : (((crossing >> k) & 1) ? CULL_INTERSECTING : CULL_INSIDE);
+}
+
+// Result of one box.
+inline int cullBox(const FrustumPlanes &frustum, float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+{
+   int outside, crossing;
+   unsigned char result;
+   testBoxLanes<float>(frustum, minX, minY, minZ, maxX, maxY, maxZ, outside, crossing);
+   writeCullResults(outside, crossing, 1, &result);
+   return result;
+}
+
+// Result of one sphere.
+inline int cullSphere(const FrustumPlanes &frustum, float x, float y, float z, float r)
+{
+   int outside, crossing;
+   unsigned char result;
+   testSphereLanes<float>(frustum, x, y, z, r, outside, crossing);
+   writeCullResults(outside, crossing, 1, &result);
+   return result;
+}
+
+// Results of n boxes, CULL_LANES at a time. The y bounds may be NULL for a 2D frustum.
+inline void cullBoxes(const FrustumPlanes &frustum, const float *minX, const float *minY, const float *minZ,
+                      const float *maxX, const float *maxY, const float *maxZ, int n, unsigned char *results)
+{
+   int k = 0, outside, crossing;
+   for (; k + CULL_LANES <= n; k += CULL_LANES)
+   {
+      CullLanes lowY = minY ? loadCullLanes(minY + k) : CullLanes(0.0f), highY = maxY ? loadCullLanes(maxY + k) : CullLanes(0.0f);
+      testBoxLanes<CullLanes>(frustum, loadCullLanes(minX + k), lowY, loadCullLanes(minZ + k),
+                              loadCullLanes(maxX + k), highY, loadCullLanes(maxZ + k), outside, crossing);
+      writeCullResults(outside, crossing, CULL_LANES, results + k);
+   }
+   for (; k < n; k++)
+      results[k] = cullBox(frustum, minX[k], minY ? minY[k] : 0.0f, minZ[k], maxX[k], maxY ? maxY[k] : 0.0f, maxZ[k]);
+}
+
+// Results of n spheres, CULL_LANES at a time. The y co-ordinates may be NULL for a 2D frustum.
+inline void cullSpheres(const FrustumPlanes &frustum, const float *x, const float *y, const float *z, const float *r,
+                        int n, unsigned char *results)
+{
+   int k = 0, outside, crossing;
+   for (; k + CULL_LANES <= n; k += CULL_LANES)
+   {
+      testSphereLanes<CullLanes>(frustum, loadCullLanes(x + k), y ? loadCullLanes(y + k) : CullLanes(0.0f),
+                                 loadCullLanes(z + k), loadCullLanes(r + k), outside, crossing);
+      writeCullResults(outside, crossing, CULL_LANES, results + k);
+   }
+   for (; k < n; k++) results[k] = cullSphere(frustum, x[k], y ? y[k] : 0.0f, z[k], r[k]);
+}
+
+// Results of the first n, at most 4, of the 2D rectangles from the given ones, in one
+// pass of four lanes; four values must be readable from each array.
+inline void cullRectangles4(const FrustumPlanes &frustum, const float *minX, const float *minZ,
+                            const float *maxX, const float *maxZ, int n, unsigned char results[4])
+{
+#if defined(FRUSTUM_SSE)
+   int outside, crossing;
+   CullLanes4 zero(0.0f);
+   testBoxLanes<CullLanes4>(frustum, loadCullLanes4(minX), zero, loadCullLanes4(minZ),
+                            loadCullLanes4(maxX), zero, loadCullLanes4(maxZ), outside, crossing);
+   writeCullResults(outside, crossing, n, results);
+#else
+   for (int k = 0; k < n; k++) results[k] = cullBox(frustum, minX[k], 0.0f, minZ[k], maxX[k], 0.0f, maxZ[k]);
+#endif
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef GPUCULLING_H
+#define GPUCULLING_H
+
+#include <vector>
+
+#include "quadtree.h"
+#include "instancedAsteroids.h"
+
+// Frustum culling of the asteroids on the GPU by the compute shader of computeShader.glsl,
+// so that the asteroids drawn never pass through the CPU. The bounds and colors of all
+// the asteroids are kept in a shader storage buffer, as instances of instancedAsteroids.h;
+// one invocation of the shader per asteroid tests its bounding sphere against the planes
+// of the frustum and, if it survives, appends it to a second buffer, the instances to
+// draw, counting it in the instanceCount of an indirect draw command in a third. The
+// draw, InstancedAsteroids::drawIndirect(), then takes both from the GPU's memory.
+//
+// Bindings of the shader's storage blocks: 0 the asteroids, 1 the instances to draw,
+// 2 the draw command.
+
+#define GPU_CULLING_GROUP_SIZE 256 // Invocations of a work group, local_size_x of the shader.
+
+// Command of glDrawElementsIndirect().
+struct DrawElementsIndirectCommand
+{
+   unsigned int count, instanceCount, firstIndex;
+   int baseVertex;
+   unsigned int baseInstance;
+};
+
+// GPU culling class.
+class GpuCulling
+{
+public:
+   GpuCulling();
+
+   // Load the asteroids into the storage buffer, with room for as many instances to
+   // draw, and make the draw command draw numIndices indices of each, culled by the
+   // given compute program.
+   void initialize(const AsteroidArray &asteroids, int numIndices, unsigned int programId);
+
+   // Load the asteroids again after they moved, the same number as initialize().
+   void update(const AsteroidArray &asteroids);
+
+   // Cull the asteroids to the frustum, writing the instances to draw and their number
+   // into the draw command.
+   void cull(const FrustumPlanes &frustum);
+
+   unsigned int getInstanceBuffer() const { return buffers[1]; }
+   unsigned int getCommandBuffer() const { return buffers[2]; }
+
+   // Number of instances left by the last cull, read back from the draw command (which
+   // waits for the GPU).
+   int getNumVisible() const;
+
+private:
+   unsigned int programId, numAsteroidsLoc, numPlanesLoc, planesLoc;
+   unsigned int buffers[3]; // Asteroids, instances to draw, draw command.
+   int numAsteroids, numIndices;
+   std::vector<AsteroidInstance> instances; // Staging of the asteroids for the upload.
+
+   void loadAsteroids(const AsteroidArray &asteroids);
+};
+
+inline GpuCulling::GpuCulling()
+{
+   programId = 0;
+   numAsteroids = numIndices = 0;
+   for (int k = 0; k < 3; k++) buffers[k] = 0;
+}
+
+inline void GpuCulling::initialize(const AsteroidArray &asteroids, int numIndices, unsigned int programId)
+{
+   this->numIndices = numIndices;
+   this->programId = programId;
+   numAsteroidsLoc = glGetUniformLocation(programId, "numAsteroids");
+   numPlanesLoc = glGetUniformLocation(programId, "numPlanes");
+   planesLoc = glGetUniformLocation(programId, "planes");
+   numAsteroids = asteroids.size();
+   GLsizeiptr size = (numAsteroids > 0 ? numAsteroids : 1) * sizeof(AsteroidInstance);
+
+   // Create the storage buffers and bind them to the shader's blocks.
+   glGenBuffers(3, buffers);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[0]);
+   glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers[0]);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[1]);
+   glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_COPY);
+   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers[1]);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[2]);
+   glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_COPY);
+   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffers[2]);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+   loadAsteroids(asteroids);
+}
+
+inline void GpuCulling::update(const AsteroidArray &asteroids)
+{
+   if (asteroids.size() == numAsteroids) loadAsteroids(asteroids);
+}
+
+inline void GpuCulling::loadAsteroids(const AsteroidArray &asteroids)
+{
+   if (numAsteroids == 0) return;
+   instances.resize(numAsteroids);
+   for (int k = 0; k < numAsteroids; k++)
+      setAsteroidInstance(instances[k], asteroids.centerX[k], asteroids.centerY[k], asteroids.centerZ[k],
+                          asteroids.radius[k], &asteroids.colors[3*k]);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[0]);
+   glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, numAsteroids * sizeof(AsteroidInstance), &instances[0]);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+inline void GpuCulling::cull(const FrustumPlanes &frustum)
+{
+   // Start the draw command with no instances, for the shader to count them.
+   DrawElementsIndirectCommand command = { (unsigned int)numIndices, 0, 0, 0, 0 };
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[2]);
+   glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(command), &command);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+   float planes[4 * FRUSTUM_MAX_PLANES];
+   for (int p = 0; p < frustum.numPlanes; p++)
+   {
+      planes[4*p] = frustum.a[p]; planes[4*p + 1] = frustum.b[p];
+      planes[4*p + 2] = frustum.c[p]; planes[4*p + 3] = frustum.d[p];
+   }
+
+   glUseProgram(programId);
+   for (int k = 0; k < 3; k++) glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k, buffers[k]);
+   glUniform1ui(numAsteroidsLoc, numAsteroids);
+   glUniform1i(numPlanesLoc, frustum.numPlanes);
+   glUniform4fv(planesLoc, frustum.numPlanes, planes);
+   glDispatchCompute((numAsteroids + GPU_CULLING_GROUP_SIZE - 1) / GPU_CULLING_GROUP_SIZE, 1, 1);
+   glUseProgram(0);
+
+   // Make the shader's writes visible to the draw command and instance attributes that
+   // read them, and to reading back the count.
+   glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+inline int GpuCulling::getNumVisible() const
+{
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[2]);
+   DrawElementsIndirectCommand *command =
+      (DrawElementsIndirectCommand *)glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_READ_ONLY);
+   int numVisible = command ? (int)command->instanceCount : 0;
+   glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+   return numVisible;
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef INSTANCEDASTEROIDS_H
+#define INSTANCEDASTEROIDS_H
+
+#include <cmath>
+#include <vector>
+
+// Instanced drawing of wire spheres, one shared mesh of a unit sphere scaled and placed
+// by per-instance attributes as in helixListShaderizedInstancedVertAttrib.cpp, so that
+// any number of asteroids take a single glDrawElementsInstancedBaseInstance() call.
+// The instance attributes are written straight into a buffer mapped once and for all
+// (persistently, where GL 4.4 or ARB_buffer_storage allows, else mapped unsynchronized
+// for each draw), divided into regions used in turn: each draw takes the next region,
+// first waiting on the fence left by the last draw from it, so that the CPU writes one
+// region while the GPU may still read the others. The instances of region k start at
+// instance k * maxInstances, picked by the base instance of the draw.
+//
+// The vertex shader takes the unit sphere's vertices at location 0 and the instance's
+// center and radius, and color, at locations 1 and 2, with uniforms modelViewMat and
+// projMat.
+//
+// Alternatively the instances and the draw command may come from buffers filled on the
+// GPU, as by gpuCulling.h, drawn by glDrawElementsIndirect() through a second vertex array
+// object sharing the sphere's buffers.
+
+#define INSTANCE_BUFFER_REGIONS 3 // Regions of the instance buffer used in turn.
+
+// Attributes of one instance, 20 bytes.
+struct AsteroidInstance
+{
+   float centerRadius[4]; // Center and radius.
+   unsigned char color[4];
+};
+
+inline void setAsteroidInstance(AsteroidInstance &instance, float x, float y, float z, float r,
+                                const unsigned char color[3])
+{
+   instance.centerRadius[0] = x; instance.centerRadius[1] = y;
+   instance.centerRadius[2] = z; instance.centerRadius[3] = r;
+   instance.color[0] = color[0]; instance.color[1] = color[1]; instance.color[2] = color[2];
+   instance.color[3] = 255;
+}
+
+// Instanced wire spheres class.
+class InstancedAsteroids
+{
+public:
+   InstancedAsteroids();
+
+   // Build the unit sphere with the lines of glutWireSphere(1.0, slices, stacks), and an
+   // instance buffer of room for maxInstances instances per region, to be drawn by the
+   // given program.
+   void initialize(int maxInstances, int slices, int stacks, unsigned int programId);
+
+   // Return where to write the instances of the next draw, at most getMaxInstances().
+   AsteroidInstance *beginInstances();
+
+   // Draw the first numInstances instances written since beginInstances().
+   void draw(int numInstances, const float modelViewMat[16], const float projMat[16]);
+
+   // Draw the instances of instanceBuffer, laid out as AsteroidInstance, as many as the
+   // instanceCount of the DrawElementsIndirectCommand in commandBuffer, whose count must
+   // be getNumIndices().
+   void drawIndirect(unsigned int instanceBuffer, unsigned int commandBuffer,
+                     const float modelViewMat[16], const float projMat[16]);
+
+   int getMaxInstances() const { return maxInstances; }
+   int getNumIndices() const { return numIndices; }
+   bool isPersistent() const { return persistent; }
+   int getNumDrawCalls() const { return numDrawCalls; } // Since initialize().
+
+private:
+   unsigned int programId, modelViewMatLoc, projMatLoc;
+   unsigned int vao, buffers[3]; // Sphere vertices, sphere indices, instances.
+   unsigned int indirectVao, indirectInstanceBuffer; // Of drawIndirect(), and its instances.
+   int numIndices, maxInstances, region, numDrawCalls;
+   bool persistent;
+   AsteroidInstance *mappedInstances; // Whole buffer if persistent, else the region.
+   GLsync fences[INSTANCE_BUFFER_REGIONS];
+
+   void setVertexAttributes(unsigned int instanceBuffer);
+};
+
+inline InstancedAsteroids::InstancedAsteroids()
+{
+   vao = indirectVao = indirectInstanceBuffer = 0;
+   numIndices = maxInstances = region = numDrawCalls = 0;
+   persistent = false;
+   mappedInstances = NULL;
+   for (int k = 0; k < INSTANCE_BUFFER_REGIONS; k++) fences[k] = 0;
+}
+
+inline void InstancedAsteroids::initialize(int maxInstances, int slices, int stacks, unsigned int programId)
+{
+   this->maxInstances = (maxInstances > 0) ? maxInstances : 1;
+   this->programId = programId;
+   modelViewMatLoc = glGetUniformLocation(programId, "modelViewMat");
+   projMatLoc = glGetUniformLocation(programId, "projMat");
+
+   // Vertices on stacks + 1 circles of latitude from pole to pole, slices to a circle;
+   // lines round the circles other than the poles and down the slices.
+   std::vector<float> vertices;
+   std::vector<unsigned int> indices;
+   for (int i = 0; i <= stacks; i++)
+   {
+      float phi = 3.14159265f * i / stacks;
+      for (int j = 0; j < slices; j++)
+      {
+         float theta = 2.0f * 3.14159265f * j / slices;
+         vertices.push_back(std::cos(theta) * std::sin(phi));
+         vertices.push_back(std::sin(theta) * std::sin(phi));
+         vertices.push_back(std::cos(phi));
+         vertices.push_back(1.0);
+      }
+   }
+   for (int i = 1; i < stacks; i++)
+      for (int j = 0; j < slices; j++)
+      {
+         indices.push_back(i * slices + j);
+         indices.push_back(i * slices + (j + 1) % slices);
+      }
+   for (int j = 0; j < slices; j++)
+      for (int i = 0; i < stacks; i++)
+      {
+         indices.push_back(i * slices + j);
+         indices.push_back((i + 1) * slices + j);
+      }
+   numIndices = (int)indices.size();
+
+   glGenVertexArrays(1, &vao);
+   glGenBuffers(3, buffers);
+   glBindVertexArray(vao);
+
+   glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+   glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+
+   GLsizeiptr size = (GLsizeiptr)INSTANCE_BUFFER_REGIONS * this->maxInstances * sizeof(AsteroidInstance);
+   glBindBuffer(GL_ARRAY_BUFFER, buffers[2]);
+   persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+   if (persistent)
+   {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+      mappedInstances = (AsteroidInstance *)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+   }
+   else glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+   setVertexAttributes(buffers[2]);
+
+   glBindVertexArray(0);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Point the attributes of the bound vertex array object at the sphere's vertices and the
+// instances of instanceBuffer, and bind the sphere's indices.
+inline void InstancedAsteroids::setVertexAttributes(unsigned int instanceBuffer)
+{
+   glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+   glEnableVertexAttribArray(0);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+
+   glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+   glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(AsteroidInstance), 0);
+   glEnableVertexAttribArray(1);
+   glVertexAttribDivisor(1, 1); // Set attribute instancing.
+   glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(AsteroidInstance),
+                         (void *)(4 * sizeof(float)));
+   glEnableVertexAttribArray(2);
+   glVertexAttribDivisor(2, 1); // Set attribute instancing.
+}
+
+inline AsteroidInstance *InstancedAsteroids::beginInstances()
+{
+   region = (region + 1) % INSTANCE_BUFFER_REGIONS;
+   if (fences[region])
+   {
+      glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+      glDeleteSync(fences[region]);
+      fences[region] = 0;
+   }
+   if (persistent) return mappedInstances + region * maxInstances;
+
+   glBindBuffer(GL_ARRAY_BUFFER, buffers[2]);
+   mappedInstances = (AsteroidInstance *)glMapBufferRange(GL_ARRAY_BUFFER,
+      (GLintptr)region * maxInstances * sizeof(AsteroidInstance), maxInstances * sizeof(AsteroidInstance),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+   return mappedInstances;
+}
+
+inline void InstancedAsteroids::draw(int numInstances, const float modelViewMat[16], const float projMat[16])
+{
+   if (!persistent)
+   {
+      glBindBuffer(GL_ARRAY_BUFFER, buffers[2]);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+   }
+
+   glUseProgram(programId);
+   glUniformMatrix4fv(modelViewMatLoc, 1, GL_FALSE, modelViewMat);
+   glUniformMatrix4fv(projMatLoc, 1, GL_FALSE, projMat);
+   glBindVertexArray(vao);
+   if (numInstances > 0)
+   {
+      glDrawElementsInstancedBaseInstance(GL_LINES, numIndices, GL_UNSIGNED_INT, 0, numInstances,
+                                          region * maxInstances);
+      numDrawCalls++;
+   }
+   fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+   glBindVertexArray(0);
+   glUseProgram(0);
+}
+
+inline void InstancedAsteroids::drawIndirect(unsigned int instanceBuffer, unsigned int commandBuffer,
+                                             const float modelViewMat[16], const float projMat[16])
+{
+   if (!indirectVao) glGenVertexArrays(1, &indirectVao);
+   glBindVertexArray(indirectVao);
+   if (instanceBuffer != indirectInstanceBuffer)
+   {
+      setVertexAttributes(instanceBuffer);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      indirectInstanceBuffer = instanceBuffer;
+   }
+
+   glUseProgram(programId);
+   glUniformMatrix4fv(modelViewMatLoc, 1, GL_FALSE, modelViewMat);
+   glUniformMatrix4fv(projMatLoc, 1, GL_FALSE, projMat);
+   glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+   glDrawElementsIndirect(GL_LINES, GL_UNSIGNED_INT, 0);
+   numDrawCalls++;
+   glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+   glBindVertexArray(0);
+   glUseProgram(0);
+}
+
+#endif
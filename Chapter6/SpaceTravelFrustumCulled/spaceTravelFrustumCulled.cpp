@@ -4,12 +4,26 @@
 // This program is based on spaceTravel.cpp with an added frustum culling option.
 // It draws a conical spacecraft that can travel and an array of fixed spherical 
 // asteroids. The view in the left viewport is from a fixed camera; the view in 
-// the right viewport is from the spacecraft.There is approximate collision detection.  
-// Frustum culling is implemented by means of a quadtree data structure.
+// the right viewport is from the spacecraft.There is approximate collision detection,
+// the asteroids near the spacecraft found in a uniform hash grid (see broadphase.h).
+// Frustum culling is implemented by means of a quadtree data structure, stored
+// linearly with the asteroids in Morton order (see quadtree.h), whose nodes are tested
+// against the planes of the frustum several at a time (see frustumCulling.h). Once the
+// asteroids are set drifting the quadtree no longer fits them, and they are kept instead
+// in a dynamic tree updated as they move (see dynamicTree.h). The asteroids which survive
+// culling may be drawn together by instancing a single sphere mesh, their centers, radii
+// and colors written into a persistently mapped buffer (see instancedAsteroids.h).
+// Alternatively the culling is done on the GPU, a compute shader testing every asteroid
+// and writing those visible, with their number, into buffers from which they are drawn
+// by an indirect draw (see gpuCulling.h).
 // 
-// COMPILE NOTE: File intersectionDetectionRoutines.cpp must be in the same folder.
-// EXECUTION NOTE: If ROWS and COLUMNS are large the quadtree takes time to build so
-//                 the display may take several seconds to come up.
+// COMPILE NOTE: Files intersectionDetectionRoutines.cpp, quadtree.h, frustumCulling.h,
+//               broadphase.h, dynamicTree.h, instancedAsteroids.h, gpuCulling.h, shader.h, 
+//               shader.cpp, vertexShader.glsl, fragmentShader.glsl and computeShader.glsl 
+//               must be in the same folder.
+// EXECUTION NOTE: The quadtree is built in time proportional to n log n for n asteroids,
+//                 on a thread for each quadrant of the field if it is large, so even
+//                 with ROWS and COLUMNS in the thousands the display comes up quickly.
 //
 // User-defined constants: 
 // ROWS is the number of rows of  asteroids.
@@ -21,13 +35,16 @@
 // Press the left/right arrow keys to turn the craft.
 // Press the up/down arrow keys to move the craft.
 // Press space to toggle between frustum culling enabled and disabled.
+// Press 'd' to start/stop the asteroids drifting.
+// Press 'i' to toggle between instanced and one-by-one drawing of the asteroids.
+// Press 'g' to toggle between frustum culling on the CPU and the GPU.
 // 
 // Sumanta Guha.
 ////////////////////////////////////////////////////////////////////////////////////// 
 
 #include <cstdlib>
 #include <cmath>
-#include <list>
+#include <vector>
 #include <iostream>
 
 #ifdef __APPLE__
@@ -60,6 +77,12 @@ static int isCollision = 0; // Is there collision between the spacecraft and an
 static unsigned int spacecraft; // Display lists base index.
 
 #include "intersectionDetectionRoutines.cpp"
+#include "quadtree.h"
+#include "broadphase.h"
+#include "dynamicTree.h"
+#include "shader.h"
+#include "instancedAsteroids.h"
+#include "gpuCulling.h"
 
 // Routine to draw a bitmap character string.
 void writeBitmapString(void *font, char *string)
@@ -80,6 +103,7 @@ public:
    float getCenterY() { return centerY; }
    float getCenterZ() { return centerZ; }
    float getRadius()  { return radius; }
+   unsigned char *getColor() { return color; }
    void draw();
 
 private:
@@ -127,161 +151,149 @@ void Asteroid::draw()
 
 Asteroid arrayAsteroids[ROWS][COLUMNS]; // Global array of asteroids.
 
-// Quadtree node class.
-class QuadtreeNode
-{
-public:
-   QuadtreeNode(float x, float z, float s);
-   int numberAsteroidsIntersected(); // Return the number of asteroids intersecting the square.
-   void addIntersectingAsteroidsToList(); // Add the intersected asteoroids to the local list of asteroids.
-
-   void build(); // Recursive routine to split a square that intersects more than one asteroid; 
-                 // if it intersects at most one asteroid leave it as a leaf and add the intersecting 
-                 // asteroid, if any, to a local list of asteroids.
-
-   void drawAsteroids(float x1, float z1, float x2, float z2,  // Recursive routine to draw the asteroids
-					  float x3, float z3, float x4, float z4); // in a square's list if the square is a
-															   // leaf and it intersects the frustum (which
-                                                               // is specified by the input parameters); 
-															   // if the square is not a leaf, the routine
-                                                               // recursively calls itself on its children.
-                                                              
-private: 
-   float SWCornerX, SWCornerZ; // x and z co-ordinates of the SW corner of the square.
-   float size; // Side length of square.
-   QuadtreeNode *SWChild, *NWChild, *NEChild, *SEChild; // Children nodes.
-   list<Asteroid> asteroidList; // Local list of asteroids intersecting the square - only filled for leaf nodes.
-
-   friend class Quadtree;
-};
+Quadtree asteroidsQuadtree; // Global quadtree.
+static vector<AsteroidRange> culledRanges; // Ranges of the asteroids of the quadtree to draw.
 
-// QuadtreeNode constructor.
-QuadtreeNode::QuadtreeNode(float x, float z, float s)
-{
-   SWCornerX = x; SWCornerZ = z; size = s;
-   SWChild = NWChild = NEChild = SEChild = NULL;
-   asteroidList.clear();
-}
+HashGrid asteroidsGrid; // Global hash grid of the asteroids of the quadtree, for collisions.
+static vector<BroadphasePair> candidatePairs; // Asteroids near the spacecraft.
 
-// Return the number of asteroids intersecting the square.
-int QuadtreeNode::numberAsteroidsIntersected()
+static int isDrifting = 0; // Are the asteroids drifting?
+static int hasDrifted = 0; // Have they drifted, so that driftingTree replaces the above?
+static int animationPeriod = 100; // Time interval between frames.
+DynamicTree driftingTree(2.0); // Global dynamic tree of the drifting asteroids, its boxes 
+                               // fattened by 2 so that most steps leave it unchanged.
+static AsteroidArray driftingAsteroids; // Copy of the quadtree's asteroids, to drift.
+static vector<float> driftX, driftZ; // Their steps per frame.
+static vector<int> driftingLeaves; // Their leaves in driftingTree.
+static vector<int> culledAsteroids; // Asteroids of driftingTree to draw.
+
+static int isInstanced = 1; // Are the asteroids drawn instanced?
+InstancedAsteroids asteroidInstances; // Global instanced sphere mesh and instance buffer.
+
+static int isGpuCulled = 0; // Are the asteroids culled on the GPU?
+GpuCulling asteroidsGpuCulling; // Global asteroid storage buffers of the compute shader.
+
+// Function to draw asteroid k of the quadtree's asteroid array.
+void drawAsteroid(const AsteroidArray &asteroids, int k)
 {
-   int numVal = 0;
-   int i, j;
-   for (j=0; j<COLUMNS; j++)
-      for (i=0; i<ROWS; i++)
-	     if (arrayAsteroids[i][j].getRadius() > 0.0) 
-	        if ( checkDiscRectangleIntersection( SWCornerX, SWCornerZ, SWCornerX+size, SWCornerZ-size,
-                 arrayAsteroids[i][j].getCenterX(), arrayAsteroids[i][j].getCenterZ(), 
-				 arrayAsteroids[i][j].getRadius() )
-			   )
-		       numVal++;
-   return numVal;
+   glPushMatrix();
+   glTranslatef(asteroids.centerX[k], asteroids.centerY[k], asteroids.centerZ[k]);
+   glColor3ubv(&asteroids.colors[3*k]);
+   glutWireSphere(asteroids.radius[k], (int)asteroids.radius[k]*6, (int)asteroids.radius[k]*6);
+   glPopMatrix();
 }
 
-// Add the asteoroids intersecting the square to a local list of asteroids.
-void QuadtreeNode::addIntersectingAsteroidsToList()
+// Function to return the box of asteroid k of driftingAsteroids.
+DynamicTreeBox driftingBox(int k)
 {
-   int i, j;
-   for (j=0; j<COLUMNS; j++)
-      for (i=0; i<ROWS; i++)
-	     if (arrayAsteroids[i][j].getRadius() > 0.0) 
-	        if ( checkDiscRectangleIntersection( SWCornerX, SWCornerZ, SWCornerX+size, SWCornerZ-size, 
-				 arrayAsteroids[i][j].getCenterX(), arrayAsteroids[i][j].getCenterZ(), 
-				 arrayAsteroids[i][j].getRadius() )
-			   )
-		       asteroidList.push_back( Asteroid(arrayAsteroids[i][j]) );
+   float r = driftingAsteroids.radius[k];
+   DynamicTreeBox box = { driftingAsteroids.centerX[k] - r, driftingAsteroids.centerY[k] - r, 
+                          driftingAsteroids.centerZ[k] - r, driftingAsteroids.centerX[k] + r, 
+                          driftingAsteroids.centerY[k] + r, driftingAsteroids.centerZ[k] + r };
+   return box;
 }
 
-// Recursive routine to split a square that intersects more than one asteroid; if it intersects
-// at most one asteroid leave it as a leaf and add the intersecting asteroid, if any, to a local 
-// list of asteroids.
-void QuadtreeNode::build()
+// Routine to draw the n instances written to asteroidInstances with the current 
+// modelview and projection matrices.
+void drawInstances(int n)
 {
-   if ( this->numberAsteroidsIntersected() <= 1 ) this->addIntersectingAsteroidsToList();
-   else
-   {
-      SWChild = new QuadtreeNode(SWCornerX, SWCornerZ, size/2.0);
-      NWChild = new QuadtreeNode(SWCornerX, SWCornerZ - size/2.0, size/2.0);
-      NEChild = new QuadtreeNode(SWCornerX + size/2.0, SWCornerZ - size/2.0, size/2.0);
-      SEChild = new QuadtreeNode(SWCornerX + size/2.0, SWCornerZ, size/2.0);
-	  
-	  SWChild->build(); NWChild->build(); NEChild->build(); SEChild->build(); 
-   }
+   float modelViewMat[16], projMat[16];
+   glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMat);
+   glGetFloatv(GL_PROJECTION_MATRIX, projMat);
+   asteroidInstances.draw(n, modelViewMat, projMat);
 }
 
-// Recursive routine to draw the asteroids in a square's list if the square is a
-// leaf and it intersects the frustum (which is specified by the input parameters);
-// if the square is not a leaf, the routine recursively calls itself on its children.
-void QuadtreeNode::drawAsteroids(float x1, float z1, float x2, float z2, 
-					             float x3, float z3, float x4, float z4)
+// Routine to draw all the asteroids.
+void drawAllAsteroids(void)
 {
-   // If the square does not intersect the frustum do nothing.
-   if ( checkQuadrilateralsIntersection(x1, z1, x2, z2, x3, z3, x4, z4,
-								        SWCornerX, SWCornerZ, SWCornerX, SWCornerZ-size,
-								        SWCornerX+size, SWCornerZ-size, SWCornerX+size, SWCornerZ) )
+   int i, j, k;
+
+   if (isInstanced)
    {
-      if (SWChild == NULL) // Square is leaf.
-	  {
-         // Define local iterator to traverse asteroidList and initialize.
-         list<Asteroid>::iterator asteroidListIterator;
-         asteroidListIterator = asteroidList.begin();
-
-         // Draw all the asteroids in asteroidList.
-         while(asteroidListIterator != asteroidList.end() )
-		 {
-            asteroidListIterator->draw();
-	        asteroidListIterator++;
-		 }	  
-	  }
-	  else 
-	  {
-	     SWChild->drawAsteroids(x1, z1, x2, z2, x3, z3, x4, z4); 
-		 NWChild->drawAsteroids(x1, z1, x2, z2, x3, z3, x4, z4); 
-		 NEChild->drawAsteroids(x1, z1, x2, z2, x3, z3, x4, z4); 
-		 SEChild->drawAsteroids(x1, z1, x2, z2, x3, z3, x4, z4);
-	  }
+      const AsteroidArray &asteroids = hasDrifted ? driftingAsteroids : asteroidsQuadtree.getAsteroids();
+      AsteroidInstance *instances = asteroidInstances.beginInstances();
+      for (k = 0; k < asteroids.size(); k++)
+         setAsteroidInstance(instances[k], asteroids.centerX[k], asteroids.centerY[k], asteroids.centerZ[k], 
+                             asteroids.radius[k], &asteroids.colors[3*k]);
+      drawInstances(asteroids.size());
    }
+   else if (hasDrifted)
+      for (k = 0; k < driftingAsteroids.size(); k++) drawAsteroid(driftingAsteroids, k);
+   else
+      for (j=0; j<COLUMNS; j++)
+         for (i=0; i<ROWS; i++)
+            arrayAsteroids[i][j].draw();
 }
 
-// Quadtree class.
-class Quadtree
+// Routine to draw the asteroids in the nodes of the quadtree, or of driftingTree once the
+// asteroids have drifted, that intersect the frustum (which is specified by the input 
+// parameters).
+void drawCulledAsteroids(float x1, float z1, float x2, float z2, 
+                         float x3, float z3, float x4, float z4)
 {
-public:
-   Quadtree() { header = NULL; } // Constructor.
-   void initialize(float x, float z, float s); // Initialize quadtree by splitting nodes
-                                                     // till each leaf node intersects at
-                                                     // most one asteroid.
+   int r, k;
+   const AsteroidArray &asteroids = asteroidsQuadtree.getAsteroids();
 
-   void drawAsteroids(float x1, float z1, float x2, float z2,  // Routine to draw all the asteroids in the  
-					  float x3, float z3, float x4, float z4); // asteroid list of each leaf square that
-                                                               // intersects the frustum.
-
-private:
-   QuadtreeNode *header;
-};
+   // Cull all the asteroids, drifted or not, on the GPU and draw those visible indirectly.
+   if (isGpuCulled)
+   {
+      FrustumPlanes frustum;
+      float modelViewMat[16], projMat[16];
+      setQuadrilateralFrustum(frustum, x1, z1, x2, z2, x3, z3, x4, z4);
+      asteroidsGpuCulling.cull(frustum);
+      glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMat);
+      glGetFloatv(GL_PROJECTION_MATRIX, projMat);
+      asteroidInstances.drawIndirect(asteroidsGpuCulling.getInstanceBuffer(), 
+                                     asteroidsGpuCulling.getCommandBuffer(), modelViewMat, projMat);
+      return;
+   }
 
-// Initialize quadtree by splitting nodes till each leaf node intersects at most one asteroid.
-void Quadtree::initialize(float x, float z, float s)
-{
-   header = new QuadtreeNode(x, z, s);
-   header->build();
-}
+   if (hasDrifted)
+   {
+      FrustumPlanes frustum;
+      setQuadrilateralFrustum(frustum, x1, z1, x2, z2, x3, z3, x4, z4);
+      driftingTree.cull(frustum, culledAsteroids);
+      if (isInstanced)
+      {
+         AsteroidInstance *instances = asteroidInstances.beginInstances();
+         for (k = 0; k < (int)culledAsteroids.size(); k++)
+         {
+            int l = culledAsteroids[k];
+            setAsteroidInstance(instances[k], driftingAsteroids.centerX[l], driftingAsteroids.centerY[l], 
+                                driftingAsteroids.centerZ[l], driftingAsteroids.radius[l], 
+                                &driftingAsteroids.colors[3*l]);
+         }
+         drawInstances((int)culledAsteroids.size());
+      }
+      else
+         for (k = 0; k < (int)culledAsteroids.size(); k++) drawAsteroid(driftingAsteroids, culledAsteroids[k]);
+      return;
+   }
 
-// Routine to draw all the asteroids in the asteroid list of each leaf square that intersects the frustum.
-void Quadtree::drawAsteroids(float x1, float z1, float x2, float z2, 
-					         float x3, float z3, float x4, float z4)
-{
-   header->drawAsteroids(x1, z1, x2, z2, x3, z3, x4, z4); 
+   asteroidsQuadtree.cull(x1, z1, x2, z2, x3, z3, x4, z4, culledRanges);
+   if (isInstanced)
+   // Write the asteroids of the culled ranges one after another as instances.
+   {
+      AsteroidInstance *instances = asteroidInstances.beginInstances();
+      int n = 0;
+      for (r = 0; r < (int)culledRanges.size(); r++)
+         for (k = culledRanges[r].first; k < culledRanges[r].first + culledRanges[r].count; k++, n++)
+            setAsteroidInstance(instances[n], asteroids.centerX[k], asteroids.centerY[k], asteroids.centerZ[k], 
+                                asteroids.radius[k], &asteroids.colors[3*k]);
+      drawInstances(n);
+   }
+   else
+      for (r = 0; r < (int)culledRanges.size(); r++)
+         for (k = culledRanges[r].first; k < culledRanges[r].first + culledRanges[r].count; k++)
+            drawAsteroid(asteroids, k);
 }
 
-Quadtree asteroidsQuadtree; // Global quadtree.
-
 // Initialization routine.
 void setup(void) 
 {
    int i, j;
    float initialSize;
+   AsteroidArray field;
 
    spacecraft = glGenLists(1);
    glNewList(spacecraft, GL_COMPILE);
@@ -309,10 +321,45 @@ void setup(void)
 			                                    rand()%256, rand()%256, rand()%256);
 		 }
 
-   // Initialize global asteroidsQuadtree - the root square bounds the entire asteroid field.
+   // Initialize global asteroidsQuadtree with the asteroids of arrayAsteroids - the root 
+   // square bounds the entire asteroid field.
+   for (j=0; j<COLUMNS; j++)
+      for (i=0; i<ROWS; i++)
+	     if (arrayAsteroids[i][j].getRadius() > 0.0) 
+            field.add(arrayAsteroids[i][j].getCenterX(), arrayAsteroids[i][j].getCenterY(), 
+                      arrayAsteroids[i][j].getCenterZ(), arrayAsteroids[i][j].getRadius(), 
+                      arrayAsteroids[i][j].getColor());
    if (ROWS <= COLUMNS) initialSize = (COLUMNS - 1)*30.0 + 6.0;
    else initialSize = (ROWS - 1)*30.0 + 6.0;
-   asteroidsQuadtree.initialize( -initialSize/2.0, -37.0, initialSize );
+   asteroidsQuadtree.initialize( field, -initialSize/2.0, -37.0, initialSize );
+
+   // Initialize global asteroidsGrid with the same asteroids, in cells the size of the 
+   // spacing of the asteroids, so that the spacecraft's bounding sphere looks in a few.
+   const AsteroidArray &asteroids = asteroidsQuadtree.getAsteroids();
+   BroadphaseSpheres spheres = { &asteroids.centerX[0], &asteroids.centerY[0], &asteroids.centerZ[0], 
+                                 &asteroids.radius[0], asteroids.size() };
+   if (asteroids.size() > 0) asteroidsGrid.initialize(spheres, 30.0);
+
+   // Initialize driftingAsteroids, ready to drift in random directions, and their leaves
+   // in driftingTree.
+   driftingAsteroids = asteroids;
+   for (i = 0; i < driftingAsteroids.size(); i++)
+   {
+      float a = (PI/180.0) * (rand()%360);
+      driftX.push_back(0.2 * sin(a));
+      driftZ.push_back(0.2 * cos(a));
+      driftingLeaves.push_back(driftingTree.insert(driftingBox(i), i));
+   }
+
+   // Create shader program executable for the instanced asteroids and initialize global 
+   // asteroidInstances with a sphere tessellated as by Asteroid::draw() for radius 3.
+   unsigned int programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
+   asteroidInstances.initialize(asteroids.size(), 18, 18, programId);
+
+   // Create the compute shader program executable and initialize global asteroidsGpuCulling
+   // with the asteroids, drawn as asteroidInstances' sphere.
+   unsigned int computeProgramId = setProgram("compute", "computeShader.glsl", NULL);
+   asteroidsGpuCulling.initialize(asteroids, asteroidInstances.getNumIndices(), computeProgramId);
 
    glEnable(GL_DEPTH_TEST);
    glClearColor (0.0, 0.0, 0.0, 0.0);
@@ -331,24 +378,42 @@ int checkSpheresIntersection(float x1, float y1, float z1, float r1,
 // Collision detection is approximate as instead of the spacecraft we use a bounding sphere.
 int asteroidCraftCollision( float x, float z, float a)
 {
-   int i,j;
+   const AsteroidArray &asteroids = asteroidsQuadtree.getAsteroids();
+   float craftX = x - 5 * sin( (PI/180.0) * a), craftZ = z - 5 * cos( (PI/180.0) * a);
 
-   // Check for collision with each asteroid.
-   for (j=0; j<COLUMNS; j++)
-      for (i=0; i<ROWS; i++)
-		 if (arrayAsteroids[i][j].getRadius() > 0 ) // If asteroid exists.
-            if ( checkSpheresIntersection( x - 5 * sin( (PI/180.0) * a), 0.0, 
-		         z - 5 * cos( (PI/180.0) * a), 7.072, 
-		         arrayAsteroids[i][j].getCenterX(), arrayAsteroids[i][j].getCenterY(), 
-		         arrayAsteroids[i][j].getCenterZ(), arrayAsteroids[i][j].getRadius() ) )
-		       return 1;
+   // Once the asteroids have drifted check for collision with each in driftingTree near
+   // the spacecraft.
+   if (hasDrifted)
+   {
+      DynamicTreeBox craftBox = { craftX - 7.072f, -7.072f, craftZ - 7.072f, 
+                                  craftX + 7.072f, 7.072f, craftZ + 7.072f };
+      driftingTree.query(craftBox, culledAsteroids);
+      for (int k = 0; k < (int)culledAsteroids.size(); k++)
+      {
+         int l = culledAsteroids[k];
+         if ( checkSpheresIntersection( craftX, 0.0, craftZ, 7.072, driftingAsteroids.centerX[l], 
+		        driftingAsteroids.centerY[l], driftingAsteroids.centerZ[l], driftingAsteroids.radius[l] ) )
+		    return 1;
+      }
+      return 0;
+   }
+
+   // Check for collision with each asteroid near the spacecraft.
+   candidatePairs.clear();
+   asteroidsGrid.findPairs(craftX, 0.0, craftZ, 7.072, 0, candidatePairs);
+   for (int k = 0; k < (int)candidatePairs.size(); k++)
+   {
+      int l = candidatePairs[k].object;
+      if ( checkSpheresIntersection( craftX, 0.0, craftZ, 7.072, 
+		     asteroids.centerX[l], asteroids.centerY[l], asteroids.centerZ[l], asteroids.radius[l] ) )
+		 return 1;
+   }
    return 0;
 }
 
 // Drawing routine.
 void drawScene(void)
 { 
-   int i, j;
    glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
    // Begin left viewport.
@@ -370,15 +435,11 @@ void drawScene(void)
    gluLookAt(0.0, 10.0, 20.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
  
    if (!isFrustumCulled)
-  // Draw all the asteroids in arrayAsteroids.
-   {
-      for (j=0; j<COLUMNS; j++)
-         for (i=0; i<ROWS; i++)
-            arrayAsteroids[i][j].draw();
-   }
-   else // Draw only asteroids in leaf squares of the quadtree that intersect the fixed frustum
+  // Draw all the asteroids.
+      drawAllAsteroids();
+   else // Draw only asteroids in nodes of the quadtree that intersect the fixed frustum
 	    // with apex at the origin.
-      asteroidsQuadtree.drawAsteroids(-5.0, -5.0, -250.0, -250.0, 250.0, -250.0, 5.0, -5.0 );
+      drawCulledAsteroids(-5.0, -5.0, -250.0, -250.0, 250.0, -250.0, 5.0, -5.0 );
 
    // Draw spacecraft.
    glPushMatrix();
@@ -424,24 +485,20 @@ void drawScene(void)
 			 0.0);
 
    if (!isFrustumCulled)
-   // Draw all the asteroids in arrayAsteroids.
-   {
-      for (j=0; j<COLUMNS; j++)
-         for (i=0; i<ROWS; i++)
-            arrayAsteroids[i][j].draw();
-   }
-   else // Draw only asteroids in leaf squares of the quadtree that intersect the frustum
+   // Draw all the asteroids.
+      drawAllAsteroids();
+   else // Draw only asteroids in nodes of the quadtree that intersect the frustum
 	    // "carried" by the spacecraft with apex at its tip and oriented with its axis
 		// along the spacecraft's axis.
-      asteroidsQuadtree.drawAsteroids( xVal - 7.072 * sin( (PI/180.0) * (45.0 + angle) ),
-	                                   zVal - 7.072 * cos( (PI/180.0) * (45.0 + angle) ),
-								       xVal - 353.6 * sin( (PI/180.0) * (45.0 + angle) ),
-	                                   zVal - 353.6 * cos( (PI/180.0) * (45.0 + angle) ),
-                                       xVal + 353.6 * sin( (PI/180.0) * (45.0 - angle) ),
-									   zVal - 353.6 * cos( (PI/180.0) * (45.0 - angle) ),
-									   xVal + 7.072 * sin( (PI/180.0) * (45.0 - angle) ),
-	                                   zVal - 7.072 * cos( (PI/180.0) * (45.0 - angle) )
-	                                 );
+      drawCulledAsteroids( xVal - 7.072 * sin( (PI/180.0) * (45.0 + angle) ),
+                           zVal - 7.072 * cos( (PI/180.0) * (45.0 + angle) ),
+                           xVal - 353.6 * sin( (PI/180.0) * (45.0 + angle) ),
+                           zVal - 353.6 * cos( (PI/180.0) * (45.0 + angle) ),
+                           xVal + 353.6 * sin( (PI/180.0) * (45.0 - angle) ),
+                           zVal - 353.6 * cos( (PI/180.0) * (45.0 - angle) ),
+                           xVal + 7.072 * sin( (PI/180.0) * (45.0 - angle) ),
+                           zVal - 7.072 * cos( (PI/180.0) * (45.0 - angle) )
+                           );
    // End right viewport.
 
    glutSwapBuffers();
@@ -461,6 +518,24 @@ void resize(int w, int h)
    height = h;
 }
 
+// Timer function: step each drifting asteroid, moving its leaf in driftingTree.
+void animate(int value)
+{
+   if (isDrifting)
+   {
+      for (int k = 0; k < driftingAsteroids.size(); k++)
+      {
+         driftingAsteroids.centerX[k] += driftX[k];
+         driftingAsteroids.centerZ[k] += driftZ[k];
+         driftingTree.move(driftingLeaves[k], driftingBox(k));
+      }
+      asteroidsGpuCulling.update(driftingAsteroids);
+
+      glutPostRedisplay();
+      glutTimerFunc(animationPeriod, animate, 1);
+   }
+}
+
 // Keyboard input processing routine.
 void keyInput(unsigned char key, int x, int y)
 {
@@ -472,6 +547,24 @@ void keyInput(unsigned char key, int x, int y)
 	  case ' ':
 	     isFrustumCulled = 1 - isFrustumCulled;
 		 glutPostRedisplay();
+		 break;
+	  case 'd':
+	     if (isDrifting) isDrifting = 0;
+		 else
+		 {
+		    isDrifting = 1;
+			hasDrifted = 1;
+			animate(1);
+		 }
+		 break;
+	  case 'i':
+	     isInstanced = 1 - isInstanced;
+		 glutPostRedisplay();
+		 break;
+	  case 'g':
+	     isGpuCulled = 1 - isGpuCulled;
+		 glutPostRedisplay();
+		 break;
       default:
          break;
    }
@@ -516,38 +609,38 @@ void specialKeyInput(int key, int x, int y)
 // Routine to output interaction instructions to the C++ window.
 void printInteraction(void)
 {
-   cout << "ALERT: The OpenGL window may take a while to come up because" << endl
-		<< "of the time to build the quadtree!" << endl
-		<<  endl;
    cout << "Interaction:" << endl;
    cout << "Press the left/right arrow keys to turn the craft." << endl
         << "Press the up/down arrow keys to move the craft." << endl
-		<< "Press space to toggle between frustum culling enabled and disabled." << endl;
+		<< "Press space to toggle between frustum culling enabled and disabled." << endl
+		<< "Press 'd' to start/stop the asteroids drifting." << endl
+		<< "Press 'i' to toggle between instanced and one-by-one drawing of the asteroids." << endl
+		<< "Press 'g' to toggle between frustum culling on the CPU and the GPU." << endl;
 }
 
 // Main routine.
 int main(int argc, char **argv) 
 {
-   printInteraction();
-   glutInit(&argc, argv);
-
-   glutInitContextVersion(4, 3); 
-   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE); 
- 
-   glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH); 
-   glutInitWindowSize(800, 400);
-   glutInitWindowPosition(100, 100); 
-   glutCreateWindow("spaceTravelFrustumCulled.cpp");
-   glutDisplayFunc(drawScene); 
-   glutReshapeFunc(resize);  
-   glutKeyboardFunc(keyInput);
-   glutSpecialFunc(specialKeyInput);
-
-   glewExperimental = GL_TRUE; 
-   glewInit(); 
-   
-   setup(); 
-
+   printInteraction();
+   glutInit(&argc, argv);
+
+   glutInitContextVersion(4, 3); 
+   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE); 
+ 
+   glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH); 
+   glutInitWindowSize(800, 400);
+   glutInitWindowPosition(100, 100); 
+   glutCreateWindow("spaceTravelFrustumCulled.cpp");
+   glutDisplayFunc(drawScene); 
+   glutReshapeFunc(resize);  
+   glutKeyboardFunc(keyInput);
+   glutSpecialFunc(specialKeyInput);
+
+   glewExperimental = GL_TRUE; 
+   glewInit(); 
+   
+   setup(); 
+
    glutMainLoop(); 
 }
 
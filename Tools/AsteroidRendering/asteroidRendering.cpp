@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// asteroidRendering.cpp
+//
+// This program compares the two ways spaceTravelFrustumCulled.cpp draws its asteroids:
+// one by one as Asteroid::draw() does, with glPushMatrix(), glTranslatef(),
+// glColor3ubv() and glutWireSphere() for each, and instanced, the asteroids written
+// into the persistently mapped buffer of instancedAsteroids.h and drawn by a single
+// call. For fields of asteroids laid out as in the program, viewed from the spacecraft
+// at its starting position, it reports for both ways, with frustum culling off (every
+// asteroid drawn) and on (those of the nodes of the quadtree meeting the frustum):
+// the CPU time of a frame, up to the last GL call; the time to its completion, after
+// glFinish(); the draw calls of a frame; and the number of pixels differing between the
+// drawings of the two ways.
+//
+// The draw calls of the one-by-one drawing are counted as freeglut 3 makes them for a
+// wire sphere, a line loop per circle of latitude and a line strip per slice.
+//
+// Usage:
+// asteroidRendering [asteroids per side] ...
+// The sides default to 100 and 1000, i.e., 10k and 1M asteroids. The shader files must
+// be in the working directory.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "quadtree.h"
+#include "shader.h"
+#include "instancedAsteroids.h"
+
+using namespace std;
+
+#define PI 3.14159265
+#define WINDOW_SIZE 400 // Width and height of the window, as the program's viewports.
+#define SPHERE_SLICES 18 // Slices and stacks of an asteroid, as Asteroid::draw() for radius 3.
+#define WIRE_SPHERE_DRAWS (2 * SPHERE_SLICES - 1) // Draw calls of freeglut 3 for a wire sphere.
+#define MAX_FRAMES 10 // Frames timed per way of drawing.
+#define FRAME_ASTEROIDS 100000 // Asteroids drawn in the frames timed, at most, beyond
+                               // the first frame.
+
+// Times and draw calls of a frame.
+struct FrameCost
+{
+   double cpuTime, frameTime;
+   long long drawCalls;
+};
+
+// Field of side x side asteroids of radius 3, 30 apart, with random colors, as in
+// spaceTravelFrustumCulled.cpp.
+void makeField(int side, AsteroidArray &field)
+{
+   field = AsteroidArray();
+   field.reserve(side * side);
+   for (int j = 0; j < side; j++)
+      for (int i = 0; i < side; i++)
+      {
+         unsigned char color[3] = { (unsigned char)(rand() % 256), (unsigned char)(rand() % 256),
+                                    (unsigned char)(rand() % 256) };
+         field.add(15.0 + 30.0 * (-side / 2 + j), 0.0, -40.0 - 30.0 * i, 3.0, color);
+      }
+}
+
+// Draw the asteroids of the ranges one by one, as Asteroid::draw(). Return the draw calls.
+long long drawOneByOne(const AsteroidArray &asteroids, const vector<AsteroidRange> &ranges)
+{
+   long long n = 0;
+   for (int r = 0; r < (int)ranges.size(); r++)
+      for (int k = ranges[r].first; k < ranges[r].first + ranges[r].count; k++, n++)
+      {
+         glPushMatrix();
+         glTranslatef(asteroids.centerX[k], asteroids.centerY[k], asteroids.centerZ[k]);
+         glColor3ubv(&asteroids.colors[3*k]);
+         glutWireSphere(asteroids.radius[k], (int)asteroids.radius[k]*6, (int)asteroids.radius[k]*6);
+         glPopMatrix();
+      }
+   return n * WIRE_SPHERE_DRAWS;
+}
+
+// Draw the asteroids of the ranges instanced. Return the draw calls.
+long long drawInstanced(InstancedAsteroids &instanced, const AsteroidArray &asteroids,
+                        const vector<AsteroidRange> &ranges)
+{
+   AsteroidInstance *instances = instanced.beginInstances();
+   int n = 0;
+   for (int r = 0; r < (int)ranges.size(); r++)
+      for (int k = ranges[r].first; k < ranges[r].first + ranges[r].count; k++, n++)
+         setAsteroidInstance(instances[n], asteroids.centerX[k], asteroids.centerY[k], asteroids.centerZ[k],
+                             asteroids.radius[k], &asteroids.colors[3*k]);
+
+   float modelViewMat[16], projMat[16];
+   glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMat);
+   glGetFloatv(GL_PROJECTION_MATRIX, projMat);
+   int drawCalls = instanced.getNumDrawCalls();
+   instanced.draw(n, modelViewMat, projMat);
+   return instanced.getNumDrawCalls() - drawCalls;
+}
+
+// Time frames of the spacecraft's view drawn one way, culled or not, reading back the
+// last into image.
+FrameCost timeFrames(const Quadtree &quadtree, InstancedAsteroids &instanced, bool isInstanced,
+                     bool isCulled, vector<unsigned char> &image)
+{
+   const AsteroidArray &asteroids = quadtree.getAsteroids();
+   vector<AsteroidRange> ranges;
+   FrameCost cost = { 0.0, 0.0, 0 };
+   int numFrames = 0, numDrawn = 0;
+   do
+   {
+      glFinish();
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      glLoadIdentity();
+      gluLookAt(0.0, 0.0, -10.0, 0.0, 0.0, -11.0, 0.0, 1.0, 0.0);
+      if (isCulled)
+         quadtree.cull(-7.072 * sin((PI/180.0) * 45.0), -7.072 * cos((PI/180.0) * 45.0),
+                       -353.6 * sin((PI/180.0) * 45.0), -353.6 * cos((PI/180.0) * 45.0),
+                       353.6 * sin((PI/180.0) * 45.0), -353.6 * cos((PI/180.0) * 45.0),
+                       7.072 * sin((PI/180.0) * 45.0), -7.072 * cos((PI/180.0) * 45.0), ranges);
+      else
+      {
+         AsteroidRange all = { 0, asteroids.size() };
+         ranges.assign(1, all);
+      }
+      numDrawn = 0;
+      for (int r = 0; r < (int)ranges.size(); r++) numDrawn += ranges[r].count;
+      cost.drawCalls = isInstanced ? drawInstanced(instanced, asteroids, ranges) : drawOneByOne(asteroids, ranges);
+      cost.cpuTime += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+      glFinish();
+      cost.frameTime += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+      numFrames++;
+   }
+   while (numFrames < MAX_FRAMES && (long long)numFrames * numDrawn < FRAME_ASTEROIDS);
+
+   image.resize(WINDOW_SIZE * WINDOW_SIZE * 4);
+   glReadPixels(0, 0, WINDOW_SIZE, WINDOW_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, &image[0]);
+   cost.cpuTime /= numFrames;
+   cost.frameTime /= numFrames;
+   return cost;
+}
+
+// Compare the two ways of drawing a field of side x side asteroids.
+void compareWays(int side, unsigned int programId)
+{
+   AsteroidArray field;
+   Quadtree quadtree;
+   InstancedAsteroids instanced;
+   makeField(side, field);
+   float size = (side - 1) * 30.0 + 6.0;
+   quadtree.initialize(field, -size / 2.0, -37.0, size);
+   instanced.initialize(quadtree.getAsteroids().size(), SPHERE_SLICES, SPHERE_SLICES, programId);
+
+   printf("\n%d asteroids, instance buffer %s\n", side * side, instanced.isPersistent() ? "persistent" : "mapped per draw");
+   printf("%-8s %-11s %10s %10s %12s %8s\n", "culling", "drawing", "CPU ms", "frame ms", "draw calls", "pixels");
+
+   // Warm up both ways, e.g., for the driver to compile its variants of the shaders.
+   vector<unsigned char> warmUpImage;
+   timeFrames(quadtree, instanced, false, true, warmUpImage);
+   timeFrames(quadtree, instanced, true, true, warmUpImage);
+   for (int isCulled = 0; isCulled <= 1; isCulled++)
+   {
+      vector<unsigned char> image, instancedImage;
+      FrameCost cost = timeFrames(quadtree, instanced, false, isCulled != 0, image);
+      FrameCost instancedCost = timeFrames(quadtree, instanced, true, isCulled != 0, instancedImage);
+      int differing = 0;
+      for (int k = 0; k < WINDOW_SIZE * WINDOW_SIZE; k++)
+      {
+         bool isDifferent = false;
+         for (int c = 0; c < 3; c++) isDifferent |= (abs(image[4 * k + c] - instancedImage[4 * k + c]) > 2);
+         differing += isDifferent;
+      }
+      printf("%-8s %-11s %10.2f %10.2f %12lld\n", isCulled ? "on" : "off", "one by one", cost.cpuTime,
+             cost.frameTime, cost.drawCalls);
+      printf("%-8s %-11s %10.2f %10.2f %12lld %8d\n", "", "instanced", instancedCost.cpuTime,
+             instancedCost.frameTime, instancedCost.drawCalls, differing);
+   }
+}
+
+// Set up the GL state as the program's right viewport and run the comparisons.
+void runBenchmark(int numSides, int *sides)
+{
+   unsigned int programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
+
+   glViewport(0, 0, WINDOW_SIZE, WINDOW_SIZE);
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 250.0);
+   glMatrixMode(GL_MODELVIEW);
+   glEnable(GL_DEPTH_TEST);
+   glClearColor(0.0, 0.0, 0.0, 0.0);
+
+   for (int k = 0; k < numSides; k++) compareWays(sides[k], programId);
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+   glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
+   glutCreateWindow("asteroidRendering.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   int defaultSides[2] = { 100, 1000 };
+   vector<int> sides;
+   for (int k = 1; k < argc; k++) sides.push_back(atoi(argv[k]));
+   if (sides.empty()) sides.assign(defaultSides, defaultSides + 2);
+   runBenchmark((int)sides.size(), &sides[0]);
+   return 0;
+}
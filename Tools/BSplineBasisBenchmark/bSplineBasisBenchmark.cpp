@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// bSplineBasisBenchmark.cpp
+//
+// This program compares the B-spline functions of bSplineBasis.h, computed by the
+// triangular table of the Cox-de Boor recursion, to those of the recursive Bspline() of
+// bSplines.cpp and the spline curve programs of Chapter 16.
+//
+// It first checks that the two agree to the last bit on the knots of those programs as
+// they are edited: the 9 knots of bSplines.cpp at orders 1 to 4, the 13 of the cubic
+// spline curve programs at order 4 and the 12 of the quadratic ones at order 3, reset,
+// with double and triple knots, with triple knots at the ends, pushed together at the
+// largest value and after random sequences of presses of the left and right arrow keys,
+// moving knots by increaseKnot() and decreaseKnot() as the programs do. Each B-spline is
+// sampled as drawSpline() samples it, every 0.005 across its support, and at the knots;
+// the points of the curves at the same parameters are compared as well, against the sum
+// of the control points weighted by Bspline() that the programs draw the knot images by.
+//
+// It then times either way for orders 1 to 8 on uniform knots, a single B-spline
+// sampled as by drawSpline() and the point of a curve with all its control points, and
+// checks the derivatives of the table against central differences of its values.
+//
+// Usage:
+// bSplineBasisBenchmark [number of random knot edit sequences]
+// The number defaults to 200.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "bSplineBasis.h"
+
+#define MAX_KNOTS 32 // Most knots of a knot vector.
+#define MAX_KNOT_VALUE 80.0 // Largest knot value of the programs.
+#define SAMPLE_STEP 0.005 // Parameter step of drawSpline().
+#define NUM_EDITS 100 // Arrow key presses of a random edit sequence.
+#define MAX_TIMED_ORDER 8 // Highest order timed.
+#define NUM_TIMED_KNOTS 24 // Knots of the timed knot vector.
+
+using namespace std;
+
+// Recursive computation of B-spline functions, Bspline() of the programs with the knots
+// passed in.
+float recursiveBspline(const float *knots, int i, int m, float u)
+{
+   float coef1, coef2;
+   if ( m == 1 )
+   {
+      if ( i == 0 ) if ( ( knots[i] <= u ) && ( u <= knots[i+1] ) ) return 1.0;
+      if ( ( knots[i] < u ) && ( u <= knots[i+1] ) ) return 1.0;
+      else return 0.0;
+   }
+   else
+   {
+      if ( knots[i+m-1] == knots[i] )
+      {
+         if ( u == knots[i] ) coef1 = 1;
+         else coef1 = 0;
+      }
+      else coef1 = (u - knots[i])/(knots[i+m-1] - knots[i]);
+
+      if ( knots[i+m] == knots[i+1] )
+      {
+         if ( u == knots[i+m] ) coef2 = 1;
+         else coef2 = 0;
+      }
+      else coef2 = (knots[i+m] - u)/(knots[i+m] - knots[i+1]);
+
+      return ( coef1 * recursiveBspline(knots, i, m-1, u) + coef2 * recursiveBspline(knots, i+1, m-1, u) );
+   }
+}
+
+// Curve point as the knot images of the programs are computed, from every control point.
+void recursiveCurvePoint(const float *knots, int numKnots, int order, const float *controlPoints,
+                         float u, float *point)
+{
+   point[0] = point[1] = point[2] = 0.0;
+   for (int j = 0; j < numKnots - order; j++)
+      for (int c = 0; c < 3; c++) point[c] += recursiveBspline(knots, j, order, u) * controlPoints[3*j + c];
+}
+
+// Knot editing of the programs, as increaseKnot() and decreaseKnot().
+void increaseKnot(float *knots, int numKnots, int i)
+{
+   if (i < numKnots - 1)
+   {
+      if (knots[i] < knots[i+1]) knots[i] += 1.0;
+      else
+      {
+         increaseKnot(knots, numKnots, i+1);
+         if (knots[i] < knots[i+1]) knots[i] += 1.0;
+      }
+   }
+   if ( (i == numKnots - 1) && (knots[i] < MAX_KNOT_VALUE) ) knots[i] += 1.0;
+}
+
+void decreaseKnot(float *knots, int numKnots, int i)
+{
+   if (i > 0)
+   {
+      if (knots[i] > knots[i-1]) knots[i] -= 1.0;
+      else
+      {
+         decreaseKnot(knots, numKnots, i-1);
+         if (knots[i] > knots[i-1]) knots[i] -= 1.0;
+      }
+   }
+   if ( (i == 0) && (knots[i] > 0.0) ) knots[i] -= 1.0;
+}
+
+// Knot vector of a program with its orders and reset spacing.
+struct Program
+{
+   const char *name;
+   int numKnots, minOrder, maxOrder;
+   float spacing;
+};
+
+static const Program programs[] =
+{
+   { "bSplines.cpp", 9, 1, 4, 10.0 },
+   { "cubicSplineCurve1.cpp", 13, 4, 4, 6.0 },
+   { "quadraticSplineCurve.cpp", 12, 3, 3, 7.0 }
+};
+
+// Tally of a comparison.
+struct Comparison
+{
+   long values, differing;
+   double maxDifference;
+};
+
+void compare(Comparison &comparison, float recursive, float table)
+{
+   comparison.values++;
+   if (memcmp(&recursive, &table, sizeof(float)) != 0 && !(recursive == 0.0 && table == 0.0))
+   {
+      comparison.differing++;
+      if (fabs(recursive - table) > comparison.maxDifference) comparison.maxDifference = fabs(recursive - table);
+   }
+}
+
+// Compare the B-splines of the order and the curve of the control points on the knots.
+void compareKnots(const float *knots, int numKnots, int order, const float *controlPoints,
+                  Comparison &functions, Comparison &curves)
+{
+   vector<float> parameters;
+   for (int index = 0; index < numKnots - order; index++)
+   {
+      parameters.clear();
+      for (float x = knots[index]; x <= knots[index + order]; x += SAMPLE_STEP) parameters.push_back(x);
+      for (int j = index; j <= index + order; j++) parameters.push_back(knots[j]);
+      for (int k = 0; k < (int)parameters.size(); k++)
+         compare(functions, recursiveBspline(knots, index, order, parameters[k]),
+                 evaluateBspline(knots, numKnots, index, order, parameters[k]));
+   }
+
+   parameters.clear();
+   for (float x = knots[0]; x <= knots[numKnots-1]; x += 20*SAMPLE_STEP) parameters.push_back(x);
+   for (int j = 0; j < numKnots; j++) parameters.push_back(knots[j]);
+   for (int k = 0; k < (int)parameters.size(); k++)
+   {
+      float recursivePoint[3], tablePoint[3];
+      recursiveCurvePoint(knots, numKnots, order, controlPoints, parameters[k], recursivePoint);
+      evaluateCurvePoint(knots, numKnots, order, controlPoints, 3, parameters[k], tablePoint);
+      for (int c = 0; c < 3; c++) compare(curves, recursivePoint[c], tablePoint[c]);
+   }
+}
+
+// Check the programs' knot editing scenarios.
+void checkScenarios(int numSequences)
+{
+   printf("Agreement with the recursion, values differing in any bit\n");
+   printf("%-26s %-22s %5s %12s %10s %12s %10s\n", "program", "knots", "order", "B-splines", "differing",
+          "curve co-ords", "differing");
+
+   // Control points of the curve programs, zigzagging as they do.
+   float controlPoints[3*MAX_KNOTS];
+   for (int j = 0; j < MAX_KNOTS; j++)
+   {
+      controlPoints[3*j] = -40.0 + 10.0*j;
+      controlPoints[3*j + 1] = (j % 2) ? 30.0 : -20.0;
+      controlPoints[3*j + 2] = 0.0;
+   }
+
+   srand(1);
+   for (int p = 0; p < (int)(sizeof(programs)/sizeof(programs[0])); p++)
+   {
+      const Program &program = programs[p];
+      int n = program.numKnots;
+      for (int order = program.minOrder; order <= program.maxOrder; order++)
+         for (int scenario = 0; scenario < 6; scenario++)
+         {
+            const char *names[] = { "reset", "double knot", "triple knot", "end triple knots", "pushed to 80",
+                                    "random edits" };
+            Comparison functions = { 0, 0, 0.0 }, curves = { 0, 0, 0.0 };
+            int numRuns = (scenario == 5) ? numSequences : 1;
+            for (int run = 0; run < numRuns; run++)
+            {
+               float knots[MAX_KNOTS];
+               for (int i = 0; i < n; i++) knots[i] = program.spacing * i;
+               int middle = n / 2;
+               switch (scenario)
+               {
+                  case 1: // Knot middle moved right onto the next.
+                     while (knots[middle] < knots[middle+1]) increaseKnot(knots, n, middle);
+                     break;
+                  case 2: // And the one before it too.
+                     while (knots[middle] < knots[middle+1]) increaseKnot(knots, n, middle);
+                     while (knots[middle-1] < knots[middle]) increaseKnot(knots, n, middle-1);
+                     break;
+                  case 3: // The first and last three knots each made equal.
+                     while (knots[2] > 0.0) decreaseKnot(knots, n, 2);
+                     while (knots[n-3] < knots[n-1]) increaseKnot(knots, n, n-3);
+                     break;
+                  case 4: // Every knot pushed to the largest value by the first.
+                     while (knots[0] < MAX_KNOT_VALUE) increaseKnot(knots, n, 0);
+                     break;
+                  case 5: // Random presses of the arrow keys on random selected knots.
+                     for (int e = 0; e < NUM_EDITS; e++)
+                     {
+                        int selected = rand() % n, presses = 1 + rand() % 20;
+                        for (int k = 0; k < presses; k++)
+                           if (rand() % 2) increaseKnot(knots, n, selected);
+                           else decreaseKnot(knots, n, selected);
+                     }
+                     break;
+                  default:
+                     break;
+               }
+               compareKnots(knots, n, order, controlPoints, functions, curves);
+            }
+            printf("%-26s %-22s %5d %12ld %10ld %12ld %10ld\n", program.name, names[scenario], order,
+                   functions.values, functions.differing, curves.values, curves.differing);
+            if (functions.differing || curves.differing)
+               printf("   largest difference %g\n", max(functions.maxDifference, curves.maxDifference));
+         }
+   }
+}
+
+double nanoseconds(chrono::high_resolution_clock::time_point start, long count)
+{
+   return chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / count;
+}
+
+// Time either way for orders 1 to MAX_TIMED_ORDER on uniform knots.
+void timeOrders()
+{
+   float knots[NUM_TIMED_KNOTS], controlPoints[3*NUM_TIMED_KNOTS];
+   for (int i = 0; i < NUM_TIMED_KNOTS; i++) knots[i] = 10.0*i;
+   for (int j = 0; j < NUM_TIMED_KNOTS; j++)
+   {
+      controlPoints[3*j] = 10.0*j; controlPoints[3*j + 1] = (j % 2) ? 30.0 : -20.0; controlPoints[3*j + 2] = 0.0;
+   }
+
+   printf("\nTime per evaluation, %d uniform knots, ns\n", NUM_TIMED_KNOTS);
+   printf("%5s %12s %12s %8s %14s %12s %8s\n", "order", "Bspline()", "table", "speedup", "curve point", "table",
+          "speedup");
+   volatile float sink = 0.0;
+   for (int order = 1; order <= MAX_TIMED_ORDER; order++)
+   {
+      // A single B-spline across its support, as drawSpline() draws it, repeated.
+      int index = (NUM_TIMED_KNOTS - order) / 2;
+      long count = 0;
+      float sum = 0.0;
+      chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+      for (int repeat = 0; repeat < 20; repeat++)
+         for (float x = knots[index]; x <= knots[index + order]; x += SAMPLE_STEP, count++)
+            sum += recursiveBspline(knots, index, order, x);
+      double recursiveTime = nanoseconds(start, count);
+      count = 0;
+      start = chrono::high_resolution_clock::now();
+      for (int repeat = 0; repeat < 20; repeat++)
+         for (float x = knots[index]; x <= knots[index + order]; x += SAMPLE_STEP, count++)
+            sum += evaluateBspline(knots, NUM_TIMED_KNOTS, index, order, x);
+      double tableTime = nanoseconds(start, count);
+
+      // The curve point of all the control points over the middle of the knots.
+      float point[3];
+      long curveCount = 0;
+      start = chrono::high_resolution_clock::now();
+      for (float x = knots[order-1]; x <= knots[NUM_TIMED_KNOTS - order]; x += 20*SAMPLE_STEP, curveCount++)
+      {
+         recursiveCurvePoint(knots, NUM_TIMED_KNOTS, order, controlPoints, x, point);
+         sum += point[0];
+      }
+      double recursiveCurveTime = nanoseconds(start, curveCount);
+      curveCount = 0;
+      start = chrono::high_resolution_clock::now();
+      for (int repeat = 0; repeat < 20; repeat++)
+         for (float x = knots[order-1]; x <= knots[NUM_TIMED_KNOTS - order]; x += 20*SAMPLE_STEP, curveCount++)
+         {
+            evaluateCurvePoint(knots, NUM_TIMED_KNOTS, order, controlPoints, 3, x, point);
+            sum += point[0];
+         }
+      double tableCurveTime = nanoseconds(start, curveCount);
+      sink = sink + sum;
+
+      printf("%5d %12.1f %12.1f %8.1f %14.1f %12.1f %8.1f\n", order, recursiveTime, tableTime,
+             recursiveTime / tableTime, recursiveCurveTime, tableCurveTime, recursiveCurveTime / tableCurveTime);
+   }
+}
+
+// Check the first and second derivatives of the table against central differences.
+void checkDerivatives()
+{
+   float knots[NUM_TIMED_KNOTS];
+   for (int i = 0; i < NUM_TIMED_KNOTS; i++) knots[i] = i + 0.3*sin(3.0*i); // Uneven knots.
+   const float h = 1e-2;
+
+   printf("\nDerivatives against central differences, h = %g, largest error\n", h);
+   printf("%5s %14s %14s\n", "order", "first", "second");
+   for (int order = 2; order <= MAX_TIMED_ORDER; order++)
+   {
+      double maxError[2] = { 0.0, 0.0 };
+      for (int s = order - 1; s < NUM_TIMED_KNOTS - order; s++)
+         for (int k = 1; k < 10; k++)
+         {
+            float u = knots[s] + (knots[s+1] - knots[s]) * k / 10.0;
+            if ( (u - h <= knots[s]) || (u + h > knots[s+1]) ) continue;
+            float derivatives[3*BSPLINE_MAX_ORDER], before[BSPLINE_MAX_ORDER], after[BSPLINE_MAX_ORDER];
+            int first = evaluateBasisDerivatives(knots, NUM_TIMED_KNOTS, order, u, 2, derivatives);
+            evaluateBasis(knots, NUM_TIMED_KNOTS, order, u - h, before);
+            evaluateBasis(knots, NUM_TIMED_KNOTS, order, u + h, after);
+            for (int j = 0; j < order; j++)
+            {
+               double firstDifference = (after[j] - before[j]) / (2.0*h);
+               double secondDifference = (after[j] - 2.0*derivatives[j] + before[j]) / (h*h);
+               maxError[0] = max(maxError[0], fabs(firstDifference - derivatives[order + j]));
+               if (order > 2) maxError[1] = max(maxError[1], fabs(secondDifference - derivatives[2*order + j]));
+            }
+            if (first != s - order + 1) printf("   wrong first B-spline at %g\n", u);
+         }
+      printf("%5d %14.2e %14.2e\n", order, maxError[0], maxError[1]);
+   }
+}
+
+int main(int argc, char **argv)
+{
+   int numSequences = (argc > 1) ? atoi(argv[1]) : 200;
+   checkScenarios(numSequences);
+   timeOrders();
+   checkDerivatives();
+   return 0;
+}
@@ -0,0 +1,347 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// bSplineCurveBenchmark.cpp
+//
+// This program compares the batch evaluation of B-spline curves of bSplineCurve.h to
+// gluNurbsCurve(), which cubicSplineCurve1.cpp, cubicSplineCurve2.cpp and
+// quadraticSplineCurve.cpp drew their curves by.
+//
+// It first checks evaluateCurvePoints() against evaluateCurvePoint() of bSplineBasis.h,
+// one at a time, on random knot vectors with knots of every multiplicity, at the
+// parameters of the line strips and at random ones, in and out of order and outside the
+// knots: the points of runs too short for the polynomial of their span, evaluated by the
+// table, must be the same to the last bit, those of the polynomials close.
+//
+// It then times, for degrees 2 to 5 on a clamped knot vector of 30 control points as
+// that of cubicSplineCurve2.cpp, the evaluation of many parameters one at a time, in
+// CURVE_LANES lanes and in lanes straight into a mapped vertex buffer object, in samples
+// per second; and the GLU tessellator alone, returning its vertices to a callback,
+// sampling as finely in the parameter (GLU_DOMAIN_DISTANCE) and as the programs do, to
+// a path length of 10 pixels in their window. Last it times the drawing of the curve of
+// each program either way, waiting for it to finish.
+//
+// Usage:
+// bSplineCurveBenchmark [number of parameters timed]
+// The number defaults to 1000000.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "bSplineCurve.h"
+
+#define PI 3.14159265
+#define WINDOW_SIZE 600 // Width and height of the window, as the programs'.
+#define NUM_CHECKED_CURVES 200 // Random curves checked at each order.
+#define NUM_RANDOM_PARAMETERS 2000 // Random parameters checked on each.
+#define NUM_CONTROL_POINTS 30 // Control points of the timed curves.
+#define NUM_DRAWS 200 // Draws of each program's curve timed.
+#define NUM_REPEATS 5 // Repeats of each evaluation timed, the best kept.
+
+using namespace std;
+
+double milliseconds(chrono::steady_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+float randomFloat(float low, float high)
+{
+   return low + (high - low) * rand() / RAND_MAX;
+}
+
+// Random knot vector of numKnots knots, steps of 0 to 3 so that knots of every
+// multiplicity up to the order come up.
+void randomKnots(float *knots, int numKnots)
+{
+   knots[0] = (float)(rand() % 5);
+   for (int i = 1; i < numKnots; i++) knots[i] = knots[i-1] + ((rand() % 3 == 0) ? 0.0f : (float)(1 + rand() % 3));
+}
+
+// Check evaluateCurvePoints() against evaluateCurvePoint().
+void checkPoints()
+{
+   printf("Agreement with evaluateCurvePoint(), %d lanes\n", CURVE_LANES);
+   printf("%6s %12s %12s %12s %16s\n", "degree", "points", "differing", "largest", "table differing");
+   srand(1);
+   for (int order = 3; order <= 6; order++)
+   {
+      long numPoints = 0, numDiffering = 0, numTableDiffering = 0;
+      double largest = 0.0;
+      for (int curve = 0; curve < NUM_CHECKED_CURVES; curve++)
+      {
+         int numControlPoints = order + rand() % 20, numKnots = numControlPoints + order;
+         vector<float> knots(numKnots), controlPoints(3 * numControlPoints);
+         randomKnots(&knots[0], numKnots);
+         for (int k = 0; k < 3 * numControlPoints; k++) controlPoints[k] = randomFloat(-50.0, 50.0);
+
+         // The line strip's parameters, then random ones over and beyond the knots,
+         // some sorted and some not, and the knots themselves.
+         vector<float> parameters;
+         fillCurveParameters(&knots[0], numKnots, order, 1 + rand() % 40, parameters);
+         vector<float> randomParameters;
+         for (int k = 0; k < NUM_RANDOM_PARAMETERS; k++)
+            randomParameters.push_back(randomFloat(knots[0] - 1.0f, knots[numKnots-1] + 1.0f));
+         for (int k = 0; k < NUM_RANDOM_PARAMETERS / 2; k++)
+            for (int l = k + 1; l < NUM_RANDOM_PARAMETERS / 2; l++)
+               if (randomParameters[l] < randomParameters[k]) swap(randomParameters[k], randomParameters[l]);
+         parameters.insert(parameters.end(), randomParameters.begin(), randomParameters.end());
+         parameters.insert(parameters.end(), knots.begin(), knots.end());
+
+         int n = (int)parameters.size();
+         vector<float> points(3 * n);
+         evaluateCurvePoints(&knots[0], numKnots, order, &controlPoints[0], 3, &parameters[0], n, &points[0]);
+         for (int p = 0; p < n; p++)
+         {
+            float point[3], tablePoint[3];
+            evaluateCurvePoint(&knots[0], numKnots, order, &controlPoints[0], 3, parameters[p], point);
+            if (memcmp(point, &points[3*p], sizeof(point)) != 0)
+            {
+               numDiffering++;
+               for (int c = 0; c < 3; c++) largest = max(largest, (double)fabs(point[c] - points[3*p + c]));
+            }
+
+            // A run of one parameter, by the table.
+            evaluateCurvePoints(&knots[0], numKnots, order, &controlPoints[0], 3, &parameters[p], 1, tablePoint);
+            if (memcmp(point, tablePoint, sizeof(point)) != 0) numTableDiffering++;
+         }
+         numPoints += n;
+      }
+      printf("%6d %12ld %12ld %12g %16ld\n", order - 1, numPoints, numDiffering, largest, numTableDiffering);
+   }
+}
+
+// Clamped knot vector and control points on a circle, as cubicSplineCurve2.cpp's.
+void makeCurve(int order, vector<float> &knots, vector<float> &controlPoints)
+{
+   int numKnots = NUM_CONTROL_POINTS + order;
+   knots.resize(numKnots);
+   for (int i = 0; i < numKnots; i++)
+      knots[i] = (float)min(max(i - order + 1, 0), NUM_CONTROL_POINTS - order + 1);
+   controlPoints.resize(3 * NUM_CONTROL_POINTS);
+   for (int k = 0; k < NUM_CONTROL_POINTS; k++)
+   {
+      float t = 2 * PI * k / NUM_CONTROL_POINTS;
+      controlPoints[3*k] = 30.0 * cos(t); controlPoints[3*k + 1] = 30.0 * sin(t); controlPoints[3*k + 2] = 0.0;
+   }
+}
+
+// Vertex callback of the GLU tessellator, counting its vertices.
+static long numGluVertices = 0;
+void countGluVertex(GLfloat *)
+{
+   numGluVertices++;
+}
+
+// Time the GLU tessellator on the curve, returning the vertices per second and setting
+// their number per curve.
+double timeGluTessellator(GLUnurbsObj *nurbsObject, vector<float> &knots, vector<float> &controlPoints,
+                          int order, long &vertices)
+{
+   numGluVertices = 0;
+   int numCurves = 0;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   while ( (numCurves < 10) || (milliseconds(start) < 200.0) )
+   {
+      gluBeginCurve(nurbsObject);
+      gluNurbsCurve(nurbsObject, (GLint)knots.size(), &knots[0], 3, &controlPoints[0], order, GL_MAP1_VERTEX_3);
+      gluEndCurve(nurbsObject);
+      numCurves++;
+   }
+   double time = milliseconds(start);
+   vertices = numGluVertices / numCurves;
+   return numGluVertices / time * 1.0e3;
+}
+
+// Time the evaluation of many parameters on the curves of degrees 2 to 5.
+void timeEvaluation(int numParameters)
+{
+   GLUnurbsObj *nurbsObject = gluNewNurbsRenderer();
+   gluNurbsProperty(nurbsObject, GLU_NURBS_MODE, GLU_NURBS_TESSELLATOR);
+   gluNurbsCallback(nurbsObject, GLU_NURBS_VERTEX, (void (*)())countGluVertex);
+
+   unsigned int buffer;
+   glGenBuffers(1, &buffer);
+
+   printf("\nMillions of samples per second, %d parameters, %d control points, clamped knots\n", numParameters,
+          NUM_CONTROL_POINTS);
+   printf("%6s %10s %10s %10s %18s %18s\n", "degree", "one by one", "lanes", "into VBO", "GLU same samples",
+          "GLU 10 px");
+   for (int order = 3; order <= 6; order++)
+   {
+      vector<float> knots, controlPoints, parameters;
+      makeCurve(order, knots, controlPoints);
+      int numKnots = (int)knots.size();
+      int numSpans = NUM_CONTROL_POINTS - order + 1;
+      int samplesPerSpan = (numParameters - 1) / numSpans;
+      int n = fillCurveParameters(&knots[0], numKnots, order, samplesPerSpan, parameters);
+      vector<float> points(3 * n);
+
+      // Each the best of NUM_REPEATS.
+      double times[3] = { 1.0e30, 1.0e30, 1.0e30 };
+      for (int repeat = 0; repeat < NUM_REPEATS; repeat++)
+      {
+         chrono::steady_clock::time_point start = chrono::steady_clock::now();
+         for (int p = 0; p < n; p++)
+            evaluateCurvePoint(&knots[0], numKnots, order, &controlPoints[0], 3, parameters[p], &points[3*p]);
+         times[0] = min(times[0], milliseconds(start));
+
+         start = chrono::steady_clock::now();
+         evaluateCurvePoints(&knots[0], numKnots, order, &controlPoints[0], 3, &parameters[0], n, &points[0]);
+         times[1] = min(times[1], milliseconds(start));
+
+         glFinish();
+         start = chrono::steady_clock::now();
+         loadCurveBuffer(buffer, &knots[0], numKnots, order, &controlPoints[0], samplesPerSpan, parameters);
+         glFinish();
+         times[2] = min(times[2], milliseconds(start));
+      }
+      double scalarRate = n / times[0] * 1.0e-3, lanesRate = n / times[1] * 1.0e-3, bufferRate = n / times[2] * 1.0e-3;
+
+      // GLU at the same samples per unit of the parameter, the knot spans being 1 long,
+      // then as the programs.
+      long vertices[2];
+      double gluRates[2];
+      gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_DOMAIN_DISTANCE);
+      gluNurbsProperty(nurbsObject, GLU_U_STEP, (float)samplesPerSpan);
+      gluRates[0] = timeGluTessellator(nurbsObject, knots, controlPoints, order, vertices[0]) * 1.0e-6;
+      gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
+      gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 10.0);
+      gluRates[1] = timeGluTessellator(nurbsObject, knots, controlPoints, order, vertices[1]) * 1.0e-6;
+
+      printf("%6d %10.1f %10.1f %10.1f %7.2f (%8ld) %7.2f (%8ld)\n", order - 1, scalarRate, lanesRate,
+             bufferRate, gluRates[0], vertices[0], gluRates[1], vertices[1]);
+   }
+   printf("(GLU vertices per curve in brackets.)\n");
+
+   glDeleteBuffers(1, &buffer);
+   gluDeleteNurbsRenderer(nurbsObject);
+}
+
+// Time drawing the curve of each program either way.
+void timeDrawing()
+{
+   glColor3f(0.0, 0.0, 0.0);
+
+   GLUnurbsObj *nurbsObject = gluNewNurbsRenderer();
+   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
+   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 10.0);
+   unsigned int buffer;
+   glGenBuffers(1, &buffer);
+   vector<float> parameters;
+
+   printf("\nEach program's curve, ms per curve, %d draws: drawn and finished, and the vertices\n", NUM_DRAWS);
+   printf("computed alone (GLU's by its tessellator, the VBO's evaluated into it)\n");
+   printf("%-26s %10s %10s %10s %10s %10s %10s\n", "program", "GLU draw", "vertices", "tessellate", "VBO draw",
+          "evaluate", "vertices");
+   const char *names[3] = { "cubicSplineCurve1.cpp", "quadraticSplineCurve.cpp", "cubicSplineCurve2.cpp" };
+   for (int program = 0; program < 3; program++)
+   {
+      vector<float> knots, controlPoints;
+      int order;
+      if (program < 2)
+      {
+         // 9 control points zigzagging, on the programs' reset knots.
+         order = 4 - program;
+         int numKnots = 9 + order;
+         for (int i = 0; i < numKnots; i++) knots.push_back((program == 0 ? 6.0f : 7.0f) * i);
+         for (int k = 0; k < 9; k++)
+         {
+            controlPoints.push_back(-40.0 + 10.0*k); controlPoints.push_back((k % 2) ? 30.0 : -20.0);
+            controlPoints.push_back(0.0);
+         }
+      }
+      else
+      {
+         order = 4;
+         makeCurve(order, knots, controlPoints);
+      }
+      int numKnots = (int)knots.size();
+
+      glFinish();
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      for (int d = 0; d < NUM_DRAWS; d++)
+      {
+         gluBeginCurve(nurbsObject);
+         gluNurbsCurve(nurbsObject, numKnots, &knots[0], 3, &controlPoints[0], order, GL_MAP1_VERTEX_3);
+         gluEndCurve(nurbsObject);
+         glFinish();
+      }
+      double gluTime = milliseconds(start) / NUM_DRAWS;
+
+      // GLU's vertices alone, from the same curve in the tessellator's mode.
+      GLUnurbsObj *tessellator = gluNewNurbsRenderer();
+      gluNurbsProperty(tessellator, GLU_NURBS_MODE, GLU_NURBS_TESSELLATOR);
+      gluNurbsProperty(tessellator, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
+      gluNurbsProperty(tessellator, GLU_SAMPLING_TOLERANCE, 10.0);
+      gluNurbsCallback(tessellator, GLU_NURBS_VERTEX, (void (*)())countGluVertex);
+      long numVerticesGlu;
+      double gluRate = timeGluTessellator(tessellator, knots, controlPoints, order, numVerticesGlu);
+      double tessellateTime = 1.0e3 * numVerticesGlu / gluRate;
+      gluDeleteNurbsRenderer(tessellator);
+
+      int numVertices = 0;
+      start = chrono::steady_clock::now();
+      for (int d = 0; d < NUM_DRAWS; d++)
+      {
+         numVertices = loadCurveBuffer(buffer, &knots[0], numKnots, order, &controlPoints[0], CURVE_SAMPLES_PER_SPAN,
+                                       parameters);
+         drawCurveBuffer(buffer, numVertices);
+         glFinish();
+      }
+      double bufferTime = milliseconds(start) / NUM_DRAWS;
+
+      start = chrono::steady_clock::now();
+      for (int d = 0; d < NUM_DRAWS; d++)
+         loadCurveBuffer(buffer, &knots[0], numKnots, order, &controlPoints[0], CURVE_SAMPLES_PER_SPAN, parameters);
+      glFinish();
+      double evaluateTime = milliseconds(start) / NUM_DRAWS;
+
+      printf("%-26s %10.3f %10ld %10.4f %10.3f %10.4f %10d\n", names[program], gluTime, numVerticesGlu, tessellateTime,
+             bufferTime, evaluateTime, numVertices);
+   }
+
+   glDeleteBuffers(1, &buffer);
+   gluDeleteNurbsRenderer(nurbsObject);
+}
+
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA);
+   glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
+   glutCreateWindow("bSplineCurveBenchmark.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   // The programs' viewing box, for GLU's sampling by path length.
+   glViewport(0, 0, WINDOW_SIZE, WINDOW_SIZE);
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   glOrtho(-50.0, 50.0, -50.0, 50.0, -1.0, 1.0);
+   glMatrixMode(GL_MODELVIEW);
+   glLoadIdentity();
+
+   int numParameters = (argc > 1) ? atoi(argv[1]) : 1000000;
+   checkPoints();
+   timeEvaluation(numParameters);
+   timeDrawing();
+   return 0;
+}
@@ -0,0 +1,216 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Broadphase collision detection between moving bodies and static objects, both
+// spheres given as structures of arrays of centers and radii. It returns the pairs of a
+// body and an object whose bounding boxes overlap, for a narrow phase such as
+// checkSpheresIntersection() to confirm. There are two variants:
+// HashGrid, a uniform grid of cells hashed into a table, each object filed under the
+// cell of its center, which each body looks up in the cells near it; and
+// SweepAndPrune, the objects sorted once along x and the bodies kept sorted from call
+// to call by insertion sort, which, as bodies move little between calls, does little
+// work, the two lists then swept together.
+
+// Pair of a body and an object, by index.
+struct BroadphasePair
+{
+   int body, object;
+};
+
+// Spheres as a structure of arrays, not owned.
+struct BroadphaseSpheres
+{
+   const float *x, *y, *z, *r;
+   int count;
+};
+
+// Uniform hash grid class.
+class HashGrid
+{
+public:
+   // File the objects under the cells of side cellSize (if not positive, the largest
+   // object's diameter) containing their centers.
+   void initialize(const BroadphaseSpheres &objects, float cellSize = 0.0);
+
+   // Append the pairs of the bodies and the objects whose boxes overlap.
+   void findPairs(const BroadphaseSpheres &bodies, std::vector<BroadphasePair> &pairs) const;
+
+   // Append the pairs of one body, with the given index, and the objects.
+   void findPairs(float x, float y, float z, float r, int body, std::vector<BroadphasePair> &pairs) const;
+
+private:
+   int cellOf(float x) const { return (int)std::floor(x * inverseCellSize); }
+   unsigned int hashCell(int i, int j, int k) const
+   {
+      return ((unsigned int)i * 73856093u ^ (unsigned int)j * 19349663u ^ (unsigned int)k * 83492791u) & tableMask;
+   }
+
+   float inverseCellSize;
+   float maxRadius; // Largest radius of an object, by which bodies look beyond their boxes.
+   unsigned int tableMask; // Table size less 1, the size a power of 2.
+   std::vector<int> bucketStarts; // Start of each bucket in the arrays below, and their end.
+   std::vector<float> x, y, z, r; // Objects in bucket order.
+   std::vector<int> cellI, cellJ, cellK; // Their cells, telling apart cells hashed together.
+   std::vector<int> indices; // Their indices among the objects given.
+};
+
+inline void HashGrid::initialize(const BroadphaseSpheres &objects, float cellSize)
+{
+   int n = objects.count;
+   maxRadius = 0.0;
+   for (int k = 0; k < n; k++) maxRadius = std::max(maxRadius, objects.r[k]);
+   if (cellSize <= 0.0) cellSize = (maxRadius > 0.0) ? 2.0f * maxRadius : 1.0f;
+   inverseCellSize = 1.0f / cellSize;
+
+   unsigned int tableSize = 1;
+   while (tableSize < 2u * (unsigned int)n) tableSize *= 2;
+   tableMask = tableSize - 1;
+
+   // Counting sort of the objects by bucket.
+   std::vector<unsigned int> buckets(n);
+   bucketStarts.assign(tableSize + 1, 0);
+   for (int k = 0; k < n; k++)
+   {
+      buckets[k] = hashCell(cellOf(objects.x[k]), cellOf(objects.y[k]), cellOf(objects.z[k]));
+      bucketStarts[buckets[k] + 1]++;
+   }
+   for (unsigned int b = 0; b < tableSize; b++) bucketStarts[b + 1] += bucketStarts[b];
+
+   std::vector<int> next(bucketStarts.begin(), bucketStarts.end() - 1);
+   x.resize(n); y.resize(n); z.resize(n); r.resize(n);
+   cellI.resize(n); cellJ.resize(n); cellK.resize(n); indices.resize(n);
+   for (int k = 0; k < n; k++)
+   {
+      int slot = next[buckets[k]]++;
+      x[slot] = objects.x[k]; y[slot] = objects.y[k]; z[slot] = objects.z[k]; r[slot] = objects.r[k];
+      cellI[slot] = cellOf(objects.x[k]); cellJ[slot] = cellOf(objects.y[k]); cellK[slot] = cellOf(objects.z[k]);
+      indices[slot] = k;
+   }
+}
+
+inline void HashGrid::findPairs(float bodyX, float bodyY, float bodyZ, float bodyR, int body,
+                                std::vector<BroadphasePair> &pairs) const
+{
+   if (indices.empty()) return;
+
+   // The cells whose objects may reach the body's box.
+   float reach = bodyR + maxRadius;
+   int i0 = cellOf(bodyX - reach), i1 = cellOf(bodyX + reach);
+   int j0 = cellOf(bodyY - reach), j1 = cellOf(bodyY + reach);
+   int k0 = cellOf(bodyZ - reach), k1 = cellOf(bodyZ + reach);
+
+   for (int i = i0; i <= i1; i++)
+      for (int j = j0; j <= j1; j++)
+         for (int k = k0; k <= k1; k++)
+         {
+            unsigned int bucket = hashCell(i, j, k);
+            for (int slot = bucketStarts[bucket]; slot < bucketStarts[bucket + 1]; slot++)
+               if ( cellI[slot] == i && cellJ[slot] == j && cellK[slot] == k &&
+                    x[slot] - r[slot] <= bodyX + bodyR && x[slot] + r[slot] >= bodyX - bodyR &&
+                    std::fabs(y[slot] - bodyY) <= r[slot] + bodyR && std::fabs(z[slot] - bodyZ) <= r[slot] + bodyR )
+               {
+                  BroadphasePair pair = { body, indices[slot] };
+                  pairs.push_back(pair);
+               }
+         }
+}
+
+inline void HashGrid::findPairs(const BroadphaseSpheres &bodies, std::vector<BroadphasePair> &pairs) const
+{
+   for (int b = 0; b < bodies.count; b++) findPairs(bodies.x[b], bodies.y[b], bodies.z[b], bodies.r[b], b, pairs);
+}
+
+// Sweep-and-prune class.
+class SweepAndPrune
+{
+public:
+   // Sort the objects by the low x of their boxes.
+   void initialize(const BroadphaseSpheres &objects);
+
+   // Append the pairs of the bodies and the objects whose boxes overlap. The bodies must
+   // be the same ones, in the same order, from call to call, only moved.
+   void findPairs(const BroadphaseSpheres &bodies, std::vector<BroadphasePair> &pairs);
+
+private:
+   float maxDiameter; // Largest width of an object's box.
+   std::vector<float> minX, maxX, y, z, r; // Objects by low x.
+   std::vector<int> indices; // Their indices among the objects given.
+   std::vector<int> bodyOrder; // Bodies by low x at the last call.
+   std::vector<float> bodyMinX; // Their low x, in that order.
+};
+
+inline void SweepAndPrune::initialize(const BroadphaseSpheres &objects)
+{
+   int n = objects.count;
+   std::vector<std::pair<float, int> > order(n);
+   maxDiameter = 0.0;
+   for (int k = 0; k < n; k++)
+   {
+      order[k] = std::make_pair(objects.x[k] - objects.r[k], k);
+      maxDiameter = std::max(maxDiameter, 2.0f * objects.r[k]);
+   }
+   std::sort(order.begin(), order.end());
+
+   minX.resize(n); maxX.resize(n); y.resize(n); z.resize(n); r.resize(n); indices.resize(n);
+   for (int k = 0; k < n; k++)
+   {
+      int a = order[k].second;
+      minX[k] = order[k].first; maxX[k] = objects.x[a] + objects.r[a];
+      y[k] = objects.y[a]; z[k] = objects.z[a]; r[k] = objects.r[a];
+      indices[k] = a;
+   }
+   bodyOrder.clear();
+   bodyMinX.clear();
+}
+
+inline void SweepAndPrune::findPairs(const BroadphaseSpheres &bodies, std::vector<BroadphasePair> &pairs)
+{
+   int n = bodies.count;
+
+   // Sort the bodies by low x, starting from their last order so that the insertion
+   // sort does no more than undo the swaps of the bodies passing one another.
+   if ((int)bodyOrder.size() != n)
+   {
+      bodyOrder.resize(n);
+      for (int b = 0; b < n; b++) bodyOrder[b] = b;
+   }
+   bodyMinX.resize(n);
+   for (int k = 0; k < n; k++) bodyMinX[k] = bodies.x[bodyOrder[k]] - bodies.r[bodyOrder[k]];
+   for (int k = 1; k < n; k++)
+   {
+      int body = bodyOrder[k];
+      float key = bodyMinX[k];
+      int l = k - 1;
+      for (; l >= 0 && bodyMinX[l] > key; l--)
+      {
+         bodyOrder[l + 1] = bodyOrder[l];
+         bodyMinX[l + 1] = bodyMinX[l];
+      }
+      bodyOrder[l + 1] = body;
+      bodyMinX[l + 1] = key;
+   }
+
+   // Sweep: objects starting too far left of a body to reach it are passed for good, as
+   // the bodies come in increasing low x.
+   int start = 0, numObjects = (int)minX.size();
+   for (int k = 0; k < n; k++)
+   {
+      int body = bodyOrder[k];
+      float bodyX = bodies.x[body], bodyY = bodies.y[body], bodyZ = bodies.z[body], bodyR = bodies.r[body];
+      float low = bodyMinX[k], high = bodyX + bodyR;
+      while (start < numObjects && minX[start] < low - maxDiameter) start++;
+      for (int slot = start; slot < numObjects && minX[slot] <= high; slot++)
+         if ( maxX[slot] >= low &&
+              std::fabs(y[slot] - bodyY) <= r[slot] + bodyR && std::fabs(z[slot] - bodyZ) <= r[slot] + bodyR )
+         {
+            BroadphasePair pair = { body, indices[slot] };
+            pairs.push_back(pair);
+         }
+   }
+}
+
+#endif
@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// broadphaseBenchmark.cpp
+//
+// This program times the broadphase collision detection of broadphase.h with many
+// spacecraft flying through a large field of asteroids laid out as in
+// spaceTravelFrustumCulled.cpp, the pairs it finds confirmed by checkSpheresIntersection()
+// as in asteroidCraftCollision().
+//
+// Every frame each craft moves a step along its heading, turning back at the edge of
+// the field. The hash grid and sweep and prune then find the pairs of a craft and an
+// asteroid whose boxes overlap, and the program checks that they find the same pairs
+// and, for some craft, that no asteroid colliding with one is missed, by testing it
+// against every asteroid.
+//
+// Usage:
+// broadphaseBenchmark [number of craft] [asteroids per side of the field] [frames]
+// The defaults are 10000 craft, a field of 1000 x 1000 asteroids and 100 frames.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "broadphase.h"
+
+#define PI 3.14159265
+#define CRAFT_RADIUS 7.072 // Radius of the bounding sphere of the spacecraft.
+#define CRAFT_SPEED 5.0 // Step of a craft per frame, as per press of an arrow key.
+#define NUM_CHECKED_CRAFT 100 // Craft checked against every asteroid.
+
+using namespace std;
+
+// Function to check if two spheres centered at (x1,y1,z1) and (x2,y2,z2) with
+// radius r1 and r2 intersect.
+int checkSpheresIntersection(float x1, float y1, float z1, float r1,
+                             float x2, float y2, float z2, float r2)
+{
+   return ( (x1-x2)*(x1-x2) + (y1-y2)*(y1-y2) + (z1-z2)*(z1-z2) <= (r1+r2)*(r1+r2) );
+}
+
+float randomFloat(float low, float high) { return low + (high - low) * rand() / RAND_MAX; }
+
+// Spheres as a structure of arrays.
+struct Spheres
+{
+   vector<float> x, y, z, r;
+
+   void add(float cx, float cy, float cz, float cr)
+   {
+      x.push_back(cx); y.push_back(cy); z.push_back(cz); r.push_back(cr);
+   }
+   BroadphaseSpheres view() const
+   {
+      BroadphaseSpheres spheres = { &x[0], &y[0], &z[0], &r[0], (int)r.size() };
+      return spheres;
+   }
+};
+
+// Field of side x side asteroids of radius 3, 30 apart, as in spaceTravelFrustumCulled.cpp.
+Spheres makeField(int side)
+{
+   Spheres field;
+   for (int j = 0; j < side; j++)
+      for (int i = 0; i < side; i++)
+         field.add(15.0 + 30.0 * (-side / 2 + j), 0.0, -40.0 - 30.0 * i, 3.0);
+   return field;
+}
+
+// Craft flying in the field.
+struct Fleet
+{
+   Spheres spheres;
+   vector<float> headingX, headingZ;
+   float minX, maxX, minZ, maxZ;
+
+   Fleet(int n, int side)
+   {
+      minX = 15.0 + 30.0 * (-side / 2); maxX = minX + 30.0 * (side - 1);
+      maxZ = -40.0; minZ = maxZ - 30.0 * (side - 1);
+      for (int k = 0; k < n; k++)
+      {
+         float a = randomFloat(0.0, 2.0 * PI);
+         spheres.add(randomFloat(minX, maxX), 0.0, randomFloat(minZ, maxZ), CRAFT_RADIUS);
+         headingX.push_back(-sin(a)); headingZ.push_back(-cos(a));
+      }
+   }
+
+   void move()
+   {
+      for (int k = 0; k < (int)headingX.size(); k++)
+      {
+         if (spheres.x[k] + CRAFT_SPEED * headingX[k] < minX || spheres.x[k] + CRAFT_SPEED * headingX[k] > maxX)
+            headingX[k] = -headingX[k];
+         if (spheres.z[k] + CRAFT_SPEED * headingZ[k] < minZ || spheres.z[k] + CRAFT_SPEED * headingZ[k] > maxZ)
+            headingZ[k] = -headingZ[k];
+         spheres.x[k] += CRAFT_SPEED * headingX[k];
+         spheres.z[k] += CRAFT_SPEED * headingZ[k];
+      }
+   }
+};
+
+// Number of the pairs whose spheres intersect.
+int countCollisions(const Spheres &craft, const Spheres &field, const vector<BroadphasePair> &pairs)
+{
+   int collisions = 0;
+   for (int k = 0; k < (int)pairs.size(); k++)
+   {
+      int b = pairs[k].body, a = pairs[k].object;
+      collisions += checkSpheresIntersection(craft.x[b], craft.y[b], craft.z[b], craft.r[b],
+                                             field.x[a], field.y[a], field.z[a], field.r[a]);
+   }
+   return collisions;
+}
+
+bool operator<(const BroadphasePair &p, const BroadphasePair &q)
+{
+   return p.body < q.body || (p.body == q.body && p.object < q.object);
+}
+
+bool operator==(const BroadphasePair &p, const BroadphasePair &q)
+{
+   return p.body == q.body && p.object == q.object;
+}
+
+// Number of the collisions of the first craft with any asteroid which are not among
+// the pairs.
+int countMissed(const Spheres &craft, const Spheres &field, vector<BroadphasePair> pairs)
+{
+   int missed = 0;
+   sort(pairs.begin(), pairs.end());
+   for (int b = 0; b < NUM_CHECKED_CRAFT && b < (int)craft.r.size(); b++)
+      for (int a = 0; a < (int)field.r.size(); a++)
+         if ( checkSpheresIntersection(craft.x[b], craft.y[b], craft.z[b], craft.r[b],
+                                       field.x[a], field.y[a], field.z[a], field.r[a]) )
+         {
+            BroadphasePair pair = { b, a };
+            if (!binary_search(pairs.begin(), pairs.end(), pair)) missed++;
+         }
+   return missed;
+}
+
+double seconds(chrono::high_resolution_clock::time_point start)
+{
+   return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+   int numCraft = (argc > 1) ? atoi(argv[1]) : 10000;
+   int side = (argc > 2) ? atoi(argv[2]) : 1000;
+   int numFrames = (argc > 3) ? atoi(argv[3]) : 100;
+
+   Spheres field = makeField(side);
+   Fleet fleet(numCraft, side);
+
+   HashGrid grid;
+   SweepAndPrune sweep;
+   chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+   grid.initialize(field.view(), 30.0);
+   double gridBuild = seconds(start);
+   start = chrono::high_resolution_clock::now();
+   sweep.initialize(field.view());
+   double sweepBuild = seconds(start);
+
+   printf("%d craft, %d asteroids, %d frames\n", numCraft, side * side, numFrames);
+   printf("build: hash grid %.1f ms, sweep and prune %.1f ms\n", 1000.0 * gridBuild, 1000.0 * sweepBuild);
+
+   vector<BroadphasePair> gridPairs, sweepPairs;
+   double gridTime = 0.0, sweepTime = 0.0, narrowTime = 0.0;
+   long long numPairs = 0, numCollisions = 0;
+   int disagreements = 0, missed = 0;
+   for (int frame = 0; frame < numFrames; frame++)
+   {
+      fleet.move();
+
+      gridPairs.clear();
+      start = chrono::high_resolution_clock::now();
+      grid.findPairs(fleet.spheres.view(), gridPairs);
+      gridTime += seconds(start);
+
+      sweepPairs.clear();
+      start = chrono::high_resolution_clock::now();
+      sweep.findPairs(fleet.spheres.view(), sweepPairs);
+      sweepTime += seconds(start);
+
+      start = chrono::high_resolution_clock::now();
+      numCollisions += countCollisions(fleet.spheres, field, gridPairs);
+      narrowTime += seconds(start);
+      numPairs += gridPairs.size();
+
+      sort(gridPairs.begin(), gridPairs.end());
+      sort(sweepPairs.begin(), sweepPairs.end());
+      if (gridPairs != sweepPairs) disagreements++;
+      if (frame == 0 || frame == numFrames - 1) missed += countMissed(fleet.spheres, field, gridPairs);
+   }
+
+   printf("%lld candidate pairs, %lld collisions; %d frames with the two disagreeing, %d collisions missed\n",
+          numPairs, numCollisions, disagreements, missed);
+   printf("%-40s %12s %14s\n", "phase", "ms/frame", "pairs/s");
+   printf("%-40s %12.2f %14.3e\n", "hash grid", 1000.0 * gridTime / numFrames, numPairs / gridTime);
+   printf("%-40s %12.2f %14.3e\n", "sweep and prune", 1000.0 * sweepTime / numFrames, numPairs / sweepTime);
+   printf("%-40s %12.2f %14.3e\n", "checkSpheresIntersection() of pairs", 1000.0 * narrowTime / numFrames,
+          numPairs / narrowTime);
+   printf("%-40s %12.2f\n", "all pairs, estimated from the check",
+          1000.0 * narrowTime / numPairs * numCraft * side * side);
+
+   return disagreements + missed;
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// compressTexture.cpp
+//
+// This program compresses bmp files offline to BC1 (DXT1) or BC3 (DXT5) texture
+// files beside them, e.g., grass.bmp to grass.bc1, which getCompressedTexture()
+// then loads instead of compressing at run time. For each file it reports the
+// encoding speed, the PSNR of the decoded result against the original and the
+// size of the upload compared to uncompressed RGBA.
+//
+// Usage:
+// compressTexture bc1|bc3 file.bmp ...
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "getbmp.h"
+#include "compressedTexture.h"
+
+using namespace std;
+
+// Peak signal to noise ratio in dB between two RGBA images, over the channels encoded.
+double psnr(const unsigned char *a, const unsigned char *b, int numTexels, int numChannels)
+{
+   double sum = 0.0;
+   for (int i = 0; i < numTexels; i++)
+      for (int c = 0; c < numChannels; c++) sum += (a[4 * i + c] - b[4 * i + c]) * (a[4 * i + c] - b[4 * i + c]);
+   double mse = sum / ((double)numTexels * numChannels);
+   return (mse == 0.0) ? 99.0 : 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   if (argc < 3 || (strcmp(argv[1], "bc1") != 0 && strcmp(argv[1], "bc3") != 0))
+   {
+      cout << "Usage: compressTexture bc1|bc3 file.bmp ..." << endl;
+      return 1;
+   }
+   int format = (strcmp(argv[1], "bc1") == 0) ? TEX_BC1 : TEX_BC3;
+
+   for (int i = 2; i < argc; i++)
+   {
+      string filename = argv[i];
+      BitMapFile *image = getbmp(filename);
+      if (image == NULL) continue;
+      int numTexels = image->sizeX * image->sizeY;
+
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      CompressedTexture *texture = compressImage(image->data, image->sizeX, image->sizeY, format);
+      double time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+      vector<unsigned char> decoded(4 * numTexels);
+      decompressImage(texture, &decoded[0]);
+
+      string compressedFilename = filename.substr(0, filename.rfind('.')) + "." + argv[1];
+      if (!writeCompressedTexture(compressedFilename, texture))
+         cout << "Cannot write " << compressedFilename << endl;
+
+      cout << compressedFilename << ": " << image->sizeX << "x" << image->sizeY << " in " << time << " ms ("
+           << numTexels / time / 1000.0 << " Mtexel/s), PSNR " << psnr(image->data, &decoded[0], numTexels, format == TEX_BC1 ? 3 : 4)
+           << " dB, upload " << texture->dataSize << " bytes instead of " << 4 * numTexels << endl;
+
+      delete[] texture->data;
+      delete texture;
+      delete[] image->data;
+      delete image;
+   }
+   return 0;
+}
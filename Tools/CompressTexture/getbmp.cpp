@@ -0,0 +1,260 @@
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// SSSE3 and AVX2 scanline conversion on x86, selected at run time.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define GETBMP_SIMD
+#  define GETBMP_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#  include <immintrin.h>
+#  define GETBMP_SIMD
+#  define GETBMP_TARGET(isa)
+#endif
+
+#include "getbmp.h"
+
+using namespace std;
+
+// Largest width or height accepted, that of the largest textures OpenGL implementations
+// commonly support; it keeps 4 * sizeX * sizeY within a 32-bit size_t.
+#define GETBMP_MAX_SIZE 16384
+
+// Read a little-endian integer of the given number of bytes from the bmp header.
+static int readInt(const unsigned char *p, int numBytes)
+{
+	unsigned int value = 0;
+	for (int i = numBytes - 1; i >= 0; i--) value = (value << 8) | p[i];
+	return (numBytes == 2) ? (short)value : (int)value;
+}
+
+// Convert numPixels BGR or BGRA pixels of a scanline to RGBA. The file's alpha
+// byte is kept only if keepAlpha is set, otherwise A is set to 1.
+static void convertScanlineScalar(const unsigned char *in, unsigned char *out, int numPixels,
+	                              int bytesPerPixel, bool keepAlpha)
+{
+	for (int x = 0; x < numPixels; x++, in += bytesPerPixel, out += 4)
+	{
+		out[0] = in[2];
+		out[1] = in[1];
+		out[2] = in[0];
+		out[3] = keepAlpha ? in[3] : 0xFF;
+	}
+}
+
+#ifdef GETBMP_SIMD
+// The SIMD kernels below convert as many pixels as they can without reading past
+// the end of the scanline and return that number; the scalar routine does the rest.
+
+// SSSE3: 4 pixels per shuffle.
+GETBMP_TARGET("ssse3")
+static int convertScanlineSSSE3(const unsigned char *in, unsigned char *out, int numPixels,
+	                            int bytesPerPixel, bool keepAlpha)
+{
+	const __m128i alpha = _mm_set1_epi32(keepAlpha ? 0 : (int)0xFF000000);
+	int x = 0;
+	if (bytesPerPixel == 3)
+	{
+		// Each 16-byte load covers 4 pixels (12 bytes) plus 4 bytes of the next.
+		const __m128i mask = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+		for (; 3 * x + 16 <= 3 * numPixels; x += 4)
+		{
+			__m128i bgr = _mm_loadu_si128((const __m128i *)(in + 3 * x));
+			_mm_storeu_si128((__m128i *)(out + 4 * x), _mm_or_si128(_mm_shuffle_epi8(bgr, mask), alpha));
+		}
+	}
+	else
+	{
+		const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		for (; x + 4 <= numPixels; x += 4)
+		{
+			__m128i bgra = _mm_loadu_si128((const __m128i *)(in + 4 * x));
+			_mm_storeu_si128((__m128i *)(out + 4 * x), _mm_or_si128(_mm_shuffle_epi8(bgra, mask), alpha));
+		}
+	}
+	return x;
+}
+
+// AVX2: 8 pixels per shuffle. For BGR the 24 bytes of 8 pixels are first split
+// across the two 128-bit lanes, since the byte shuffle cannot cross lanes.
+GETBMP_TARGET("avx2")
+static int convertScanlineAVX2(const unsigned char *in, unsigned char *out, int numPixels,
+	                           int bytesPerPixel, bool keepAlpha)
+{
+	const __m256i alpha = _mm256_set1_epi32(keepAlpha ? 0 : (int)0xFF000000);
+	int x = 0;
+	if (bytesPerPixel == 3)
+	{
+		const __m256i split = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+		const __m256i mask = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+			                                  2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+		for (; 3 * x + 32 <= 3 * numPixels; x += 8)
+		{
+			__m256i bgr = _mm256_loadu_si256((const __m256i *)(in + 3 * x));
+			bgr = _mm256_permutevar8x32_epi32(bgr, split);
+			_mm256_storeu_si256((__m256i *)(out + 4 * x), _mm256_or_si256(_mm256_shuffle_epi8(bgr, mask), alpha));
+		}
+	}
+	else
+	{
+		const __m256i mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			                                  2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		for (; x + 8 <= numPixels; x += 8)
+		{
+			__m256i bgra = _mm256_loadu_si256((const __m256i *)(in + 4 * x));
+			_mm256_storeu_si256((__m256i *)(out + 4 * x), _mm256_or_si256(_mm256_shuffle_epi8(bgra, mask), alpha));
+		}
+	}
+	return x;
+}
+
+// Best instruction set supported by the processor: 2 for AVX2, 1 for SSSE3, 0 for neither.
+static int detectSimdLevel()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool ssse3 = (info[2] & (1 << 9)) != 0;
+	bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osAvx)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	bool ssse3 = __builtin_cpu_supports("ssse3") != 0;
+	bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+	return avx2 ? 2 : (ssse3 ? 1 : 0);
+}
+
+// The level, detected once. getbmp() is called from several texture loading threads
+// at once, and the initialization of a local static is thread-safe in C++11.
+static int simdLevel()
+{
+	static const int level = detectSimdLevel();
+	return level;
+}
+#endif
+
+// Convert a scanline to RGBA with the fastest kernel available.
+static void convertScanline(const unsigned char *in, unsigned char *out, int numPixels,
+	                        int bytesPerPixel, bool keepAlpha)
+{
+	int x = 0;
+#ifdef GETBMP_SIMD
+	int level = simdLevel();
+	if (level == 2) x = convertScanlineAVX2(in, out, numPixels, bytesPerPixel, keepAlpha);
+	else if (level == 1) x = convertScanlineSSSE3(in, out, numPixels, bytesPerPixel, keepAlpha);
+#endif
+	convertScanlineScalar(in + bytesPerPixel * x, out + 4 * x, numPixels - x, bytesPerPixel, keepAlpha);
+}
+
+// Routine to read an uncompressed 24-bit color RGB or 32-bit color RGBA bmp file
+// into a 32-bit color RGBA bitmap file (A value being set to 1 unless the file
+// carries its own alpha channel). The file is memory-mapped and its scanlines are
+// expanded directly into the output storage in a single pass. Scanlines of the
+// output are always bottom-up, as OpenGL expects, whether the file stores them
+// bottom-up (positive height) or top-down (negative height). Returns NULL if the
+// file cannot be read or is not a bmp of a supported type. The caller owns the
+// returned bitmap file and its data (allocated with new[]).
+BitMapFile *getbmp(string filename)
+{
+	BitMapFile *bmpRGBA = NULL;
+	const unsigned char *file = NULL;
+	long fileSize = 0;
+
+	// Map the bmp file into memory.
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	HANDLE mapHandle = NULL;
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		fileSize = (long)GetFileSize(fileHandle, NULL);
+		mapHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapHandle != NULL) file = (const unsigned char *)MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	struct stat fileStat;
+	if (fd >= 0 && fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		fileSize = (long)fileStat.st_size;
+		void *mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED) file = (const unsigned char *)mapped;
+	}
+#endif
+
+	if (file == NULL) cout << "getbmp: cannot open " << filename << endl;
+	else if (fileSize < 54 || file[0] != 'B' || file[1] != 'M')
+		cout << "getbmp: " << filename << " is not a bmp file" << endl;
+	else
+	{
+		// Get starting point of image data, image dimensions, bits per pixel
+		// and compression type from the bmp file header.
+		int offset = readInt(file + 10, 4);
+		int sizeX = readInt(file + 18, 4);
+		int sizeY = readInt(file + 22, 4);
+		int bitsPerPixel = readInt(file + 28, 2);
+		int compression = readInt(file + 30, 4);
+
+		// Negative height indicates scanlines stored top-down.
+		bool topDown = sizeY < 0;
+		if (topDown) sizeY = (sizeY < -GETBMP_MAX_SIZE) ? 0 : -sizeY;
+
+		// Bytes per pixel and whether the file's alpha byte is meaningful (BI_BITFIELDS).
+		int bytesPerPixel = bitsPerPixel / 8;
+		bool hasAlpha = (bitsPerPixel == 32 && compression == 3);
+
+		// Each scanline of a bmp file is 4-byte aligned by padding with zeros. Sizes are
+		// reckoned in 64 bits, as long is 32 bits on Windows, once the dimensions are
+		// known not to be absurd.
+		bool validSize = sizeX > 0 && sizeY > 0 && sizeX <= GETBMP_MAX_SIZE && sizeY <= GETBMP_MAX_SIZE;
+		long long sizeScanline = validSize ? ((long long)bytesPerPixel * sizeX + 3) & ~3LL : 0;
+
+		if ( (bitsPerPixel != 24 && bitsPerPixel != 32) ||
+			 (compression != 0 && !(bitsPerPixel == 32 && compression == 3)) )
+			cout << "getbmp: " << filename << " is not an uncompressed 24- or 32-bit bmp" << endl;
+		else if (!validSize || offset < 54 || (long long)offset + sizeScanline * sizeY > (long long)fileSize)
+			cout << "getbmp: " << filename << " has an invalid header" << endl;
+		else
+		{
+			bmpRGBA = new BitMapFile;
+			bmpRGBA->sizeX = sizeX;
+			bmpRGBA->sizeY = sizeY;
+			bmpRGBA->data = new unsigned char[(size_t)4 * sizeX * sizeY];
+
+			// Expand each scanline from BGR(A) with padding straight into RGBA.
+			for (int y = 0; y < sizeY; y++)
+				convertScanline(file + offset + (size_t)sizeScanline * (topDown ? sizeY - 1 - y : y),
+				                bmpRGBA->data + (size_t)4 * sizeX * y, sizeX, bytesPerPixel, hasAlpha);
+		}
+	}
+
+	// Unmap the bmp file.
+#ifdef _WIN32
+	if (file != NULL) UnmapViewOfFile(file);
+	if (mapHandle != NULL) CloseHandle(mapHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+	if (file != NULL) munmap((void *)file, fileSize);
+	if (fd >= 0) close(fd);
+#endif
+
+	return bmpRGBA;
+}
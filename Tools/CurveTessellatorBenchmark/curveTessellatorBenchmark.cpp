@@ -0,0 +1,483 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// curveTessellatorBenchmark.cpp
+//
+// This program compares the adaptive tessellation of curves of curveTessellator.h to
+// sampling them uniformly in the parameter, as glMapGrid1f() and glEvalMesh1() did for
+// the Bezier curves of deCasteljau3.cpp, bezierCurves.cpp and rationalBezierCurve1.cpp
+// to rationalBezierCurve3.cpp, loadCurveBuffer() of bSplineCurve.h for the B-spline
+// curves of cubicSplineCurve1.cpp, cubicSplineCurve2.cpp and quadraticSplineCurve.cpp,
+// and drawSpline() of bSplines.cpp for the graphs of B-spline functions.
+//
+// The error of a line strip is the largest distance in pixels, in the window of the
+// program, of a point of the curve from the strip, found at NUM_ERROR_SAMPLES points of
+// the curve, or of each knot span of a B-spline curve. For the curves of the programs,
+// each in the view it is drawn in, and then for random curves, the program finds:
+// - the vertices and error of the programs' sampling, 100 segments of a Bezier curve,
+//   CURVE_SAMPLES_PER_SPAN of each knot span of a B-spline curve and steps of 0.005
+//   of the graph of a B-spline function of bSplines.cpp;
+// - the vertices, error and time of the adaptive tessellation to CURVE_TOLERANCE, of a
+//   B-spline curve its parameters by tessellateBsplineParameters() and their points by
+//   evaluateCurvePoints();
+// - the fewest vertices of uniform sampling (segments of the whole Bezier curve, or
+//   of each knot span) whose error is at most that of the adaptive tessellation, and
+//   the time to evaluate them in lanes by evaluateCurvePoints() of bSplineCurve.h, a
+//   Bezier curve as the B-spline curve of a single span.
+//
+// Usage:
+// curveTessellatorBenchmark [number of random curves of each kind]
+// The number defaults to 100.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "bSplineCurve.h"
+#include "curveTessellator.h"
+
+#define PI 3.14159265
+#define NUM_ERROR_SAMPLES 2000 // Points of the curve, or of each knot span, the error is found at.
+#define PROGRAM_SEGMENTS 100 // Segments of glMapGrid1f() in the Bezier curve programs.
+#define MIN_TIMING 20.0 // Fewest milliseconds each tessellation is repeated for.
+#define NUM_REPEATS 5 // Repeats of each timing, the best kept.
+
+using namespace std;
+
+// A curve of a program, Bezier if it has no knots, in the view it is drawn in.
+struct Curve
+{
+   const char *name;
+   int order, dimension;
+   int programSegments; // Segments of each knot span as the program draws it.
+   vector<float> knots, controlPoints;
+   CurveView view;
+};
+
+double milliseconds(chrono::steady_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+float randomFloat(float low, float high)
+{
+   return low + (high - low) * rand() / RAND_MAX;
+}
+
+// View of glOrtho(-50.0, 50.0, -50.0, 50.0, -1.0, 1.0) in a square window, as the
+// programs' but rationalBezierCurve1.cpp's.
+void orthoView(int windowSize, CurveView &view)
+{
+   float identity[16] = { 1.0, 0.0, 0.0, 0.0,  0.0, 1.0, 0.0, 0.0,  0.0, 0.0, 1.0, 0.0,  0.0, 0.0, 0.0, 1.0 };
+   float ortho[16] = { 0.02f, 0.0, 0.0, 0.0,  0.0, 0.02f, 0.0, 0.0,  0.0, 0.0, -1.0, 0.0,  0.0, 0.0, 0.0, 1.0 };
+   int viewport[4] = { 0, 0, windowSize, windowSize };
+   makeCurveView(identity, ortho, viewport, view);
+}
+
+// Product a*b of column-major matrices.
+void multiply(const float *a, const float *b, float *product)
+{
+   for (int c = 0; c < 4; c++)
+      for (int r = 0; r < 4; r++)
+      {
+         product[4*c + r] = 0.0;
+         for (int k = 0; k < 4; k++) product[4*c + r] += a[4*k + r] * b[4*c + k];
+      }
+}
+
+// View of rationalBezierCurve1.cpp: gluPerspective(120.0, 1.0, 1.0, 50.0) in its
+// window of 500 pixels, after glTranslatef(-8.3, -5.8, -7.0),
+// glRotatef(300.0, 1.0, 0.0, 0.0) and glScalef(1.0, 1.0, 5.0).
+void perspectiveView(CurveView &view)
+{
+   float f = 1.0 / tan(60.0 * PI / 180.0), n = 1.0, fa = 50.0;
+   float perspective[16] = { f, 0.0, 0.0, 0.0,  0.0, f, 0.0, 0.0,  0.0, 0.0, (fa + n) / (n - fa), -1.0,
+                             0.0, 0.0, 2 * fa * n / (n - fa), 0.0 };
+   float c = cos(300.0 * PI / 180.0), s = sin(300.0 * PI / 180.0);
+   float translate[16] = { 1.0, 0.0, 0.0, 0.0,  0.0, 1.0, 0.0, 0.0,  0.0, 0.0, 1.0, 0.0,  -8.3f, -5.8f, -7.0, 1.0 };
+   float rotate[16] = { 1.0, 0.0, 0.0, 0.0,  0.0, c, s, 0.0,  0.0, -s, c, 0.0,  0.0, 0.0, 0.0, 1.0 };
+   float scale[16] = { 1.0, 0.0, 0.0, 0.0,  0.0, 1.0, 0.0, 0.0,  0.0, 0.0, 5.0, 0.0,  0.0, 0.0, 0.0, 1.0 };
+   float translateRotate[16], modelview[16];
+   multiply(translate, rotate, translateRotate);
+   multiply(translateRotate, scale, modelview);
+   int viewport[4] = { 0, 0, 500, 500 };
+   makeCurveView(modelview, perspective, viewport, view);
+}
+
+// Knots of a Bezier curve of the order as a B-spline curve of a single span.
+void bezierKnots(int order, vector<float> &knots)
+{
+   knots.assign(2 * order, 0.0);
+   for (int i = order; i < 2 * order; i++) knots[i] = 1.0;
+}
+
+// Knots of the curve, its Bezier knots if it has none.
+const vector<float> &curveKnots(const Curve &curve, vector<float> &scratch)
+{
+   if (!curve.knots.empty()) return curve.knots;
+   bezierKnots(curve.order, scratch);
+   return scratch;
+}
+
+// Homogeneous control points of the curve, w 1 if it is of dimension 3.
+void homogeneousPoints(const Curve &curve, vector<float> &points)
+{
+   int numControlPoints = curve.controlPoints.size() / curve.dimension;
+   points.resize(4 * numControlPoints);
+   makeHomogeneous(&curve.controlPoints[0], numControlPoints, curve.dimension, &points[0]);
+}
+
+// Window co-ordinates of the point (x, y, z) in the view.
+void toWindow(const CurveView &view, const float *point, float &x, float &y)
+{
+   const float *m = view.matrix;
+   float w = m[3]*point[0] + m[7]*point[1] + m[11]*point[2] + m[15];
+   x = (m[0]*point[0] + m[4]*point[1] + m[8]*point[2] + m[12]) / w;
+   y = (m[1]*point[0] + m[5]*point[1] + m[9]*point[2] + m[13]) / w;
+}
+
+// Uniform line strip of the curve, segments per knot span, evaluated by
+// evaluateCurvePoints() into points, the homogeneous vertices, and then vertices.
+int uniformStrip(const Curve &curve, const vector<float> &knots, const vector<float> &homogeneous, int segments,
+                 vector<float> &parameters, vector<float> &points, vector<float> &vertices)
+{
+   int n = fillCurveParameters(&knots[0], knots.size(), curve.order, segments, parameters);
+   points.resize(4 * n);
+   vertices.resize(3 * n);
+   evaluateCurvePoints(&knots[0], knots.size(), curve.order, &homogeneous[0], 4, &parameters[0], n, &points[0]);
+   for (int k = 0; k < n; k++)
+      for (int c = 0; c < 3; c++) vertices[3*k + c] = points[4*k + c] / points[4*k + 3];
+   return n;
+}
+
+// Adaptive line strip of the curve. The parameters of a B-spline curve's strip are
+// evaluated by evaluateCurvePoints(), as loadCurveBuffer() evaluates them, into points,
+// the homogeneous vertices, and then vertices.
+int adaptiveStrip(const Curve &curve, vector<float> &vertices)
+{
+   vertices.clear();
+   if (curve.knots.empty())
+      return tessellateBezierCurve(&curve.controlPoints[0], curve.order, curve.dimension, 0.0, 1.0, curve.view,
+                                   CURVE_TOLERANCE, vertices);
+   vector<float> homogeneous, parameters, points;
+   homogeneousPoints(curve, homogeneous);
+   int n = tessellateBsplineParameters(&curve.knots[0], curve.knots.size(), curve.order, &curve.controlPoints[0],
+                                       curve.dimension, curve.view, CURVE_TOLERANCE, parameters);
+   points.resize(4 * n);
+   vertices.resize(3 * n);
+   evaluateCurvePoints(&curve.knots[0], curve.knots.size(), curve.order, &homogeneous[0], 4, &parameters[0], n,
+                       &points[0]);
+   for (int k = 0; k < n; k++)
+      for (int c = 0; c < 3; c++) vertices[3*k + c] = points[4*k + c] / points[4*k + 3];
+   return n;
+}
+
+// Largest distance in pixels of the curve from the line strip of vertices.
+double stripError(const Curve &curve, const vector<float> &vertices)
+{
+   vector<float> scratch, homogeneous;
+   const vector<float> &knots = curveKnots(curve, scratch);
+   homogeneousPoints(curve, homogeneous);
+   int numVertices = vertices.size() / 3, order = curve.order, numKnots = knots.size();
+   vector<float> x(numVertices), y(numVertices);
+   for (int k = 0; k < numVertices; k++) toWindow(curve.view, &vertices[3*k], x[k], y[k]);
+
+   double largest = 0.0;
+   for (int s = order - 1; s < numKnots - order; s++)
+      for (int k = 0; (knots[s] < knots[s+1]) && (k <= NUM_ERROR_SAMPLES); k++)
+      {
+         float u = knots[s] + (knots[s+1] - knots[s]) * k / NUM_ERROR_SAMPLES, point[4], px, py;
+         evaluateCurvePoint(&knots[0], numKnots, order, &homogeneous[0], 4, u, point);
+         for (int c = 0; c < 3; c++) point[c] /= point[3];
+         toWindow(curve.view, point, px, py);
+
+         double distance = 1.0e30;
+         for (int i = 0; i + 1 < numVertices; i++)
+         {
+            double dx = x[i+1] - x[i], dy = y[i+1] - y[i], ex = px - x[i], ey = py - y[i];
+            double t = (dx*dx + dy*dy > 0.0) ? (ex*dx + ey*dy) / (dx*dx + dy*dy) : 0.0;
+            t = (t < 0.0) ? 0.0 : ((t > 1.0) ? 1.0 : t);
+            double d = sqrt((ex - t*dx)*(ex - t*dx) + (ey - t*dy)*(ey - t*dy));
+            if (d < distance) distance = d;
+         }
+         if (numVertices == 1) distance = sqrt((px - x[0])*(px - x[0]) + (py - y[0])*(py - y[0]));
+         if (distance > largest) largest = distance;
+      }
+   return largest;
+}
+
+// Fewest segments per knot span of a uniform line strip whose error is at most error.
+int uniformSegments(const Curve &curve, double error)
+{
+   vector<float> scratch, homogeneous, parameters, points, vertices;
+   const vector<float> &knots = curveKnots(curve, scratch);
+   homogeneousPoints(curve, homogeneous);
+   int high = 1;
+   for (;; high *= 2)
+   {
+      uniformStrip(curve, knots, homogeneous, high, parameters, points, vertices);
+      if (stripError(curve, vertices) <= error) break;
+   }
+   int low = high / 2; // Too few, or 0.
+   while (high - low > 1)
+   {
+      int middle = (low + high) / 2;
+      uniformStrip(curve, knots, homogeneous, middle, parameters, points, vertices);
+      if (stripError(curve, vertices) <= error) high = middle;
+      else low = middle;
+   }
+   return high;
+}
+
+// Milliseconds of one adaptive tessellation of the curve, the best of NUM_REPEATS.
+double adaptiveTime(const Curve &curve)
+{
+   vector<float> vertices;
+   double best = 1.0e30;
+   for (int repeat = 0; repeat < NUM_REPEATS; repeat++)
+   {
+      int count = 0;
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      do { adaptiveStrip(curve, vertices); count++; } while (milliseconds(start) < MIN_TIMING);
+      best = min(best, milliseconds(start) / count);
+   }
+   return best;
+}
+
+// Milliseconds of one uniform line strip of the curve, the best of NUM_REPEATS.
+double uniformTime(const Curve &curve, int segments)
+{
+   vector<float> scratch, homogeneous, parameters, points, vertices;
+   const vector<float> &knots = curveKnots(curve, scratch);
+   double best = 1.0e30;
+   for (int repeat = 0; repeat < NUM_REPEATS; repeat++)
+   {
+      int count = 0;
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      do
+      {
+         homogeneousPoints(curve, homogeneous);
+         uniformStrip(curve, knots, homogeneous, segments, parameters, points, vertices);
+         count++;
+      } while (milliseconds(start) < MIN_TIMING);
+      best = min(best, milliseconds(start) / count);
+   }
+   return best;
+}
+
+// Results of a curve.
+struct Result
+{
+   int programVertices, adaptiveVertices, uniformVertices;
+   double programError, adaptiveError, uniformError, adaptiveMs, uniformMs;
+};
+
+Result measure(const Curve &curve)
+{
+   Result result;
+   vector<float> scratch, homogeneous, parameters, points, vertices;
+   const vector<float> &knots = curveKnots(curve, scratch);
+   homogeneousPoints(curve, homogeneous);
+   int numSpans = 0;
+   for (int s = curve.order - 1; s < (int)knots.size() - curve.order; s++) if (knots[s] < knots[s+1]) numSpans++;
+
+   result.programVertices = uniformStrip(curve, knots, homogeneous, curve.programSegments, parameters, points,
+                                         vertices);
+   result.programError = stripError(curve, vertices);
+
+   result.adaptiveVertices = adaptiveStrip(curve, vertices);
+   result.adaptiveError = stripError(curve, vertices);
+   result.adaptiveMs = adaptiveTime(curve);
+
+   int segments = uniformSegments(curve, result.adaptiveError);
+   result.uniformVertices = uniformStrip(curve, knots, homogeneous, segments, parameters, points, vertices);
+   result.uniformError = stripError(curve, vertices);
+   result.uniformMs = uniformTime(curve, segments);
+   return result;
+}
+
+void printResult(const char *name, const Result &result)
+{
+   printf("%-24s %6d %7.3f %6d %7.3f %9.2f %6d %7.3f %9.2f %6.2f\n", name,
+          result.programVertices, result.programError,
+          result.adaptiveVertices, result.adaptiveError, 1.0e3 * result.adaptiveMs,
+          result.uniformVertices, result.uniformError, 1.0e3 * result.uniformMs,
+          (double)result.uniformVertices / result.adaptiveVertices);
+}
+
+void printHeader(const char *title)
+{
+   printf("\n%s\n", title);
+   printf("%-24s %14s %24s %24s %6s\n", "", "program", "adaptive", "uniform", "");
+   printf("%-24s %6s %7s %6s %7s %9s %6s %7s %9s %6s\n", "curve", "verts", "error", "verts", "error", "us",
+          "verts", "error", "us", "ratio");
+}
+
+Curve makeCurve(const char *name, int order, int dimension, const float *controlPoints, int numControlPoints,
+                const float *knots, int numKnots)
+{
+   Curve curve;
+   curve.name = name;
+   curve.order = order;
+   curve.dimension = dimension;
+   curve.controlPoints.assign(controlPoints, controlPoints + dimension * numControlPoints);
+   if (knots) curve.knots.assign(knots, knots + numKnots);
+   curve.programSegments = knots ? CURVE_SAMPLES_PER_SPAN : PROGRAM_SEGMENTS;
+   orthoView(500, curve.view);
+   return curve;
+}
+
+// The curves of the programs as they start, but the flat ones of bezierCurves.cpp
+// and rationalBezierCurve3.cpp bent by moving their control points.
+void programCurves(vector<Curve> &curves)
+{
+   float deCasteljau3[] = { -40.0, -20.0, 0.0,  0.0, 40.0, 0.0,  40.0, -20.0, 0.0 };
+   curves.push_back(makeCurve("deCasteljau3", 3, 3, deCasteljau3, 3, NULL, 0));
+
+   float bezierCurves[] = { -40.0, 0.0, 0.0,  -30.0, 30.0, 0.0,  -10.0, -30.0, 0.0,
+                            0.0, 30.0, 0.0,  30.0, -30.0, 0.0,  40.0, 0.0, 0.0 };
+   for (int order = 3; order <= 6; order++)
+   {
+      static char names[4][32];
+      sprintf(names[order-3], "bezierCurves order %d", order);
+      curves.push_back(makeCurve(names[order-3], order, 3, bezierCurves, order, NULL, 0));
+   }
+
+   // Red rational and green lifted curves of rationalBezierCurve1.cpp in perspective.
+   float planePoints[4][3] = { {7.0, 2.0, 1.0}, {5.0, 0.0, 1.0}, {3.0, 7.0, 1.0}, {0.0, 3.0, 1.0} };
+   float rational1[16], lifted1[12];
+   for (int i = 0; i < 4; i++)
+   {
+      for (int c = 0; c < 3; c++) rational1[4*i + c] = lifted1[3*i + c] = 1.5f * planePoints[i][c];
+      rational1[4*i + 3] = 1.5;
+   }
+   curves.push_back(makeCurve("rationalBezierCurve1", 4, 4, rational1, 4, NULL, 0));
+   perspectiveView(curves.back().view);
+   curves.push_back(makeCurve("rationalBezierCurve1 lift", 4, 3, lifted1, 4, NULL, 0));
+   perspectiveView(curves.back().view);
+
+   float rational2[] = { 40.0, 0.0, 0.0, 1.0,  60.0, 60.0, 0.0, 1.5,  0.0, 40.0, 0.0, 1.0 };
+   curves.push_back(makeCurve("rationalBezierCurve2", 3, 4, rational2, 3, NULL, 0));
+
+   float points3[6][3] = { {40.0, 0.0, 0.0}, {40.0, 40.0, 0.0}, {0.0, 40.0, 0.0},
+                           {0.0, 0.0, 0.0}, {-40.0, 0.0, 0.0}, {-40.0, -40.0, 0.0} };
+   float weights3[6] = { 1.0, 3.0, 0.5, 1.0, 2.0, 1.0 }, rational3[24];
+   for (int i = 0; i < 6; i++)
+   {
+      for (int c = 0; c < 3; c++) rational3[4*i + c] = points3[i][c] * weights3[i];
+      rational3[4*i + 3] = weights3[i];
+   }
+   curves.push_back(makeCurve("rationalBezierCurve3", 6, 4, rational3, 6, NULL, 0));
+
+   float splinePoints[] = { -40.0, -20.0, 0.0,  -30.0, 30.0, 0.0,  -20.0, -20.0, 0.0,
+                            -10.0, 30.0, 0.0,  0.0, -20.0, 0.0,  10.0, 30.0, 0.0,
+                            20.0, -20.0, 0.0,  30.0, 30.0, 0.0,  40.0, -20.0, 0.0 };
+   float knots1[13], knotsQuadratic[12];
+   for (int i = 0; i < 13; i++) knots1[i] = 6.0 * i;
+   for (int i = 0; i < 12; i++) knotsQuadratic[i] = 7.0 * i;
+   curves.push_back(makeCurve("cubicSplineCurve1", 4, 3, splinePoints, 9, knots1, 13));
+   orthoView(600, curves.back().view);
+   curves.push_back(makeCurve("quadraticSplineCurve", 3, 3, splinePoints, 9, knotsQuadratic, 12));
+   orthoView(600, curves.back().view);
+
+   float points2[90], knots2[34];
+   for (int i = 0; i < 30; i++)
+   {
+      float t = 2 * PI * i / 30.0;
+      points2[3*i] = 30.0 * cos(t); points2[3*i + 1] = 30.0 * sin(t); points2[3*i + 2] = 0.0;
+   }
+   for (int i = 0; i < 34; i++) knots2[i] = (i < 4) ? 0.0f : ((i > 29) ? 27.0f : (float)(i - 3));
+   curves.push_back(makeCurve("cubicSplineCurve2", 4, 3, points2, 30, knots2, 34));
+   orthoView(600, curves.back().view);
+
+   // Graph of a cubic B-spline function of bSplines.cpp, drawn as a B-spline curve of
+   // the knots 0, 10, 20, 30 and 40 clamped, at steps of 0.005 in the program.
+   float graphKnots[11] = { 0.0, 0.0, 0.0, 0.0, 10.0, 20.0, 30.0, 40.0, 40.0, 40.0, 40.0 }, graphPoints[21];
+   for (int i = 0; i < 7; i++)
+   {
+      graphPoints[3*i] = -40.0;
+      for (int j = i + 1; j < i + 4; j++) graphPoints[3*i] += graphKnots[j] / 3;
+      graphPoints[3*i + 1] = (i == 3) ? 10.0 : -20.0;
+      graphPoints[3*i + 2] = 0.0;
+   }
+   curves.push_back(makeCurve("bSplines cubic graph", 4, 3, graphPoints, 7, graphKnots, 11));
+   curves.back().programSegments = 2000;
+   orthoView(600, curves.back().view);
+}
+
+int main(int argc, char **argv)
+{
+   int numRandom = (argc > 1) ? atoi(argv[1]) : 100;
+   printf("Tolerance %.2f pixels, %d lanes; error in pixels, time in microseconds per curve.\n",
+          CURVE_TOLERANCE, CURVE_LANES);
+
+   vector<Curve> curves;
+   programCurves(curves);
+   printHeader("Curves of the programs");
+   for (int k = 0; k < (int)curves.size(); k++) printResult(curves[k].name, measure(curves[k]));
+
+   // Random Bezier curves of degrees 2 to 5, polynomial and rational, across the
+   // window, and random cubic B-spline curves of 20 control points on knot vectors with
+   // double and triple knots; the sums of their vertices and times, the largest of their errors.
+   printHeader("Random curves, totals");
+   srand(1);
+   for (int kind = 0; kind < 9; kind++)
+   {
+      static const char *names[9] = { "Bezier degree 2", "Bezier degree 3", "Bezier degree 4", "Bezier degree 5",
+                                      "rational degree 2", "rational degree 3", "rational degree 4",
+                                      "rational degree 5", "cubic B-spline" };
+      Result total = { 0, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+      for (int k = 0; k < numRandom; k++)
+      {
+         int order = (kind < 8) ? 3 + kind % 4 : 4, numControlPoints = (kind < 8) ? order : 20;
+         bool rational = (kind >= 4) && (kind < 8);
+         vector<float> controlPoints, knots;
+         for (int i = 0; i < numControlPoints; i++)
+         {
+            float w = rational ? randomFloat(0.25, 4.0) : 1.0f;
+            controlPoints.push_back(w * randomFloat(-45.0, 45.0));
+            controlPoints.push_back(w * randomFloat(-45.0, 45.0));
+            controlPoints.push_back(0.0);
+            if (rational) controlPoints.push_back(w);
+         }
+         if (kind == 8)
+         {
+            // Knots of multiplicity up to order - 1, so that the curve is continuous.
+            int multiplicity = 1;
+            knots.push_back(0.0);
+            for (int i = 1; i < numControlPoints + order; i++)
+            {
+               bool repeat = (multiplicity < order - 1) && (rand() % 4 == 0);
+               knots.push_back(knots.back() + (repeat ? 0.0f : 1.0f));
+               multiplicity = repeat ? multiplicity + 1 : 1;
+            }
+         }
+         Curve curve = makeCurve(names[kind], order, rational ? 4 : 3, &controlPoints[0], numControlPoints,
+                                 knots.empty() ? NULL : &knots[0], knots.size());
+         Result result = measure(curve);
+         total.programVertices += result.programVertices;
+         total.adaptiveVertices += result.adaptiveVertices;
+         total.uniformVertices += result.uniformVertices;
+         total.programError = max(total.programError, result.programError);
+         total.adaptiveError = max(total.adaptiveError, result.adaptiveError);
+         total.uniformError = max(total.uniformError, result.uniformError);
+         total.adaptiveMs += result.adaptiveMs;
+         total.uniformMs += result.uniformMs;
+      }
+      printResult(names[kind], total);
+   }
+   return 0;
+}
@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// dynamicTreeBenchmark.cpp
+//
+// This program stresses the dynamic tree of dynamicTree.h with a field of asteroids laid
+// out as in spaceTravelFrustumCulled.cpp, of which a fraction drift every frame and a few
+// split in two, and times the updates against rebuilding the quadtree of quadtree.h.
+//
+// Every frame each drifting asteroid moves a step along its heading, and some asteroids,
+// chosen at random, are removed and replaced by two of half the volume. After the frames
+// the program checks the links and boxes of the tree, and that culling by the tree and
+// querying it about spheres like the spacecraft's miss no asteroid which a test of each
+// finds to meet the frustum or the sphere.
+//
+// Usage:
+// dynamicTreeBenchmark [asteroids per side] [frames] [percentage drifting] [splits per frame]
+// The defaults are a field of 1000 x 1000 asteroids, 100 frames, 5% drifting and 100
+// splits per frame.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "dynamicTree.h"
+#include "quadtree.h"
+
+#define PI 3.14159265
+#define DRIFT_SPEED 0.5 // Step of a drifting asteroid per frame.
+#define TREE_MARGIN 2.0 // Margin of the fat boxes of the tree.
+#define MIN_SPLIT_RADIUS 0.5 // Smallest asteroid split.
+#define NUM_CHECKS 100 // Random frusta and spheres checked.
+
+using namespace std;
+
+float randomFloat(float low, float high) { return low + (high - low) * rand() / RAND_MAX; }
+
+// Asteroids of the field with their leaves in the tree.
+struct Field
+{
+   vector<float> x, y, z, r, headingX, headingZ;
+   vector<int> leaves; // -1 once an asteroid is split.
+   DynamicTree tree;
+
+   Field() : tree(TREE_MARGIN) {}
+
+   DynamicTreeBox box(int k) const
+   {
+      DynamicTreeBox b = { x[k] - r[k], y[k] - r[k], z[k] - r[k], x[k] + r[k], y[k] + r[k], z[k] + r[k] };
+      return b;
+   }
+
+   void add(float cx, float cy, float cz, float cr)
+   {
+      float a = randomFloat(0.0, 2.0 * PI);
+      x.push_back(cx); y.push_back(cy); z.push_back(cz); r.push_back(cr);
+      headingX.push_back(-sin(a)); headingZ.push_back(-cos(a));
+      leaves.push_back(tree.insert(box((int)x.size() - 1), (int)x.size() - 1));
+   }
+
+   // Replace asteroid k by two of half its volume side by side.
+   void split(int k)
+   {
+      tree.remove(leaves[k]);
+      leaves[k] = -1;
+      float s = r[k] * 0.7937f; // Cube root of 1/2.
+      float cx = x[k], cy = y[k], cz = z[k];
+      add(cx - headingZ[k] * s, cy, cz + headingX[k] * s, s);
+      add(cx + headingZ[k] * s, cy, cz - headingX[k] * s, s);
+   }
+
+   // Step asteroid k along its heading, returning whether it was inserted again.
+   bool drift(int k)
+   {
+      x[k] += DRIFT_SPEED * headingX[k];
+      z[k] += DRIFT_SPEED * headingZ[k];
+      return tree.move(leaves[k], box(k));
+   }
+};
+
+// Random quadrilateral like the spacecraft's frustum in the field.
+void randomFrustum(FrustumPlanes &frustum, float minX, float maxX, float minZ, float maxZ)
+{
+   float x = randomFloat(minX, maxX), z = randomFloat(minZ, maxZ), a = randomFloat(0.0, 360.0);
+   setQuadrilateralFrustum(frustum, x - 7.072 * sin((PI/180.0) * (45.0 + a)), z - 7.072 * cos((PI/180.0) * (45.0 + a)),
+                           x - 353.6 * sin((PI/180.0) * (45.0 + a)), z - 353.6 * cos((PI/180.0) * (45.0 + a)),
+                           x + 353.6 * sin((PI/180.0) * (45.0 - a)), z - 353.6 * cos((PI/180.0) * (45.0 - a)),
+                           x + 7.072 * sin((PI/180.0) * (45.0 - a)), z - 7.072 * cos((PI/180.0) * (45.0 - a)));
+}
+
+// Number of asteroids meeting random frusta, and spheres the size of the spacecraft's
+// bounding sphere, which the tree misses.
+int countMissed(const Field &field, float minX, float maxX, float minZ, float maxZ)
+{
+   int missed = 0, n = (int)field.x.size();
+   vector<int> objects;
+   vector<unsigned char> found(n);
+   for (int c = 0; c < NUM_CHECKS; c++)
+   {
+      FrustumPlanes frustum;
+      randomFrustum(frustum, minX, maxX, minZ, maxZ);
+      field.tree.cull(frustum, objects);
+      fill(found.begin(), found.end(), 0);
+      for (int k = 0; k < (int)objects.size(); k++) found[objects[k]] = 1;
+      for (int k = 0; k < n; k++)
+         if (field.leaves[k] >= 0 && !found[k])
+         {
+            DynamicTreeBox b = field.box(k);
+            missed += (cullBox(frustum, b.minX, b.minY, b.minZ, b.maxX, b.maxY, b.maxZ) != CULL_OUTSIDE);
+         }
+
+      float x = randomFloat(minX, maxX), z = randomFloat(minZ, maxZ), r = 7.072;
+      DynamicTreeBox craft = { x - r, -r, z - r, x + r, r, z + r };
+      field.tree.query(craft, objects);
+      fill(found.begin(), found.end(), 0);
+      for (int k = 0; k < (int)objects.size(); k++) found[objects[k]] = 1;
+      for (int k = 0; k < n; k++)
+         if ( field.leaves[k] >= 0 && !found[k] &&
+              (field.x[k] - x) * (field.x[k] - x) + field.y[k] * field.y[k] + (field.z[k] - z) * (field.z[k] - z) <=
+              (field.r[k] + r) * (field.r[k] + r) )
+            missed++;
+   }
+   return missed;
+}
+
+double milliseconds(chrono::high_resolution_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+   int side = (argc > 1) ? atoi(argv[1]) : 1000;
+   int numFrames = (argc > 2) ? atoi(argv[2]) : 100;
+   int percentDrifting = (argc > 3) ? atoi(argv[3]) : 5;
+   int splitsPerFrame = (argc > 4) ? atoi(argv[4]) : 100;
+
+   // Field laid out as in spaceTravelFrustumCulled.cpp.
+   float minX = 15.0 + 30.0 * (-side / 2), maxX = minX + 30.0 * (side - 1);
+   float maxZ = -40.0, minZ = maxZ - 30.0 * (side - 1);
+   Field field;
+   chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+   for (int j = 0; j < side; j++)
+      for (int i = 0; i < side; i++)
+         field.add(minX + 30.0 * j, 0.0, maxZ - 30.0 * i, 3.0);
+   double buildTime = milliseconds(start);
+
+   printf("%d asteroids, %d frames, %d%% drifting, %d splits per frame\n", side * side, numFrames,
+          percentDrifting, splitsPerFrame);
+   printf("tree built by insertion in %.0f ms (%.0f ns per asteroid), height %d\n", buildTime,
+          1.0e6 * buildTime / (side * side), field.tree.getHeight());
+
+   // The first asteroids of every hundred drift.
+   vector<int> drifting;
+   for (int k = 0; k < side * side; k++)
+      if (k % 100 < percentDrifting) drifting.push_back(k);
+
+   double driftTime = 0.0, splitTime = 0.0, rebuildTime = 0.0;
+   long long numReinserted = 0, numSplit = 0;
+   AsteroidArray asteroids;
+   Quadtree quadtree;
+   const unsigned char color[3] = { 255, 255, 255 };
+   for (int frame = 0; frame < numFrames; frame++)
+   {
+      start = chrono::high_resolution_clock::now();
+      for (int d = 0; d < (int)drifting.size(); d++)
+         if (field.leaves[drifting[d]] >= 0) numReinserted += field.drift(drifting[d]);
+      driftTime += milliseconds(start);
+
+      start = chrono::high_resolution_clock::now();
+      for (int s = 0; s < splitsPerFrame; s++)
+      {
+         int k = rand() % (int)field.x.size();
+         if (field.leaves[k] >= 0 && field.r[k] >= MIN_SPLIT_RADIUS)
+         {
+            field.split(k);
+            numSplit++;
+         }
+      }
+      splitTime += milliseconds(start);
+
+      // What the quadtree would take to follow: rebuilding it from all the asteroids.
+      if (frame < 3)
+      {
+         start = chrono::high_resolution_clock::now();
+         asteroids = AsteroidArray();
+         for (int k = 0; k < (int)field.x.size(); k++)
+            if (field.leaves[k] >= 0) asteroids.add(field.x[k], field.y[k], field.z[k], field.r[k], color);
+         quadtree.initialize(asteroids, minX - 1000.0, maxZ + 1000.0, maxX - minX + 2000.0);
+         rebuildTime += milliseconds(start);
+      }
+   }
+
+   printf("%lld drifting asteroids inserted again, %lld split; %d asteroids, height %d\n", numReinserted,
+          numSplit, field.tree.getNumObjects(), field.tree.getHeight());
+   printf("%-46s %12s %16s\n", "per frame", "ms", "ns per update");
+   printf("%-46s %12.3f %16.1f\n", "drift (DynamicTree::move)", driftTime / numFrames,
+          1.0e6 * driftTime / ((double)numFrames * drifting.size()));
+   printf("%-46s %12.3f %16.1f\n", "split (DynamicTree::remove, insert x 2)", splitTime / numFrames,
+          numSplit ? 1.0e6 * splitTime / numSplit : 0.0);
+   printf("%-46s %12.3f\n", "rebuilding the Quadtree instead",
+          rebuildTime / min(numFrames, 3));
+
+   FrustumPlanes frustum;
+   vector<int> objects;
+   long long numCulled = 0;
+   start = chrono::high_resolution_clock::now();
+   for (int c = 0; c < NUM_CHECKS; c++)
+   {
+      randomFrustum(frustum, minX, maxX, minZ, maxZ);
+      numCulled += field.tree.cull(frustum, objects);
+   }
+   printf("%-46s %12.3f %16s\n", "cull (DynamicTree::cull), per frustum",
+          milliseconds(start) / NUM_CHECKS, "");
+   printf("(%.0f asteroids per frustum)\n", (double)numCulled / NUM_CHECKS);
+
+   int errors = field.tree.validate();
+   int missed = countMissed(field, minX, maxX, minZ, maxZ);
+   printf("validate: %d errors; %d asteroids missed by culling and queries\n", errors, missed);
+
+   return errors + missed;
+}
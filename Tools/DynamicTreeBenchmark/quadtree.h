@@ -0,0 +1,327 @@
+#ifndef QUADTREE_H
+#define QUADTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "frustumCulling.h"
+
+// Linear quadtree over the asteroid field. The asteroids are stored as a structure of
+// arrays, sorted by the Morton codes of the x and z co-ordinates of their centers, so
+// that the asteroids of every node of the tree occupy a single range of the arrays.
+// The nodes are stored in one array, the children of a node consecutive and in Morton
+// order, and refer to one another by index rather than by pointer. The tree is built by
+// partitioning the asteroids of each node among its quadrants, so that each child sees
+// only its parent's asteroids, in O(n log n) time for n asteroids.
+
+#define QUADTREE_MORTON_BITS 16 // Bits of each co-ordinate in a Morton code.
+#define QUADTREE_LEAF_ASTEROIDS 1 // Nodes with more asteroids than this are split.
+#define QUADTREE_PARALLEL_ASTEROIDS 65536 // Fewest asteroids for which the subtrees of the root
+                                          // are built on threads of their own.
+
+// Asteroids as a structure of arrays.
+struct AsteroidArray
+{
+   std::vector<float> centerX, centerY, centerZ, radius;
+   std::vector<unsigned char> colors; // Three bytes per asteroid.
+
+   int size() const { return (int)radius.size(); }
+
+   void reserve(int n)
+   {
+      centerX.reserve(n); centerY.reserve(n); centerZ.reserve(n); radius.reserve(n);
+      colors.reserve(3 * n);
+   }
+
+   void add(float x, float y, float z, float r, const unsigned char color[3])
+   {
+      centerX.push_back(x); centerY.push_back(y); centerZ.push_back(z); radius.push_back(r);
+      colors.insert(colors.end(), color, color + 3);
+   }
+
+   // Bytes held by the arrays.
+   size_t memorySize() const
+   {
+      return 4 * centerX.capacity() * sizeof(float) + colors.capacity();
+   }
+};
+
+// Range of consecutive asteroids in an asteroid array.
+struct AsteroidRange
+{
+   int first, count;
+};
+
+// Quadtree node: its range of asteroids and its children, numChildren of them from
+// firstChild in the node array, none if the node is a leaf. The rectangle bounding the
+// discs of its asteroids in the xz-plane is kept in arrays of the quadtree apart.
+struct QuadtreeNode
+{
+   int firstAsteroid, numAsteroids;
+   int firstChild, numChildren;
+};
+
+// Spread the low 16 bits of n to the even bits of the result.
+inline unsigned int spreadMortonBits(unsigned int n)
+{
+   n &= 0xFFFF;
+   n = (n | (n << 8)) & 0x00FF00FF;
+   n = (n | (n << 4)) & 0x0F0F0F0F;
+   n = (n | (n << 2)) & 0x33333333;
+   n = (n | (n << 1)) & 0x55555555;
+   return n;
+}
+
+// Quadtree class.
+class Quadtree
+{
+public:
+   // Split the square with SW corner at (x, z) and side s, and recursively its quadrants,
+   // till each leaf node has at most QUADTREE_LEAF_ASTEROIDS asteroids of the field,
+   // building the subtrees of the root's children in parallel if asked to.
+   void initialize(const AsteroidArray &field, float x, float z, float s, bool parallel = true);
+
+   // Collect the ranges of asteroids in the nodes which intersect the frustum, the
+   // quadrilateral with vertices (x1, z1), ..., (x4, z4), using an explicit stack in place
+   // of recursion. Return the number of asteroids in the ranges.
+   int cull(float x1, float z1, float x2, float z2, float x3, float z3, float x4, float z4,
+            std::vector<AsteroidRange> &ranges) const;
+
+   // Likewise with the frustum given by its planes, testing the children of a node
+   // together in the lanes of a SIMD register.
+   int cull(const FrustumPlanes &frustum, std::vector<AsteroidRange> &ranges) const;
+
+   const AsteroidArray &getAsteroids() const { return asteroids; }
+   const std::vector<QuadtreeNode> &getNodes() const { return nodes; }
+   int getNumNodes() const { return (int)nodes.size(); }
+
+   // Bytes held by the nodes, their bounds and the asteroids.
+   size_t memorySize() const
+   {
+      return nodes.capacity() * sizeof(QuadtreeNode) + 4 * nodeMinX.capacity() * sizeof(float) + asteroids.memorySize();
+   }
+
+private:
+   typedef std::pair<unsigned int, int> MortonEntry; // Morton code and index of an asteroid.
+
+   unsigned int mortonCode(float x, float z) const;
+   static bool splitNode(std::vector<QuadtreeNode> &nodes, int node, int depth,
+                         MortonEntry *entries, MortonEntry *scratch);
+   static void buildNode(std::vector<QuadtreeNode> &nodes, int node, int depth,
+                         MortonEntry *entries, MortonEntry *scratch);
+   void boundNodes();
+
+   float SWCornerX, SWCornerZ; // x and z co-ordinates of the SW corner of the root square.
+   float size; // Side length of the root square.
+   std::vector<QuadtreeNode> nodes; // Root first.
+   std::vector<float> nodeMinX, nodeMinZ, nodeMaxX, nodeMaxZ; // Bounds of the nodes, and three more entries
+                                                              // so that any four may be read from a node.
+   AsteroidArray asteroids; // Asteroids in Morton order.
+};
+
+// Morton code of the point (x, z) of the root square, x in the even and z in the odd bits.
+inline unsigned int Quadtree::mortonCode(float x, float z) const
+{
+   const float scale = (float)(1 << QUADTREE_MORTON_BITS) / size;
+   float u = (x - SWCornerX) * scale, v = (SWCornerZ - z) * scale;
+   const float maxCell = (float)((1 << QUADTREE_MORTON_BITS) - 1);
+   u = std::min(std::max(u, 0.0f), maxCell);
+   v = std::min(std::max(v, 0.0f), maxCell);
+   return spreadMortonBits((unsigned int)u) | (spreadMortonBits((unsigned int)v) << 1);
+}
+
+inline void Quadtree::initialize(const AsteroidArray &field, float x, float z, float s, bool parallel)
+{
+   SWCornerX = x; SWCornerZ = z; size = s;
+   int n = field.size();
+
+   std::vector<MortonEntry> entries(n), scratch(n);
+   for (int k = 0; k < n; k++) entries[k] = MortonEntry(mortonCode(field.centerX[k], field.centerZ[k]), k);
+
+   nodes.clear();
+   nodeMinX.clear(); nodeMinZ.clear(); nodeMaxX.clear(); nodeMaxZ.clear();
+   asteroids = AsteroidArray();
+   if (n == 0) return;
+   QuadtreeNode root = { 0, n, 0, 0 };
+   nodes.push_back(root);
+
+   if (!parallel || n < QUADTREE_PARALLEL_ASTEROIDS) buildNode(nodes, 0, 0, &entries[0], &scratch[0]);
+   else if (splitNode(nodes, 0, 0, &entries[0], &scratch[0]))
+   {
+      // Build the subtree of each child of the root into a node array of its own, the
+      // child first, on a thread of its own.
+      int firstChild = nodes[0].firstChild, numChildren = nodes[0].numChildren;
+      std::vector<std::vector<QuadtreeNode> > subtrees(numChildren);
+      std::vector<std::thread> threads;
+      for (int c = 0; c < numChildren; c++)
+      {
+         subtrees[c].push_back(nodes[firstChild + c]);
+         threads.push_back(std::thread(buildNode, std::ref(subtrees[c]), 0, 1, &scratch[0], &entries[0]));
+      }
+      for (int c = 0; c < numChildren; c++) threads[c].join();
+
+      // Append the subtrees, moving the indices of their nodes' children past the nodes before.
+      size_t numNodes = nodes.size();
+      for (int c = 0; c < numChildren; c++) numNodes += subtrees[c].size() - 1;
+      nodes.reserve(numNodes);
+      for (int c = 0; c < numChildren; c++)
+      {
+         int offset = (int)nodes.size() - 1;
+         for (int k = 0; k < (int)subtrees[c].size(); k++)
+         {
+            QuadtreeNode node = subtrees[c][k];
+            if (node.numChildren > 0) node.firstChild += offset;
+            if (k == 0) nodes[firstChild + c] = node;
+            else nodes.push_back(node);
+         }
+         std::vector<QuadtreeNode>().swap(subtrees[c]);
+      }
+   }
+
+   // Gather the asteroids in Morton order.
+   asteroids.reserve(n);
+   for (int k = 0; k < n; k++)
+   {
+      int a = entries[k].second;
+      asteroids.add(field.centerX[a], field.centerY[a], field.centerZ[a], field.radius[a], &field.colors[3 * a]);
+   }
+   boundNodes();
+}
+
+// If the node at the given depth has too many asteroids, partition its range of entries
+// among the quadrants of its square, by the two bits of their codes below the node's
+// prefix, and add the non-empty quadrants as its children. The entries are moved from
+// one array to the other, so the children's are in scratch; those of a leaf are
+// returned to the array the root's were in, the scratch array of a leaf at odd depth.
+// Return whether the node was split.
+inline bool Quadtree::splitNode(std::vector<QuadtreeNode> &nodes, int node, int depth,
+                                MortonEntry *entries, MortonEntry *scratch)
+{
+   int first = nodes[node].firstAsteroid, count = nodes[node].numAsteroids;
+
+   if (count <= QUADTREE_LEAF_ASTEROIDS || depth == QUADTREE_MORTON_BITS)
+   {
+      if (depth % 2) std::copy(entries + first, entries + first + count, scratch + first);
+      return false;
+   }
+
+   // Count the entries of each quadrant, then move them to their places in scratch.
+   int shift = 2 * (QUADTREE_MORTON_BITS - 1 - depth);
+   int bounds[5] = { first, 0, 0, 0, first + count }, next[4];
+   int counts[4] = { 0, 0, 0, 0 };
+   for (int k = first; k < first + count; k++) counts[(entries[k].first >> shift) & 3]++;
+   for (int q = 0; q < 3; q++) bounds[q + 1] = bounds[q] + counts[q];
+   for (int q = 0; q < 4; q++) next[q] = bounds[q];
+   for (int k = first; k < first + count; k++) scratch[next[(entries[k].first >> shift) & 3]++] = entries[k];
+
+   int firstChild = (int)nodes.size(), numChildren = 0;
+   for (int q = 0; q < 4; q++)
+      if (counts[q] > 0)
+      {
+         QuadtreeNode child = { bounds[q], counts[q], 0, 0 };
+         nodes.push_back(child);
+         numChildren++;
+      }
+   nodes[node].firstChild = firstChild;
+   nodes[node].numChildren = numChildren;
+   return true;
+}
+
+// Recursive routine to split the node and its descendants, the arrays of entries
+// changing places at each level.
+inline void Quadtree::buildNode(std::vector<QuadtreeNode> &nodes, int node, int depth,
+                                MortonEntry *entries, MortonEntry *scratch)
+{
+   if ( !splitNode(nodes, node, depth, entries, scratch) ) return;
+   int firstChild = nodes[node].firstChild, numChildren = nodes[node].numChildren;
+   for (int c = firstChild; c < firstChild + numChildren; c++) buildNode(nodes, c, depth + 1, scratch, entries);
+}
+
+// Bound the asteroids of each leaf and the children of each other node, children
+// coming after their parents in the node array.
+inline void Quadtree::boundNodes()
+{
+   int numNodes = (int)nodes.size();
+   nodeMinX.assign(numNodes + 3, 0.0f); nodeMinZ.assign(numNodes + 3, 0.0f);
+   nodeMaxX.assign(numNodes + 3, 0.0f); nodeMaxZ.assign(numNodes + 3, 0.0f);
+   for (int k = numNodes - 1; k >= 0; k--)
+   {
+      const QuadtreeNode &node = nodes[k];
+      float minX = 1e30f, minZ = 1e30f, maxX = -1e30f, maxZ = -1e30f;
+      if (node.numChildren == 0)
+         for (int a = node.firstAsteroid; a < node.firstAsteroid + node.numAsteroids; a++)
+         {
+            minX = std::min(minX, asteroids.centerX[a] - asteroids.radius[a]);
+            maxX = std::max(maxX, asteroids.centerX[a] + asteroids.radius[a]);
+            minZ = std::min(minZ, asteroids.centerZ[a] - asteroids.radius[a]);
+            maxZ = std::max(maxZ, asteroids.centerZ[a] + asteroids.radius[a]);
+         }
+      else
+         for (int c = node.firstChild; c < node.firstChild + node.numChildren; c++)
+         {
+            minX = std::min(minX, nodeMinX[c]); maxX = std::max(maxX, nodeMaxX[c]);
+            minZ = std::min(minZ, nodeMinZ[c]); maxZ = std::max(maxZ, nodeMaxZ[c]);
+         }
+      nodeMinX[k] = minX; nodeMinZ[k] = minZ; nodeMaxX[k] = maxX; nodeMaxZ[k] = maxZ;
+   }
+}
+
+inline int Quadtree::cull(float x1, float z1, float x2, float z2, float x3, float z3, float x4, float z4,
+                          std::vector<AsteroidRange> &ranges) const
+{
+   FrustumPlanes frustum;
+   setQuadrilateralFrustum(frustum, x1, z1, x2, z2, x3, z3, x4, z4);
+   return cull(frustum, ranges);
+}
+
+inline int Quadtree::cull(const FrustumPlanes &frustum, std::vector<AsteroidRange> &ranges) const
+{
+   ranges.clear();
+   if (nodes.empty()) return 0;
+
+   // The stack holds nodes which meet the frustum, with their results.
+   int stack[4 * (QUADTREE_MORTON_BITS + 1)], top = 0, numAsteroids = 0;
+   unsigned char results[4 * (QUADTREE_MORTON_BITS + 1)];
+   results[0] = (unsigned char)cullBox(frustum, nodeMinX[0], 0.0f, nodeMinZ[0], nodeMaxX[0], 0.0f, nodeMaxZ[0]);
+   if (results[0] != CULL_OUTSIDE) stack[top++] = 0;
+   while (top > 0)
+   {
+      top--;
+      const QuadtreeNode &node = nodes[stack[top]];
+
+      // Take the node's whole range if it is a leaf or it lies in the frustum, merging it
+      // with the last range if they are adjacent.
+      if (node.numChildren == 0 || results[top] == CULL_INSIDE)
+      {
+         if (!ranges.empty() && ranges.back().first + ranges.back().count == node.firstAsteroid)
+            ranges.back().count += node.numAsteroids;
+         else
+         {
+            AsteroidRange range = { node.firstAsteroid, node.numAsteroids };
+            ranges.push_back(range);
+         }
+         numAsteroids += node.numAsteroids;
+      }
+
+      // Otherwise test the children together and push those meeting the frustum, in
+      // reverse so that they are popped in Morton order.
+      else
+      {
+         unsigned char childResults[4];
+         int c = node.firstChild;
+         cullRectangles4(frustum, &nodeMinX[c], &nodeMinZ[c], &nodeMaxX[c], &nodeMaxZ[c], node.numChildren, childResults);
+         for (int k = node.numChildren - 1; k >= 0; k--)
+            if (childResults[k] != CULL_OUTSIDE)
+            {
+               results[top] = childResults[k];
+               stack[top++] = c + k;
+            }
+      }
+   }
+   return numAsteroids;
+}
+
+#endif
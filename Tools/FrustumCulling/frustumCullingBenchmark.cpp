@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// frustumCullingBenchmark.cpp
+//
+// This program checks the culling routines of frustumCulling.h on random inputs and
+// times them against checkQuadrilateralsIntersection() of
+// intersectionDetectionRoutines.cpp, which tested the nodes of the quadtree of
+// spaceTravelFrustumCulled.cpp before.
+//
+// The checks are, on random frusta and random boxes and spheres about them:
+// 2D: a rectangle is culled exactly when checkQuadrilateralsIntersection() finds that
+//     it misses the quadrilateral, and is inside only if its corners all are;
+// 3D: a box or sphere is never culled if a point of it lies in the view volume, and is
+//     inside only if all of it does;
+// SIMD: the lanes agree with the routines for one box or sphere.
+//
+// Usage:
+// frustumCullingBenchmark [number of boxes]
+// The number of boxes defaults to 1000000.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "intersectionDetectionRoutines.cpp"
+#include "frustumCulling.h"
+
+#define PI 3.14159265
+#define NUM_FRUSTA 1000 // Random frusta in the checks.
+#define BOXES_PER_FRUSTUM 1000 // Random boxes and spheres per frustum in the checks.
+
+using namespace std;
+
+float randomFloat(float low, float high) { return low + (high - low) * rand() / RAND_MAX; }
+
+// Random wedge like the spacecraft's frustum in the xz-plane: apex near the origin,
+// random heading, half-angle, near and far distances.
+void randomQuadrilateral(float x[4], float z[4])
+{
+   float apexX = randomFloat(-50.0, 50.0), apexZ = randomFloat(-50.0, 50.0);
+   float heading = randomFloat(0.0, 2.0 * PI), halfAngle = randomFloat(0.1, 1.4);
+   float nearDistance = randomFloat(1.0, 20.0), farDistance = nearDistance + randomFloat(10.0, 300.0);
+   float distances[4] = { nearDistance, farDistance, farDistance, nearDistance };
+   float angles[4] = { heading - halfAngle, heading - halfAngle, heading + halfAngle, heading + halfAngle };
+   for (int k = 0; k < 4; k++)
+   {
+      x[k] = apexX + distances[k] / cos(halfAngle) * sin(angles[k]);
+      z[k] = apexZ - distances[k] / cos(halfAngle) * cos(angles[k]);
+   }
+}
+
+// Random rectangle about the quadrilateral.
+void randomRectangle(const float x[4], const float z[4], float &minX, float &minZ, float &maxX, float &maxZ)
+{
+   float centerX = x[rand() % 4] + randomFloat(-150.0, 150.0), centerZ = z[rand() % 4] + randomFloat(-150.0, 150.0);
+   float width = randomFloat(0.1, 80.0), depth = randomFloat(0.1, 80.0);
+   minX = centerX - width / 2.0; maxX = centerX + width / 2.0;
+   minZ = centerZ - depth / 2.0; maxZ = centerZ + depth / 2.0;
+}
+
+// Column-major product of 4x4 matrices.
+void multiplyMatrices(const float a[16], const float b[16], float product[16])
+{
+   for (int column = 0; column < 4; column++)
+      for (int row = 0; row < 4; row++)
+      {
+         product[4*column + row] = 0.0;
+         for (int k = 0; k < 4; k++) product[4*column + row] += a[4*k + row] * b[4*column + k];
+      }
+}
+
+// Random clip matrix: a glFrustum() projection times a gluLookAt() view from a random
+// eye to a random point.
+void randomClipMatrix(float clip[16])
+{
+   float nearDistance = randomFloat(0.5, 10.0), farDistance = nearDistance + randomFloat(20.0, 300.0);
+   float halfWidth = nearDistance * randomFloat(0.2, 2.0), halfHeight = nearDistance * randomFloat(0.2, 2.0);
+   float projection[16] = { nearDistance / halfWidth, 0, 0, 0,   0, nearDistance / halfHeight, 0, 0,
+                            0, 0, -(farDistance + nearDistance) / (farDistance - nearDistance), -1,
+                            0, 0, -2 * farDistance * nearDistance / (farDistance - nearDistance), 0 };
+
+   float eye[3], center[3], up[3] = { 0.0, 1.0, 0.0 }, f[3], s[3], u[3];
+   for (int k = 0; k < 3; k++) { eye[k] = randomFloat(-50.0, 50.0); center[k] = randomFloat(-50.0, 50.0); }
+   for (int k = 0; k < 3; k++) f[k] = center[k] - eye[k];
+   float length = sqrt(f[0]*f[0] + f[1]*f[1] + f[2]*f[2]);
+   for (int k = 0; k < 3; k++) f[k] /= length;
+   s[0] = f[1]*up[2] - f[2]*up[1]; s[1] = f[2]*up[0] - f[0]*up[2]; s[2] = f[0]*up[1] - f[1]*up[0];
+   length = sqrt(s[0]*s[0] + s[1]*s[1] + s[2]*s[2]);
+   for (int k = 0; k < 3; k++) s[k] /= length;
+   u[0] = s[1]*f[2] - s[2]*f[1]; u[1] = s[2]*f[0] - s[0]*f[2]; u[2] = s[0]*f[1] - s[1]*f[0];
+   float view[16] = { s[0], u[0], -f[0], 0,   s[1], u[1], -f[1], 0,   s[2], u[2], -f[2], 0,
+                      -(s[0]*eye[0] + s[1]*eye[1] + s[2]*eye[2]), -(u[0]*eye[0] + u[1]*eye[1] + u[2]*eye[2]),
+                      f[0]*eye[0] + f[1]*eye[1] + f[2]*eye[2], 1 };
+   multiplyMatrices(projection, view, clip);
+}
+
+// Whether a point lies in the view volume of the clip matrix, within a tolerance
+// relative to w.
+bool pointInClipVolume(const float clip[16], float x, float y, float z, float tolerance)
+{
+   float c[4];
+   for (int row = 0; row < 4; row++) c[row] = clip[row] * x + clip[4 + row] * y + clip[8 + row] * z + clip[12 + row];
+   float w = c[3] * (1.0 + tolerance);
+   return w > 0 && fabs(c[0]) <= w && fabs(c[1]) <= w && fabs(c[2]) <= w;
+}
+
+// Check the 2D routines.
+void check2D()
+{
+   int mismatches = 0, wrongInside = 0, laneMismatches = 0, outside = 0;
+   vector<float> minX(BOXES_PER_FRUSTUM), minZ(BOXES_PER_FRUSTUM), maxX(BOXES_PER_FRUSTUM), maxZ(BOXES_PER_FRUSTUM);
+   vector<unsigned char> results(BOXES_PER_FRUSTUM);
+   for (int f = 0; f < NUM_FRUSTA; f++)
+   {
+      float x[4], z[4];
+      randomQuadrilateral(x, z);
+      FrustumPlanes frustum;
+      setQuadrilateralFrustum(frustum, x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3]);
+      for (int k = 0; k < BOXES_PER_FRUSTUM; k++) randomRectangle(x, z, minX[k], minZ[k], maxX[k], maxZ[k]);
+      cullBoxes(frustum, &minX[0], NULL, &minZ[0], &maxX[0], NULL, &maxZ[0], BOXES_PER_FRUSTUM, &results[0]);
+
+      for (int k = 0; k < BOXES_PER_FRUSTUM; k++)
+      {
+         int meets = checkQuadrilateralsIntersection(x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3],
+                                                     minX[k], maxZ[k], minX[k], minZ[k], maxX[k], minZ[k], maxX[k], maxZ[k]);
+         if (meets != (results[k] != CULL_OUTSIDE)) mismatches++;
+         if (results[k] == CULL_OUTSIDE) outside++;
+         if ( results[k] == CULL_INSIDE &&
+              !( checkPointInQuadrilateral(x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3], minX[k], minZ[k]) &&
+                 checkPointInQuadrilateral(x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3], minX[k], maxZ[k]) &&
+                 checkPointInQuadrilateral(x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3], maxX[k], minZ[k]) &&
+                 checkPointInQuadrilateral(x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3], maxX[k], maxZ[k]) ) )
+            wrongInside++;
+         if (results[k] != cullBox(frustum, minX[k], 0.0, minZ[k], maxX[k], 0.0, maxZ[k])) laneMismatches++;
+      }
+      for (int k = 0; k + 4 <= BOXES_PER_FRUSTUM; k += 4)
+      {
+         unsigned char fours[4];
+         cullRectangles4(frustum, &minX[k], &minZ[k], &maxX[k], &maxZ[k], 4, fours);
+         for (int l = 0; l < 4; l++) if (fours[l] != results[k + l]) laneMismatches++;
+      }
+   }
+   printf("2D rectangles: %d tested, %d outside; %d disagree with checkQuadrilateralsIntersection(), "
+          "%d wrongly inside, %d lanes disagree\n", NUM_FRUSTA * BOXES_PER_FRUSTUM, outside, mismatches, wrongInside, laneMismatches);
+}
+
+// Check the 3D routines.
+void check3D()
+{
+   int wrongBoxes = 0, wrongSpheres = 0, laneMismatches = 0, outsideBoxes = 0, outsideSpheres = 0;
+   int n = BOXES_PER_FRUSTUM;
+   vector<float> minX(n), minY(n), minZ(n), maxX(n), maxY(n), maxZ(n), r(n);
+   vector<unsigned char> boxResults(n), sphereResults(n);
+   for (int f = 0; f < NUM_FRUSTA; f++)
+   {
+      float clip[16];
+      randomClipMatrix(clip);
+      FrustumPlanes frustum;
+      setMatrixFrustum(frustum, clip);
+      for (int k = 0; k < n; k++)
+      {
+         float x = randomFloat(-200.0, 200.0), y = randomFloat(-200.0, 200.0), z = randomFloat(-200.0, 200.0);
+         float size = randomFloat(0.1, 60.0);
+         minX[k] = x - size * randomFloat(0.1, 1.0); maxX[k] = x + size * randomFloat(0.1, 1.0);
+         minY[k] = y - size * randomFloat(0.1, 1.0); maxY[k] = y + size * randomFloat(0.1, 1.0);
+         minZ[k] = z - size * randomFloat(0.1, 1.0); maxZ[k] = z + size * randomFloat(0.1, 1.0);
+         r[k] = size;
+      }
+      // Spheres are centered at the boxes' minimum corners.
+      cullBoxes(frustum, &minX[0], &minY[0], &minZ[0], &maxX[0], &maxY[0], &maxZ[0], n, &boxResults[0]);
+      cullSpheres(frustum, &minX[0], &minY[0], &minZ[0], &r[0], n, &sphereResults[0]);
+
+      for (int k = 0; k < n; k++)
+      {
+         if (boxResults[k] != cullBox(frustum, minX[k], minY[k], minZ[k], maxX[k], maxY[k], maxZ[k])) laneMismatches++;
+         if (sphereResults[k] != cullSphere(frustum, minX[k], minY[k], minZ[k], r[k])) laneMismatches++;
+         if (boxResults[k] == CULL_OUTSIDE) outsideBoxes++;
+         if (sphereResults[k] == CULL_OUTSIDE) outsideSpheres++;
+
+         // Sample points of the box: none may be in the volume if it is culled, all must
+         // be if it is inside.
+         for (int sample = 0; sample < 27; sample++)
+         {
+            float px = minX[k] + (maxX[k] - minX[k]) * (sample % 3) / 2.0;
+            float py = minY[k] + (maxY[k] - minY[k]) * (sample / 3 % 3) / 2.0;
+            float pz = minZ[k] + (maxZ[k] - minZ[k]) * (sample / 9) / 2.0;
+            if (boxResults[k] == CULL_OUTSIDE && pointInClipVolume(clip, px, py, pz, -1e-4)) { wrongBoxes++; break; }
+            if (boxResults[k] == CULL_INSIDE && !pointInClipVolume(clip, px, py, pz, 1e-4)) { wrongBoxes++; break; }
+         }
+
+         // Sample points of the sphere: its center and the ends of its axes.
+         for (int sample = 0; sample < 7; sample++)
+         {
+            float p[3] = { minX[k], minY[k], minZ[k] };
+            if (sample > 0) p[(sample - 1) / 2] += (sample % 2 ? r[k] : -r[k]) * 0.9999;
+            if (sphereResults[k] == CULL_OUTSIDE && pointInClipVolume(clip, p[0], p[1], p[2], -1e-4)) { wrongSpheres++; break; }
+            if (sphereResults[k] == CULL_INSIDE && !pointInClipVolume(clip, p[0], p[1], p[2], 1e-4)) { wrongSpheres++; break; }
+         }
+      }
+   }
+   printf("3D boxes: %d tested, %d outside, %d wrong; spheres: %d outside, %d wrong; %d lanes disagree\n",
+          NUM_FRUSTA * n, outsideBoxes, wrongBoxes, outsideSpheres, wrongSpheres, laneMismatches);
+}
+
+double nanoseconds(chrono::high_resolution_clock::time_point start, int n)
+{
+   return chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / n;
+}
+
+// Time the routines on n boxes.
+void runBenchmark(int n)
+{
+   vector<float> minX(n), minY(n), minZ(n), maxX(n), maxY(n), maxZ(n), r(n);
+   vector<unsigned char> results(n);
+   float x[4], z[4], clip[16];
+   randomQuadrilateral(x, z);
+   randomClipMatrix(clip);
+   for (int k = 0; k < n; k++)
+   {
+      randomRectangle(x, z, minX[k], minZ[k], maxX[k], maxZ[k]);
+      minY[k] = randomFloat(-200.0, 0.0); maxY[k] = minY[k] + randomFloat(0.1, 60.0);
+      r[k] = randomFloat(0.1, 60.0);
+   }
+   FrustumPlanes quadrilateral, frustum;
+   setQuadrilateralFrustum(quadrilateral, x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3]);
+   setMatrixFrustum(frustum, clip);
+
+   printf("\n%d boxes, %d SIMD lanes\n%-52s %10s\n", n, CULL_LANES, "routine", "ns/box");
+   long kept = 0;
+   chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+   for (int k = 0; k < n; k++)
+      kept += checkQuadrilateralsIntersection(x[0], z[0], x[1], z[1], x[2], z[2], x[3], z[3],
+                                              minX[k], maxZ[k], minX[k], minZ[k], maxX[k], minZ[k], maxX[k], maxZ[k]);
+   printf("%-52s %10.2f\n", "2D checkQuadrilateralsIntersection()", nanoseconds(start, n));
+
+   start = chrono::high_resolution_clock::now();
+   for (int k = 0; k < n; k++) results[k] = cullBox(quadrilateral, minX[k], 0.0, minZ[k], maxX[k], 0.0, maxZ[k]);
+   printf("%-52s %10.2f\n", "2D cullBox(), one at a time", nanoseconds(start, n));
+
+   start = chrono::high_resolution_clock::now();
+   for (int k = 0; k + 4 <= n; k += 4) cullRectangles4(quadrilateral, &minX[k], &minZ[k], &maxX[k], &maxZ[k], 4, &results[k]);
+   printf("%-52s %10.2f\n", "2D cullRectangles4(), four lanes", nanoseconds(start, n));
+
+   start = chrono::high_resolution_clock::now();
+   cullBoxes(quadrilateral, &minX[0], NULL, &minZ[0], &maxX[0], NULL, &maxZ[0], n, &results[0]);
+   printf("%-52s %10.2f\n", "2D cullBoxes(), CULL_LANES lanes", nanoseconds(start, n));
+
+   start = chrono::high_resolution_clock::now();
+   for (int k = 0; k < n; k++) results[k] = cullBox(frustum, minX[k], minY[k], minZ[k], maxX[k], maxY[k], maxZ[k]);
+   printf("%-52s %10.2f\n", "3D cullBox(), one at a time", nanoseconds(start, n));
+
+   start = chrono::high_resolution_clock::now();
+   cullBoxes(frustum, &minX[0], &minY[0], &minZ[0], &maxX[0], &maxY[0], &maxZ[0], n, &results[0]);
+   printf("%-52s %10.2f\n", "3D cullBoxes(), CULL_LANES lanes", nanoseconds(start, n));
+
+   start = chrono::high_resolution_clock::now();
+   for (int k = 0; k < n; k++) results[k] = cullSphere(frustum, minX[k], minY[k], minZ[k], r[k]);
+   printf("%-52s %10.2f\n", "3D cullSphere(), one at a time", nanoseconds(start, n));
+
+   start = chrono::high_resolution_clock::now();
+   cullSpheres(frustum, &minX[0], &minY[0], &minZ[0], &r[0], n, &results[0]);
+   printf("%-52s %10.2f\n", "3D cullSpheres(), CULL_LANES lanes", nanoseconds(start, n));
+
+   for (int k = 0; k < n; k++) kept += results[k];
+   if (kept == -1) printf("\n"); // Keep the results live.
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   srand(1);
+   check2D();
+   check3D();
+   runBenchmark((argc > 1) ? atoi(argv[1]) : 1000000);
+   return 0;
+}
@@ -0,0 +1,353 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// getbmpBenchmark.cpp
+//
+// This program times the memory-mapped, single-pass getbmp() against the original
+// loader, which read the file with an ifstream into an RGB buffer, swapped its bytes
+// in place and copied them out to RGBA, on all the bmp files in a directory and on two
+// large images it writes to, and deletes from, the working directory. It checks that
+// the two return the same bytes. It then times each of getbmp()'s scanline conversion
+// kernels the processor supports, scalar, SSSE3 and AVX2, on 24- and 32-bit images,
+// and checks that the SIMD kernels match the scalar one byte for byte.
+//
+// getbmp.cpp is included rather than linked, so as to reach its static kernels.
+//
+// Usage:
+// getbmpBenchmark [directory]
+// The directory defaults to ../../Textures.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <dirent.h>
+#endif
+
+#include "getbmp.cpp"
+
+using namespace std;
+
+// The original loader, as it was before getbmp() was memory-mapped, except that it
+// frees its intermediate RGB bitmap file, which it used to leak, so that the repeated
+// timings do not run out of memory.
+BitMapFile *getbmpOriginal(string filename)
+{
+	int offset, headerSize;
+
+	// Initialize bitmap files for RGB (input) and RGBA (output).
+	BitMapFile *bmpRGB = new BitMapFile;
+	BitMapFile *bmpRGBA = new BitMapFile;
+
+	// Read input bmp file name.
+	ifstream infile(filename.c_str(), ios::binary);
+
+	// Get starting point of image data in bmp file.
+	infile.seekg(10);
+	infile.read((char *)&offset, 4);
+
+	// Get header size of bmp file.
+	infile.read((char *)&headerSize,4);
+
+	// Get image width and height values from bmp file header.
+	infile.seekg(18);
+	infile.read((char *)&bmpRGB->sizeX, 4);
+	infile.read((char *)&bmpRGB->sizeY, 4);
+
+	// Determine the length of zero-byte padding of the scanlines 
+	// (each scanline of a bmp file is 4-byte aligned by padding with zeros).
+	int padding = (3 * bmpRGB->sizeX) % 4 ? 4 - (3 * bmpRGB->sizeX) % 4 : 0;
+
+	// Add the padding to determine size of each scanline.
+	int sizeScanline = 3 * bmpRGB->sizeX + padding;
+
+	// Allocate storage for image in input bitmap file.
+	int sizeStorage = sizeScanline * bmpRGB->sizeY;
+	bmpRGB->data = new unsigned char[sizeStorage];
+
+	// Read bmp file image data into input bitmap file.
+	infile.seekg(offset);
+	infile.read((char *) bmpRGB->data , sizeStorage);
+
+	// Reverse color values from BGR (bmp storage format) to RGB.
+	int startScanline, endScanlineImageData, temp;
+	for (int y = 0; y < bmpRGB->sizeY; y++)
+	{
+		startScanline = y * sizeScanline; // Start position of y'th scanline.
+		endScanlineImageData = startScanline + 3 * bmpRGB->sizeX; // Image data excludes padding.
+		for (int x = startScanline; x < endScanlineImageData; x += 3)
+		{
+			temp = bmpRGB->data[x];
+			bmpRGB->data[x] = bmpRGB->data[x+2];
+			bmpRGB->data[x+2] = temp;
+		}
+	}
+
+	// Set image width and height values and allocate storage for image in output bitmap file.
+	bmpRGBA->sizeX = bmpRGB->sizeX;
+	bmpRGBA->sizeY = bmpRGB->sizeY;
+	bmpRGBA->data = new unsigned char[4*bmpRGB->sizeX*bmpRGB->sizeY];
+
+	// Copy RGB data from input to output bitmap files, set output A to 1.
+	for(int j = 0; j < 4*bmpRGB->sizeY * bmpRGB->sizeX; j+=4)
+	{
+		bmpRGBA->data[j] = bmpRGB->data[(j/4)*3];
+		bmpRGBA->data[j+1] = bmpRGB->data[(j/4)*3+1];
+		bmpRGBA->data[j+2] = bmpRGB->data[(j/4)*3+2];
+		bmpRGBA->data[j+3] = 0xFF;
+	}
+
+	delete[] bmpRGB->data;
+	delete bmpRGB;
+
+	return bmpRGBA;
+}
+
+// List the bmp files in a directory.
+vector<string> listBmpFiles(string directory)
+{
+	vector<string> filenames;
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE find = FindFirstFileA((directory + "/*.bmp").c_str(), &found);
+	if (find != INVALID_HANDLE_VALUE)
+	{
+		do filenames.push_back(directory + "/" + found.cFileName);
+		while (FindNextFileA(find, &found));
+		FindClose(find);
+	}
+#else
+	DIR *dir = opendir(directory.c_str());
+	if (dir != NULL)
+	{
+		struct dirent *found;
+		while ((found = readdir(dir)) != NULL)
+		{
+			string name = found->d_name;
+			if (name.size() > 4 && name.compare(name.size() - 4, 4, ".bmp") == 0)
+				filenames.push_back(directory + "/" + name);
+		}
+		closedir(dir);
+	}
+#endif
+	return filenames;
+}
+
+// Write a 24-bit bmp file of the given size filled with pseudo-random pixels.
+bool writeTestBmp(string filename, int sizeX, int sizeY)
+{
+	int sizeScanline = (3 * sizeX + 3) & ~3;
+	unsigned char header[54] = { 'B', 'M' };
+	unsigned int fields[][2] = { {2, 54 + (unsigned int)sizeScanline * sizeY}, {10, 54}, {14, 40},
+		                         {18, (unsigned int)sizeX}, {22, (unsigned int)sizeY} };
+	for (int f = 0; f < 5; f++)
+		for (int b = 0; b < 4; b++) header[fields[f][0] + b] = (unsigned char)(fields[f][1] >> (8 * b));
+	header[26] = 1; // Planes.
+	header[28] = 24; // Bits per pixel.
+
+	ofstream outfile(filename.c_str(), ios::binary);
+	outfile.write((const char *)header, 54);
+	vector<unsigned char> scanline(sizeScanline, 0);
+	unsigned int seed = 12345;
+	for (int y = 0; y < sizeY; y++)
+	{
+		for (int x = 0; x < 3 * sizeX; x++) scanline[x] = (unsigned char)((seed = seed * 1664525 + 1013904223) >> 24);
+		outfile.write((const char *)&scanline[0], sizeScanline);
+	}
+	return outfile.good();
+}
+
+// Free a bitmap file returned by a loader.
+void freeBmp(BitMapFile *bmp)
+{
+	if (bmp == NULL) return;
+	delete[] bmp->data;
+	delete bmp;
+}
+
+// Best of several timings of a loader on a file, in milliseconds.
+double timeLoad(BitMapFile *(*load)(string), string filename, int repeats)
+{
+	double best = 1e30;
+	for (int r = 0; r < repeats; r++)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		BitMapFile *bmp = load(filename);
+		double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		freeBmp(bmp);
+		best = min(best, elapsed);
+	}
+	return best;
+}
+
+// Time both loaders on a file, compare their output and print a line of the table.
+// Returns whether the output is identical.
+bool compareLoaders(string filename, double &originalTotal, double &mappedTotal)
+{
+	string name = filename.substr(filename.find_last_of("/\\") + 1);
+	BitMapFile *original = getbmpOriginal(filename), *mapped = getbmp(filename);
+	if (mapped == NULL)
+	{
+		printf("%-24s not read by getbmp()\n", name.c_str());
+		freeBmp(original);
+		return false;
+	}
+	int sizeX = mapped->sizeX, sizeY = mapped->sizeY;
+	size_t size = (size_t)4 * sizeX * sizeY;
+	bool identical = original->sizeX == sizeX && original->sizeY == sizeY && memcmp(original->data, mapped->data, size) == 0;
+	freeBmp(original);
+	freeBmp(mapped);
+
+	int repeats = max(3, (int)min((size_t)1000, 64 * 1024 * 1024 / size));
+	double originalTime = timeLoad(getbmpOriginal, filename, repeats);
+	double mappedTime = timeLoad(getbmp, filename, repeats);
+	originalTotal += originalTime;
+	mappedTotal += mappedTime;
+
+	printf("%-24s %5d x %-5d %12.3f %12.3f %8.1fx %9.2f  %s\n", name.c_str(), sizeX, sizeY, originalTime, mappedTime,
+	       originalTime / mappedTime, size / mappedTime / 1e6, identical ? "identical" : "DIFFERENT");
+	return identical;
+}
+
+// A scanline conversion kernel of getbmp.cpp, converting the pixels it can and
+// returning their number.
+typedef int (*ScanlineKernel)(const unsigned char *in, unsigned char *out, int numPixels,
+	                          int bytesPerPixel, bool keepAlpha);
+
+// The scalar path: no pixels converted before the scalar routine.
+int convertScanlineNone(const unsigned char *, unsigned char *, int, int, bool) { return 0; }
+
+// Convert an image of padded scanlines to RGBA with a kernel followed by the scalar
+// routine, as convertScanline() does.
+void convertImage(ScanlineKernel kernel, const unsigned char *in, unsigned char *out, int sizeX, int sizeY,
+	              int bytesPerPixel, bool keepAlpha)
+{
+	size_t sizeScanline = ((size_t)bytesPerPixel * sizeX + 3) & ~(size_t)3;
+	for (int y = 0; y < sizeY; y++, in += sizeScanline, out += (size_t)4 * sizeX)
+	{
+		int x = kernel(in, out, sizeX, bytesPerPixel, keepAlpha);
+		convertScanlineScalar(in + bytesPerPixel * x, out + 4 * x, sizeX - x, bytesPerPixel, keepAlpha);
+	}
+}
+
+// Fill a buffer with pseudo-random bytes.
+void fillRandom(vector<unsigned char> &bytes, unsigned int seed)
+{
+	for (size_t k = 0; k < bytes.size(); k++) bytes[k] = (unsigned char)((seed = seed * 1664525 + 1013904223) >> 24);
+}
+
+// Whether a kernel matches the scalar routine on every scanline width from 1 to 69,
+// for both pixel sizes, and with and without the file's alpha, which only 32-bit
+// pixels have.
+bool checkKernel(ScanlineKernel kernel)
+{
+	for (int bytesPerPixel = 3; bytesPerPixel <= 4; bytesPerPixel++)
+		for (int keepAlpha = 0; keepAlpha <= bytesPerPixel - 3; keepAlpha++)
+			for (int sizeX = 1; sizeX <= 69; sizeX++)
+			{
+				vector<unsigned char> in((((size_t)bytesPerPixel * sizeX + 3) & ~(size_t)3) * 3), scalar(12 * sizeX), simd(12 * sizeX);
+				fillRandom(in, sizeX * 8 + bytesPerPixel * 2 + keepAlpha);
+				convertImage(convertScanlineNone, &in[0], &scalar[0], sizeX, 3, bytesPerPixel, keepAlpha != 0);
+				convertImage(kernel, &in[0], &simd[0], sizeX, 3, bytesPerPixel, keepAlpha != 0);
+				if (scalar != simd) return false;
+			}
+	return true;
+}
+
+// Time the kernels on an image of the given size and pixel size, and check that
+// they agree with the scalar routine on it. Returns whether they do.
+bool timeKernels(ScanlineKernel kernels[], int numKernels, int sizeX, int sizeY, int bytesPerPixel)
+{
+	vector<unsigned char> in((((size_t)bytesPerPixel * sizeX + 3) & ~(size_t)3) * sizeY);
+	vector<unsigned char> scalar((size_t)4 * sizeX * sizeY), out(scalar.size());
+	fillRandom(in, sizeX + sizeY + bytesPerPixel);
+	convertImage(convertScanlineNone, &in[0], &scalar[0], sizeX, sizeY, bytesPerPixel, false);
+
+	bool identical = true;
+	printf("%4d x %-4d %2d-bit", sizeX, sizeY, 8 * bytesPerPixel);
+	int repeats = max(3, (int)(256 * 1024 * 1024 / out.size()));
+	for (int k = 0; k < numKernels; k++)
+	{
+		double best = 1e30;
+		for (int r = 0; r < repeats; r++)
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			convertImage(kernels[k], &in[0], &out[0], sizeX, sizeY, bytesPerPixel, false);
+			best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+		}
+		identical = identical && out == scalar;
+		printf(" %9.2f", out.size() / best / 1e9);
+	}
+	printf("  %s\n", identical ? "identical" : "DIFFERENT");
+	return identical;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	string directory = argc > 1 ? argv[1] : "../../Textures";
+	vector<string> filenames = listBmpFiles(directory);
+	if (filenames.empty())
+	{
+		cout << "No .bmp files found in " << directory << endl;
+		return 1;
+	}
+	sort(filenames.begin(), filenames.end());
+
+	printf("%-24s %13s %12s %12s %9s %9s  %s\n", "file", "size", "ifstream ms", "mapped ms", "speedup", "out GB/s",
+	       "output");
+	double originalTotal = 0.0, mappedTotal = 0.0;
+	bool identical = true;
+	for (int i = 0; i < (int)filenames.size(); i++)
+		identical = compareLoaders(filenames[i], originalTotal, mappedTotal) && identical;
+	printf("%-24s %13s %12.3f %12.3f %8.1fx\n\n", "all files", "", originalTotal, mappedTotal,
+	       originalTotal / mappedTotal);
+
+	// Large images, whose scanlines no longer fit in the caches.
+	int sizes[] = { 2048, 4096 };
+	for (int s = 0; s < 2; s++)
+	{
+		char filename[64];
+		sprintf(filename, "getbmpBenchmark%d.bmp", sizes[s]);
+		if (!writeTestBmp(filename, sizes[s], sizes[s])) { cout << "Cannot write " << filename << endl; continue; }
+		double originalTime = 0.0, mappedTime = 0.0;
+		identical = compareLoaders(filename, originalTime, mappedTime) && identical;
+		remove(filename);
+	}
+
+	cout << endl << (identical ? "getbmp() output is identical to the original loader's on every file."
+	                           : "getbmp() output DIFFERS from the original loader's.") << endl << endl;
+
+	// The kernels the processor supports, scalar first.
+	const char *names[3] = { "scalar", "SSSE3", "AVX2" };
+	ScanlineKernel kernels[3] = { convertScanlineNone };
+	int numKernels = 1;
+#ifdef GETBMP_SIMD
+	int level = detectSimdLevel();
+	if (level >= 1) kernels[numKernels++] = convertScanlineSSSE3;
+	if (level >= 2) kernels[numKernels++] = convertScanlineAVX2;
+#endif
+
+	printf("Output GB/s%10s", "");
+	for (int k = 0; k < numKernels; k++) printf(" %9s", names[k]);
+	printf("\n");
+	int kernelSizes[][2] = { {512, 64}, {4096, 4096} };
+	for (int s = 0; s < 2; s++)
+		for (int bytesPerPixel = 3; bytesPerPixel <= 4; bytesPerPixel++)
+			identical = timeKernels(kernels, numKernels, kernelSizes[s][0], kernelSizes[s][1], bytesPerPixel) && identical;
+
+	bool exact = true;
+	for (int k = 1; k < numKernels; k++) exact = checkKernel(kernels[k]) && exact;
+	cout << endl << (exact ? "The SIMD kernels match the scalar routine at every width from 1 to 69."
+	                       : "The SIMD kernels DIFFER from the scalar routine.") << endl;
+	return identical && exact ? 0 : 1;
+}
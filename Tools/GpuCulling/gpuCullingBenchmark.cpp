@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// gpuCullingBenchmark.cpp
+//
+// This program compares the two ways spaceTravelFrustumCulled.cpp culls its asteroids
+// before drawing them instanced: on the CPU, the nodes of the quadtree meeting the
+// frustum found by quadtree.h and their asteroids written into the instance buffer of
+// instancedAsteroids.h, and on the GPU, every asteroid tested by the compute shader of
+// gpuCulling.h and those visible drawn by an indirect draw.
+//
+// First it checks the GPU's culling against cullSphere() of frustumCulling.h, for random
+// frusta both like the spacecraft's, quadrilaterals in the xz-plane, and given by random
+// modelview matrices with the program's projection: the instances the shader writes must
+// be the asteroids, and as many, that cullSphere() does not find outside, but for those
+// on the boundary, within rounding of a plane. Then, for fields of asteroids laid out as
+// in the program, viewed from the spacecraft at its starting position and along random
+// headings, it reports for both ways the asteroids drawn (for the GPU the counter of its
+// draw command), the time of the culling alone, the CPU time of a frame up to the last GL
+// call, the time to its completion after glFinish(), and the number of pixels differing
+// between the drawings of the two ways.
+//
+// Usage:
+// gpuCullingBenchmark [asteroids per side] ...
+// The sides default to 100 and 1000, i.e., 10k and 1M asteroids. The shader files must
+// be in the working directory. The program needs OpenGL 4.3 for compute shaders.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "quadtree.h"
+#include "shader.h"
+#include "instancedAsteroids.h"
+#include "gpuCulling.h"
+
+using namespace std;
+
+#define PI 3.14159265
+#define WINDOW_SIZE 400 // Width and height of the window, as the program's viewports.
+#define SPHERE_SLICES 18 // Slices and stacks of an asteroid, as Asteroid::draw() for radius 3.
+#define NUM_CHECKS 50 // Random frusta of each kind checked.
+#define NUM_VIEWS 10 // Views timed: the starting one and random headings.
+#define BOUNDARY_TOLERANCE 1.0e-3 // Distance from a plane within which either result is right.
+
+// Times of a frame and the asteroids drawn.
+struct FrameCost
+{
+   double cullTime, cpuTime, frameTime;
+   long long numDrawn;
+};
+
+float randomFloat(float low, float high) { return low + (high - low) * rand() / RAND_MAX; }
+
+double milliseconds(chrono::steady_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Field of side x side asteroids of radius 3, 30 apart, with random colors, as in
+// spaceTravelFrustumCulled.cpp.
+void makeField(int side, AsteroidArray &field)
+{
+   field = AsteroidArray();
+   field.reserve(side * side);
+   for (int j = 0; j < side; j++)
+      for (int i = 0; i < side; i++)
+      {
+         unsigned char color[3] = { (unsigned char)(rand() % 256), (unsigned char)(rand() % 256),
+                                    (unsigned char)(rand() % 256) };
+         field.add(15.0 + 30.0 * (-side / 2 + j), 0.0, -40.0 - 30.0 * i, 3.0, color);
+      }
+}
+
+// View from the spacecraft at (x, 0, z) turned by angle a: the corners of its
+// quadrilateral frustum, as in the program's drawScene(), and the modelview matrix.
+struct View
+{
+   float corners[8];
+   float x, z, a;
+
+   View(float x, float z, float a) : x(x), z(z), a(a)
+   {
+      float s = (PI/180.0) * (45.0 + a), t = (PI/180.0) * (45.0 - a);
+      corners[0] = x - 7.072 * sin(s); corners[1] = z - 7.072 * cos(s);
+      corners[2] = x - 353.6 * sin(s); corners[3] = z - 353.6 * cos(s);
+      corners[4] = x + 353.6 * sin(t); corners[5] = z - 353.6 * cos(t);
+      corners[6] = x + 7.072 * sin(t); corners[7] = z - 7.072 * cos(t);
+   }
+
+   void setQuadrilateral(FrustumPlanes &frustum) const
+   {
+      setQuadrilateralFrustum(frustum, corners[0], corners[1], corners[2], corners[3],
+                              corners[4], corners[5], corners[6], corners[7]);
+   }
+
+   // Load the camera at the tip of the spacecraft, as gluLookAt() in drawScene().
+   void loadModelView() const
+   {
+      glLoadIdentity();
+      gluLookAt(x - 10 * sin((PI/180.0) * a), 0.0, z - 10 * cos((PI/180.0) * a),
+                x - 11 * sin((PI/180.0) * a), 0.0, z - 11 * cos((PI/180.0) * a), 0.0, 1.0, 0.0);
+   }
+};
+
+// Random view from within the field.
+View randomView(const AsteroidArray &asteroids)
+{
+   int k = rand() % asteroids.size();
+   return View(asteroids.centerX[k] + 15.0, asteroids.centerZ[k] + 15.0, randomFloat(0.0, 360.0));
+}
+
+// Frustum of the current projection and modelview matrices, tilted by pitch degrees
+// about the x-axis so that the field cuts the frustum's top or bottom.
+void setTiltedFrustum(FrustumPlanes &frustum, float pitch)
+{
+   float modelViewMat[16], projMat[16], clipMat[16];
+   glPushMatrix();
+   glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMat);
+   glLoadIdentity();
+   glRotatef(pitch, 1.0, 0.0, 0.0);
+   glMultMatrixf(modelViewMat);
+   glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMat);
+   glPopMatrix();
+   glGetFloatv(GL_PROJECTION_MATRIX, projMat);
+   for (int c = 0; c < 4; c++)
+      for (int r = 0; r < 4; r++)
+      {
+         clipMat[4*c + r] = 0.0;
+         for (int k = 0; k < 4; k++) clipMat[4*c + r] += projMat[4*k + r] * modelViewMat[4*c + k];
+      }
+   setMatrixFrustum(frustum, clipMat);
+}
+
+// Whether a sphere is within rounding of a plane of the frustum.
+bool isOnBoundary(const FrustumPlanes &frustum, float x, float y, float z, float r)
+{
+   for (int p = 0; p < frustum.numPlanes; p++)
+      if (fabs(frustum.a[p] * x + frustum.b[p] * y + frustum.c[p] * z + frustum.d[p] + r) < BOUNDARY_TOLERANCE)
+         return true;
+   return false;
+}
+
+// Number of asteroids culled wrongly by the GPU for the frustum: instances written that
+// cullSphere() finds outside, and the difference of their number from the asteroids it
+// does not, less those on the boundary.
+int countWrong(GpuCulling &gpuCulling, const AsteroidArray &asteroids, const FrustumPlanes &frustum)
+{
+   gpuCulling.cull(frustum);
+   int numVisible = gpuCulling.getNumVisible(), wrong = 0, expected = 0, boundary = 0;
+   for (int k = 0; k < asteroids.size(); k++)
+   {
+      float x = asteroids.centerX[k], y = asteroids.centerY[k], z = asteroids.centerZ[k], r = asteroids.radius[k];
+      if (isOnBoundary(frustum, x, y, z, r)) boundary++;
+      else expected += (cullSphere(frustum, x, y, z, r) != CULL_OUTSIDE);
+   }
+
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, gpuCulling.getInstanceBuffer());
+   const AsteroidInstance *instances = (const AsteroidInstance *)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+      (numVisible > 0 ? numVisible : 1) * sizeof(AsteroidInstance), GL_MAP_READ_BIT);
+   for (int k = 0; k < numVisible; k++)
+   {
+      const float *c = instances[k].centerRadius;
+      wrong += ( !isOnBoundary(frustum, c[0], c[1], c[2], c[3]) &&
+                 cullSphere(frustum, c[0], c[1], c[2], c[3]) == CULL_OUTSIDE );
+   }
+   glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+   if (numVisible < expected) wrong += expected - numVisible;
+   if (numVisible > expected + boundary) wrong += numVisible - expected - boundary;
+   return wrong;
+}
+
+// Cull and draw one frame of the view, on the CPU or GPU, reading it back into image.
+FrameCost drawFrame(const Quadtree &quadtree, InstancedAsteroids &instanced, GpuCulling &gpuCulling,
+                    const View &view, bool isGpuCulled, vector<unsigned char> &image)
+{
+   const AsteroidArray &asteroids = quadtree.getAsteroids();
+   static vector<AsteroidRange> ranges;
+   FrameCost cost = { 0.0, 0.0, 0.0, 0 };
+   float modelViewMat[16], projMat[16];
+
+   glFinish();
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+   view.loadModelView();
+   glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMat);
+   glGetFloatv(GL_PROJECTION_MATRIX, projMat);
+   if (isGpuCulled)
+   {
+      FrustumPlanes frustum;
+      view.setQuadrilateral(frustum);
+      gpuCulling.cull(frustum);
+      glFinish();
+      cost.cullTime = milliseconds(start);
+      instanced.drawIndirect(gpuCulling.getInstanceBuffer(), gpuCulling.getCommandBuffer(), modelViewMat, projMat);
+   }
+   else
+   {
+      quadtree.cull(view.corners[0], view.corners[1], view.corners[2], view.corners[3],
+                    view.corners[4], view.corners[5], view.corners[6], view.corners[7], ranges);
+      AsteroidInstance *instances = instanced.beginInstances();
+      int n = 0;
+      for (int r = 0; r < (int)ranges.size(); r++)
+         for (int k = ranges[r].first; k < ranges[r].first + ranges[r].count; k++, n++)
+            setAsteroidInstance(instances[n], asteroids.centerX[k], asteroids.centerY[k], asteroids.centerZ[k],
+                                asteroids.radius[k], &asteroids.colors[3*k]);
+      cost.cullTime = milliseconds(start);
+      cost.numDrawn = n;
+      instanced.draw(n, modelViewMat, projMat);
+   }
+   cost.cpuTime = milliseconds(start);
+   glFinish();
+   cost.frameTime = milliseconds(start);
+   if (isGpuCulled) cost.numDrawn = gpuCulling.getNumVisible();
+
+   image.resize(WINDOW_SIZE * WINDOW_SIZE * 4);
+   glReadPixels(0, 0, WINDOW_SIZE, WINDOW_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, &image[0]);
+   return cost;
+}
+
+// Number of pixels differing between two images.
+int countDiffering(const vector<unsigned char> &image, const vector<unsigned char> &otherImage)
+{
+   int differing = 0;
+   for (int k = 0; k < WINDOW_SIZE * WINDOW_SIZE; k++)
+   {
+      bool isDifferent = false;
+      for (int c = 0; c < 3; c++) isDifferent |= (abs(image[4 * k + c] - otherImage[4 * k + c]) > 2);
+      differing += isDifferent;
+   }
+   return differing;
+}
+
+// Compare the two ways of culling a field of side x side asteroids.
+void compareWays(int side, unsigned int programId, unsigned int computeProgramId)
+{
+   AsteroidArray field;
+   Quadtree quadtree;
+   InstancedAsteroids instanced;
+   GpuCulling gpuCulling;
+   makeField(side, field);
+   float size = (side - 1) * 30.0 + 6.0;
+   quadtree.initialize(field, -size / 2.0, -37.0, size);
+   const AsteroidArray &asteroids = quadtree.getAsteroids();
+   instanced.initialize(asteroids.size(), SPHERE_SLICES, SPHERE_SLICES, programId);
+   gpuCulling.initialize(asteroids, instanced.getNumIndices(), computeProgramId);
+
+   printf("\n%d asteroids\n", side * side);
+
+   // Check the GPU's culling.
+   int wrongQuadrilateral = 0, wrongMatrix = 0;
+   for (int c = 0; c < NUM_CHECKS; c++)
+   {
+      FrustumPlanes frustum;
+      View view = randomView(asteroids);
+      view.setQuadrilateral(frustum);
+      wrongQuadrilateral += countWrong(gpuCulling, asteroids, frustum);
+      view.loadModelView();
+      setTiltedFrustum(frustum, randomFloat(-30.0, 30.0));
+      wrongMatrix += countWrong(gpuCulling, asteroids, frustum);
+   }
+   printf("asteroids culled wrongly by the GPU in %d frusta: %d quadrilateral, %d matrix\n", NUM_CHECKS,
+          wrongQuadrilateral, wrongMatrix);
+
+   // Warm up both ways, e.g., for the driver to compile its variants of the shaders.
+   vector<unsigned char> image, gpuImage;
+   View start(0.0, 0.0, 0.0);
+   drawFrame(quadtree, instanced, gpuCulling, start, false, image);
+   drawFrame(quadtree, instanced, gpuCulling, start, true, gpuImage);
+
+   printf("%-6s %-8s %10s %10s %10s %10s %8s\n", "view", "culling", "drawn", "cull ms", "CPU ms", "frame ms",
+          "pixels");
+   FrameCost total = { 0.0, 0.0, 0.0, 0 }, gpuTotal = { 0.0, 0.0, 0.0, 0 };
+   int differing = 0;
+   for (int v = 0; v < NUM_VIEWS; v++)
+   {
+      View view = v ? randomView(asteroids) : start;
+      FrameCost cost = drawFrame(quadtree, instanced, gpuCulling, view, false, image);
+      FrameCost gpuCost = drawFrame(quadtree, instanced, gpuCulling, view, true, gpuImage);
+      int viewDiffering = countDiffering(image, gpuImage);
+      if (v == 0)
+      {
+         printf("%-6s %-8s %10lld %10.2f %10.2f %10.2f\n", "start", "CPU", cost.numDrawn, cost.cullTime,
+                cost.cpuTime, cost.frameTime);
+         printf("%-6s %-8s %10lld %10.2f %10.2f %10.2f %8d\n", "", "GPU", gpuCost.numDrawn, gpuCost.cullTime,
+                gpuCost.cpuTime, gpuCost.frameTime, viewDiffering);
+      }
+      total.numDrawn += cost.numDrawn; total.cullTime += cost.cullTime;
+      total.cpuTime += cost.cpuTime; total.frameTime += cost.frameTime;
+      gpuTotal.numDrawn += gpuCost.numDrawn; gpuTotal.cullTime += gpuCost.cullTime;
+      gpuTotal.cpuTime += gpuCost.cpuTime; gpuTotal.frameTime += gpuCost.frameTime;
+      differing += viewDiffering;
+   }
+   printf("%-6s %-8s %10.0f %10.2f %10.2f %10.2f\n", "mean", "CPU", (double)total.numDrawn / NUM_VIEWS,
+          total.cullTime / NUM_VIEWS, total.cpuTime / NUM_VIEWS, total.frameTime / NUM_VIEWS);
+   printf("%-6s %-8s %10.0f %10.2f %10.2f %10.2f %8d\n", "", "GPU", (double)gpuTotal.numDrawn / NUM_VIEWS,
+          gpuTotal.cullTime / NUM_VIEWS, gpuTotal.cpuTime / NUM_VIEWS, gpuTotal.frameTime / NUM_VIEWS, differing);
+}
+
+// Set up the GL state as the program's right viewport and run the comparisons.
+void runBenchmark(int numSides, int *sides)
+{
+   unsigned int programId = setProgram("vertex", "vertexShader.glsl", "fragment", "fragmentShader.glsl", NULL);
+   unsigned int computeProgramId = setProgram("compute", "computeShader.glsl", NULL);
+
+   glViewport(0, 0, WINDOW_SIZE, WINDOW_SIZE);
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 250.0);
+   glMatrixMode(GL_MODELVIEW);
+   glEnable(GL_DEPTH_TEST);
+   glClearColor(0.0, 0.0, 0.0, 0.0);
+
+   for (int k = 0; k < numSides; k++) compareWays(sides[k], programId, computeProgramId);
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+   glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
+   glutCreateWindow("gpuCullingBenchmark.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   int defaultSides[2] = { 100, 1000 };
+   vector<int> sides;
+   for (int k = 1; k < argc; k++) sides.push_back(atoi(argv[k]));
+   if (sides.empty()) sides.assign(defaultSides, defaultSides + 2);
+   runBenchmark((int)sides.size(), &sides[0]);
+   return 0;
+}
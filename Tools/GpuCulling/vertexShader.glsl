@@ -0,0 +1,17 @@
+#version 430 core
+
+layout(location=0) in vec4 sphereCoords; // Vertex of the unit sphere.
+layout(location=1) in vec4 asteroidCenterRadius; // Center and radius of the instance.
+layout(location=2) in vec4 asteroidColor; // Color of the instance.
+
+uniform mat4 modelViewMat;
+uniform mat4 projMat;
+
+out vec4 colorsExport;
+
+void main(void)
+{   
+   gl_Position = projMat * modelViewMat * vec4(asteroidCenterRadius.xyz + asteroidCenterRadius.w * sphereCoords.xyz, 1.0);
+   
+   colorsExport = asteroidColor;
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// meshLayouts.cpp
+//
+// This program compares the three index layouts of meshBuilder.h on tori of
+// increasing tessellation: one triangle strip per latitude drawn with
+// glMultiDrawElements(), the strips as one stream with primitive restart drawn with
+// glDrawElements(), and a triangle list reordered for the vertex cache, or left in
+// grid order above MESH_REORDER_VERTICES vertices. For each it reports the average
+// cache miss ratio (ACMR, post-transform cache misses per triangle) of FIFO caches of
+// 16 and 32 entries, the CPU time to submit the draw and the time to draw it to
+// completion.
+//
+// Usage:
+// meshLayouts [maximum number of slices]
+// The number of slices defaults to 1024.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib") 
+#endif
+
+#include "meshBuilder.h"
+
+using namespace std;
+
+#define PI 3.14159265
+#define NUM_DRAWS 20 // Draws timed per layout and size.
+
+struct Vertex
+{
+   float coords[4];
+};
+
+// Sampler of a torus of outer radius 0.6 and inner radius 0.3.
+struct TorusSampler
+{
+   AngleTable longAngles, latAngles;
+
+   TorusSampler(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      float r = 0.6f + 0.3f * latAngles.cosines[j];
+      vertex.coords[0] = r * longAngles.cosines[i];
+      vertex.coords[1] = r * longAngles.sines[i];
+      vertex.coords[2] = 0.3f * latAngles.sines[j];
+      vertex.coords[3] = 1.0f;
+   }
+};
+
+static const char *vertexShader =
+   "#version 430 core\n"
+   "layout(location=0) in vec4 coords;\n"
+   "void main(void) { gl_Position = vec4(coords.xy, coords.z * 0.5, 1.0); }\n";
+static const char *fragmentShader =
+   "#version 430 core\n"
+   "out vec4 colorsOut;\n"
+   "void main(void) { colorsOut = vec4(0.0, 1.0, 0.0, 1.0); }\n";
+
+// Average cache miss ratio of the vertices referenced by an index stream, for a FIFO
+// cache of the given size: misses per triangle drawn. Strips are read as strips, with
+// restarts, and lists as lists.
+double averageCacheMissRatio(const GridMesh<Vertex> &mesh, int cacheSize)
+{
+   deque<unsigned int> cache;
+   long misses = 0, triangles = 0, stripLength = 0;
+   for (int k = 0; k < (int)mesh.indices.size(); k++)
+   {
+      unsigned int index = mesh.indices[k];
+      if (index == MESH_RESTART_INDEX)
+      {
+         stripLength = 0;
+         continue;
+      }
+      if (mesh.layout == MESH_TRIANGLES) triangles += (k % 3 == 2);
+      else
+      {
+         // Each strip of MESH_STRIPS is a draw of its own.
+         if (mesh.layout == MESH_STRIPS && k % gridStripLength(mesh.longs) == 0) stripLength = 0;
+         if (++stripLength >= 3) triangles++;
+      }
+
+      bool hit = false;
+      for (int i = 0; i < (int)cache.size() && !hit; i++) hit = (cache[i] == index);
+      if (!hit)
+      {
+         misses++;
+         cache.push_back(index);
+         if ((int)cache.size() > cacheSize) cache.pop_front();
+      }
+   }
+   return (double)misses / triangles;
+}
+
+// Issue the draw of a mesh in its layout.
+void drawMesh(const GridMesh<Vertex> &mesh)
+{
+   if (mesh.layout == MESH_STRIPS)
+      glMultiDrawElements(GL_TRIANGLE_STRIP, &mesh.counts[0], GL_UNSIGNED_INT, (const void **)&mesh.offsets[0], mesh.lats);
+   else
+      glDrawElements(mesh.layout == MESH_RESTART ? GL_TRIANGLE_STRIP : GL_TRIANGLES, (int)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+}
+
+// Build, load and time a torus of each layout for each tessellation.
+void runBenchmark(int maxSlices)
+{
+   int programId = glCreateProgram();
+   const char *sources[2] = { vertexShader, fragmentShader };
+   GLenum stages[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+   for (int i = 0; i < 2; i++)
+   {
+      int shaderId = glCreateShader(stages[i]);
+      glShaderSource(shaderId, 1, &sources[i], NULL);
+      glCompileShader(shaderId);
+      glAttachShader(programId, shaderId);
+   }
+   glLinkProgram(programId);
+   glUseProgram(programId);
+
+   unsigned int vao, buffer[2];
+   glGenVertexArrays(1, &vao);
+   glGenBuffers(2, buffer);
+   glBindVertexArray(vao);
+   glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+   glEnable(GL_DEPTH_TEST);
+
+   static const char *layoutNames[3] = { "strips", "restart", "triangles" };
+   printf("%9s %-9s %8s %8s %10s %12s %12s %12s\n", "slices", "layout", "ACMR-16", "ACMR-32", "indices",
+          "build ms", "submit us", "draw ms");
+   for (int slices = 16; slices <= maxSlices; slices *= 4)
+      for (int layout = MESH_STRIPS; layout <= MESH_TRIANGLES; layout++)
+      {
+         GridMesh<Vertex> mesh;
+         chrono::steady_clock::time_point start = chrono::steady_clock::now();
+         buildGridMesh(mesh, slices, slices, TorusSampler(slices, slices), layout);
+         double buildTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+         glBindBuffer(GL_ARRAY_BUFFER, buffer[0]);
+         glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Vertex), &mesh.vertices[0], GL_STATIC_DRAW);
+         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer[1]);
+         glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), &mesh.indices[0], GL_STATIC_DRAW);
+         glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
+         glEnableVertexAttribArray(0);
+
+         // Warm up, then time the submission alone and the draws to completion.
+         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+         drawMesh(mesh);
+         glFinish();
+         double submitTime = 0.0;
+         start = chrono::steady_clock::now();
+         for (int k = 0; k < NUM_DRAWS; k++)
+         {
+            chrono::steady_clock::time_point submitStart = chrono::steady_clock::now();
+            drawMesh(mesh);
+            submitTime += chrono::duration<double, micro>(chrono::steady_clock::now() - submitStart).count();
+         }
+         glFinish();
+         double drawTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+         printf("%4dx%-4d %-9s %8.3f %8.3f %10d %12.2f %12.1f %12.2f\n", slices, slices, layoutNames[layout],
+                averageCacheMissRatio(mesh, 16), averageCacheMissRatio(mesh, 32), (int)mesh.indices.size(),
+                buildTime, submitTime / NUM_DRAWS, drawTime / NUM_DRAWS);
+      }
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_CORE_PROFILE);
+   glutInitContextFlags(GLUT_FORWARD_COMPATIBLE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+   glutInitWindowSize(500, 500);
+   glutCreateWindow("meshLayouts.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   runBenchmark(argc > 1 ? atoi(argv[1]) : 1024);
+   return 0;
+}
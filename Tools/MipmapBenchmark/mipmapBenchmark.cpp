@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// mipmapBenchmark.cpp
+//
+// This program times the building of a full mipmap chain on the CPU (see mipmap.h)
+// from square RGBA images of increasing size with each filter, the 2x2 box and the
+// 8-tap Kaiser and Lanczos sincs, averaging in sRGB values and as linear intensities,
+// and reports the throughput in millions of base-level texels per second. It checks
+// that every filter leaves a constant image constant at every level, and that on an
+// image of odd size, a constant plus a gradient, no filter averaging in sRGB values
+// drops the last row and column or shifts the image, which would change its mean.
+//
+// Usage:
+// mipmapBenchmark [maximum size]
+// The size defaults to 4096.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "mipmap.h"
+
+using namespace std;
+
+// Build the whole chain of levels below an image of size sizeX x sizeY, alternating
+// between two buffers large enough for its first level.
+void buildMipmapChain(const unsigned char *image, int sizeX, int sizeY, unsigned char *levels[2],
+                      int filter, bool sRGB)
+{
+   const unsigned char *level = image;
+   for (int i = 0; sizeX > 1 || sizeY > 1; i++)
+   {
+      buildMipmapLevel(level, sizeX, sizeY, levels[i % 2], filter, sRGB);
+      level = levels[i % 2];
+      nextMipmapSize(sizeX, sizeY, &sizeX, &sizeY);
+   }
+}
+
+// Whether a filter keeps a constant image of the given size constant down to 1x1.
+bool keepsConstant(int size, int filter, bool sRGB)
+{
+   const unsigned char texel[4] = { 200, 120, 40, 255 };
+   vector<unsigned char> image(4 * size * size), level(image.size());
+   for (int k = 0; k < (int)image.size(); k++) image[k] = texel[k % 4];
+
+   int sizeX = size, sizeY = size;
+   while (sizeX > 1 || sizeY > 1)
+   {
+      buildMipmapLevel(&image[0], sizeX, sizeY, &level[0], filter, sRGB);
+      nextMipmapSize(sizeX, sizeY, &sizeX, &sizeY);
+      for (int k = 0; k < 4 * sizeX * sizeY; k++)
+         if (level[k] != texel[k % 4]) return false;
+      image.swap(level);
+   }
+   return true;
+}
+
+// Largest difference, over the levels down to 1x1 and the red and green channels, of
+// the mean of a level from that of an image of the given size whose red and green
+// channels are gradients along x and y, its blue channel a constant, which must be
+// kept exactly, filtered without sRGB averaging, for which means are not kept.
+double gradientMeanError(int sizeX, int sizeY, int filter)
+{
+   vector<unsigned char> image(4 * sizeX * sizeY), level;
+   double mean[2] = { 0.0, 0.0 };
+   for (int y = 0; y < sizeY; y++)
+      for (int x = 0; x < sizeX; x++)
+      {
+         unsigned char *texel = &image[4 * (sizeX * y + x)];
+         texel[0] = (unsigned char)(40 + 160 * x / (sizeX - 1));
+         texel[1] = (unsigned char)(40 + 160 * y / (sizeY - 1));
+         texel[2] = 120;
+         texel[3] = 255;
+         mean[0] += texel[0];
+         mean[1] += texel[1];
+      }
+   mean[0] /= sizeX * sizeY;
+   mean[1] /= sizeX * sizeY;
+
+   double error = 0.0;
+   while (sizeX > 1 || sizeY > 1)
+   {
+      int nextSizeX, nextSizeY;
+      nextMipmapSize(sizeX, sizeY, &nextSizeX, &nextSizeY);
+      level.resize(4 * nextSizeX * nextSizeY);
+      buildMipmapLevel(&image[0], sizeX, sizeY, &level[0], filter, false);
+      sizeX = nextSizeX;
+      sizeY = nextSizeY;
+
+      double levelMean[2] = { 0.0, 0.0 };
+      for (int k = 0; k < sizeX * sizeY; k++)
+      {
+         levelMean[0] += level[4 * k];
+         levelMean[1] += level[4 * k + 1];
+         if (level[4 * k + 2] != 120) return 255.0;
+      }
+      for (int c = 0; c < 2; c++) error = max(error, fabs(levelMean[c] / (sizeX * sizeY) - mean[c]));
+      image.swap(level);
+   }
+   return error;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   int maxSize = (argc > 1) ? atoi(argv[1]) : 4096;
+
+   const char *names[6] = { "box", "box sRGB", "Kaiser", "Kaiser sRGB", "Lanczos", "Lanczos sRGB" };
+   int filters[6] = { MIP_BOX, MIP_BOX, MIP_KAISER, MIP_KAISER, MIP_LANCZOS, MIP_LANCZOS };
+
+   printf("%u hardware threads, %d threads per level from 64 rows.\n\n", thread::hardware_concurrency(), MIP_THREADS);
+   printf("Full chain, Mtexel/s of the base level\n%12s", "size");
+   for (int f = 0; f < 6; f++) printf(" %13s", names[f]);
+   printf("\n");
+
+   for (int size = 128; size <= maxSize; size *= 2)
+   {
+      // A pseudo-random image, so that no filter sees uniform data.
+      vector<unsigned char> image(4 * size * size), levels[2];
+      unsigned int seed = size;
+      for (int k = 0; k < (int)image.size(); k++) image[k] = (unsigned char)((seed = seed * 1664525 + 1013904223) >> 24);
+      levels[0].resize(image.size() / 4);
+      levels[1].resize(image.size() / 4);
+      unsigned char *levelData[2] = { &levels[0][0], &levels[1][0] };
+
+      printf("%5d x %-5d", size, size);
+      int repeats = max(3, 16 * 1024 * 1024 / (size * size));
+      for (int f = 0; f < 6; f++)
+      {
+         double best = 1e30;
+         for (int r = 0; r < repeats; r++)
+         {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            buildMipmapChain(&image[0], size, size, levelData, filters[f], f % 2 == 1);
+            best = min(best, chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+         }
+         printf(" %13.1f", (double)size * size / best);
+      }
+      printf("\n");
+   }
+
+   bool constant = true;
+   for (int f = 0; f < 6; f++) constant = keepsConstant(300, filters[f], f % 2 == 1) && constant;
+   printf("\n%s\n", constant ? "Every filter keeps a constant 300x300 image constant at every level."
+                             : "Some filter CHANGES a constant image.");
+
+   // Rounding to 8 bits at each level moves the mean by up to about a unit.
+   bool keepsMean = true;
+   int oddSizes[][2] = { {5, 5}, {7, 3}, {301, 201} };
+   printf("\nLargest change of the mean of an odd-sized gradient over its levels, of 255\n%12s", "size");
+   for (int f = 0; f < 6; f += 2) printf(" %13s", names[f]);
+   printf("\n");
+   for (int s = 0; s < 3; s++)
+   {
+      printf("%5d x %-5d", oddSizes[s][0], oddSizes[s][1]);
+      for (int f = 0; f < 6; f += 2)
+      {
+         double error = gradientMeanError(oddSizes[s][0], oddSizes[s][1], filters[f]);
+         keepsMean = keepsMean && error <= 2.0;
+         printf(" %13.2f", error);
+      }
+      printf("\n");
+   }
+   printf("\n%s\n", keepsMean ? "Every filter keeps the mean of odd-sized images."
+                             : "Some filter SHIFTS or CROPS odd-sized images.");
+   return constant && keepsMean ? 0 : 1;
+}
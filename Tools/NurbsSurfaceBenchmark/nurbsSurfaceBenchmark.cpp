@@ -0,0 +1,364 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// nurbsSurfaceBenchmark.cpp
+//
+// This program compares the tessellation of B-spline surfaces by nurbsSurface.h to
+// gluNurbsSurface(), which bicubicSplineSurface.cpp and
+// bicubicSplineSurfaceLitTextured.cpp drew their surfaces by, while a control point
+// is dragged.
+//
+// It first checks the vertices against the surface evaluated one point at a time by
+// evaluateBasis() of bSplineBasis.h, on random knot vectors with knots of every
+// multiplicity below the order, polynomial and rational, of orders 2 to 5; and checks
+// that a grid updated after random edits of single control points, only where they
+// moved it, is the same to the last bit as the grid evaluated whole.
+//
+// It then times frames of a control point being dragged, the surface lit and drawn
+// filled in the programs' view, on the programs' 15 x 10 grid of control points and on
+// a 200 x 200 grid with the same knot spacing, a frame being the move, the surface
+// retessellated and drawn, and the drawing finished:
+// - GLU sampling as the programs, to a path length of 100 pixels;
+// - GLU sampling as nurbsSurface.h, NURBS_SAMPLES_PER_SPAN steps a knot span
+//   (GLU_DOMAIN_DISTANCE);
+// - nurbsSurface.h retessellating the whole grid every frame;
+// - nurbsSurface.h retessellating the part the control point moves.
+// For nurbsSurface.h it times too the update alone, evaluation and copy into the vertex
+// buffer, and the evaluation alone, of the whole grid and of the part moved.
+//
+// Usage:
+// nurbsSurfaceBenchmark [large grid size]
+// The size defaults to 200.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "nurbsSurface.h"
+
+#define WINDOW_SIZE 600 // Width and height of the window.
+#define NUM_CHECKED_SURFACES 100 // Random surfaces checked at each order.
+#define NUM_CHECKED_EDITS 50 // Random edits of each, each updated and checked.
+#define MIN_FRAMES 5 // Fewest frames timed of each method...
+#define MIN_TIME 1000.0 // ...and fewest milliseconds.
+
+using namespace std;
+
+double milliseconds(chrono::steady_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+float randomFloat(float low, float high)
+{
+   return low + (high - low) * rand() / RAND_MAX;
+}
+
+// Random knot vector of numKnots knots, steps of 0 to 3, no knot of multiplicity above
+// order - 1 so that the surface is continuous.
+void randomKnots(vector<float> &knots, int numKnots, int order)
+{
+   knots.resize(numKnots);
+   knots[0] = (float)(rand() % 5);
+   int multiplicity = 1;
+   for (int i = 1; i < numKnots; i++)
+   {
+      bool repeat = (rand() % 3 == 0) && (multiplicity < order - 1);
+      knots[i] = knots[i-1] + (repeat ? 0.0f : (float)(1 + rand() % 3));
+      multiplicity = repeat ? multiplicity + 1 : 1;
+   }
+}
+
+// Point of the surface at (u, v), one B-spline at a time.
+void evaluateSurfacePoint(const NurbsSurface &surface, float u, float v, float *point)
+{
+   float uBasis[BSPLINE_MAX_ORDER], vBasis[BSPLINE_MAX_ORDER], homogeneous[4] = { 0.0f };
+   int numUknots = (int)surface.uKnots.size(), numVknots = (int)surface.vKnots.size();
+   int uFirst = evaluateBasis(&surface.uKnots[0], numUknots, surface.uOrder, u, uBasis);
+   int vFirst = evaluateBasis(&surface.vKnots[0], numVknots, surface.vOrder, v, vBasis);
+   for (int i = 0; i < surface.uOrder; i++)
+      for (int j = 0; j < surface.vOrder; j++)
+      {
+         int a = uFirst + i, b = vFirst + j;
+         if ( (a < 0) || (b < 0) || (a >= numUknots - surface.uOrder) || (b >= numVknots - surface.vOrder) ) continue;
+         const float *controlPoint = surface.controlPoints + a * surface.uStride + b * surface.vStride;
+         for (int c = 0; c < surface.dimension; c++) homogeneous[c] += uBasis[i] * vBasis[j] * controlPoint[c];
+      }
+   for (int c = 0; c < 3; c++) point[c] = (surface.dimension == 4) ? homogeneous[c] / homogeneous[3] : homogeneous[c];
+}
+
+// Check the vertices against evaluateSurfacePoint(), and updates after edits against
+// whole evaluations.
+void checkSurfaces()
+{
+   printf("Agreement with the surface evaluated point by point, and of updates after edits with the whole grid\n");
+   printf("%6s %9s %10s %12s %12s %10s %10s\n", "order", "rational", "vertices", "largest", "normal", "edits",
+          "differing");
+   srand(1);
+   for (int order = 2; order <= 5; order++)
+      for (int dimension = 3; dimension <= 4; dimension++)
+      {
+         long numVertices = 0, numEdits = 0, numDiffering = 0;
+         double largest = 0.0, normalLength = 0.0;
+         for (int s = 0; s < NUM_CHECKED_SURFACES; s++)
+         {
+            int uOrder = order, vOrder = 2 + rand() % 4;
+            int numUpoints = uOrder + rand() % 12, numVpoints = vOrder + rand() % 12;
+            vector<float> uKnots, vKnots, controlPoints(dimension * numUpoints * numVpoints);
+            randomKnots(uKnots, numUpoints + uOrder, uOrder);
+            randomKnots(vKnots, numVpoints + vOrder, vOrder);
+            for (int k = 0; k < numUpoints * numVpoints; k++)
+            {
+               float w = (dimension == 4) ? randomFloat(0.5, 2.0) : 1.0f;
+               for (int c = 0; c < 3; c++) controlPoints[dimension * k + c] = randomFloat(-10.0, 10.0) * w;
+               if (dimension == 4) controlPoints[dimension * k + 3] = w;
+            }
+
+            NurbsSurface surface;
+            makeNurbsSurface(surface, (int)uKnots.size(), &uKnots[0], (int)vKnots.size(), &vKnots[0],
+                             dimension * numVpoints, dimension, &controlPoints[0], uOrder, vOrder, dimension,
+                             1 + rand() % 6);
+            evaluateNurbsSurface(surface);
+            int numColumns = (int)surface.uParameters.size();
+            for (int q = 0; q < (int)surface.vParameters.size(); q++)
+               for (int p = 0; p < numColumns; p++)
+               {
+                  float point[3];
+                  const NurbsVertex &vertex = surface.vertices[q * numColumns + p];
+                  evaluateSurfacePoint(surface, surface.uParameters[p], surface.vParameters[q], point);
+                  for (int c = 0; c < 3; c++) largest = max(largest, (double)fabs(point[c] - vertex.coords[c]));
+                  float length = sqrt(vertex.normal[0] * vertex.normal[0] + vertex.normal[1] * vertex.normal[1] +
+                                      vertex.normal[2] * vertex.normal[2]);
+                  normalLength = max(normalLength, (double)fabs(length - 1.0f));
+                  numVertices++;
+               }
+
+            // Edits of single control points, each updated where it moved the grid,
+            // against the whole grid.
+            surface.firstColumn = surface.lastColumn = 0;
+            for (int e = 0; e < NUM_CHECKED_EDITS; e++)
+            {
+               int i = rand() % numUpoints, j = rand() % numVpoints;
+               float *controlPoint = &controlPoints[dimension * (i * numVpoints + j)];
+               for (int c = 0; c < dimension; c++) controlPoint[c] *= randomFloat(0.8, 1.25);
+               editNurbsControlPoint(surface, i, j);
+               evaluateNurbsSurface(surface);
+               surface.firstColumn = surface.lastColumn = 0;
+               numEdits++;
+            }
+            vector<NurbsVertex> updated = surface.vertices;
+            editNurbsSurface(surface);
+            evaluateNurbsSurface(surface);
+            for (int k = 0; k < (int)updated.size(); k++)
+               if (memcmp(&updated[k], &surface.vertices[k], sizeof(NurbsVertex)) != 0) numDiffering++;
+         }
+         printf("%6d %9s %10ld %12g %12g %10ld %10ld\n", order, (dimension == 4) ? "yes" : "no", numVertices, largest,
+                normalLength, numEdits, numDiffering);
+      }
+   printf("(Largest distance of a vertex from its point, largest departure of a normal from unit length.)\n");
+}
+
+// A grid of numUpoints x numVpoints control points as the programs', 0.5 apart, on
+// clamped cubic knots 1 apart.
+struct TestSurface
+{
+   int numUpoints, numVpoints;
+   vector<float> uKnots, vKnots, controlPoints;
+};
+
+void makeTestSurface(TestSurface &test, int numUpoints, int numVpoints)
+{
+   test.numUpoints = numUpoints;
+   test.numVpoints = numVpoints;
+   test.uKnots.resize(numUpoints + 4);
+   test.vKnots.resize(numVpoints + 4);
+   for (int i = 0; i < numUpoints + 4; i++) test.uKnots[i] = (float)min(max(i - 3, 0), numUpoints - 3);
+   for (int j = 0; j < numVpoints + 4; j++) test.vKnots[j] = (float)min(max(j - 3, 0), numVpoints - 3);
+   test.controlPoints.resize(3 * numUpoints * numVpoints);
+   for (int i = 0; i < numUpoints; i++)
+      for (int j = 0; j < numVpoints; j++)
+      {
+         float *controlPoint = &test.controlPoints[3 * (i * numVpoints + j)];
+         controlPoint[0] = -2.5 + j * 0.5;
+         controlPoint[1] = 0.0;
+         controlPoint[2] = 6.0 - i;
+      }
+}
+
+// The programs' view, scaled to fit the grid in.
+void setView(const TestSurface &test)
+{
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   gluPerspective(60.0, 1.0, 1.0, 50.0);
+   glMatrixMode(GL_MODELVIEW);
+   glLoadIdentity();
+   gluLookAt(0.0, 0.0, 12.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+   glRotatef(40.0, 0.0, 0.0, 1.0);
+   glRotatef(10.0, 0.0, 1.0, 0.0);
+   glRotatef(30.0, 1.0, 0.0, 0.0);
+   float scale = 15.0f / max(test.numUpoints, 2 * test.numVpoints);
+   glScalef(scale, scale, scale);
+}
+
+// Move the control point in the middle of the grid for frame number frame.
+float *dragControlPoint(TestSurface &test, int frame)
+{
+   float *controlPoint = &test.controlPoints[3 * ((test.numUpoints / 2) * test.numVpoints + test.numVpoints / 2)];
+   controlPoint[1] = 2.0 * sin(0.1 * frame);
+   return controlPoint;
+}
+
+// Milliseconds per frame of the control point dragged, the surface drawn by GLU as set.
+double timeGluFrames(GLUnurbsObj *nurbsObject, TestSurface &test)
+{
+   int frames = 0;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   while ( (frames < MIN_FRAMES) || (milliseconds(start) < MIN_TIME) )
+   {
+      dragControlPoint(test, frames);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      gluBeginSurface(nurbsObject);
+      gluNurbsSurface(nurbsObject, (GLint)test.uKnots.size(), &test.uKnots[0], (GLint)test.vKnots.size(),
+                      &test.vKnots[0], 3 * test.numVpoints, 3, &test.controlPoints[0], 4, 4, GL_MAP2_VERTEX_3);
+      gluEndSurface(nurbsObject);
+      glFinish();
+      frames++;
+   }
+   return milliseconds(start) / frames;
+}
+
+// Milliseconds per frame of the control point dragged, the surface retessellated whole
+// or where moved, and drawn; and per update and per evaluation alone.
+void timeSurfaceFrames(NurbsSurface &surface, TestSurface &test, bool whole, double *times, long &numEvaluated)
+{
+   int i = test.numUpoints / 2, j = test.numVpoints / 2, frames = 0;
+   numEvaluated = 0;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   while ( (frames < MIN_FRAMES) || (milliseconds(start) < MIN_TIME) )
+   {
+      dragControlPoint(test, frames);
+      if (whole) editNurbsSurface(surface);
+      else editNurbsControlPoint(surface, i, j);
+      numEvaluated += (long)(surface.lastColumn - surface.firstColumn) * (surface.lastRow - surface.firstRow);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      updateNurbsSurface(surface);
+      drawNurbsSurface(surface, NURBS_FILL);
+      glFinish();
+      frames++;
+   }
+   times[0] = milliseconds(start) / frames;
+   numEvaluated /= frames;
+
+   frames = 0;
+   start = chrono::steady_clock::now();
+   while ( (frames < MIN_FRAMES) || (milliseconds(start) < MIN_TIME / 4) )
+   {
+      dragControlPoint(test, frames);
+      if (whole) editNurbsSurface(surface);
+      else editNurbsControlPoint(surface, i, j);
+      updateNurbsSurface(surface);
+      glFinish();
+      frames++;
+   }
+   times[1] = milliseconds(start) / frames;
+
+   frames = 0;
+   start = chrono::steady_clock::now();
+   while ( (frames < MIN_FRAMES) || (milliseconds(start) < MIN_TIME / 4) )
+   {
+      dragControlPoint(test, frames);
+      if (whole) editNurbsSurface(surface);
+      else editNurbsControlPoint(surface, i, j);
+      evaluateNurbsSurface(surface);
+      surface.firstColumn = surface.lastColumn = 0;
+      frames++;
+   }
+   times[2] = milliseconds(start) / frames;
+}
+
+// Time the dragging of a control point of a grid of numUpoints x numVpoints.
+void timeDragging(int numUpoints, int numVpoints)
+{
+   TestSurface test;
+   makeTestSurface(test, numUpoints, numVpoints);
+   setView(test);
+
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   NurbsSurface surface;
+   makeNurbsSurface(surface, (int)test.uKnots.size(), &test.uKnots[0], (int)test.vKnots.size(), &test.vKnots[0],
+                    3 * numVpoints, 3, &test.controlPoints[0], 4, 4, 3);
+   double makeTime = milliseconds(start);
+   start = chrono::steady_clock::now();
+   updateNurbsSurface(surface);
+   glFinish();
+   double loadTime = milliseconds(start);
+   int numColumns = (int)surface.uParameters.size(), numRows = (int)surface.vParameters.size();
+
+   printf("\n%d x %d control points, %d x %d vertices, %d triangles, %d thread(s) for the whole grid\n", numUpoints,
+          numVpoints, numColumns, numRows, surface.numTriangleIndices / 3, nurbsThreads(numColumns * numRows));
+   printf("Made in %.2f ms, first evaluated and loaded in %.2f ms\n", makeTime, loadTime);
+   printf("%-30s %10s %10s %10s %10s\n", "ms per frame", "frame", "update", "evaluate", "vertices");
+
+   GLUnurbsObj *nurbsObject = gluNewNurbsRenderer();
+   gluNurbsProperty(nurbsObject, GLU_DISPLAY_MODE, GLU_FILL);
+   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
+   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 100.0);
+   printf("%-30s %10.3f\n", "GLU, 100 pixel path length", timeGluFrames(nurbsObject, test));
+   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_DOMAIN_DISTANCE);
+   gluNurbsProperty(nurbsObject, GLU_U_STEP, (float)NURBS_SAMPLES_PER_SPAN);
+   gluNurbsProperty(nurbsObject, GLU_V_STEP, (float)NURBS_SAMPLES_PER_SPAN);
+   printf("%-30s %10.3f\n", "GLU, same samples", timeGluFrames(nurbsObject, test));
+   gluDeleteNurbsRenderer(nurbsObject);
+
+   double times[3];
+   long numEvaluated;
+   timeSurfaceFrames(surface, test, true, times, numEvaluated);
+   printf("%-30s %10.3f %10.3f %10.3f %10ld\n", "nurbsSurface.h, whole grid", times[0], times[1], times[2],
+          numEvaluated);
+   timeSurfaceFrames(surface, test, false, times, numEvaluated);
+   printf("%-30s %10.3f %10.3f %10.3f %10ld\n", "nurbsSurface.h, part moved", times[0], times[1], times[2],
+          numEvaluated);
+
+   glDeleteBuffers(2, surface.buffers);
+}
+
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+   glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
+   glutCreateWindow("nurbsSurfaceBenchmark.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   // The lighting of bicubicSplineSurfaceLitTextured.cpp.
+   glViewport(0, 0, WINDOW_SIZE, WINDOW_SIZE);
+   glEnable(GL_DEPTH_TEST);
+   glEnable(GL_LIGHTING);
+   glEnable(GL_LIGHT0);
+   glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+   glEnable(GL_AUTO_NORMAL);
+
+   int size = (argc > 1) ? atoi(argv[1]) : 200;
+   checkSurfaces();
+   timeDragging(15, 10);
+   timeDragging(size, size);
+   return 0;
+}
@@ -0,0 +1,240 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// occlusionCullingBenchmark.cpp
+//
+// This program measures the occlusion culling of occlusionCulling.h on a dense city of
+// buildings, walking a camera at street level down the middle street, where the
+// buildings on either side hide most of the rest. Every frame is drawn in each mode of
+// OcclusionCulling::render(): frustum culling only; stop-and-wait, a query for each
+// node, waited for before going on; and coherent hierarchical culling, the previous
+// frame's visibility reused and the queries batched, leaves drawn by conditional
+// rendering. For each mode it reports per frame: the CPU time, up to the last GL call;
+// the time to its completion, after glFinish(); the buildings drawn, unconditionally and
+// by conditional rendering, and those whose draws were skipped, either never issued or
+// discarded by the GPU as their queries found them hidden; the queries and batches
+// issued; the time the CPU waited for query results and the share of results it did not
+// wait for; and the mean latency of a query, from its issue to its result being read.
+// It checks that the culling is exact by counting the pixels differing from the frame
+// drawn with frustum culling only.
+//
+// Usage:
+// occlusionCullingBenchmark [blocks per side] [frames]
+// The defaults are a city of 40 x 40 blocks and 100 frames.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "occlusionCulling.h"
+
+using namespace std;
+
+#define PI 3.14159265
+#define WINDOW_SIZE 400 // Width and height of the window.
+#define BLOCK_SIZE 20.0 // Distance between the centers of neighboring blocks.
+#define FLOOR_HEIGHT 3.0
+#define EYE_HEIGHT 2.0
+#define NEAR_DISTANCE 1.0
+#define WALK_STEP 2.0 // Step of the camera per frame.
+#define LEAF_SIZE 4 // Buildings to a leaf of the hierarchy.
+
+static unsigned int buildingLists; // Display lists base index, one for each building.
+
+// Times and counts of the frames of a mode, summed.
+struct ModeCost
+{
+   double cpuTime, frameTime, waitTime, latency;
+   long long numDrawn, numConditional, numConditionalHidden, numSkipped, numQueries, numBatches, numReady;
+   long long numDiffering;
+};
+
+float randomFloat(float low, float high) { return low + (high - low) * rand() / RAND_MAX; }
+
+double milliseconds(chrono::steady_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Routine to draw building k.
+void drawBuilding(int k)
+{
+   glCallList(buildingLists + k);
+}
+
+// Compile the display list of a building on the box, floor by floor, each face of each
+// floor a quad with its own shade of the building's color.
+void makeBuilding(unsigned int list, const OcclusionBox &b)
+{
+   float r = randomFloat(0.3, 1.0), g = randomFloat(0.3, 1.0), bl = randomFloat(0.3, 1.0);
+   int numFloors = (int)((b.maxY - b.minY) / FLOOR_HEIGHT + 0.5);
+   glNewList(list, GL_COMPILE);
+   glBegin(GL_QUADS);
+   for (int f = 0; f < numFloors; f++)
+   {
+      float y0 = b.minY + f * FLOOR_HEIGHT, y1 = (f == numFloors - 1) ? b.maxY : y0 + FLOOR_HEIGHT;
+      float shade = (f % 2) ? 0.8 : 1.0;
+      glColor3f(shade * r, shade * g, shade * bl);
+      glVertex3f(b.minX, y0, b.maxZ); glVertex3f(b.maxX, y0, b.maxZ); glVertex3f(b.maxX, y1, b.maxZ); glVertex3f(b.minX, y1, b.maxZ);
+      glColor3f(0.7 * shade * r, 0.7 * shade * g, 0.7 * shade * bl);
+      glVertex3f(b.maxX, y0, b.maxZ); glVertex3f(b.maxX, y0, b.minZ); glVertex3f(b.maxX, y1, b.minZ); glVertex3f(b.maxX, y1, b.maxZ);
+      glColor3f(0.5 * shade * r, 0.5 * shade * g, 0.5 * shade * bl);
+      glVertex3f(b.maxX, y0, b.minZ); glVertex3f(b.minX, y0, b.minZ); glVertex3f(b.minX, y1, b.minZ); glVertex3f(b.maxX, y1, b.minZ);
+      glColor3f(0.6 * shade * r, 0.6 * shade * g, 0.6 * shade * bl);
+      glVertex3f(b.minX, y0, b.minZ); glVertex3f(b.minX, y0, b.maxZ); glVertex3f(b.minX, y1, b.maxZ); glVertex3f(b.minX, y1, b.minZ);
+   }
+   glColor3f(0.3 * r, 0.3 * g, 0.3 * bl);
+   glVertex3f(b.minX, b.maxY, b.maxZ); glVertex3f(b.maxX, b.maxY, b.maxZ); glVertex3f(b.maxX, b.maxY, b.minZ); glVertex3f(b.minX, b.maxY, b.minZ);
+   glEnd();
+   glEndList();
+}
+
+// City of side x side blocks about the origin, a building of random footprint and
+// height in each, mostly low with some towers; streets run between the blocks, one
+// down the middle along the z-axis.
+void makeCity(int side, vector<OcclusionBox> &buildings)
+{
+   buildings.clear();
+   for (int i = 0; i < side; i++)
+      for (int j = 0; j < side; j++)
+      {
+         float x = BLOCK_SIZE * (i - side / 2 + 0.5), z = BLOCK_SIZE * (j - side / 2 + 0.5);
+         float halfWidth = randomFloat(5.0, 8.0), halfDepth = randomFloat(5.0, 8.0);
+         float height = FLOOR_HEIGHT * (int)(randomFloat(2.0, 10.0) + ((rand() % 10 == 0) ? randomFloat(10.0, 30.0) : 0.0));
+         OcclusionBox b = { x - halfWidth, 0.0, z - halfDepth, x + halfWidth, height, z + halfDepth };
+         buildings.push_back(b);
+      }
+   buildingLists = glGenLists((int)buildings.size());
+   for (int k = 0; k < (int)buildings.size(); k++) makeBuilding(buildingLists + k, buildings[k]);
+}
+
+// Draw frame f of the walk in the mode, adding its costs, and read it back into image.
+void drawFrame(OcclusionCulling &culling, int side, int f, int mode, ModeCost &cost, vector<unsigned char> &image)
+{
+   float eye[3] = { 0.0, EYE_HEIGHT, (float)(BLOCK_SIZE * side / 2 - WALK_STEP * f) };
+   float heading = (PI/180.0) * 25.0 * sin(f / 15.0);
+
+   glFinish();
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+   glLoadIdentity();
+   gluLookAt(eye[0], eye[1], eye[2], eye[0] - sin(heading), eye[1], eye[2] - cos(heading), 0.0, 1.0, 0.0);
+   culling.render(eye, NEAR_DISTANCE, mode, drawBuilding);
+   cost.cpuTime += milliseconds(start);
+   glFinish();
+   cost.frameTime += milliseconds(start);
+
+   const OcclusionStats &stats = culling.getStats();
+   cost.numDrawn += stats.numDrawn;
+   cost.numConditional += stats.numConditional;
+   cost.numConditionalHidden += stats.numConditionalHidden;
+   cost.numSkipped += culling.getNumObjects() - stats.numDrawn - (stats.numConditional - stats.numConditionalHidden);
+   cost.numQueries += stats.numQueries;
+   cost.numBatches += stats.numBatches;
+   cost.numReady += stats.numReady;
+   cost.waitTime += stats.waitTime;
+   cost.latency += stats.latency;
+
+   image.resize(WINDOW_SIZE * WINDOW_SIZE * 4);
+   glReadPixels(0, 0, WINDOW_SIZE, WINDOW_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, &image[0]);
+}
+
+// Number of pixels differing between two images.
+int countDiffering(const vector<unsigned char> &image, const vector<unsigned char> &otherImage)
+{
+   int differing = 0;
+   for (int k = 0; k < WINDOW_SIZE * WINDOW_SIZE; k++)
+   {
+      bool isDifferent = false;
+      for (int c = 0; c < 3; c++) isDifferent |= (abs(image[4 * k + c] - otherImage[4 * k + c]) > 2);
+      differing += isDifferent;
+   }
+   return differing;
+}
+
+// Set up the GL state, build the city and walk through it in each mode.
+void runBenchmark(int side, int numFrames)
+{
+   glViewport(0, 0, WINDOW_SIZE, WINDOW_SIZE);
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   gluPerspective(60.0, 1.0, NEAR_DISTANCE, 2000.0);
+   glMatrixMode(GL_MODELVIEW);
+   glEnable(GL_DEPTH_TEST);
+   glClearColor(0.0, 0.0, 0.0, 0.0);
+
+   vector<OcclusionBox> buildings;
+   makeCity(side, buildings);
+   if (numFrames > (int)(BLOCK_SIZE * side / WALK_STEP)) numFrames = (int)(BLOCK_SIZE * side / WALK_STEP);
+
+   // A hierarchy for each mode, as each keeps the visibility of its last frame.
+   static const char *names[3] = { "frustum only", "stop-and-wait", "coherent" };
+   OcclusionCulling culling[3];
+   ModeCost costs[3];
+   for (int m = 0; m < 3; m++)
+   {
+      culling[m].initialize(buildings, LEAF_SIZE);
+      ModeCost zero = { 0.0, 0.0, 0.0, 0.0, 0, 0, 0, 0, 0, 0, 0, 0 };
+      costs[m] = zero;
+   }
+   printf("%d buildings, %d nodes, %d frames\n", (int)buildings.size(), culling[0].getNumNodes(), numFrames);
+
+   // Warm up, e.g., for the driver to compile the display lists' state.
+   vector<unsigned char> image, otherImage;
+   ModeCost warmUp = costs[0];
+   drawFrame(culling[0], side, 0, OCCLUSION_FRUSTUM_ONLY, warmUp, image);
+
+   for (int f = 0; f < numFrames; f++)
+   {
+      drawFrame(culling[0], side, f, OCCLUSION_FRUSTUM_ONLY, costs[0], image);
+      for (int m = 1; m < 3; m++)
+      {
+         drawFrame(culling[m], side, f, m, costs[m], otherImage);
+         costs[m].numDiffering += countDiffering(image, otherImage);
+      }
+   }
+
+   printf("%-14s %8s %9s %8s %8s %8s %8s %8s %8s %8s %8s %10s %8s\n", "per frame", "CPU ms", "frame ms", "drawn",
+          "cond.", "hidden", "skipped", "queries", "batches", "wait ms", "ready %", "latency ms", "pixels");
+   for (int m = 0; m < 3; m++)
+   {
+      const ModeCost &c = costs[m];
+      printf("%-14s %8.2f %9.2f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.2f %8.1f %10.3f %8lld\n", names[m],
+             c.cpuTime / numFrames, c.frameTime / numFrames, (double)c.numDrawn / numFrames,
+             (double)c.numConditional / numFrames, (double)c.numConditionalHidden / numFrames,
+             (double)c.numSkipped / numFrames, (double)c.numQueries / numFrames, (double)c.numBatches / numFrames,
+             c.waitTime / numFrames, c.numQueries ? 100.0 * c.numReady / c.numQueries : 0.0,
+             c.numQueries ? c.latency / c.numQueries : 0.0, c.numDiffering);
+   }
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+   glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
+   glutCreateWindow("occlusionCullingBenchmark.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   int side = (argc > 1) ? atoi(argv[1]) : 40;
+   int numFrames = (argc > 2) ? atoi(argv[2]) : 100;
+   runBenchmark(side, numFrames);
+   return 0;
+}
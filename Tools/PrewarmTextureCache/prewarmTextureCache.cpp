@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// prewarmTextureCache.cpp
+//
+// This program fills the shared texture cache (see textureCache.h) with the decoded
+// and mipmapped images of all the bmp files in a directory, so that programs loading
+// them through getCachedTexture() start warm. It then evicts the least recently used
+// cache files beyond a size limit.
+//
+// Usage:
+// prewarmTextureCache [directory [maximum cache size in MB]]
+// The directory defaults to ../../Textures and the size to TEX_CACHE_MAX_SIZE.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <dirent.h>
+#endif
+
+#include "textureCache.h"
+
+using namespace std;
+
+// List the bmp files in a directory.
+vector<string> listBmpFiles(string directory)
+{
+   vector<string> filenames;
+#ifdef _WIN32
+   WIN32_FIND_DATAA found;
+   HANDLE find = FindFirstFileA((directory + "/*.bmp").c_str(), &found);
+   if (find != INVALID_HANDLE_VALUE)
+   {
+      do filenames.push_back(directory + "/" + found.cFileName);
+      while (FindNextFileA(find, &found));
+      FindClose(find);
+   }
+#else
+   DIR *dir = opendir(directory.c_str());
+   if (dir != NULL)
+   {
+      struct dirent *found;
+      while ((found = readdir(dir)) != NULL)
+      {
+         string name = found->d_name;
+         if (name.size() > 4 && name.compare(name.size() - 4, 4, ".bmp") == 0)
+            filenames.push_back(directory + "/" + name);
+      }
+      closedir(dir);
+   }
+#endif
+   return filenames;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   string directory = argc > 1 ? argv[1] : "../../Textures";
+   long long maxSize = argc > 2 ? atoll(argv[2]) * 1024 * 1024 : TEX_CACHE_MAX_SIZE;
+
+   vector<string> filenames = listBmpFiles(directory);
+   if (filenames.empty()) cout << "No bmp files in " << directory << endl;
+
+   for (int i = 0; i < (int)filenames.size(); i++)
+   {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      CachedTexture *texture = getCachedTexture(filenames[i]);
+      double time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+      if (texture == NULL) continue;
+
+      cout << filenames[i] << ": " << texture->sizeX[0] << "x" << texture->sizeY[0] << ", "
+           << texture->numLevels << " levels, " << (texture->fromCache ? "already cached" : "cached")
+           << " in " << time << " ms" << endl;
+      releaseCachedTexture(texture);
+   }
+
+   cout << "Cache size: " << evictTextureCache(maxSize) / 1024 << " KB" << endl;
+   return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <string>
+
+using namespace std;
+
+#define TEX_CACHE_DIR "../../Textures/cache/" // Directory of cached texture files.
+#define TEX_CACHE_MAX_SIZE (256LL * 1024 * 1024) // Default cache size limit in bytes.
+#define TEX_CACHE_MAX_LEVELS 16 // Maximum number of mipmap levels of a cached texture.
+
+// A decoded RGBA texture with its full chain of mipmap levels, memory-mapped
+// from the cache file named by the hash of the source image file's contents.
+struct CachedTexture
+{
+   int numLevels;
+   int sizeX[TEX_CACHE_MAX_LEVELS];
+   int sizeY[TEX_CACHE_MAX_LEVELS];
+   const unsigned char *data[TEX_CACHE_MAX_LEVELS]; // RGBA data of each level.
+   bool fromCache; // Whether the cache file already existed.
+   void *mapping; // Mapped cache file.
+   long mappingSize;
+   void *mappingHandle;
+};
+
+CachedTexture *getCachedTexture(string filename);
+void texImageCached(CachedTexture *texture, bool mipmaps);
+void releaseCachedTexture(CachedTexture *texture);
+long long evictTextureCache(long long maxSize);
+
+#endif
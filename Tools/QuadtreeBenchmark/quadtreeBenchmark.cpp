@@ -0,0 +1,336 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// quadtreeBenchmark.cpp
+//
+// This program compares the quadtree of spaceTravelFrustumCulled.cpp as it was, with
+// nodes allocated one by one and lists of asteroids in the leaves, to the linear
+// quadtree of quadtree.h on square fields of asteroids laid out as in that program.
+// For each field it reports the time to build either tree, the memory it holds and the
+// average time to cull the field to the frustum of the spacecraft at random positions
+// and headings. It checks that the linear quadtree keeps every asteroid whose bounding
+// square meets the frustum. It then times the build of the linear quadtree, serially
+// and with the subtrees of the root on threads of their own, on fields of doubling side
+// up to the largest given, and checks that the two builds agree.
+//
+// The original tree scans the whole field at every node, so it is only built for
+// fields of up to POINTER_TREE_MAX_ASTEROIDS asteroids.
+//
+// Usage:
+// quadtreeBenchmark [side of field ...]
+// The sides default to 100, 1000 and 4000.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <thread>
+#include <vector>
+
+#include "intersectionDetectionRoutines.cpp"
+#include "quadtree.h"
+
+#define PI 3.14159265
+#define POINTER_TREE_MAX_ASTEROIDS 40000 // Largest field for the original quadtree.
+#define NUM_FRUSTA 1000 // Number of spacecraft frusta culled per field.
+#define NUM_CHECKED_FRUSTA 20 // Number of those checked against every asteroid.
+
+using namespace std;
+
+// Asteroid as in spaceTravelFrustumCulled.cpp.
+struct Asteroid
+{
+   float centerX, centerY, centerZ, radius;
+   unsigned char color[3];
+};
+
+static vector<Asteroid> field; // Asteroids of the current field.
+
+// Original quadtree node, reading the asteroids of the field in place of arrayAsteroids.
+class PointerQuadtreeNode
+{
+public:
+   PointerQuadtreeNode(float x, float z, float s)
+   {
+      SWCornerX = x; SWCornerZ = z; size = s;
+      SWChild = NWChild = NEChild = SEChild = NULL;
+   }
+
+   ~PointerQuadtreeNode() { delete SWChild; delete NWChild; delete NEChild; delete SEChild; }
+
+   int numberAsteroidsIntersected()
+   {
+      int numVal = 0;
+      for (size_t k = 0; k < field.size(); k++)
+         if ( checkDiscRectangleIntersection(SWCornerX, SWCornerZ, SWCornerX+size, SWCornerZ-size,
+                                             field[k].centerX, field[k].centerZ, field[k].radius) )
+            numVal++;
+      return numVal;
+   }
+
+   void addIntersectingAsteroidsToList()
+   {
+      for (size_t k = 0; k < field.size(); k++)
+         if ( checkDiscRectangleIntersection(SWCornerX, SWCornerZ, SWCornerX+size, SWCornerZ-size,
+                                             field[k].centerX, field[k].centerZ, field[k].radius) )
+            asteroidList.push_back(field[k]);
+   }
+
+   void build()
+   {
+      if ( numberAsteroidsIntersected() <= 1 ) addIntersectingAsteroidsToList();
+      else
+      {
+         SWChild = new PointerQuadtreeNode(SWCornerX, SWCornerZ, size/2.0);
+         NWChild = new PointerQuadtreeNode(SWCornerX, SWCornerZ - size/2.0, size/2.0);
+         NEChild = new PointerQuadtreeNode(SWCornerX + size/2.0, SWCornerZ - size/2.0, size/2.0);
+         SEChild = new PointerQuadtreeNode(SWCornerX + size/2.0, SWCornerZ, size/2.0);
+         SWChild->build(); NWChild->build(); NEChild->build(); SEChild->build();
+      }
+   }
+
+   // Collect the asteroids drawAsteroids() would draw.
+   void cull(float x1, float z1, float x2, float z2, float x3, float z3, float x4, float z4,
+             vector<const Asteroid *> &culled)
+   {
+      if ( checkQuadrilateralsIntersection(x1, z1, x2, z2, x3, z3, x4, z4,
+                                           SWCornerX, SWCornerZ, SWCornerX, SWCornerZ-size,
+                                           SWCornerX+size, SWCornerZ-size, SWCornerX+size, SWCornerZ) )
+      {
+         if (SWChild == NULL)
+            for (list<Asteroid>::iterator it = asteroidList.begin(); it != asteroidList.end(); it++)
+               culled.push_back(&*it);
+         else
+         {
+            SWChild->cull(x1, z1, x2, z2, x3, z3, x4, z4, culled);
+            NWChild->cull(x1, z1, x2, z2, x3, z3, x4, z4, culled);
+            NEChild->cull(x1, z1, x2, z2, x3, z3, x4, z4, culled);
+            SEChild->cull(x1, z1, x2, z2, x3, z3, x4, z4, culled);
+         }
+      }
+   }
+
+   // Count the nodes and the asteroids in the leaf lists.
+   void count(int &numNodes, int &numListed)
+   {
+      numNodes++;
+      numListed += (int)asteroidList.size();
+      if (SWChild != NULL)
+      {
+         SWChild->count(numNodes, numListed); NWChild->count(numNodes, numListed);
+         NEChild->count(numNodes, numListed); SEChild->count(numNodes, numListed);
+      }
+   }
+
+private:
+   float SWCornerX, SWCornerZ;
+   float size;
+   PointerQuadtreeNode *SWChild, *NWChild, *NEChild, *SEChild;
+   list<Asteroid> asteroidList;
+};
+
+// Frustum of the spacecraft at (x, z) heading at angle a, as in drawScene().
+struct Frustum
+{
+   float x[4], z[4];
+
+   Frustum(float xVal, float zVal, float angle)
+   {
+      x[0] = xVal - 7.072 * sin( (PI/180.0) * (45.0 + angle) );
+      z[0] = zVal - 7.072 * cos( (PI/180.0) * (45.0 + angle) );
+      x[1] = xVal - 353.6 * sin( (PI/180.0) * (45.0 + angle) );
+      z[1] = zVal - 353.6 * cos( (PI/180.0) * (45.0 + angle) );
+      x[2] = xVal + 353.6 * sin( (PI/180.0) * (45.0 - angle) );
+      z[2] = zVal - 353.6 * cos( (PI/180.0) * (45.0 - angle) );
+      x[3] = xVal + 7.072 * sin( (PI/180.0) * (45.0 - angle) );
+      z[3] = zVal - 7.072 * cos( (PI/180.0) * (45.0 - angle) );
+   }
+};
+
+// Fill the field with side x side asteroids placed as in setup(); return the side of the root square.
+float makeField(int side)
+{
+   field.resize((size_t)side * side);
+   for (int j = 0; j < side; j++)
+      for (int i = 0; i < side; i++)
+      {
+         Asteroid &asteroid = field[(size_t)j * side + i];
+         asteroid.centerX = (side % 2 ? 0.0 : 15.0) + 30.0*(-side/2 + j);
+         asteroid.centerY = 0.0;
+         asteroid.centerZ = -40.0 - 30.0*i;
+         asteroid.radius = 3.0;
+         asteroid.color[0] = rand()%256; asteroid.color[1] = rand()%256; asteroid.color[2] = rand()%256;
+      }
+   return (side - 1)*30.0 + 6.0;
+}
+
+double milliseconds(chrono::high_resolution_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+// Number of asteroids whose bounding square meets the frustum and which are not in the culled ranges.
+int countMissed(const Quadtree &quadtree, const Frustum &f, const vector<AsteroidRange> &ranges)
+{
+   const AsteroidArray &asteroids = quadtree.getAsteroids();
+   vector<char> kept(asteroids.size(), 0);
+   for (size_t r = 0; r < ranges.size(); r++)
+      for (int k = ranges[r].first; k < ranges[r].first + ranges[r].count; k++) kept[k] = 1;
+
+   int missed = 0;
+   for (int k = 0; k < asteroids.size(); k++)
+   {
+      // Co-ordinates relative to the first vertex of the frustum, as in Quadtree::cull().
+      float x = asteroids.centerX[k] - f.x[0], z = asteroids.centerZ[k] - f.z[0], r = asteroids.radius[k];
+      if ( !kept[k] && checkQuadrilateralsIntersection(0.0, 0.0, f.x[1] - f.x[0], f.z[1] - f.z[0],
+                                                       f.x[2] - f.x[0], f.z[2] - f.z[0], f.x[3] - f.x[0], f.z[3] - f.z[0],
+                                                       x - r, z + r, x - r, z - r, x + r, z - r, x + r, z + r) )
+         missed++;
+   }
+   return missed;
+}
+
+void runBenchmark(int side)
+{
+   float initialSize = makeField(side);
+   int n = (int)field.size();
+
+   // Random spacecraft positions within the field and headings.
+   vector<Frustum> frusta;
+   for (int k = 0; k < NUM_FRUSTA; k++)
+      frusta.push_back( Frustum( -initialSize/2.0 + initialSize * rand() / RAND_MAX,
+                                 -37.0 - initialSize * rand() / RAND_MAX, 360.0 * rand() / RAND_MAX ) );
+
+   printf("%d x %d asteroids\n", side, side);
+
+   // Original quadtree.
+   if (n <= POINTER_TREE_MAX_ASTEROIDS)
+   {
+      chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+      PointerQuadtreeNode *root = new PointerQuadtreeNode(-initialSize/2.0, -37.0, initialSize);
+      root->build();
+      double buildTime = milliseconds(start);
+
+      int numNodes = 0, numListed = 0;
+      root->count(numNodes, numListed);
+      double memory = (double)numNodes * sizeof(PointerQuadtreeNode) +
+                      (double)numListed * (sizeof(Asteroid) + 2 * sizeof(void *));
+
+      vector<const Asteroid *> culled;
+      long total = 0;
+      start = chrono::high_resolution_clock::now();
+      for (int k = 0; k < NUM_FRUSTA; k++)
+      {
+         culled.clear();
+         const Frustum &f = frusta[k];
+         root->cull(f.x[0], f.z[0], f.x[1], f.z[1], f.x[2], f.z[2], f.x[3], f.z[3], culled);
+         total += (long)culled.size();
+      }
+      double cullTime = 1000.0 * milliseconds(start) / NUM_FRUSTA;
+
+      printf("   pointer tree: build %10.1f ms, %9.2f MB, %9d nodes, cull %8.2f us, %6.1f asteroids drawn\n",
+             buildTime, memory / 1048576.0, numNodes, cullTime, (double)total / NUM_FRUSTA);
+      delete root;
+   }
+   else printf("   pointer tree: not built, %d asteroids scanned at every node\n", n);
+
+   // Linear quadtree.
+   chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+   AsteroidArray asteroids;
+   asteroids.reserve(n);
+   for (int k = 0; k < n; k++)
+      asteroids.add(field[k].centerX, field[k].centerY, field[k].centerZ, field[k].radius, field[k].color);
+   Quadtree quadtree;
+   quadtree.initialize(asteroids, -initialSize/2.0, -37.0, initialSize);
+   double buildTime = milliseconds(start);
+   vector<Asteroid>().swap(field);
+   asteroids = AsteroidArray();
+
+   vector<AsteroidRange> ranges;
+   long total = 0;
+   start = chrono::high_resolution_clock::now();
+   for (int k = 0; k < NUM_FRUSTA; k++)
+   {
+      const Frustum &f = frusta[k];
+      total += quadtree.cull(f.x[0], f.z[0], f.x[1], f.z[1], f.x[2], f.z[2], f.x[3], f.z[3], ranges);
+   }
+   double cullTime = 1000.0 * milliseconds(start) / NUM_FRUSTA;
+
+   int missed = 0;
+   for (int k = 0; k < NUM_CHECKED_FRUSTA; k++)
+   {
+      const Frustum &f = frusta[k];
+      quadtree.cull(f.x[0], f.z[0], f.x[1], f.z[1], f.x[2], f.z[2], f.x[3], f.z[3], ranges);
+      missed += countMissed(quadtree, f, ranges);
+   }
+
+   printf("   linear tree:  build %10.1f ms, %9.2f MB, %9d nodes, cull %8.2f us, %6.1f asteroids drawn, %d missed\n",
+          buildTime, quadtree.memorySize() / 1048576.0, quadtree.getNumNodes(), cullTime,
+          (double)total / NUM_FRUSTA, missed);
+}
+
+// Whether two quadtrees have the same nodes and asteroids.
+bool sameQuadtrees(const Quadtree &a, const Quadtree &b)
+{
+   const vector<QuadtreeNode> &nodesA = a.getNodes(), &nodesB = b.getNodes();
+   const AsteroidArray &asteroidsA = a.getAsteroids(), &asteroidsB = b.getAsteroids();
+   return nodesA.size() == nodesB.size() && asteroidsA.size() == asteroidsB.size() &&
+          memcmp(&nodesA[0], &nodesB[0], nodesA.size() * sizeof(QuadtreeNode)) == 0 &&
+          asteroidsA.centerX == asteroidsB.centerX && asteroidsA.centerZ == asteroidsB.centerZ;
+}
+
+// Time serial and parallel builds of the linear quadtree on fields of doubling side.
+void runBuildScaling(int maxSide)
+{
+   printf("\nLinear quadtree build, %u hardware threads, parallel from %d asteroids\n", 
+          thread::hardware_concurrency(), QUADTREE_PARALLEL_ASTEROIDS);
+   printf("%12s %12s %12s %12s %12s %8s\n", "field", "serial ms", "ns/asteroid", "parallel ms", "ns/asteroid", "same");
+   for (int side = 125; side <= maxSide; side *= 2)
+   {
+      float initialSize = makeField(side);
+      int n = (int)field.size();
+      AsteroidArray asteroids;
+      asteroids.reserve(n);
+      for (int k = 0; k < n; k++)
+         asteroids.add(field[k].centerX, field[k].centerY, field[k].centerZ, field[k].radius, field[k].color);
+      vector<Asteroid>().swap(field);
+
+      double times[2];
+      Quadtree quadtrees[2];
+      for (int parallel = 0; parallel < 2; parallel++)
+      {
+         times[parallel] = 1e30;
+         for (int repeat = 0; repeat < (n < 1000000 ? 3 : 1); repeat++)
+         {
+            chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+            quadtrees[parallel].initialize(asteroids, -initialSize/2.0, -37.0, initialSize, parallel == 1);
+            times[parallel] = min(times[parallel], milliseconds(start));
+         }
+      }
+      printf("%5d x %-5d %12.1f %12.1f %12.1f %12.1f %8s\n", side, side, times[0], 1e6 * times[0] / n,
+             times[1], 1e6 * times[1] / n, sameQuadtrees(quadtrees[0], quadtrees[1]) ? "yes" : "NO");
+   }
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   int maxSide = 0;
+   if (argc > 1)
+      for (int k = 1; k < argc; k++) 
+      {
+         runBenchmark(atoi(argv[k]));
+         maxSide = max(maxSide, atoi(argv[k]));
+      }
+   else
+   {
+      runBenchmark(100);
+      runBenchmark(1000);
+      runBenchmark(4000);
+      maxSide = 4000;
+   }
+   runBuildScaling(maxSide);
+   return 0;
+}
@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// surfaceBenchmark.cpp
+//
+// This program times the regeneration of the vertices of a lit, textured torus and of
+// the helical pipe of Chapter 10, with unit normals, at increasing tessellations by
+// three methods: the original one, calling cos() and sin() for every vertex; a
+// sampler reading tables of the cosines and sines of the grid's angles
+// (fillGridVertices()); and the parametric surface evaluator, evaluating the same
+// tables in SIMD lanes and threads (fillSurfaceVertices()). It checks that the three
+// agree and reports the speedup of the last over the first.
+//
+// Usage:
+// surfaceBenchmark [maximum number of slices]
+// The number of slices defaults to 2048.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "meshBuilder.h"
+
+#define PI 3.14159265358979324
+#define TOR_OUTRAD 3.0 // Torus outer radius.
+#define TOR_INRAD 1.0 // Torus inner radius.
+
+using namespace std;
+
+// Vertex with the attributes of a lit, textured mesh.
+struct Vertex
+{
+   float coords[4];
+   float normal[3];
+   float texCoords[2];
+};
+
+// Original torus: point (i, j) at angles (-1 + 2i/longs)PI and (-1 + 2j/lats)PI,
+// with two cosines and two sines per vertex.
+void fillTorusDirect(Vertex *vertices, int longs, int lats)
+{
+   for (int j = 0; j <= lats; j++)
+      for (int i = 0; i <= longs; i++)
+      {
+         Vertex &vertex = *vertices++;
+         float u = (-1 + 2*(float)i/longs) * PI, v = (-1 + 2*(float)j/lats) * PI;
+         vertex.coords[0] = (TOR_OUTRAD + TOR_INRAD * cos(v)) * cos(u);
+         vertex.coords[1] = (TOR_OUTRAD + TOR_INRAD * cos(v)) * sin(u);
+         vertex.coords[2] = TOR_INRAD * sin(v);
+         vertex.coords[3] = 1.0;
+         vertex.normal[0] = cos(v) * cos(u);
+         vertex.normal[1] = cos(v) * sin(u);
+         vertex.normal[2] = sin(v);
+         vertex.texCoords[0] = (float)i / longs;
+         vertex.texCoords[1] = (float)j / lats;
+      }
+}
+
+// Torus by tables of cosines and sines.
+struct TorusSampler
+{
+   AngleTable longAngles, latAngles;
+
+   TorusSampler(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats),
+                                       longs(longs), lats(lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      float r = TOR_OUTRAD + TOR_INRAD * latAngles.cosines[j];
+      vertex.coords[0] = r * longAngles.cosines[i];
+      vertex.coords[1] = r * longAngles.sines[i];
+      vertex.coords[2] = TOR_INRAD * latAngles.sines[j];
+      vertex.coords[3] = 1.0;
+      vertex.normal[0] = latAngles.cosines[j] * longAngles.cosines[i];
+      vertex.normal[1] = latAngles.cosines[j] * longAngles.sines[i];
+      vertex.normal[2] = latAngles.sines[j];
+      vertex.texCoords[0] = (float)i / longs;
+      vertex.texCoords[1] = (float)j / lats;
+   }
+
+   int longs, lats;
+};
+
+// Torus as a parametric surface.
+struct TorusSurface
+{
+   AngleTable longAngles, latAngles;
+
+   TorusSurface(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats),
+                                       longs(longs), lats(lats) {}
+
+   template <class T>
+   void operator()(SurfacePoint<T> &point, const SurfaceAngle<T> &u, const SurfaceAngle<float> &v) const
+   {
+      float r = TOR_OUTRAD + TOR_INRAD * v.cosine;
+      point.x = r * u.cosine;
+      point.y = r * u.sine;
+      point.z = TOR_INRAD * v.sine;
+      point.nx = v.cosine * u.cosine;
+      point.ny = v.cosine * u.sine;
+      point.nz = v.sine;
+   }
+
+   void store(Vertex &vertex, const SurfacePoint<float> &point) const
+   {
+      vertex.coords[0] = point.x;
+      vertex.coords[1] = point.y;
+      vertex.coords[2] = point.z;
+      vertex.coords[3] = 1.0;
+      vertex.normal[0] = point.nx;
+      vertex.normal[1] = point.ny;
+      vertex.normal[2] = point.nz;
+      vertex.texCoords[0] = point.s;
+      vertex.texCoords[1] = point.t;
+   }
+
+   int longs, lats;
+};
+
+// Original helical pipe: (f, g, h)(u, v) = (cos u + sin v, sin u + cos v, u) at
+// u = (-1 + 2i/longs)PI and v = (-1 + 2j/lats)PI, with the normal the cross product
+// (sin v, cos v, sin u sin v - cos u cos v) of the partial derivatives, normalized.
+void fillPipeDirect(Vertex *vertices, int longs, int lats)
+{
+   for (int j = 0; j <= lats; j++)
+      for (int i = 0; i <= longs; i++)
+      {
+         Vertex &vertex = *vertices++;
+         vertex.coords[0] = cos( (-1 + 2*(float)i/longs) * PI ) + sin( (-1 + 2*(float)j/lats) * PI );
+         vertex.coords[1] = sin( (-1 + 2*(float)i/longs) * PI ) + cos( (-1 + 2*(float)j/lats) * PI );
+         vertex.coords[2] = (-1 + 2*(float)i/longs) * PI;
+         vertex.coords[3] = 1.0;
+         float nz = sin( (-1 + 2*(float)i/longs) * PI ) * sin( (-1 + 2*(float)j/lats) * PI ) - cos( (-1 + 2*(float)i/longs) * PI ) * cos( (-1 + 2*(float)j/lats) * PI );
+         float n = sqrt(1.0 + nz * nz);
+         vertex.normal[0] = sin( (-1 + 2*(float)j/lats) * PI ) / n;
+         vertex.normal[1] = cos( (-1 + 2*(float)j/lats) * PI ) / n;
+         vertex.normal[2] = nz / n;
+      }
+}
+
+// Helical pipe by tables of cosines and sines.
+struct PipeSampler
+{
+   AngleTable longAngles, latAngles;
+
+   PipeSampler(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats) {}
+
+   void operator()(Vertex &vertex, int i, int j) const
+   {
+      vertex.coords[0] = longAngles.cosines[i] + latAngles.sines[j];
+      vertex.coords[1] = longAngles.sines[i] + latAngles.cosines[j];
+      vertex.coords[2] = longAngles.angles[i];
+      vertex.coords[3] = 1.0;
+      float nz = longAngles.sines[i] * latAngles.sines[j] - longAngles.cosines[i] * latAngles.cosines[j];
+      float n = sqrt(1.0f + nz * nz);
+      vertex.normal[0] = latAngles.sines[j] / n;
+      vertex.normal[1] = latAngles.cosines[j] / n;
+      vertex.normal[2] = nz / n;
+   }
+};
+
+// Helical pipe as a parametric surface, whose normalization in lanes is where SIMD
+// evaluation pays most.
+struct PipeSurface
+{
+   AngleTable longAngles, latAngles;
+
+   PipeSurface(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats) {}
+
+   template <class T>
+   void operator()(SurfacePoint<T> &point, const SurfaceAngle<T> &u, const SurfaceAngle<float> &v) const
+   {
+      point.x = u.cosine + v.sine;
+      point.y = u.sine + v.cosine;
+      point.z = u.angle;
+      T nz = u.sine * v.sine - u.cosine * v.cosine;
+      T n = 1.0f / sqrt(1.0f + nz * nz);
+      point.nx = v.sine * n;
+      point.ny = v.cosine * n;
+      point.nz = nz * n;
+   }
+
+   void store(Vertex &vertex, const SurfacePoint<float> &point) const
+   {
+      vertex.coords[0] = point.x;
+      vertex.coords[1] = point.y;
+      vertex.coords[2] = point.z;
+      vertex.coords[3] = 1.0;
+      vertex.normal[0] = point.nx;
+      vertex.normal[1] = point.ny;
+      vertex.normal[2] = point.nz;
+   }
+};
+
+// Largest difference between the co-ordinates and normals of two vertex arrays.
+float maxDifference(const vector<Vertex> &a, const vector<Vertex> &b)
+{
+   float difference = 0.0;
+   for (int k = 0; k < (int)a.size(); k++)
+   {
+      for (int c = 0; c < 3; c++) difference = max(difference, fabs(a[k].coords[c] - b[k].coords[c]));
+      for (int c = 0; c < 3; c++) difference = max(difference, fabs(a[k].normal[c] - b[k].normal[c]));
+   }
+   return difference;
+}
+
+// Best of several timings of a fill, in microseconds.
+template <class Fill>
+double timeFill(const Fill &fill, int longs)
+{
+   int repeats = max(3, 4096 / longs);
+   double best = 1e30;
+   for (int r = 0; r < repeats; r++)
+   {
+      chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+      fill();
+      double elapsed = chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+      best = min(best, elapsed);
+   }
+   return best;
+}
+
+// Time and check the three methods on a surface at each tessellation.
+template <class Sampler, class Surface, class Direct>
+void runBenchmark(const char *name, Direct fillDirect, int maxSlices)
+{
+   printf("%s\n%10s %12s %12s %12s %8s %10s\n", name, "slices", "direct us", "tables us", "surface us", "speedup", "max diff");
+   for (int slices = 16; slices <= maxSlices; slices *= 2)
+   {
+      vector<Vertex> direct(gridNumVertices(slices, slices)), tables(direct.size()), surface(direct.size());
+      double directTime = timeFill([&]() { fillDirect(&direct[0], slices, slices); }, slices);
+      double tablesTime = timeFill([&]() { fillGridVertices(&tables[0], slices, slices, Sampler(slices, slices)); }, slices);
+      double surfaceTime = timeFill([&]() { fillSurfaceVertices(&surface[0], slices, slices, Surface(slices, slices)); }, slices);
+      float difference = max(maxDifference(direct, tables), maxDifference(direct, surface));
+      printf("%4d x %-4d %12.1f %12.1f %12.1f %7.1fx %10.2g\n", slices, slices, directTime, tablesTime, surfaceTime,
+             directTime / surfaceTime, difference);
+   }
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   int maxSlices = (argc > 1) ? atoi(argv[1]) : 2048;
+
+   printf("%d SIMD lanes, %u hardware threads, threads from %d vertices.\n\n", SURFACE_LANES,
+          thread::hardware_concurrency(), 2 * SURFACE_THREAD_VERTICES);
+   runBenchmark<TorusSampler, TorusSurface>("Lit, textured torus", fillTorusDirect, maxSlices);
+   printf("\n");
+   runBenchmark<PipeSampler, PipeSurface>("Helical pipe", fillPipeDirect, maxSlices);
+
+   return 0;
+}
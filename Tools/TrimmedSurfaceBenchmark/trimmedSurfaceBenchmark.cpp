@@ -0,0 +1,623 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// trimmedSurfaceBenchmark.cpp
+//
+// This program compares the trimming of B-spline surfaces by nurbsSurface.h to GLU's,
+// by gluBeginTrim(), which trimmedBicubicSplineSurface.cpp drew its surface by.
+//
+// It first checks the triangulations of random trims of random surfaces: outer loops
+// the whole domain, star polygons or B-spline loops; holes polygons, rectangles on the
+// grid lines, or B-spline loops, a few so small as to lie within one cell, some holding
+// islands. The triangles must be counter-clockwise in (u, v); their area must be that
+// of the loops, summed with sign; and the edges of the triangles without a twin
+// reversed must be the boundary, their length that of the loops, else a crack or a
+// T-junction is left. It checks the vertices of the trim against the surface evaluated
+// one point at a time by evaluateBasis() of bSplineBasis.h, and that vertices updated
+// after random edits of single control points are the same to the last bit as all
+// evaluated whole.
+//
+// It then times frames of a control point being dragged, the trimmed surface lit and
+// drawn filled in the program's view, with the program's trim loops, on its 15 x 10
+// grid of control points sampled twice a knot span, and on a 200 x 200 grid with the
+// loops scaled to its domain, a frame being the move, the surface retessellated and
+// drawn, and the drawing finished:
+// - GLU sampling as the program, to a path length of 100 pixels; and GLU's
+//   tessellation alone, by GLU_NURBS_TESSELLATOR;
+// - nurbsSurface.h trimming the surface anew every frame;
+// - nurbsSurface.h reevaluating the whole trimmed surface every frame;
+// - nurbsSurface.h reevaluating the part the control point moves.
+// For nurbsSurface.h it times too the update alone, the retessellation latency from an
+// edit to vertices in the buffer, and the triangles and vertices of each.
+//
+// Usage:
+// trimmedSurfaceBenchmark [large grid size]
+// The size defaults to 200.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "nurbsSurface.h"
+
+#define PI 3.14159265
+#define WINDOW_SIZE 600 // Width and height of the window.
+#define NUM_CHECKED_SURFACES 400 // Random trimmed surfaces checked.
+#define NUM_CHECKED_EDITS 20 // Random edits of each, each updated and checked.
+#define MIN_FRAMES 5 // Fewest frames timed of each method...
+#define MIN_TIME 1000.0 // ...and fewest milliseconds.
+
+using namespace std;
+
+// The trim loops of trimmedBicubicSplineSurface.cpp, in its domain of 12 x 7.
+static float boundaryPoints[5][2] =
+{ {0.0, 0.0}, {12.0, 0.0}, {12.0, 7.0}, {0.0, 7.0}, {0.0, 0.0} };
+static float circlePoints[11][2];
+static float curvePoints[6][2] =
+{ {9.0, 5.0}, {9.0, 7.0}, {11.0, 7.0}, {11.0, 3.0}, {9.0, 3.0}, {9.0, 5.0} };
+static float curveKnots[10] = {0.0, 0.0, 0.0, 0.0, 1.0, 2.0, 3.0, 3.0, 3.0, 3.0};
+
+double milliseconds(chrono::steady_clock::time_point start)
+{
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+float randomFloat(float low, float high)
+{
+   return low + (high - low) * rand() / RAND_MAX;
+}
+
+// Random knot vector of numKnots knots, steps of 0 to 3, no knot of multiplicity above
+// order - 1 so that the surface is continuous.
+void randomKnots(vector<float> &knots, int numKnots, int order)
+{
+   knots.resize(numKnots);
+   knots[0] = (float)(rand() % 5);
+   int multiplicity = 1;
+   for (int i = 1; i < numKnots; i++)
+   {
+      bool repeat = (rand() % 3 == 0) && (multiplicity < order - 1);
+      knots[i] = knots[i-1] + (repeat ? 0.0f : (float)(1 + rand() % 3));
+      multiplicity = repeat ? multiplicity + 1 : 1;
+   }
+}
+
+// Point of the surface at (u, v), one B-spline at a time.
+void evaluateSurfacePoint(const NurbsSurface &surface, float u, float v, float *point)
+{
+   float uBasis[BSPLINE_MAX_ORDER], vBasis[BSPLINE_MAX_ORDER], homogeneous[4] = { 0.0f };
+   int numUknots = (int)surface.uKnots.size(), numVknots = (int)surface.vKnots.size();
+   int uFirst = evaluateBasis(&surface.uKnots[0], numUknots, surface.uOrder, u, uBasis);
+   int vFirst = evaluateBasis(&surface.vKnots[0], numVknots, surface.vOrder, v, vBasis);
+   for (int i = 0; i < surface.uOrder; i++)
+      for (int j = 0; j < surface.vOrder; j++)
+      {
+         int a = uFirst + i, b = vFirst + j;
+         if ( (a < 0) || (b < 0) || (a >= numUknots - surface.uOrder) || (b >= numVknots - surface.vOrder) ) continue;
+         const float *controlPoint = surface.controlPoints + a * surface.uStride + b * surface.vStride;
+         for (int c = 0; c < surface.dimension; c++) homogeneous[c] += uBasis[i] * vBasis[j] * controlPoint[c];
+      }
+   for (int c = 0; c < 3; c++) point[c] = (surface.dimension == 4) ? homogeneous[c] / homogeneous[3] : homogeneous[c];
+}
+
+// Parameters (u, v) of vertex k of the surface, of the grid or of the trim.
+void vertexParameters(const NurbsSurface &surface, unsigned int k, double &u, double &v)
+{
+   unsigned int numColumns = (unsigned int)surface.uParameters.size();
+   unsigned int numGridVertices = numColumns * (unsigned int)surface.vParameters.size();
+   if (k < numGridVertices)
+   {
+      u = surface.uParameters[k % numColumns];
+      v = surface.vParameters[k / numColumns];
+   }
+   else
+   {
+      u = surface.trimParameters[2 * (k - numGridVertices)];
+      v = surface.trimParameters[2 * (k - numGridVertices) + 1];
+   }
+}
+
+// Area and length of the boundary of the trim loops, the area summed with sign.
+void measureLoops(const NurbsSurface &surface, double &area, double &length)
+{
+   area = length = 0.0;
+   for (int l = 0; l < (int)surface.trimLoops.size(); l++)
+   {
+      const vector<float> &loop = surface.trimLoops[l];
+      int n = (int)loop.size() / 2;
+      for (int k = 0; k < n; k++)
+      {
+         int next = (k + 1) % n;
+         area += 0.5 * ((double)loop[2*k] * loop[2*next + 1] - (double)loop[2*next] * loop[2*k + 1]);
+         length += hypot((double)loop[2*next] - loop[2*k], (double)loop[2*next + 1] - loop[2*k + 1]);
+      }
+   }
+}
+
+// Add a polygon of n points about (u, v) of radii a and b, counter-clockwise if ccw,
+// closed by its first point again.
+void addPolygonLoop(NurbsSurface &surface, float u, float v, float a, float b, int n, bool ccw, float jitter)
+{
+   vector<float> points;
+   for (int k = 0; k <= n; k++)
+   {
+      float t = 2.0 * PI * (k % n) / n * (ccw ? 1.0 : -1.0), radius = 1.0f - jitter * (k % 3) / 2.0f;
+      points.push_back(u + a * radius * cos(t));
+      points.push_back(v + b * radius * sin(t));
+   }
+   beginNurbsTrim(surface);
+   nurbsTrimPolyline(surface, n + 1, &points[0], 2);
+}
+
+// Add a closed cubic B-spline loop of n control points about (u, v) of radii a and b,
+// on clamped uniform knots, the first control point repeated last.
+void addSplineLoop(NurbsSurface &surface, float u, float v, float a, float b, int n, bool ccw, float jitter)
+{
+   vector<float> controlPoints, knots;
+   for (int k = 0; k <= n; k++)
+   {
+      float t = 2.0 * PI * (k % n) / n * (ccw ? 1.0 : -1.0), radius = 1.0f - jitter * ((k % n) % 2);
+      controlPoints.push_back(u + a * radius * cos(t));
+      controlPoints.push_back(v + b * radius * sin(t));
+   }
+   for (int k = 0; k < n + 5; k++) knots.push_back((float)min(max(k - 3, 0), n - 2));
+   beginNurbsTrim(surface);
+   nurbsTrimCurve(surface, n + 5, &knots[0], 2, &controlPoints[0], 4);
+}
+
+// Random trim of the surface. Loops are placed in co-ordinates x, y from -1 to 1 across
+// the domain; holes, and islands in them, within 0.45 of the middle.
+void randomTrim(NurbsSurface &surface)
+{
+   const vector<float> &us = surface.uParameters, &vs = surface.vParameters;
+   float uMiddle = 0.5f * (us[0] + us.back()), vMiddle = 0.5f * (vs[0] + vs.back());
+   float uHalf = 0.5f * (us.back() - us[0]), vHalf = 0.5f * (vs.back() - vs[0]);
+
+   int outer = rand() % 3;
+   if (outer == 0)
+   {
+      float points[5][2] = { { us[0], vs[0] }, { us.back(), vs[0] }, { us.back(), vs.back() }, { us[0], vs.back() },
+                             { us[0], vs[0] } };
+      beginNurbsTrim(surface);
+      nurbsTrimPolyline(surface, 5, points[0], 2);
+   }
+   else if (outer == 1) addPolygonLoop(surface, uMiddle, vMiddle, 0.95f * uHalf, 0.95f * vHalf, 8 + rand() % 24, true,
+                                       randomFloat(0.0, 0.25));
+   else addSplineLoop(surface, uMiddle, vMiddle, 0.95f * uHalf, 0.95f * vHalf, 8 + rand() % 12, true,
+                      randomFloat(0.0, 0.15));
+
+   vector<float> holes; // x, y and radius of each.
+   int numHoles = rand() % 5;
+   for (int attempt = 0; (attempt < 50) && ((int)holes.size() < 3 * numHoles); attempt++)
+   {
+      float radius = (rand() % 4 == 0) ? randomFloat(0.002, 0.02) : randomFloat(0.02, 0.2);
+      float x = randomFloat(radius - 0.45f, 0.45f - radius), y = randomFloat(radius - 0.45f, 0.45f - radius);
+      if (hypot(x, y) + radius > 0.45f) continue;
+      bool apart = true;
+      for (int h = 0; h < (int)holes.size(); h += 3)
+         if (hypot(x - holes[h], y - holes[h+1]) < 1.5f * (radius + holes[h+2])) apart = false;
+      if (!apart) continue;
+      holes.push_back(x);
+      holes.push_back(y);
+      holes.push_back(radius);
+
+      float u = uMiddle + x * uHalf, v = vMiddle + y * vHalf, a = radius * uHalf, b = radius * vHalf;
+      int kind = rand() % 3;
+      if (kind == 1)
+      {
+         // A rectangle on the grid lines within the hole's square, if there is one.
+         int p0 = (int)(lower_bound(us.begin(), us.end(), u - a) - us.begin());
+         int p1 = (int)(upper_bound(us.begin(), us.end(), u + a) - us.begin()) - 1;
+         int q0 = (int)(lower_bound(vs.begin(), vs.end(), v - b) - vs.begin());
+         int q1 = (int)(upper_bound(vs.begin(), vs.end(), v + b) - vs.begin()) - 1;
+         if ( (p0 < p1) && (q0 < q1) )
+         {
+            float points[5][2] = { { us[p0], vs[q0] }, { us[p0], vs[q1] }, { us[p1], vs[q1] }, { us[p1], vs[q0] },
+                                   { us[p0], vs[q0] } };
+            beginNurbsTrim(surface);
+            nurbsTrimPolyline(surface, 5, points[0], 2);
+            continue;
+         }
+      }
+      if (kind == 2) addSplineLoop(surface, u, v, a, b, 4 + rand() % 6, false, 0.0f);
+      else
+      {
+         addPolygonLoop(surface, u, v, a, b, 3 + rand() % 22, false, 0.0f);
+         if (rand() % 2) addPolygonLoop(surface, u, v, 0.4f * a, 0.4f * b, 3 + rand() % 10, true, 0.0f);
+      }
+   }
+}
+
+// Check the triangulations of random trims, their vertices, and updates after edits.
+void checkTrims()
+{
+   printf("Random trims: triangulations against the loops, the trim's vertices against the surface evaluated point by\n"
+          "point, and updates after edits against the whole surface\n");
+   printf("%9s %10s %10s %10s %10s %10s %10s %10s %10s\n", "surfaces", "loops", "triangles", "inverted", "area",
+          "boundary", "largest", "edits", "differing");
+   srand(1);
+   long numLoops = 0, numTriangles = 0, numInverted = 0, numEdits = 0, numDiffering = 0;
+   double areaError = 0.0, boundaryError = 0.0, largest = 0.0;
+   for (int s = 0; s < NUM_CHECKED_SURFACES; s++)
+   {
+      int dimension = 3 + rand() % 2, uOrder = 2 + rand() % 4, vOrder = 2 + rand() % 4;
+      int numUpoints = uOrder + 1 + rand() % 12, numVpoints = vOrder + 1 + rand() % 12;
+      vector<float> uKnots, vKnots, controlPoints(dimension * numUpoints * numVpoints);
+      randomKnots(uKnots, numUpoints + uOrder, uOrder);
+      randomKnots(vKnots, numVpoints + vOrder, vOrder);
+      for (int k = 0; k < numUpoints * numVpoints; k++)
+      {
+         float w = (dimension == 4) ? randomFloat(0.5, 2.0) : 1.0f;
+         for (int c = 0; c < 3; c++) controlPoints[dimension * k + c] = randomFloat(-10.0, 10.0) * w;
+         if (dimension == 4) controlPoints[dimension * k + 3] = w;
+      }
+
+      NurbsSurface surface;
+      makeNurbsSurface(surface, (int)uKnots.size(), &uKnots[0], (int)vKnots.size(), &vKnots[0],
+                       dimension * numVpoints, dimension, &controlPoints[0], uOrder, vOrder, dimension, 1 + rand() % 6);
+      if ( (surface.uParameters.size() < 2) || (surface.vParameters.size() < 2) ) continue;
+      randomTrim(surface);
+      trimNurbsSurface(surface);
+      numLoops += (long)surface.trimLoops.size();
+
+      // Area, orientation, and the edges without a twin.
+      double area = 0.0, boundary = 0.0, loopArea, loopLength;
+      map< pair<unsigned int, unsigned int>, int > edges;
+      for (int t = 0; t < surface.numTriangleIndices; t += 3)
+      {
+         double u[3], v[3];
+         for (int c = 0; c < 3; c++) vertexParameters(surface, surface.indices[t + c], u[c], v[c]);
+         double triangleArea = 0.5 * ((u[1] - u[0]) * (v[2] - v[0]) - (v[1] - v[0]) * (u[2] - u[0]));
+         if (triangleArea <= 0.0) numInverted++;
+         area += triangleArea;
+         for (int c = 0; c < 3; c++)
+         {
+            unsigned int a = surface.indices[t + c], b = surface.indices[t + (c + 1) % 3];
+            map< pair<unsigned int, unsigned int>, int >::iterator twin = edges.find(make_pair(b, a));
+            if (twin != edges.end() && twin->second > 0)
+            {
+               if (--twin->second == 0) edges.erase(twin);
+            }
+            else edges[make_pair(a, b)]++;
+         }
+      }
+      for (map< pair<unsigned int, unsigned int>, int >::iterator edge = edges.begin(); edge != edges.end(); edge++)
+      {
+         double u[2], v[2];
+         vertexParameters(surface, edge->first.first, u[0], v[0]);
+         vertexParameters(surface, edge->first.second, u[1], v[1]);
+         boundary += edge->second * hypot(u[1] - u[0], v[1] - v[0]);
+      }
+      measureLoops(surface, loopArea, loopLength);
+      areaError = max(areaError, fabs(area - loopArea) / loopArea);
+      boundaryError = max(boundaryError, fabs(boundary - loopLength) / loopLength);
+      numTriangles += surface.numTriangleIndices / 3;
+
+      // The trim's vertices.
+      evaluateNurbsSurface(surface);
+      int numGridVertices = (int)(surface.uParameters.size() * surface.vParameters.size());
+      for (int k = 0; k < (int)surface.trimParameters.size() / 2; k++)
+      {
+         float point[3];
+         evaluateSurfacePoint(surface, surface.trimParameters[2*k], surface.trimParameters[2*k + 1], point);
+         for (int c = 0; c < 3; c++)
+            largest = max(largest, (double)fabs(point[c] - surface.vertices[numGridVertices + k].coords[c]));
+      }
+
+      // Edits of single control points, each updated where it moved the surface,
+      // against the whole surface.
+      surface.firstColumn = surface.lastColumn = 0;
+      for (int e = 0; e < NUM_CHECKED_EDITS; e++)
+      {
+         int i = rand() % numUpoints, j = rand() % numVpoints;
+         float *controlPoint = &controlPoints[dimension * (i * numVpoints + j)];
+         for (int c = 0; c < dimension; c++) controlPoint[c] *= randomFloat(0.8, 1.25);
+         editNurbsControlPoint(surface, i, j);
+         evaluateNurbsSurface(surface);
+         surface.firstColumn = surface.lastColumn = 0;
+         numEdits++;
+      }
+      vector<NurbsVertex> updated = surface.vertices;
+      editNurbsSurface(surface);
+      evaluateNurbsSurface(surface);
+      for (int k = 0; k < (int)updated.size(); k++)
+         if (memcmp(&updated[k], &surface.vertices[k], sizeof(NurbsVertex)) != 0) numDiffering++;
+   }
+   printf("%9d %10ld %10ld %10ld %10.2g %10.2g %10.2g %10ld %10ld\n", NUM_CHECKED_SURFACES, numLoops, numTriangles,
+          numInverted, areaError, boundaryError, largest, numEdits, numDiffering);
+   printf("(Largest relative errors of the area and of the length of the boundary, largest distance of a vertex of\n"
+          "the trim from its point.)\n");
+}
+
+// A grid of numUpoints x numVpoints control points as the program's, 0.5 apart, on
+// clamped cubic knots 1 apart, with its trim loops scaled to the domain.
+struct TestSurface
+{
+   int numUpoints, numVpoints;
+   vector<float> uKnots, vKnots, controlPoints;
+   float uScale, vScale;
+   vector<float> boundary, circle, curve;
+};
+
+void makeTestSurface(TestSurface &test, int numUpoints, int numVpoints)
+{
+   test.numUpoints = numUpoints;
+   test.numVpoints = numVpoints;
+   test.uKnots.resize(numUpoints + 4);
+   test.vKnots.resize(numVpoints + 4);
+   for (int i = 0; i < numUpoints + 4; i++) test.uKnots[i] = (float)min(max(i - 3, 0), numUpoints - 3);
+   for (int j = 0; j < numVpoints + 4; j++) test.vKnots[j] = (float)min(max(j - 3, 0), numVpoints - 3);
+   test.controlPoints.resize(3 * numUpoints * numVpoints);
+   for (int i = 0; i < numUpoints; i++)
+      for (int j = 0; j < numVpoints; j++)
+      {
+         float *controlPoint = &test.controlPoints[3 * (i * numVpoints + j)];
+         controlPoint[0] = -2.5 + j * 0.5;
+         controlPoint[1] = 0.0;
+         controlPoint[2] = 6.0 - i;
+      }
+
+   test.uScale = (numUpoints - 3) / 12.0f;
+   test.vScale = (numVpoints - 3) / 7.0f;
+   test.boundary.clear();
+   test.circle.clear();
+   test.curve.clear();
+   for (int k = 0; k < 5; k++)
+   {
+      test.boundary.push_back(boundaryPoints[k][0] * test.uScale);
+      test.boundary.push_back(boundaryPoints[k][1] * test.vScale);
+   }
+   for (int k = 0; k < 11; k++)
+   {
+      test.circle.push_back(circlePoints[k][0] * test.uScale);
+      test.circle.push_back(circlePoints[k][1] * test.vScale);
+   }
+   for (int k = 0; k < 6; k++)
+   {
+      test.curve.push_back(curvePoints[k][0] * test.uScale);
+      test.curve.push_back(curvePoints[k][1] * test.vScale);
+   }
+}
+
+// Make the surface of the test and trim it by the program's loops.
+void makeTrimmedSurface(NurbsSurface &surface, TestSurface &test)
+{
+   makeNurbsSurface(surface, (int)test.uKnots.size(), &test.uKnots[0], (int)test.vKnots.size(), &test.vKnots[0],
+                    3 * test.numVpoints, 3, &test.controlPoints[0], 4, 4, 3, 2);
+   beginNurbsTrim(surface);
+   nurbsTrimPolyline(surface, 5, &test.boundary[0], 2);
+   beginNurbsTrim(surface);
+   nurbsTrimPolyline(surface, 11, &test.circle[0], 2);
+   beginNurbsTrim(surface);
+   nurbsTrimCurve(surface, 10, curveKnots, 2, &test.curve[0], 4);
+   trimNurbsSurface(surface);
+}
+
+// The program's view, scaled to fit the grid in.
+void setView(const TestSurface &test)
+{
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   gluPerspective(60.0, 1.0, 1.0, 50.0);
+   glMatrixMode(GL_MODELVIEW);
+   glLoadIdentity();
+   gluLookAt(0.0, 0.0, 12.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+   glRotatef(40.0, 0.0, 0.0, 1.0);
+   glRotatef(10.0, 0.0, 1.0, 0.0);
+   glRotatef(30.0, 1.0, 0.0, 0.0);
+   float scale = 15.0f / max(test.numUpoints, 2 * test.numVpoints);
+   glScalef(scale, scale, scale);
+}
+
+// Move the control point in the middle of the grid for frame number frame.
+void dragControlPoint(TestSurface &test, int frame)
+{
+   float *controlPoint = &test.controlPoints[3 * ((test.numUpoints / 2) * test.numVpoints + test.numVpoints / 2)];
+   controlPoint[1] = 2.0 * sin(0.1 * frame);
+}
+
+// Draw the trimmed surface of the test by GLU.
+void drawGluSurface(GLUnurbsObj *nurbsObject, TestSurface &test)
+{
+   gluBeginSurface(nurbsObject);
+   gluNurbsSurface(nurbsObject, (GLint)test.uKnots.size(), &test.uKnots[0], (GLint)test.vKnots.size(),
+                   &test.vKnots[0], 3 * test.numVpoints, 3, &test.controlPoints[0], 4, 4, GL_MAP2_VERTEX_3);
+   gluBeginTrim(nurbsObject);
+   gluPwlCurve(nurbsObject, 5, &test.boundary[0], 2, GLU_MAP1_TRIM_2);
+   gluEndTrim(nurbsObject);
+   gluBeginTrim(nurbsObject);
+   gluPwlCurve(nurbsObject, 11, &test.circle[0], 2, GLU_MAP1_TRIM_2);
+   gluEndTrim(nurbsObject);
+   gluBeginTrim(nurbsObject);
+   gluNurbsCurve(nurbsObject, 10, curveKnots, 2, &test.curve[0], 4, GLU_MAP1_TRIM_2);
+   gluEndTrim(nurbsObject);
+   gluEndSurface(nurbsObject);
+}
+
+// Callbacks of the GLU tessellator, counting its triangles.
+static long numGluTriangles = 0, numGluVertices = 0;
+static GLenum gluPrimitive;
+void beginGluPrimitive(GLenum type)
+{
+   gluPrimitive = type;
+   numGluVertices = 0;
+}
+
+void countGluVertex(GLfloat *)
+{
+   numGluVertices++;
+}
+
+void endGluPrimitive()
+{
+   if (gluPrimitive == GL_TRIANGLES) numGluTriangles += numGluVertices / 3;
+   else if (gluPrimitive == GL_QUADS) numGluTriangles += numGluVertices / 2;
+   else if ( (gluPrimitive == GL_TRIANGLE_STRIP) || (gluPrimitive == GL_TRIANGLE_FAN) ||
+             (gluPrimitive == GL_QUAD_STRIP) || (gluPrimitive == GL_POLYGON) )
+      numGluTriangles += max(numGluVertices - 2, 0L);
+}
+
+// Milliseconds per frame of the control point dragged, the surface drawn by GLU, or only
+// tessellated if tessellateOnly.
+double timeGluFrames(GLUnurbsObj *nurbsObject, TestSurface &test, bool tessellateOnly)
+{
+   int frames = 0;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   while ( (frames < MIN_FRAMES) || (milliseconds(start) < MIN_TIME) )
+   {
+      dragControlPoint(test, frames);
+      if (!tessellateOnly) glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      drawGluSurface(nurbsObject, test);
+      if (!tessellateOnly) glFinish();
+      frames++;
+   }
+   return milliseconds(start) / frames;
+}
+
+// The ways of retessellating the surface after a move.
+enum Retessellation { RETRIM, WHOLE, PART };
+
+// Retessellate the surface after the move of the control point in the middle.
+void retessellate(NurbsSurface &surface, TestSurface &test, Retessellation method)
+{
+   if (method == RETRIM) makeTrimmedSurface(surface, test);
+   else if (method == WHOLE) editNurbsSurface(surface);
+   else editNurbsControlPoint(surface, test.numUpoints / 2, test.numVpoints / 2);
+}
+
+// Milliseconds per frame of the control point dragged, the surface retessellated and
+// drawn, and per update alone; and the vertices evaluated per frame.
+void timeSurfaceFrames(NurbsSurface &surface, TestSurface &test, Retessellation method, double *times,
+                       long &numEvaluated)
+{
+   int frames = 0;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   while ( (frames < MIN_FRAMES) || (milliseconds(start) < MIN_TIME) )
+   {
+      dragControlPoint(test, frames);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      retessellate(surface, test, method);
+      updateNurbsSurface(surface);
+      drawNurbsSurface(surface, NURBS_FILL);
+      glFinish();
+      frames++;
+   }
+   times[0] = milliseconds(start) / frames;
+
+   frames = 0;
+   numEvaluated = 0;
+   start = chrono::steady_clock::now();
+   while ( (frames < MIN_FRAMES) || (milliseconds(start) < MIN_TIME / 4) )
+   {
+      dragControlPoint(test, frames);
+      retessellate(surface, test, method);
+      numEvaluated += (long)(surface.lastColumn - surface.firstColumn) * (surface.lastRow - surface.firstRow);
+      updateNurbsSurface(surface);
+      numEvaluated += surface.lastTrimVertex - surface.firstTrimVertex;
+      glFinish();
+      frames++;
+   }
+   times[1] = milliseconds(start) / frames;
+   numEvaluated /= frames;
+}
+
+// Time the dragging of a control point of a grid of numUpoints x numVpoints.
+void timeDragging(int numUpoints, int numVpoints)
+{
+   TestSurface test;
+   makeTestSurface(test, numUpoints, numVpoints);
+   setView(test);
+
+   NurbsSurface surface;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   makeTrimmedSurface(surface, test);
+   double trimTime = milliseconds(start);
+   start = chrono::steady_clock::now();
+   updateNurbsSurface(surface);
+   glFinish();
+   double loadTime = milliseconds(start);
+   int numColumns = (int)surface.uParameters.size(), numRows = (int)surface.vParameters.size();
+   int numTrimVertices = (int)surface.trimParameters.size() / 2;
+
+   GLUnurbsObj *nurbsObject = gluNewNurbsRenderer();
+   gluNurbsProperty(nurbsObject, GLU_NURBS_MODE, GLU_NURBS_TESSELLATOR);
+   gluNurbsProperty(nurbsObject, GLU_SAMPLING_METHOD, GLU_PATH_LENGTH);
+   gluNurbsProperty(nurbsObject, GLU_SAMPLING_TOLERANCE, 100.0);
+   gluNurbsCallback(nurbsObject, GLU_NURBS_BEGIN, (void (*)())beginGluPrimitive);
+   gluNurbsCallback(nurbsObject, GLU_NURBS_VERTEX, (void (*)())countGluVertex);
+   gluNurbsCallback(nurbsObject, GLU_NURBS_END, (void (*)())endGluPrimitive);
+   numGluTriangles = 0;
+   drawGluSurface(nurbsObject, test);
+   long gluTriangles = numGluTriangles;
+   double gluTessellation = timeGluFrames(nurbsObject, test, true);
+   gluNurbsProperty(nurbsObject, GLU_NURBS_MODE, GLU_NURBS_RENDERER);
+   gluNurbsProperty(nurbsObject, GLU_DISPLAY_MODE, GLU_FILL);
+
+   printf("\n%d x %d control points, %d x %d grid, %d vertices of the trim, %d triangles; GLU 100 px, %ld triangles\n",
+          numUpoints, numVpoints, numColumns, numRows, numTrimVertices, surface.numTriangleIndices / 3, gluTriangles);
+   printf("Made and trimmed in %.2f ms, first evaluated and loaded in %.2f ms\n", trimTime, loadTime);
+   printf("%-30s %10s %10s %10s\n", "ms per frame", "frame", "update", "vertices");
+   printf("%-30s %10.3f %10.3f\n", "GLU, 100 pixel path length", timeGluFrames(nurbsObject, test, false),
+          gluTessellation);
+   gluDeleteNurbsRenderer(nurbsObject);
+
+   const char *names[3] = { "nurbsSurface.h, retrimmed", "nurbsSurface.h, whole surface", "nurbsSurface.h, part moved" };
+   for (int method = RETRIM; method <= PART; method++)
+   {
+      double times[2];
+      long numEvaluated;
+      timeSurfaceFrames(surface, test, (Retessellation)method, times, numEvaluated);
+      printf("%-30s %10.3f %10.3f %10ld\n", names[method], times[0], times[1], numEvaluated);
+   }
+
+   glDeleteBuffers(2, surface.buffers);
+}
+
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+   glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
+   glutCreateWindow("trimmedSurfaceBenchmark.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   // The lighting of bicubicSplineSurfaceLitTextured.cpp.
+   glViewport(0, 0, WINDOW_SIZE, WINDOW_SIZE);
+   glEnable(GL_DEPTH_TEST);
+   glEnable(GL_LIGHTING);
+   glEnable(GL_LIGHT0);
+   glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+   glEnable(GL_AUTO_NORMAL);
+
+   for (int k = 0; k < 11; k++)
+   {
+      float t = 2 * PI * k / 10.0;
+      circlePoints[k][0] = 6.0 + 2.0 * sin(t);
+      circlePoints[k][1] = 3.5 + 2.0 * cos(t);
+   }
+
+   int size = (argc > 1) ? atoi(argv[1]) : 200;
+   checkTrims();
+   timeDragging(15, 10);
+   timeDragging(size, size);
+   return 0;
+}
@@ -0,0 +1,337 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// vertexFormats.cpp
+//
+// This program compares float and packed vertices (see vertexPacking.h) for a lit,
+// textured torus and cylinder of increasing tessellation. For each it reports the
+// size of the vertex buffer, the vertex-fetch traffic of a draw (vertex shader
+// invocations, counted by a pipeline statistics query where available, times the
+// vertex size), the time to draw it to completion, the largest error of the packed
+// attributes and the number of pixels whose color differs by more than 2/255 in some
+// channel between the two drawings.
+//
+// Usage:
+// vertexFormats [maximum number of slices]
+// The number of slices defaults to 1024.
+//
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <OpenGL/glext.h>
+#else
+#  include <GL/glew.h>
+#  include <GL/freeglut.h>
+#  include <GL/glext.h>
+#pragma comment(lib, "glew32.lib")
+#endif
+
+#include "meshBuilder.h"
+#include "vertexPacking.h"
+
+using namespace std;
+
+#define PI 3.14159265
+#define NUM_DRAWS 20 // Draws timed per format and size.
+#define WINDOW_SIZE 500 // Width and height of the window compared.
+#ifndef GL_VERTEX_SHADER_INVOCATIONS
+#define GL_VERTEX_SHADER_INVOCATIONS 0x82F0
+#endif
+
+// Float vertex, 36 bytes.
+struct Vertex
+{
+   float coords[4];
+   float normal[3];
+   float texCoords[2];
+};
+
+// Packed vertex, 16 bytes.
+struct PackedVertex
+{
+   short coords[4];
+   unsigned int normal;
+   unsigned short texCoords[2];
+};
+
+// Store of a surface point in either format.
+struct VertexStore
+{
+   MeshBounds bounds;
+
+   void store(Vertex &vertex, const SurfacePoint<float> &point) const
+   {
+      vertex.coords[0] = point.x; vertex.coords[1] = point.y; vertex.coords[2] = point.z; vertex.coords[3] = 1.0f;
+      vertex.normal[0] = point.nx; vertex.normal[1] = point.ny; vertex.normal[2] = point.nz;
+      vertex.texCoords[0] = point.s; vertex.texCoords[1] = point.t;
+   }
+
+   void store(PackedVertex &vertex, const SurfacePoint<float> &point) const
+   {
+      packPosition(vertex.coords, point.x, point.y, point.z, bounds);
+      vertex.normal = packNormal(point.nx, point.ny, point.nz);
+      vertex.texCoords[0] = packHalf(point.s);
+      vertex.texCoords[1] = packHalf(point.t);
+   }
+};
+
+// Torus of outer radius 0.6 and inner radius 0.3, with normals.
+struct TorusSurface : VertexStore
+{
+   AngleTable longAngles, latAngles;
+
+   TorusSurface(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -PI, 2.0 * PI / lats)
+   {
+      MeshBounds torBounds = { {0.0f, 0.0f, 0.0f}, {0.9f, 0.9f, 0.3f} };
+      bounds = torBounds;
+   }
+
+   template <class T>
+   void operator()(SurfacePoint<T> &point, const SurfaceAngle<T> &u, const SurfaceAngle<float> &v) const
+   {
+      float r = 0.6f + 0.3f * v.cosine;
+      point.x = r * u.cosine;
+      point.y = r * u.sine;
+      point.z = 0.3f * v.sine;
+      point.nx = v.cosine * u.cosine;
+      point.ny = v.cosine * u.sine;
+      point.nz = v.sine;
+   }
+};
+
+// Cylinder of radius 0.5 and height 1, with normals.
+struct CylinderSurface : VertexStore
+{
+   AngleTable longAngles, latAngles;
+
+   CylinderSurface(int longs, int lats) : longAngles(longs, -PI, 2.0 * PI / longs), latAngles(lats, -0.5, 1.0 / lats)
+   {
+      MeshBounds cylBounds = { {0.0f, 0.0f, 0.0f}, {0.5f, 0.5f, 0.5f} };
+      bounds = cylBounds;
+   }
+
+   template <class T>
+   void operator()(SurfacePoint<T> &point, const SurfaceAngle<T> &u, const SurfaceAngle<float> &v) const
+   {
+      point.x = 0.5f * u.cosine;
+      point.y = 0.5f * u.sine;
+      point.z = v.angle;
+      point.nx = u.cosine;
+      point.ny = u.sine;
+   }
+};
+
+static const char *vertexShader =
+   "#version 430 core\n"
+   "layout(location=0) in vec4 coords;\n"
+   "layout(location=1) in vec3 normal;\n"
+   "layout(location=2) in vec2 texCoords;\n"
+   "uniform vec3 meshCenter, meshExtent;\n"
+   "out vec4 colorsExport;\n"
+   "void main(void)\n"
+   "{\n"
+   "   vec3 position = meshCenter + meshExtent * coords.xyz;\n"
+   "   mat3 tilt = mat3(1.0, 0.0, 0.0, 0.0, 0.6, 0.8, 0.0, -0.8, 0.6);\n"
+   "   float diffuse = max(dot(normalize(tilt * normal), normalize(vec3(0.3, 0.5, 1.0))), 0.0);\n"
+   "   float checker = mod(floor(texCoords.s * 32.0) + floor(texCoords.t * 16.0), 2.0);\n"
+   "   colorsExport = vec4(diffuse * vec3(0.4 + 0.6 * checker, 0.7, 0.2), 1.0);\n"
+   "   gl_Position = vec4(tilt * position * vec3(1.0, 1.0, -0.5), 1.0);\n"
+   "}\n";
+static const char *fragmentShader =
+   "#version 430 core\n"
+   "in vec4 colorsExport;\n"
+   "out vec4 colorsOut;\n"
+   "void main(void) { colorsOut = colorsExport; }\n";
+
+// Largest errors of the packed vertices, decoded as the GL does, against the float ones:
+// of position, of normal direction in degrees and of texture co-ordinates.
+void packingErrors(const vector<Vertex> &vertices, const vector<PackedVertex> &packed, const MeshBounds &bounds,
+                   float errors[3])
+{
+   errors[0] = errors[1] = errors[2] = 0.0f;
+   for (int k = 0; k < (int)vertices.size(); k++)
+   {
+      float normal[3], length = 0.0f, cosine = 0.0f;
+      for (int c = 0; c < 3; c++)
+      {
+         float position = bounds.center[c] + bounds.extent[c] * max(packed[k].coords[c] / (float)PACKED_SNORM16_MAX, -1.0f);
+         errors[0] = max(errors[0], fabs(position - vertices[k].coords[c]));
+         int component = (int)(packed[k].normal << (22 - 10 * c)) >> 22;
+         normal[c] = max(component / (float)PACKED_SNORM10_MAX, -1.0f);
+         length += normal[c] * normal[c];
+      }
+      for (int c = 0; c < 3; c++) cosine += normal[c] * vertices[k].normal[c] / sqrt(length);
+      errors[1] = max(errors[1], (float)(acos(min(cosine, 1.0f)) * 180.0 / PI));
+      for (int c = 0; c < 2; c++)
+      {
+         unsigned int half = packed[k].texCoords[c], exponent = (half >> 10) & 31, bits;
+         float value;
+         if (exponent == 0) value = ldexp((float)(half & 1023), -24);
+         else
+         {
+            bits = (exponent + 112) << 23 | (half & 1023) << 13;
+            memcpy(&value, &bits, sizeof(value));
+         }
+         errors[2] = max(errors[2], fabs(value - vertices[k].texCoords[c]));
+      }
+   }
+}
+
+// Load the vertices of one format into the bound VAO and buffer.
+void loadVertices(const vector<Vertex> &vertices)
+{
+   glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
+   glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+   glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+}
+
+void loadVertices(const vector<PackedVertex> &vertices)
+{
+   glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PackedVertex), &vertices[0], GL_STATIC_DRAW);
+   glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, sizeof(PackedVertex), 0);
+   glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+   glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoords));
+}
+
+// Draw a mesh once to read back its image and count its vertex shader invocations,
+// then time NUM_DRAWS draws; return the time per draw in milliseconds.
+template <class VertexType>
+double drawMesh(const GridMesh<VertexType> &mesh, bool hasStatistics, long long *invocations,
+                vector<unsigned char> &image)
+{
+   unsigned int query;
+   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+   if (hasStatistics)
+   {
+      glGenQueries(1, &query);
+      glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS, query);
+   }
+   glDrawElements(GL_TRIANGLES, (int)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+   if (hasStatistics)
+   {
+      glEndQuery(GL_VERTEX_SHADER_INVOCATIONS);
+      GLuint64 count;
+      glGetQueryObjectui64v(query, GL_QUERY_RESULT, &count);
+      *invocations = (long long)count;
+      glDeleteQueries(1, &query);
+   }
+   else *invocations = (long long)mesh.indices.size();
+   image.resize(4 * WINDOW_SIZE * WINDOW_SIZE);
+   glReadPixels(0, 0, WINDOW_SIZE, WINDOW_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, &image[0]);
+
+   glFinish();
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   for (int k = 0; k < NUM_DRAWS; k++) glDrawElements(GL_TRIANGLES, (int)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+   glFinish();
+   return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / NUM_DRAWS;
+}
+
+// Build, load and compare the two formats of a surface for each tessellation.
+template <class Surface>
+void compareFormats(const char *name, int programId, int maxSlices, bool hasStatistics)
+{
+   printf("%s\n%9s %-6s %6s %12s %12s %10s %10s %10s %10s %8s\n", name, "slices", "format", "bytes", "buffer KB",
+          "fetched KB", "draw ms", "pos err", "normal deg", "tex err", "pixels");
+   for (int slices = 16; slices <= maxSlices; slices *= 4)
+   {
+      Surface surface(slices, slices);
+      GridMesh<Vertex> mesh;
+      GridMesh<PackedVertex> packedMesh;
+      buildSurfaceMesh(mesh, slices, slices, surface, MESH_TRIANGLES);
+      buildSurfaceMesh(packedMesh, slices, slices, surface, MESH_TRIANGLES);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), &mesh.indices[0], GL_STATIC_DRAW);
+
+      long long invocations, packedInvocations;
+      vector<unsigned char> image, packedImage;
+      glUniform3f(glGetUniformLocation(programId, "meshCenter"), 0.0, 0.0, 0.0);
+      glUniform3f(glGetUniformLocation(programId, "meshExtent"), 1.0, 1.0, 1.0);
+      loadVertices(mesh.vertices);
+      double drawTime = drawMesh(mesh, hasStatistics, &invocations, image);
+      glUniform3fv(glGetUniformLocation(programId, "meshCenter"), 1, surface.bounds.center);
+      glUniform3fv(glGetUniformLocation(programId, "meshExtent"), 1, surface.bounds.extent);
+      loadVertices(packedMesh.vertices);
+      double packedDrawTime = drawMesh(packedMesh, hasStatistics, &packedInvocations, packedImage);
+
+      float errors[3];
+      packingErrors(mesh.vertices, packedMesh.vertices, surface.bounds, errors);
+      int differing = 0;
+      for (int k = 0; k < WINDOW_SIZE * WINDOW_SIZE; k++)
+      {
+         bool isDifferent = false;
+         for (int c = 0; c < 3; c++) isDifferent |= (abs(image[4 * k + c] - packedImage[4 * k + c]) > 2);
+         differing += isDifferent;
+      }
+
+      printf("%4dx%-4d %-6s %6d %12.1f %12.1f %10.2f\n", slices, slices, "float", (int)sizeof(Vertex),
+             mesh.vertices.size() * sizeof(Vertex) / 1024.0, invocations * sizeof(Vertex) / 1024.0, drawTime);
+      printf("%9s %-6s %6d %12.1f %12.1f %10.2f %10.2g %10.3f %10.2g %8d\n", "", "packed", (int)sizeof(PackedVertex),
+             packedMesh.vertices.size() * sizeof(PackedVertex) / 1024.0, packedInvocations * sizeof(PackedVertex) / 1024.0,
+             packedDrawTime, errors[0], errors[1], errors[2], differing);
+   }
+}
+
+// Set up the GL state and run the comparisons.
+void runBenchmark(int maxSlices)
+{
+   int programId = glCreateProgram();
+   const char *sources[2] = { vertexShader, fragmentShader };
+   GLenum stages[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+   for (int i = 0; i < 2; i++)
+   {
+      int shaderId = glCreateShader(stages[i]);
+      glShaderSource(shaderId, 1, &sources[i], NULL);
+      glCompileShader(shaderId);
+      glAttachShader(programId, shaderId);
+   }
+   glLinkProgram(programId);
+   glUseProgram(programId);
+
+   unsigned int vao, buffer[2];
+   glGenVertexArrays(1, &vao);
+   glGenBuffers(2, buffer);
+   glBindVertexArray(vao);
+   glBindBuffer(GL_ARRAY_BUFFER, buffer[0]);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer[1]);
+   for (int i = 0; i < 3; i++) glEnableVertexAttribArray(i);
+   glEnable(GL_DEPTH_TEST);
+   glClearColor(1.0, 1.0, 1.0, 0.0);
+
+   // Vertex shader invocations are counted with ARB_pipeline_statistics_query (core in
+   // GL 4.6), otherwise every index is taken to be fetched.
+   bool hasStatistics = false;
+   int numExtensions;
+   glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+   for (int i = 0; i < numExtensions; i++)
+      if (!strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_pipeline_statistics_query")) hasStatistics = true;
+   printf("Fetched vertices %s.\n\n", hasStatistics ? "from vertex shader invocations" : "taken as indices");
+
+   compareFormats<TorusSurface>("Lit, textured torus", programId, maxSlices, hasStatistics);
+   printf("\n");
+   compareFormats<CylinderSurface>("Lit, textured cylinder", programId, maxSlices, hasStatistics);
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+   glutInit(&argc, argv);
+   glutInitContextVersion(4, 3);
+   glutInitContextProfile(GLUT_CORE_PROFILE);
+   glutInitContextFlags(GLUT_FORWARD_COMPATIBLE);
+   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+   glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
+   glutCreateWindow("vertexFormats.cpp");
+   glewExperimental = GL_TRUE;
+   glewInit();
+
+   runBenchmark(argc > 1 ? atoi(argv[1]) : 1024);
+   return 0;
+}